@@ -0,0 +1,136 @@
+/*  KStars Altitude Curves tests
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testaltitudecurves.h"
+
+#include "auxiliary/altitudecurves.h"
+#include "auxiliary/geolocation.h"
+#include "skyobjects/skypoint.h"
+
+TestAltitudeCurves::TestAltitudeCurves(QObject *parent) : QObject(parent)
+{
+}
+
+void TestAltitudeCurves::init()
+{
+    AltitudeCurves::clearCache();
+}
+
+void TestAltitudeCurves::testMatchesScalar()
+{
+    GeoLocation geo(dms(-70.8), dms(-30.2));
+    KStarsDateTime const start(QDate(2021, 3, 20), QTime(18, 0), Qt::UTC);
+
+    QList<SkyPoint> points;
+    points << SkyPoint(dms(0.0), dms(0.0)) << SkyPoint(dms(83.8), dms(-5.4)) << SkyPoint(dms(201.3), dms(-43.0))
+           << SkyPoint(dms(37.9), dms(89.3)) << SkyPoint(dms(279.2), dms(38.8));
+
+    QVector<const SkyPoint *> targets;
+    for (const SkyPoint &point : points)
+        targets.append(&point);
+
+    AltitudeCurves curves(&geo, start, 0.25, 97);
+    curves.compute(targets);
+    QCOMPARE(curves.samples(), 97);
+    QCOMPARE(curves.targets(), points.size());
+
+    for (int j = 0; j < points.size(); j++)
+    {
+        for (int i = 0; i < curves.samples(); i++)
+        {
+            SkyPoint sp = points[j];
+            CachingDms const LST = geo.GSTtoLST(start.addSecs(i * 900).gst());
+            sp.EquatorialToHorizontal(&LST, geo.lat());
+
+            QVERIFY(qAbs(curves.lst(i).Degrees() - LST.Degrees()) < 1e-9);
+            QVERIFY(qAbs(curves.altitude(j, i) - sp.alt().Degrees()) < 1e-6);
+            double dAz = qAbs(curves.azimuths(j)[i] - sp.az().Degrees());
+            // The azimuth of the pole is unstable, and wraps at 360 degrees
+            QVERIFY(qMin(dAz, 360.0 - dAz) < 1e-6 || qAbs(sp.alt().Degrees()) > 89.9);
+        }
+    }
+}
+
+void TestAltitudeCurves::testCache()
+{
+    GeoLocation geo(dms(2.3), dms(48.8));
+    KStarsDateTime const start(QDate(2021, 6, 21), QTime(12, 0), Qt::UTC);
+    SkyPoint const vega(dms(279.2), dms(38.8));
+    SkyPoint const deneb(dms(310.4), dms(45.3));
+
+    AltitudeCurves first(&geo, start, 0.5, 49);
+    first.compute(QVector<const SkyPoint *>() << &vega);
+    QCOMPARE(first.computedTargets(), 1);
+
+    // A cached curve is returned with the new target computed alongside
+    AltitudeCurves second(&geo, start, 0.5, 49);
+    second.compute(QVector<const SkyPoint *>() << &deneb << &vega);
+    QCOMPARE(second.computedTargets(), 1);
+    for (int i = 0; i < 49; i++)
+        QCOMPARE(second.altitude(1, i), first.altitude(0, i));
+
+    // Both are cached now
+    second.compute(QVector<const SkyPoint *>() << &vega << &deneb);
+    QCOMPARE(second.computedTargets(), 0);
+    for (int i = 0; i < 49; i++)
+        QCOMPARE(second.altitude(0, i), first.altitude(0, i));
+
+    // Another site gives another curve
+    GeoLocation other(dms(2.3), dms(-48.8));
+    AltitudeCurves third(&other, start, 0.5, 49);
+    third.compute(QVector<const SkyPoint *>() << &vega);
+    QCOMPARE(third.computedTargets(), 1);
+    QVERIFY(third.altitude(0, 0) != first.altitude(0, 0));
+
+    // Another step too
+    AltitudeCurves fourth(&geo, start, 0.25, 49);
+    fourth.compute(QVector<const SkyPoint *>() << &vega);
+    QCOMPARE(fourth.computedTargets(), 1);
+}
+
+void TestAltitudeCurves::testUncached()
+{
+    GeoLocation geo(dms(2.3), dms(48.8));
+    KStarsDateTime const start(QDate(2021, 6, 21), QTime(12, 0), Qt::UTC);
+    SkyPoint const vega(dms(279.2), dms(38.8));
+
+    AltitudeCurves cached(&geo, start, 0.5, 49);
+    cached.compute(QVector<const SkyPoint *>() << &vega);
+
+    // Uncached curves ignore the cache, but give the same altitudes
+    AltitudeCurves uncached(&geo, start, 0.5, 49, false);
+    uncached.compute(QVector<const SkyPoint *>() << &vega);
+    QCOMPARE(uncached.computedTargets(), 1);
+    for (int i = 0; i < 49; i++)
+        QCOMPARE(uncached.altitude(0, i), cached.altitude(0, i));
+
+    // And do not fill it
+    AltitudeCurves::clearCache();
+    uncached.compute(QVector<const SkyPoint *>() << &vega);
+    AltitudeCurves again(&geo, start, 0.5, 49);
+    again.compute(QVector<const SkyPoint *>() << &vega);
+    QCOMPARE(again.computedTargets(), 1);
+}
+
+void TestAltitudeCurves::testEmpty()
+{
+    GeoLocation geo(dms(0.0), dms(0.0));
+    KStarsDateTime const start(QDate(2021, 1, 1), QTime(0, 0), Qt::UTC);
+
+    AltitudeCurves noSamples(&geo, start, 1, 0);
+    SkyPoint const point(dms(10.0), dms(20.0));
+    noSamples.compute(QVector<const SkyPoint *>() << &point);
+    QCOMPARE(noSamples.samples(), 0);
+
+    AltitudeCurves noTargets(&geo, start, 1, 24);
+    noTargets.compute(QVector<const SkyPoint *>());
+    QCOMPARE(noTargets.targets(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestAltitudeCurves)
@@ -0,0 +1,31 @@
+/*  KStars Altitude Curves tests
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTALTITUDECURVES_H
+#define TESTALTITUDECURVES_H
+
+#include <QtTest>
+#include <QObject>
+
+class TestAltitudeCurves : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TestAltitudeCurves(QObject *parent = nullptr);
+
+private slots:
+    void init();
+
+    void testMatchesScalar();
+    void testCache();
+    void testUncached();
+    void testEmpty();
+};
+
+#endif // TESTALTITUDECURVES_H
@@ -0,0 +1,132 @@
+/*  KStars Profiler tests
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testksprofiler.h"
+
+#include "auxiliary/ksprofiler.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtConcurrent>
+
+TestKSProfiler::TestKSProfiler(QObject *parent) : QObject(parent)
+{
+}
+
+void TestKSProfiler::init()
+{
+    KSProfiler::Instance()->clear();
+    KSProfiler::Instance()->setEnabled(true);
+}
+
+void TestKSProfiler::cleanup()
+{
+    KSProfiler::Instance()->setEnabled(false);
+    KSProfiler::Instance()->clear();
+}
+
+void TestKSProfiler::testDisabled()
+{
+    KSProfiler::Instance()->setEnabled(false);
+    QVERIFY(!KSProfiler::isEnabled());
+
+    {
+        KSPROFILE_SCOPE("test", QStringLiteral("disabled"));
+    }
+    KSProfiler::Instance()->counter("test", "disabled counter", 5);
+
+    QJsonObject stats = KSProfiler::Instance()->statistics();
+    QVERIFY(!stats.contains("test"));
+}
+
+void TestKSProfiler::testScopeStatistics()
+{
+    for (int i = 0; i < 3; i++)
+    {
+        KSPROFILE_SCOPE("test", QStringLiteral("sleep"));
+        QThread::msleep(10);
+    }
+
+    QJsonObject sleep = KSProfiler::Instance()->statistics()["test"].toObject()["sleep"].toObject();
+    QCOMPARE(sleep["count"].toInt(), 3);
+    QVERIFY(sleep["last"].toDouble() >= 9);
+    QVERIFY(sleep["average"].toDouble() >= 9);
+    QVERIFY(sleep["max"].toDouble() >= sleep["average"].toDouble());
+}
+
+void TestKSProfiler::testCounter()
+{
+    KSProfiler::Instance()->counter("test", "stars", 10);
+    KSProfiler::Instance()->counter("test", "stars", 42);
+
+    QJsonObject stars = KSProfiler::Instance()->statistics()["test"].toObject()["stars"].toObject();
+    QCOMPARE(stars["count"].toInt(), 2);
+    QCOMPARE(stars["value"].toInt(), 42);
+}
+
+void TestKSProfiler::testChromeTrace()
+{
+    {
+        KSPROFILE_SCOPE("test", QStringLiteral("outer \"quoted\""));
+        KSPROFILE_SCOPE("test", QStringLiteral("inner"));
+        KSProfiler::Instance()->counter("test", "value", 7);
+    }
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString filename = dir.path() + "/trace.json";
+    QVERIFY(KSProfiler::Instance()->writeTrace(filename));
+
+    QFile file(filename);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QJsonParseError error;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+
+    QJsonArray events = document.object()["traceEvents"].toArray();
+    QCOMPARE(events.size(), 3);
+
+    // Scopes are recorded when they end, so the inner one comes first
+    QJsonObject counter = events[0].toObject();
+    QCOMPARE(counter["ph"].toString(), QString("C"));
+    QCOMPARE(counter["args"].toObject()["value"].toInt(), 7);
+
+    QJsonObject inner = events[1].toObject();
+    QJsonObject outer = events[2].toObject();
+    QCOMPARE(inner["ph"].toString(), QString("X"));
+    QCOMPARE(inner["cat"].toString(), QString("test"));
+    QCOMPARE(outer["name"].toString(), QString("outer \"quoted\""));
+    QVERIFY(outer["ts"].toDouble() <= inner["ts"].toDouble());
+    QVERIFY(outer["dur"].toDouble() >= inner["dur"].toDouble());
+    QCOMPARE(outer["tid"].toInt(), inner["tid"].toInt());
+}
+
+void TestKSProfiler::testThreads()
+{
+    QList<QFuture<void>> futures;
+    for (int i = 0; i < 4; i++)
+    {
+        futures.append(QtConcurrent::run([]()
+        {
+            for (int j = 0; j < 1000; j++)
+            {
+                KSPROFILE_SCOPE("test", QStringLiteral("worker"));
+            }
+        }));
+    }
+    for (auto &future : futures)
+        future.waitForFinished();
+
+    QJsonObject worker = KSProfiler::Instance()->statistics()["test"].toObject()["worker"].toObject();
+    QCOMPARE(worker["count"].toInt(), 4000);
+}
+
+QTEST_GUILESS_MAIN(TestKSProfiler)
@@ -0,0 +1,33 @@
+/*  KStars Profiler tests
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTKSPROFILER_H
+#define TESTKSPROFILER_H
+
+#include <QtTest>
+#include <QObject>
+
+class TestKSProfiler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TestKSProfiler(QObject *parent = nullptr);
+
+private slots:
+    void init();
+    void cleanup();
+
+    void testDisabled();
+    void testScopeStatistics();
+    void testCounter();
+    void testChromeTrace();
+    void testThreads();
+};
+
+#endif // TESTKSPROFILER_H
@@ -0,0 +1,160 @@
+/*  KStars Record Parser tests
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testrecordparser.h"
+
+#include "ksrecordparser.h"
+
+#include <cmath>
+
+TestRecordParser::TestRecordParser(QObject *parent) : QObject(parent)
+{
+}
+
+QString TestRecordParser::writeFile(const QByteArray &contents)
+{
+    static int count = 0;
+    QString const name = m_Dir.filePath(QString("records%1.txt").arg(count++));
+    QFile file(name);
+    if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size())
+        return QString();
+    return name;
+}
+
+void TestRecordParser::testNumbers()
+{
+    const char *numbers[] = { "0", ".07582276595896797", "2.557665961167666", "-3.141", " 1.5E-3 ", "20130916.6150519",
+                              "6.02214076e23", "123456789012345678901234"
+                            };
+    for (const char *number : numbers)
+    {
+        bool ok = false;
+        double const value = KSRecordParser::Text(number, qstrlen(number)).toDouble(&ok);
+        QVERIFY(ok);
+        QCOMPARE(value, QByteArray(number).trimmed().toDouble());
+    }
+
+    const char *invalid[] = { "", " ", "abc", "1.2.3", "e5", "-", "1e", "3x" };
+    for (const char *number : invalid)
+    {
+        bool ok = true;
+        QCOMPARE(KSRecordParser::Text(number, qstrlen(number)).toDouble(&ok), 0.0);
+        QVERIFY(!ok);
+    }
+
+    QVERIFY(std::isnan(KSRecordParser::Text("nan", 3).toDouble()));
+
+    bool ok = false;
+    QCOMPARE(KSRecordParser::Text(" -12 ", 5).toInt(&ok), -12);
+    QVERIFY(ok);
+    QCOMPARE(KSRecordParser::Text("3.0", 3).toInt(&ok), 0);
+    QVERIFY(!ok);
+    QCOMPARE(KSRecordParser::Text("99999999999", 11).toInt(&ok), 0);
+    QVERIFY(!ok);
+}
+
+void TestRecordParser::testCSV()
+{
+    QString const name = writeFile("\n"
+                                   "# comment,with,fields\n"
+                                   ",isn't,\"amusing\",3,\"isn't, pi\",-3.141,either\n"
+                                   ",isn't,\"quotes\"(, )\"in\",3,\"\",-3.141,either\r\n"
+                                   ",too,few,fields\n"
+                                   "too,many,fields,4,a,b,c,d\n"
+                                   ",,,,,,\n"
+                                   "last,row,\"without\",7,newline,1e2,end");
+    QVERIFY(!name.isEmpty());
+
+    KSRecordParser::Text first, second, third, fifth, last;
+    int number  = -1;
+    float value = -1;
+    KSRecordParser parser(name, '#', { &first, &second, &third, &number, &fifth, &value, &last });
+    QVERIFY(parser.isOpen());
+
+    QVERIFY(parser.readRow());
+    QVERIFY(first.isEmpty());
+    QCOMPARE(second.toString(), QString("isn't"));
+    QCOMPARE(third.toString(), QString("amusing"));
+    QCOMPARE(number, 3);
+    QCOMPARE(fifth.toString(), QString("isn't, pi"));
+    QCOMPARE(value, -3.141f);
+    QCOMPARE(last.toString(), QString("either"));
+
+    QVERIFY(parser.readRow());
+    QCOMPARE(third.toString(), QString("quotes\"(, )\"in"));
+    QVERIFY(fifth.isEmpty());
+    // The carriage return is not part of the field
+    QCOMPARE(last.toString(), QString("either"));
+
+    // Rows with a wrong number of fields are skipped
+    QVERIFY(parser.readRow());
+    QVERIFY(first.isEmpty());
+    QVERIFY(second.isEmpty());
+    QCOMPARE(number, 0);
+    QCOMPARE(value, 0.0f);
+
+    QVERIFY(parser.readRow());
+    QCOMPARE(first.latin1(), QLatin1String("last"));
+    QCOMPARE(third.toString(), QString("without"));
+    QCOMPARE(number, 7);
+    QCOMPARE(value, 100.0f);
+    QCOMPARE(last.toString(), QString("end"));
+
+    QVERIFY(!parser.readRow());
+    QVERIFY(!parser.readRow());
+    QCOMPARE(parser.progress(), 1.0);
+    // Fields stay valid after the end of the file
+    QCOMPARE(last.toString(), QString("end"));
+}
+
+void TestRecordParser::testFixedWidth()
+{
+    QString const name = writeFile("# comment\n"
+                                   "N 224 0042.7 +4116 M 31 Andromeda Galaxy  \n"
+                                   "short\n"
+                                   "I1234 1234.5 -0102\n");
+    QVERIFY(!name.isEmpty());
+
+    KSRecordParser::Text flag, longname;
+    int id       = -1;
+    double ra    = -1;
+    int dec      = -1;
+    KSRecordParser parser(name, '#', { &flag, &id, &ra, &dec, &longname }, { 1, 4, 7, 6 });
+    QVERIFY(parser.isOpen());
+
+    QVERIFY(parser.readRow());
+    QCOMPARE(flag.latin1(), QLatin1String("N"));
+    QCOMPARE(id, 224);
+    QCOMPARE(ra, 42.7);
+    QCOMPARE(dec, 4116);
+    // Fields are trimmed, and the last one runs to the end of the line
+    QCOMPARE(longname.toString(), QString("M 31 Andromeda Galaxy"));
+
+    // Short lines are skipped
+    QVERIFY(parser.readRow());
+    QCOMPARE(flag.latin1(), QLatin1String("I"));
+    QCOMPARE(id, 1234);
+    QCOMPARE(ra, 1234.5);
+    QCOMPARE(dec, -102);
+    QVERIFY(longname.isEmpty());
+
+    QVERIFY(!parser.readRow());
+}
+
+void TestRecordParser::testMissingFile()
+{
+    KSRecordParser::Text field;
+    KSRecordParser parser(m_Dir.filePath("missing.txt"), '#', { &field, {} });
+    QVERIFY(!parser.isOpen());
+    for (int i = 0; i < 3; i++)
+        QVERIFY(!parser.readRow());
+    QVERIFY(field.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestRecordParser)
@@ -0,0 +1,35 @@
+/*  KStars Record Parser tests
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TESTRECORDPARSER_H
+#define TESTRECORDPARSER_H
+
+#include <QtTest>
+#include <QObject>
+#include <QTemporaryDir>
+
+class TestRecordParser : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TestRecordParser(QObject *parent = nullptr);
+
+private slots:
+    void testNumbers();
+    void testCSV();
+    void testFixedWidth();
+    void testMissingFile();
+
+private:
+    QString writeFile(const QByteArray &contents);
+
+    QTemporaryDir m_Dir;
+};
+
+#endif // TESTRECORDPARSER_H
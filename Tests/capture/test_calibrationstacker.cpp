@@ -0,0 +1,221 @@
+/*  KStars tests
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "test_calibrationstacker.h"
+#include "ekos/auxiliary/calibrationstacker.h"
+
+#include <fitsio.h>
+
+TestCalibrationStacker::TestCalibrationStacker() : QObject()
+{
+}
+
+QString TestCalibrationStacker::writeFrame(const QVector<float> &pixels, int width, int height)
+{
+    QString filename = m_Directory.filePath(QString("frame_%1.fits").arg(m_FrameCounter++));
+    fitsfile *fptr = nullptr;
+    int status = 0;
+    long naxes[2] = {width, height};
+
+    fits_create_file(&fptr, QString("!%1").arg(filename).toLocal8Bit(), &status);
+    fits_create_img(fptr, USHORT_IMG, 2, naxes, &status);
+    fits_write_img(fptr, TFLOAT, 1, pixels.size(), const_cast<float *>(pixels.constData()), &status);
+    fits_close_file(fptr, &status);
+    if (status)
+        return QString();
+
+    return filename;
+}
+
+QVector<float> TestCalibrationStacker::readFrame(const QString &filename, int *bitpix)
+{
+    fitsfile *fptr = nullptr;
+    int status = 0, anynull = 0, type = 0;
+    long naxes[2] = {0, 0};
+
+    fits_open_diskfile(&fptr, filename.toLocal8Bit(), READONLY, &status);
+    fits_get_img_equivtype(fptr, &type, &status);
+    fits_get_img_size(fptr, 2, naxes, &status);
+    QVector<float> pixels(naxes[0] * naxes[1]);
+    fits_read_img(fptr, TFLOAT, 1, pixels.size(), nullptr, pixels.data(), &anynull, &status);
+    fits_close_file(fptr, &status);
+
+    if (bitpix)
+        *bitpix = type;
+
+    return status ? QVector<float>() : pixels;
+}
+
+void TestCalibrationStacker::testSigmaClippedMean()
+{
+    Ekos::CalibrationStacker stacker;
+    QVERIFY(stacker.start(FRAME_DARK));
+
+    // Twenty frames alternating between 100 and 110
+    for (int i = 0; i < 20; i++)
+        QVERIFY(stacker.addFrame(writeFrame(QVector<float>(4 * 3, (i % 2) ? 110 : 100), 4, 3)));
+
+    // One more at the mean level, with a cosmic ray hit at the first pixel
+    QVector<float> pixels(4 * 3, 105);
+    pixels[0] = 60000;
+    QVERIFY(stacker.addFrame(writeFrame(pixels, 4, 3)));
+    QCOMPARE(stacker.count(), 21);
+
+    const QString master = m_Directory.filePath("master.fits");
+    QVERIFY2(stacker.finish(master), stacker.errorMessage().toLatin1());
+
+    int bitpix = 0;
+    QVector<float> result = readFrame(master, &bitpix);
+    QCOMPARE(result.size(), 12);
+    QCOMPARE(bitpix, USHORT_IMG);
+    for (const float value : result)
+        QCOMPARE(value, 105.0f);
+}
+
+void TestCalibrationStacker::testClippingLimit()
+{
+    Ekos::CalibrationStacker stacker;
+    QVERIFY(stacker.start(FRAME_DARK));
+
+    // Each rejection pass only removes the farthest outlier, so the pass limit is reached
+    for (int i = 0; i < 20; i++)
+        QVERIFY(stacker.addFrame(writeFrame(QVector<float>(2, (i % 2) ? 101 : 99), 2, 1)));
+    const float outliers[] = {60000, 20000, 7000, 2500, 900, 400, 200};
+    for (const float outlier : outliers)
+        QVERIFY(stacker.addFrame(writeFrame(QVector<float>(2, outlier), 2, 1)));
+
+    const QString master = m_Directory.filePath("limit.fits");
+    QVERIFY(stacker.finish(master));
+
+    // Mean of the frames left after the last pass, 20 frames, 400 and 200, rounded to 16 bits
+    for (const float value : readFrame(master))
+        QCOMPARE(value, 118.0f);
+}
+
+void TestCalibrationStacker::testMedian()
+{
+    Ekos::CalibrationStacker stacker;
+    QVERIFY(stacker.start(FRAME_BIAS, Ekos::CalibrationStacker::STACK_MEDIAN));
+
+    const float levels[] = {10, 50, 20, 40};
+    for (const float level : levels)
+        QVERIFY(stacker.addFrame(writeFrame(QVector<float>(6, level), 3, 2)));
+
+    const QString master = m_Directory.filePath("median.fits");
+    QVERIFY(stacker.finish(master));
+
+    // Even number of frames, average of 20 and 40
+    for (const float value : readFrame(master))
+        QCOMPARE(value, 30.0f);
+}
+
+void TestCalibrationStacker::testTiling()
+{
+    const int width = 64, height = 50, frames = 5;
+
+    // A memory limit of a few rows forces many tiles, including a short last one
+    Ekos::CalibrationStacker stacker;
+    QVERIFY(stacker.start(FRAME_DARK, Ekos::CalibrationStacker::STACK_MEDIAN, 3, width * sizeof(float) * (frames + 1) * 7));
+
+    for (int i = 0; i < frames; i++)
+    {
+        QVector<float> pixels(width * height);
+        for (int p = 0; p < pixels.size(); p++)
+            pixels[p] = p % 1000 + i;
+        QVERIFY(stacker.addFrame(writeFrame(pixels, width, height)));
+    }
+
+    const QString master = m_Directory.filePath("tiled.fits");
+    QVERIFY(stacker.finish(master));
+
+    QVector<float> result = readFrame(master);
+    QCOMPARE(result.size(), width * height);
+    for (int p = 0; p < result.size(); p++)
+        QCOMPARE(result[p], static_cast<float>(p % 1000 + 2));
+}
+
+void TestCalibrationStacker::testFlatScaling()
+{
+    Ekos::CalibrationStacker stacker;
+    QVERIFY(stacker.start(FRAME_FLAT));
+
+    // Same vignetting pattern at three brightness levels
+    const float scales[] = {1, 2, 0.5};
+    for (const float scale : scales)
+    {
+        QVector<float> pixels = {1000, 2000, 3000, 2000};
+        for (float &value : pixels)
+            value *= scale;
+        QVERIFY(stacker.addFrame(writeFrame(pixels, 2, 2)));
+    }
+
+    const QString master = m_Directory.filePath("flat.fits");
+    QVERIFY(stacker.finish(master));
+    QCOMPARE(readFrame(master), QVector<float>({1000, 2000, 3000, 2000}));
+}
+
+void TestCalibrationStacker::testSizeMismatch()
+{
+    Ekos::CalibrationStacker stacker;
+    QVERIFY(stacker.start(FRAME_DARK));
+    QVERIFY(stacker.addFrame(writeFrame(QVector<float>(4, 1), 2, 2)));
+    QVERIFY(!stacker.addFrame(writeFrame(QVector<float>(6, 1), 3, 2)));
+    QVERIFY(!stacker.errorMessage().isEmpty());
+    QCOMPARE(stacker.count(), 1);
+
+    // Nothing to combine without start()
+    Ekos::CalibrationStacker idle;
+    QVERIFY(!idle.finish(m_Directory.filePath("none.fits")));
+}
+
+void TestCalibrationStacker::testKeywords()
+{
+    Ekos::CalibrationStacker stacker;
+    QVERIFY(stacker.start(FRAME_DARK));
+
+    // Acquisition keywords of the first frame describe the master
+    QString first = writeFrame(QVector<float>(4, 100), 2, 2);
+    fitsfile *fptr = nullptr;
+    int status = 0, binning = 2;
+    double exposure = 120, temperature = -10;
+    char camera[] = "CCD Simulator";
+    fits_open_diskfile(&fptr, first.toLocal8Bit(), READWRITE, &status);
+    fits_update_key(fptr, TDOUBLE, "EXPTIME", &exposure, nullptr, &status);
+    fits_update_key(fptr, TDOUBLE, "CCD-TEMP", &temperature, nullptr, &status);
+    fits_update_key(fptr, TINT, "XBINNING", &binning, nullptr, &status);
+    fits_update_key(fptr, TSTRING, "INSTRUME", camera, nullptr, &status);
+    fits_close_file(fptr, &status);
+    QCOMPARE(status, 0);
+
+    QVERIFY(stacker.addFrame(first));
+    QVERIFY(stacker.addFrame(writeFrame(QVector<float>(4, 100), 2, 2)));
+
+    const QString master = m_Directory.filePath("keywords.fits");
+    QVERIFY(stacker.finish(master));
+
+    char value[FLEN_VALUE] = {0};
+    fits_open_diskfile(&fptr, master.toLocal8Bit(), READONLY, &status);
+    fits_read_key(fptr, TDOUBLE, "EXPTIME", &exposure, nullptr, &status);
+    fits_read_key(fptr, TDOUBLE, "CCD-TEMP", &temperature, nullptr, &status);
+    fits_read_key(fptr, TINT, "XBINNING", &binning, nullptr, &status);
+    fits_read_key(fptr, TSTRING, "INSTRUME", value, nullptr, &status);
+    QCOMPARE(status, 0);
+    QCOMPARE(exposure, 120.0);
+    QCOMPARE(temperature, -10.0);
+    QCOMPARE(binning, 2);
+    QCOMPARE(QString(value), QString("CCD Simulator"));
+
+    // Keywords missing from the frames are not written
+    fits_read_key(fptr, TDOUBLE, "GAIN", &exposure, nullptr, &status);
+    QCOMPARE(status, KEY_NO_EXIST);
+    status = 0;
+    fits_close_file(fptr, &status);
+}
+
+QTEST_GUILESS_MAIN(TestCalibrationStacker)
@@ -0,0 +1,46 @@
+/*  KStars tests
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#ifndef TEST_CALIBRATIONSTACKER_H
+#define TEST_CALIBRATIONSTACKER_H
+
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+
+/**
+ * @class TestCalibrationStacker
+ * @short Tests for the master calibration frame stacker
+ */
+class TestCalibrationStacker : public QObject
+{
+        Q_OBJECT
+
+    public:
+        TestCalibrationStacker();
+        ~TestCalibrationStacker() override = default;
+
+    private:
+        // Write a width x height frame of unsigned 16-bit pixels to a new FITS file.
+        QString writeFrame(const QVector<float> &pixels, int width, int height);
+        QVector<float> readFrame(const QString &filename, int *bitpix = nullptr);
+
+        QTemporaryDir m_Directory;
+        int m_FrameCounter { 0 };
+
+    private slots:
+        void testSigmaClippedMean();
+        void testClippingLimit();
+        void testMedian();
+        void testTiling();
+        void testFlatScaling();
+        void testSizeMismatch();
+        void testKeywords();
+};
+
+#endif // TEST_CALIBRATIONSTACKER_H
@@ -0,0 +1,253 @@
+/*  MediaEncoder class test.
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "ekos/ekoslive/mediaencoder.h"
+#include "fitsviewer/fitsdata.h"
+
+#include <QtTest>
+
+#include <QImage>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QWebSocket>
+#include <QWebSocketServer>
+
+using EkosLive::MediaEncoder;
+
+namespace
+{
+// Gray frames, the level identifies the frame once decoded.
+QImage grayFrame(int width, int height, int level)
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    image.fill(qRgb(level, level, level));
+    return image;
+}
+
+QByteArray metadata(int index)
+{
+    return QJsonDocument(QJsonObject{{"index", index}}).toJson(QJsonDocument::Compact);
+}
+
+int payloadIndex(const QByteArray &payload)
+{
+    QByteArray header = payload.left(MediaEncoder::METADATA_PACKET);
+    header.truncate(header.indexOf('\0') < 0 ? header.size() : header.indexOf('\0'));
+    return QJsonDocument::fromJson(header).object().value("index").toInt(-1);
+}
+
+QImage payloadImage(const QByteArray &payload)
+{
+    return QImage::fromData(payload.mid(MediaEncoder::METADATA_PACKET), "JPG");
+}
+}
+
+class TestMediaEncoder : public QObject
+{
+        Q_OBJECT
+
+    public:
+        /** @short Constructor */
+        TestMediaEncoder() = default;
+
+    private slots:
+        void testPayload();
+        void testLatestFrameWins();
+        void testCongestion();
+        void testOversizeMetadata();
+        void testFITSDownsampling();
+        void testEchoServer();
+};
+
+#include "testmediaencoder.moc"
+
+void TestMediaEncoder::testPayload()
+{
+    MediaEncoder encoder;
+    QSignalSpy spy(&encoder, &MediaEncoder::encoded);
+
+    encoder.encode(MediaEncoder::STREAM_IMAGE, grayFrame(1920, 1080, 128), metadata(7), 960, 90, true);
+    QVERIFY(spy.wait(5000));
+
+    const QByteArray payload = spy.first().at(1).toByteArray();
+    QCOMPARE(payloadIndex(payload), 7);
+
+    const QImage image = payloadImage(payload);
+    QCOMPARE(image.size(), QSize(960, 540));
+    QVERIFY(qAbs(qGray(image.pixel(480, 270)) - 128) <= 2);
+
+    const QJsonObject stats = encoder.statistics();
+    QCOMPARE(stats["encoded"].toInt(), 1);
+    QCOMPARE(stats["dropped"].toInt(), 0);
+    QVERIFY(stats["latency_max"].toDouble() >= stats["latency_avg"].toDouble());
+}
+
+void TestMediaEncoder::testLatestFrameWins()
+{
+    MediaEncoder encoder;
+    QList<int> received;
+    connect(&encoder, &MediaEncoder::encoded, this, [&received](MediaEncoder::Stream, const QByteArray & payload)
+    {
+        received.append(payloadIndex(payload));
+    });
+
+    // Far more frames than can be encoded while the first one is busy
+    const int frames = 20;
+    for (int i = 0; i < frames; i++)
+        encoder.encode(MediaEncoder::STREAM_VIDEO, grayFrame(1280, 960, i * 10), metadata(i), 640, -1, false);
+
+    QTRY_COMPARE_WITH_TIMEOUT(encoder.statistics()["encoded"].toInt() + encoder.statistics()["dropped"].toInt(), frames,
+                              10000);
+
+    // Only the frame in flight and the latest one are left, in order
+    QCOMPARE(received.size(), 2);
+    QCOMPARE(received.first(), 0);
+    QCOMPARE(received.last(), frames - 1);
+    QCOMPARE(encoder.statistics()["dropped"].toInt(), frames - 2);
+    QCOMPARE(encoder.statistics()["superseded"].toInt(), frames - 2);
+}
+
+void TestMediaEncoder::testCongestion()
+{
+    MediaEncoder encoder;
+    QSignalSpy spy(&encoder, &MediaEncoder::encoded);
+
+    encoder.setCongested(true);
+    encoder.encode(MediaEncoder::STREAM_VIDEO, grayFrame(320, 240, 50), metadata(0), 640, -1, false);
+    QCOMPARE(encoder.statistics()["dropped"].toInt(), 1);
+
+    // Still images are never dropped for congestion
+    encoder.encode(MediaEncoder::STREAM_IMAGE, grayFrame(320, 240, 50), metadata(1), 640, 90, false);
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(payloadIndex(spy.first().at(1).toByteArray()), 1);
+
+    encoder.setCongested(false);
+    encoder.encode(MediaEncoder::STREAM_VIDEO, grayFrame(320, 240, 50), metadata(2), 640, -1, false);
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(payloadIndex(spy.last().at(1).toByteArray()), 2);
+}
+
+void TestMediaEncoder::testOversizeMetadata()
+{
+    MediaEncoder encoder;
+    QSignalSpy spy(&encoder, &MediaEncoder::encoded);
+
+    // Truncated metadata would not be valid JSON, so the frame is not sent at all
+    const QByteArray oversize = QJsonDocument(QJsonObject{{"index", 0}, {"uuid", QString(300, 'x')}}).toJson(
+                                    QJsonDocument::Compact);
+    encoder.encode(MediaEncoder::STREAM_IMAGE, grayFrame(320, 240, 50), oversize, 640, 90, false);
+    QCOMPARE(encoder.statistics()["dropped"].toInt(), 1);
+
+    encoder.encode(MediaEncoder::STREAM_IMAGE, grayFrame(320, 240, 50), metadata(1), 640, 90, false);
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(payloadIndex(spy.first().at(1).toByteArray()), 1);
+}
+
+void TestMediaEncoder::testFITSDownsampling()
+{
+    QTemporaryDir directory;
+    const QString filename = directory.filePath("frame.fits");
+
+    // A 2000x1000 ramp
+    const long width = 2000, height = 1000;
+    QVector<uint16_t> pixels(width * height);
+    for (long y = 0; y < height; y++)
+        for (long x = 0; x < width; x++)
+            pixels[y * width + x] = static_cast<uint16_t>(x * 30);
+
+    fitsfile *fptr = nullptr;
+    int status = 0;
+    long naxes[2] = {width, height};
+    fits_create_file(&fptr, QString("!%1").arg(filename).toLocal8Bit(), &status);
+    fits_create_img(fptr, USHORT_IMG, 2, naxes, &status);
+    fits_write_img(fptr, TUSHORT, 1, pixels.size(), pixels.data(), &status);
+    fits_close_file(fptr, &status);
+    QCOMPARE(status, 0);
+
+    QSharedPointer<FITSData> data(new FITSData());
+    QFuture<bool> future = data->loadFromFile(filename);
+    future.waitForFinished();
+    QVERIFY(future.result());
+
+    MediaEncoder encoder;
+    QSignalSpy spy(&encoder, &MediaEncoder::encoded);
+    encoder.encode(MediaEncoder::STREAM_IMAGE, data.data(), metadata(3), 480, 90);
+    // The encoder works on a copy of the pixels
+    data.clear();
+    QVERIFY(spy.wait(5000));
+
+    // Sampled by 5 while stretching, the ramp stays dark on the left and bright on the right
+    const QImage image = payloadImage(spy.first().at(1).toByteArray());
+    QCOMPARE(image.size(), QSize(400, 200));
+    QVERIFY(qGray(image.pixel(5, 100)) < qGray(image.pixel(395, 100)));
+}
+
+void TestMediaEncoder::testEchoServer()
+{
+    QWebSocketServer server("echo", QWebSocketServer::NonSecureMode);
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QWebSocket *serverSocket = nullptr;
+    connect(&server, &QWebSocketServer::newConnection, this, [&]()
+    {
+        serverSocket = server.nextPendingConnection();
+        connect(serverSocket, &QWebSocket::binaryMessageReceived, serverSocket, [&](const QByteArray & message)
+        {
+            serverSocket->sendBinaryMessage(message);
+        });
+    });
+
+    QWebSocket client;
+    QSignalSpy connectedSpy(&client, &QWebSocket::connected);
+    client.open(QUrl(QString("ws://127.0.0.1:%1").arg(server.serverPort())));
+    QVERIFY(connectedSpy.wait(5000));
+
+    // Wire the encoder to the socket the way the media channel does
+    MediaEncoder encoder;
+    qint64 pending = 0;
+    connect(&encoder, &MediaEncoder::encoded, this, [&](MediaEncoder::Stream, const QByteArray & payload)
+    {
+        pending += client.sendBinaryMessage(payload);
+        encoder.setCongested(pending > 2 * 1024 * 1024);
+    });
+    connect(&client, &QWebSocket::bytesWritten, this, [&](qint64 bytes)
+    {
+        pending = qMax<qint64>(0, pending - bytes);
+        encoder.setCongested(pending > 2 * 1024 * 1024);
+    });
+
+    QList<int> echoed;
+    connect(&client, &QWebSocket::binaryMessageReceived, this, [&](const QByteArray & message)
+    {
+        echoed.append(payloadIndex(message));
+    });
+
+    // A 30 fps stream for two seconds
+    const int frames = 60;
+    for (int i = 0; i < frames; i++)
+    {
+        encoder.encode(MediaEncoder::STREAM_VIDEO, grayFrame(1920, 1080, i * 4), metadata(i), 960, -1, false);
+        QTest::qWait(33);
+    }
+
+    QTRY_VERIFY_WITH_TIMEOUT(echoed.isEmpty() == false && echoed.last() == frames - 1, 10000);
+
+    const QJsonObject stats = encoder.statistics();
+
+    // Frames arrive in order and none of them twice
+    for (int i = 1; i < echoed.size(); i++)
+        QVERIFY(echoed[i] > echoed[i - 1]);
+    QCOMPARE(stats["encoded"].toInt() + stats["dropped"].toInt(), frames);
+    QVERIFY(stats["superseded"].toInt() <= stats["dropped"].toInt());
+}
+
+QTEST_GUILESS_MAIN(TestMediaEncoder)
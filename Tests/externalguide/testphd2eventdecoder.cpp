@@ -0,0 +1,415 @@
+/*  PHD2EventDecoder class test.
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "ekos/guide/externalguide/phd2eventdecoder.h"
+
+#include <QtTest>
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QSemaphore>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+
+#include <cmath>
+
+using Ekos::PHD2EventDecoder;
+
+namespace
+{
+enum TestEvent
+{
+    Version,
+    AppState,
+    StartGuiding,
+    SettleBegin,
+    Settling,
+    SettleDone,
+    GuideStep,
+    Alert
+};
+
+void registerEvents(PHD2EventDecoder &decoder)
+{
+    decoder.registerEvent("Version", Version);
+    decoder.registerEvent("AppState", AppState);
+    decoder.registerEvent("StartGuiding", StartGuiding);
+    decoder.registerEvent("SettleBegin", SettleBegin);
+    decoder.registerEvent("Settling", Settling);
+    decoder.registerEvent("SettleDone", SettleDone);
+    decoder.registerEvent("GuideStep", GuideStep);
+    decoder.registerEvent("Alert", Alert);
+}
+
+QByteArray guideStepLine(int frame)
+{
+    const double ra = 0.35 * std::sin(frame * 0.1), de = -0.27 * std::cos(frame * 0.13);
+    return QString("{\"Event\":\"GuideStep\",\"Timestamp\":%1.123,\"Host\":\"localhost\",\"Inst\":1,\"Frame\":%2,"
+                   "\"Time\":%3,\"Mount\":\"Guide Simulator\",\"dx\":%4,\"dy\":%5,\"RADistanceRaw\":%4,"
+                   "\"DECDistanceRaw\":%5,\"RADistanceGuide\":%4,\"DECDistanceGuide\":%5,\"RADuration\":%6,"
+                   "\"RADirection\":\"%7\",\"DECDuration\":%8,\"DECDirection\":\"%9\",\"StarMass\":20418,"
+                   "\"SNR\":57.21,\"HFD\":2.35,\"AvgDist\":0.41}\r\n")
+           .arg(1600000000 + frame).arg(frame).arg(frame * 2.004, 0, 'f', 3)
+           .arg(ra, 0, 'f', 3).arg(de, 0, 'f', 3).arg(static_cast<int>(qAbs(ra) * 300))
+           .arg(ra < 0 ? "East" : "West").arg(static_cast<int>(qAbs(de) * 300)).arg(de < 0 ? "South" : "North")
+           .toLatin1();
+}
+
+QByteArray starImagePixels()
+{
+    QByteArray pixels(32 * 32 * 2, 0);
+    quint16 *data = reinterpret_cast<quint16 *>(pixels.data());
+    for (int y = 0; y < 32; y++)
+        for (int x = 0; x < 32; x++)
+            data[y * 32 + x] = static_cast<quint16>(1000 + 30000 * std::exp(-((x - 16) * (x - 16) + (y - 16) * (y - 16)) / 8.0));
+    return pixels;
+}
+
+QByteArray starImageLine(int id)
+{
+    // PHD2 escapes slashes in its JSON writer, which the decoder has to cope with
+    QByteArray pixels = starImagePixels().toBase64().replace("/", "\\/");
+    return "{\"jsonrpc\":\"2.0\",\"result\":{\"frame\":" + QByteArray::number(id) +
+           ",\"width\":32,\"height\":32,\"star_pos\":[16.0,16.0],\"pixels\":\"" + pixels + "\"},\"id\":" +
+           QByteArray::number(id) + "}\r\n";
+}
+
+// A guiding session as PHD2 streams it: connection banner, settling, then one
+// GuideStep per frame, each followed by the star image Ekos requests.
+QByteArray guidingSession(int frames)
+{
+    QByteArray session;
+    session += "{\"Event\":\"Version\",\"Timestamp\":1600000000.1,\"Host\":\"localhost\",\"Inst\":1,"
+               "\"PHDVersion\":\"2.6.9\",\"PHDSubver\":\"\",\"OverlapSupport\":true,\"MsgVersion\":1}\r\n";
+    session += "{\"Event\":\"AppState\",\"Timestamp\":1600000000.2,\"Host\":\"localhost\",\"Inst\":1,\"State\":\"Stopped\"}\r\n";
+    session += "{\"Event\":\"StartGuiding\",\"Timestamp\":1600000001.0,\"Host\":\"localhost\",\"Inst\":1}\r\n";
+    session += "{\"Event\":\"SettleBegin\",\"Timestamp\":1600000001.1,\"Host\":\"localhost\",\"Inst\":1}\r\n";
+    session += "{\"Event\":\"SettleDone\",\"Timestamp\":1600000003.0,\"Host\":\"localhost\",\"Inst\":1,\"Status\":0,"
+               "\"TotalFrames\":2,\"DroppedFrames\":0}\r\n";
+
+    for (int i = 0; i < frames; i++)
+    {
+        session += guideStepLine(i);
+        session += starImageLine(i + 1);
+    }
+
+    return session;
+}
+
+// Stand-in for the PHD2 event server, streams a recorded session to the first client in small packets.
+class PHD2StandIn : public QThread
+{
+    public:
+        explicit PHD2StandIn(const QByteArray &session) : m_Session(session) {}
+
+        quint16 waitForPort()
+        {
+            m_Ready.acquire();
+            return m_Port;
+        }
+
+    protected:
+        void run() override
+        {
+            QTcpServer server;
+            server.listen(QHostAddress::LocalHost, 0);
+            m_Port = server.serverPort();
+            m_Ready.release();
+
+            if (!server.waitForNewConnection(10000))
+                return;
+
+            QTcpSocket *client = server.nextPendingConnection();
+            constexpr int packetSize = 1400;
+            for (int offset = 0; offset < m_Session.size(); offset += packetSize)
+            {
+                client->write(m_Session.constData() + offset, qMin(packetSize, m_Session.size() - offset));
+                client->waitForBytesWritten(10000);
+            }
+            client->disconnectFromHost();
+            if (client->state() != QAbstractSocket::UnconnectedState)
+                client->waitForDisconnected(10000);
+            delete client;
+        }
+
+    private:
+        QByteArray m_Session;
+        QSemaphore m_Ready;
+        quint16 m_Port { 0 };
+};
+}
+
+class TestPHD2EventDecoder : public QObject
+{
+        Q_OBJECT
+
+    public:
+        /** @short Constructor */
+        TestPHD2EventDecoder();
+
+        /** @short Destructor */
+        ~TestPHD2EventDecoder() override = default;
+
+    private slots:
+        void lineSplittingTest();
+        void eventDispatchTest();
+        void guideStepFieldsTest();
+        void starImageTest();
+        void replayDecoderBenchmark();
+        void replayJsonDocumentBenchmark();
+
+    private:
+        QByteArray m_Session;
+};
+
+#include "testphd2eventdecoder.moc"
+
+TestPHD2EventDecoder::TestPHD2EventDecoder() : QObject()
+{
+    m_Session = guidingSession(2000);
+}
+
+void TestPHD2EventDecoder::lineSplittingTest()
+{
+    PHD2EventDecoder decoder;
+    QByteArray line;
+
+    // Feed the session in odd-sized fragments, every line must come out whole
+    const QByteArray session = guidingSession(20);
+    const QList<QByteArray> expected = session.split('\n');
+    int count = 0;
+    for (int offset = 0; offset < session.size(); offset += 37)
+    {
+        decoder.append(session.constData() + offset, qMin(37, session.size() - offset));
+        while (decoder.nextLine(line))
+        {
+            QByteArray reference = expected[count++];
+            reference.chop(1);
+            QCOMPARE(line, reference);
+        }
+    }
+    QCOMPARE(count, expected.size() - 1);
+
+    // Empty lines are skipped and a partial line is kept until it is completed
+    decoder.append("\r\n\n{\"a\":1", 9);
+    QVERIFY(!decoder.nextLine(line));
+    decoder.append("}\n", 2);
+    QVERIFY(decoder.nextLine(line));
+    QCOMPARE(line, QByteArray("{\"a\":1}"));
+
+    // Once warmed up, the buffer no longer grows
+    decoder.append(session.constData(), session.size());
+    while (decoder.nextLine(line));
+    const int capacity = decoder.capacity();
+    for (int i = 0; i < 3; i++)
+    {
+        decoder.append(session.constData(), session.size());
+        while (decoder.nextLine(line));
+        QCOMPARE(decoder.capacity(), capacity);
+    }
+}
+
+void TestPHD2EventDecoder::eventDispatchTest()
+{
+    PHD2EventDecoder decoder;
+    registerEvents(decoder);
+    QLatin1String name;
+
+    // The name is a view into the line, so every line has to outlive its checks
+    const QByteArray guideStep = guideStepLine(1);
+    QCOMPARE(PHD2EventDecoder::messageType(guideStep, name), PHD2EventDecoder::MESSAGE_EVENT);
+    QCOMPARE(decoder.eventId(name), static_cast<int>(GuideStep));
+
+    const QByteArray alert(" { \"Event\" : \"Alert\", \"Msg\":\"x\"}");
+    QCOMPARE(PHD2EventDecoder::messageType(alert, name), PHD2EventDecoder::MESSAGE_EVENT);
+    QCOMPARE(decoder.eventId(name), static_cast<int>(Alert));
+
+    const QByteArray unknown("{\"Event\":\"ConfigurationChange\"}");
+    QCOMPARE(PHD2EventDecoder::messageType(unknown, name), PHD2EventDecoder::MESSAGE_EVENT);
+    QCOMPARE(decoder.eventId(name), -1);
+
+    // "Settling" must not be resolved as a prefix of "SettleDone" or the reverse
+    const QByteArray settling("{\"Event\":\"Settling\"}");
+    QCOMPARE(PHD2EventDecoder::messageType(settling, name), PHD2EventDecoder::MESSAGE_EVENT);
+    QCOMPARE(decoder.eventId(name), static_cast<int>(Settling));
+
+    // JSON does not order keys, the event may come after other members
+    const QByteArray reordered("{\"Timestamp\":1600000003.0,\"Host\":\"localhost\",\"Msg\":\"\\\"Event\\\"\","
+                               "\"Inst\":{\"Event\":\"Alert\"},\"Event\":\"SettleDone\",\"Status\":0}");
+    QCOMPARE(PHD2EventDecoder::messageType(reordered, name), PHD2EventDecoder::MESSAGE_EVENT);
+    QCOMPARE(decoder.eventId(name), static_cast<int>(SettleDone));
+
+    const QByteArray response("{\"jsonrpc\":\"2.0\",\"result\":0,\"id\":1}");
+    QCOMPARE(PHD2EventDecoder::messageType(response, name), PHD2EventDecoder::MESSAGE_UNKNOWN);
+    const QByteArray starImage = starImageLine(3);
+    QCOMPARE(PHD2EventDecoder::messageType(starImage, name), PHD2EventDecoder::MESSAGE_UNKNOWN);
+    // An "Event" key of a nested object does not make the message an event
+    const QByteArray nested("{\"jsonrpc\":\"2.0\",\"result\":{\"Event\":\"Alert\"},\"id\":2}");
+    QCOMPARE(PHD2EventDecoder::messageType(nested, name), PHD2EventDecoder::MESSAGE_UNKNOWN);
+    const QByteArray truncated("{\"Event\":\"Trunc");
+    QCOMPARE(PHD2EventDecoder::messageType(truncated, name), PHD2EventDecoder::MESSAGE_UNKNOWN);
+}
+
+void TestPHD2EventDecoder::guideStepFieldsTest()
+{
+    // The scanner has to agree with QJsonDocument on every field PHD2::processGuideStep reads
+    for (int i = 0; i < 200; i++)
+    {
+        const QByteArray line = guideStepLine(i);
+        const QJsonObject json = QJsonDocument::fromJson(line).object();
+
+        for (const char *key : {"RADistanceRaw", "DECDistanceRaw", "RADuration", "DECDuration", "SNR", "Timestamp"})
+            QVERIFY(qAbs(PHD2EventDecoder::doubleValue(line, key) - json[key].toDouble()) <= 1e-12 * qMax(1.0, qAbs(json[key].toDouble())));
+
+        QCOMPARE(QString(PHD2EventDecoder::stringValue(line, "RADirection")), json["RADirection"].toString());
+        QCOMPARE(QString(PHD2EventDecoder::stringValue(line, "DECDirection")), json["DECDirection"].toString());
+    }
+
+    const QByteArray line("{\"a\":-1.5e-3,\"b\":\"x\\\"y\",\"c\":null,\"d\":12345678901234567890}");
+    QCOMPARE(PHD2EventDecoder::doubleValue(line, "a"), -1.5e-3);
+    QCOMPARE(PHD2EventDecoder::doubleValue(line, "c", 7), 7.0);
+    QCOMPARE(PHD2EventDecoder::doubleValue(line, "missing", 3), 3.0);
+    QVERIFY(qAbs(PHD2EventDecoder::doubleValue(line, "d") / 12345678901234567890.0 - 1) < 1e-15);
+    QCOMPARE(QString(PHD2EventDecoder::stringValue(line, "b")), QString("x\\\"y"));
+    // A key name that only appears inside a string value or a nested object is not a match
+    QCOMPARE(PHD2EventDecoder::doubleValue("{\"m\":\"\\\"a\\\":5\",\"a\":2}", "a"), 2.0);
+    QCOMPARE(PHD2EventDecoder::doubleValue("{\"o\":{\"a\":5},\"l\":[{\"a\":6}],\"a\":2}", "a"), 2.0);
+    QCOMPARE(PHD2EventDecoder::doubleValue("{\"o\":{\"a\":5}}", "a", 3), 3.0);
+}
+
+void TestPHD2EventDecoder::starImageTest()
+{
+    const QByteArray expected = starImagePixels();
+    QByteArray pixels;
+
+    QVERIFY(PHD2EventDecoder::base64Value(starImageLine(1), "pixels", pixels, "result"));
+    QCOMPARE(pixels, expected);
+
+    // The buffer is reused for the next frame
+    const char *storage = pixels.constData();
+    QVERIFY(PHD2EventDecoder::base64Value(starImageLine(2), "pixels", pixels, "result"));
+    QCOMPARE(pixels, expected);
+    QVERIFY(pixels.constData() == storage);
+
+    QVERIFY(!PHD2EventDecoder::base64Value("{\"width\":32}", "pixels", pixels));
+
+    // The frame size is read from the result the same way
+    QVERIFY(PHD2EventDecoder::hasValue(starImageLine(4), "result"));
+    QVERIFY(!PHD2EventDecoder::hasValue(starImageLine(4), "error"));
+    QCOMPARE(PHD2EventDecoder::doubleValue(starImageLine(4), "id"), 4.0);
+    QCOMPARE(PHD2EventDecoder::doubleValue(starImageLine(4), "width", 0, "result"), 32.0);
+    QCOMPARE(PHD2EventDecoder::doubleValue(starImageLine(4), "width", -1), -1.0);
+    // The pixels are a member of the result, not of the response
+    QVERIFY(!PHD2EventDecoder::base64Value(starImageLine(3), "pixels", pixels));
+}
+
+void TestPHD2EventDecoder::replayDecoderBenchmark()
+{
+    QBENCHMARK
+    {
+        PHD2StandIn server(m_Session);
+        server.start();
+
+        QTcpSocket socket;
+        socket.connectToHost(QHostAddress::LocalHost, server.waitForPort());
+        QVERIFY(socket.waitForConnected(10000));
+
+        PHD2EventDecoder decoder;
+        registerEvents(decoder);
+        QByteArray line, pixels;
+        QLatin1String name;
+        int guideSteps = 0, starImages = 0;
+        double sum = 0;
+
+        while (socket.state() == QAbstractSocket::ConnectedState || socket.bytesAvailable() > 0)
+        {
+            if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(10000))
+                break;
+
+            decoder.append(&socket);
+            while (decoder.nextLine(line))
+            {
+                if (PHD2EventDecoder::messageType(line, name) == PHD2EventDecoder::MESSAGE_EVENT)
+                {
+                    if (decoder.eventId(name) == GuideStep)
+                    {
+                        sum += PHD2EventDecoder::doubleValue(line, "RADistanceRaw") + PHD2EventDecoder::doubleValue(line, "DECDistanceRaw");
+                        sum += PHD2EventDecoder::doubleValue(line, "RADuration") + PHD2EventDecoder::doubleValue(line, "DECDuration");
+                        sum += PHD2EventDecoder::doubleValue(line, "SNR");
+                        if (PHD2EventDecoder::stringValue(line, "RADirection") == QLatin1String("East"))
+                            sum = -sum;
+                        guideSteps++;
+                    }
+                }
+                else if (PHD2EventDecoder::base64Value(line, "pixels", pixels, "result"))
+                    starImages++;
+            }
+        }
+
+        server.wait();
+        QCOMPARE(guideSteps, 2000);
+        QCOMPARE(starImages, 2000);
+        QVERIFY(std::isfinite(sum));
+    }
+}
+
+void TestPHD2EventDecoder::replayJsonDocumentBenchmark()
+{
+    // Reference figure for the previous readLine/QJsonDocument ingestion
+    QBENCHMARK
+    {
+        PHD2StandIn server(m_Session);
+        server.start();
+
+        QTcpSocket socket;
+        socket.connectToHost(QHostAddress::LocalHost, server.waitForPort());
+        QVERIFY(socket.waitForConnected(10000));
+
+        int guideSteps = 0, starImages = 0;
+        double sum = 0;
+
+        while (socket.state() == QAbstractSocket::ConnectedState || socket.bytesAvailable() > 0)
+        {
+            if (!socket.canReadLine() && !socket.waitForReadyRead(10000))
+                break;
+
+            while (socket.canReadLine())
+            {
+                const QJsonObject json = QJsonDocument::fromJson(socket.readLine()).object();
+                if (json.contains("Event"))
+                {
+                    if (json["Event"].toString() == "GuideStep")
+                    {
+                        sum += json["RADistanceRaw"].toDouble() + json["DECDistanceRaw"].toDouble();
+                        sum += json["RADuration"].toDouble() + json["DECDuration"].toDouble();
+                        sum += json["SNR"].toDouble();
+                        if (json["RADirection"].toString() == "East")
+                            sum = -sum;
+                        guideSteps++;
+                    }
+                }
+                else if (json.contains("result"))
+                {
+                    QByteArray pixels = QByteArray::fromBase64(json["result"].toObject()["pixels"].toString().toLocal8Bit());
+                    if (!pixels.isEmpty())
+                        starImages++;
+                }
+            }
+        }
+
+        server.wait();
+        QCOMPARE(guideSteps, 2000);
+        QCOMPARE(starImages, 2000);
+        QVERIFY(std::isfinite(sum));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestPHD2EventDecoder)
@@ -0,0 +1,466 @@
+/*  KStars sky map render benchmark
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "benchmark_skymap.h"
+
+#include "kstarsdata.h"
+#include "ksprofiler.h"
+#include "Options.h"
+#include "skymap.h"
+#include "skyqpainter.h"
+#include "projections/projector.h"
+#include "skycomponents/skymapcomposite.h"
+#include "skyobjects/starobject.h"
+#include "auxiliary/colorscheme.h"
+#include "time/simclock.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QtTest>
+
+#include <algorithm>
+#include <atomic>
+
+// Count heap allocations by interposing the allocator of glibc. Elsewhere only times are compared.
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+namespace
+{
+std::atomic<quint64> s_Allocations { 0 };
+
+quint64 allocationCount()
+{
+    return s_Allocations.load(std::memory_order_relaxed);
+}
+}
+
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *pointer, size_t size);
+
+    void *malloc(size_t size)
+    {
+        s_Allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t count, size_t size)
+    {
+        s_Allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *pointer, size_t size)
+    {
+        s_Allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(pointer, size);
+    }
+}
+#define KSTARS_COUNT_ALLOCATIONS
+#endif
+
+namespace
+{
+// Timings below this many milliseconds are noise
+constexpr double TIME_SLACK = 0.5;
+// Allocation counts vary a little with the caches of Qt
+constexpr double ALLOCATION_TOLERANCE = 0.10;
+constexpr double ALLOCATION_SLACK = 50;
+
+double median(QVector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return values.isEmpty() ? 0 : values[values.size() / 2];
+}
+}
+
+BenchmarkSkyMap::BenchmarkSkyMap() : QObject()
+{
+}
+
+void BenchmarkSkyMap::initTestCase()
+{
+    bool ok = false;
+    const int frames = qgetenv("KSTARS_BENCHMARK_FRAMES").toInt(&ok);
+    if (ok && frames > 0)
+        m_Frames = frames;
+
+    KStarsData *data = KStarsData::Create();
+    QVERIFY(data != nullptr);
+    if (!data->initialize())
+        QSKIP("KStars data is not installed, cannot benchmark the sky map.");
+
+    data->setLocationFromOptions();
+    data->colorScheme()->loadFromConfig();
+
+    // Fixed time and a stopped clock, so every run draws the same sky
+    data->clock()->stop();
+    data->clock()->setUTC(KStarsDateTime(QDateTime(QDate(2021, 3, 20), QTime(22, 0, 0), Qt::UTC)));
+    data->setFullTimeUpdate();
+    data->updateTime(data->geo());
+
+    m_Map = SkyMap::Create();
+    m_Map->resize(1280, 800);
+
+    for (const auto &entry : data->skyComposite()->objectLists(SkyObject::STAR))
+    {
+        const StarObject *star = dynamic_cast<const StarObject *>(entry.second);
+        if (star)
+            m_Stars.append(*star);
+    }
+
+#ifdef KSTARS_COUNT_ALLOCATIONS
+    KSProfiler::setAllocationCounter(allocationCount);
+#endif
+    KSProfiler::Instance()->setEnabled(true);
+}
+
+void BenchmarkSkyMap::cleanupTestCase()
+{
+    KSProfiler::Instance()->setEnabled(false);
+    KSProfiler::setAllocationCounter(nullptr);
+
+    if (m_Results.isEmpty())
+        return;
+
+    const QString output = QString::fromLocal8Bit(qgetenv("KSTARS_BENCHMARK_OUTPUT"));
+    if (!output.isEmpty())
+    {
+        QFile file(output);
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(QJsonDocument(m_Results).toJson());
+    }
+
+    compareWithBaseline();
+}
+
+void BenchmarkSkyMap::advanceTime(double seconds)
+{
+    KStarsData *data = KStarsData::Instance();
+    if (seconds != 0)
+        data->clock()->setUTC(data->ut().addSecs(seconds));
+    data->updateTime(data->geo());
+    m_Map->focus()->EquatorialToHorizontal(data->lst(), data->geo()->lat());
+}
+
+void BenchmarkSkyMap::setView(int projection, double zoom, double ra, double dec)
+{
+    Options::setProjection(projection);
+    Options::setZoomFactor(zoom);
+    const SkyPoint focus(ra * 15.0, dec);
+    m_Map->setDestination(focus);
+    m_Map->setFocus(m_Map->destination());
+    m_Map->setupProjector();
+}
+
+void BenchmarkSkyMap::renderFrame()
+{
+    static QImage image(m_Map->size(), QImage::Format_ARGB32_Premultiplied);
+
+    KSPROFILE_SCOPE("draw", QStringLiteral("Frame"));
+
+    m_Map->setupProjector();
+
+    SkyQPainter painter(&image, image.size());
+    painter.begin();
+    painter.drawSkyBackground();
+
+    QPainterPath path;
+    path.addPolygon(m_Map->projector()->clipPoly());
+    painter.setClipPath(path);
+    painter.setClipping(true);
+
+    KStarsData::Instance()->skyComposite()->draw(&painter);
+    painter.end();
+}
+
+void BenchmarkSkyMap::record(const QString &name, const QJsonObject &result)
+{
+    m_Results.insert(name, result);
+
+    QString summary;
+    for (auto value = result.constBegin(); value != result.constEnd(); ++value)
+    {
+        if (value.value().isDouble())
+            summary += QString(" %1=%2").arg(value.key()).arg(value.value().toDouble(), 0, 'f', 2);
+    }
+    qInfo().noquote() << name << summary;
+}
+
+void BenchmarkSkyMap::benchmarkRender_data()
+{
+    QTest::addColumn<int>("projection");
+    QTest::addColumn<double>("zoom");
+    QTest::addColumn<double>("ra");
+    QTest::addColumn<double>("dec");
+    QTest::addColumn<double>("timeStep");
+    QTest::addColumn<int>("starDensity");
+    QTest::addColumn<double>("magLimitDeepSky");
+
+    // One parameter at a time around a default view of Orion
+    QTest::newRow("default") << 0 << 2000.0 << 5.5 << 0.0 << 0.0 << 5 << 16.0;
+
+    const QStringList projections = { "Lambert", "AzimuthalEquidistant", "Orthographic", "Equirectangular",
+                                      "Stereographic", "Gnomonic"
+                                    };
+    for (int i = 1; i < projections.size(); i++)
+        QTest::newRow(qPrintable("projection " + projections[i])) << i << 2000.0 << 5.5 << 0.0 << 0.0 << 5 << 16.0;
+
+    for (double zoom : { 250.0, 20000.0, 200000.0 })
+        QTest::newRow(qPrintable(QString("zoom %1").arg(zoom))) << 0 << zoom << 5.5 << 0.0 << 0.0 << 5 << 16.0;
+
+    QTest::newRow("focus galactic center") << 0 << 2000.0 << 17.75 << -29.0 << 0.0 << 5 << 16.0;
+    QTest::newRow("focus pole") << 0 << 2000.0 << 0.0 << 89.0 << 0.0 << 5 << 16.0;
+    QTest::newRow("focus Virgo cluster") << 0 << 2000.0 << 12.5 << 12.5 << 0.0 << 5 << 16.0;
+
+    QTest::newRow("time step 1 s") << 0 << 2000.0 << 5.5 << 0.0 << 1.0 << 5 << 16.0;
+    QTest::newRow("time step 1 h") << 0 << 2000.0 << 5.5 << 0.0 << 3600.0 << 5 << 16.0;
+
+    QTest::newRow("shallow catalogs") << 0 << 2000.0 << 5.5 << 0.0 << 0.0 << 2 << 10.0;
+    QTest::newRow("deep catalogs") << 0 << 2000.0 << 5.5 << 0.0 << 0.0 << 15 << 18.0;
+    QTest::newRow("deep catalogs zoomed") << 0 << 20000.0 << 5.5 << 0.0 << 0.0 << 15 << 18.0;
+}
+
+void BenchmarkSkyMap::benchmarkRender()
+{
+    QFETCH(int, projection);
+    QFETCH(double, zoom);
+    QFETCH(double, ra);
+    QFETCH(double, dec);
+    QFETCH(double, timeStep);
+    QFETCH(int, starDensity);
+    QFETCH(double, magLimitDeepSky);
+
+    Options::setStarDensity(starDensity);
+    Options::setMagLimitDrawDeepSky(magLimitDeepSky);
+    setView(projection, zoom, ra, dec);
+
+    // Warm up the caches of the star catalogs and the sky mesh
+    advanceTime(0);
+    renderFrame();
+
+    KSProfiler *profiler = KSProfiler::Instance();
+    profiler->clear();
+
+    QVector<double> times;
+    QVector<double> allocations;
+    for (int i = 0; i < m_Frames; i++)
+    {
+        const quint64 start = KSProfiler::allocations();
+        QElapsedTimer timer;
+        timer.start();
+
+        advanceTime(timeStep);
+        renderFrame();
+
+        times.append(timer.nsecsElapsed() / 1e6);
+        allocations.append(KSProfiler::allocations() - start);
+    }
+
+    QJsonObject result;
+    result.insert("frame", median(times));
+#ifdef KSTARS_COUNT_ALLOCATIONS
+    result.insert("allocations", median(allocations));
+#endif
+
+    // Average time of every component drawn
+    const QJsonObject components = profiler->statistics().value("draw").toObject();
+    for (auto component = components.constBegin(); component != components.constEnd(); ++component)
+    {
+        if (component.key() == "Frame")
+            continue;
+        const QJsonObject stats = component.value().toObject();
+        result.insert(component.key(), stats.value("average").toDouble());
+#ifdef KSTARS_COUNT_ALLOCATIONS
+        result.insert(component.key() + " allocations", stats.value("allocations").toDouble());
+#endif
+    }
+
+    record(QString("render %1").arg(QTest::currentDataTag()), result);
+}
+
+void BenchmarkSkyMap::benchmarkJITUpdate_data()
+{
+    QTest::addColumn<double>("timeStep");
+
+    // Only the horizontal coordinates, then precession and nutation of every star as well
+    QTest::newRow("horizontal") << 0.0;
+    QTest::newRow("1 min") << 60.0;
+    QTest::newRow("1 day") << 86400.0;
+}
+
+void BenchmarkSkyMap::benchmarkJITUpdate()
+{
+    QFETCH(double, timeStep);
+
+    if (m_Stars.isEmpty())
+        QSKIP("No named stars loaded.");
+
+    QVector<double> times;
+    QVector<double> allocations;
+    for (int i = 0; i < m_Frames; i++)
+    {
+        KStarsData::Instance()->setFullTimeUpdate();
+        advanceTime(timeStep);
+
+        const quint64 start = KSProfiler::allocations();
+        QElapsedTimer timer;
+        timer.start();
+
+        for (auto &star : m_Stars)
+            star.JITupdate();
+
+        times.append(timer.nsecsElapsed() / 1e6);
+        allocations.append(KSProfiler::allocations() - start);
+    }
+
+    QJsonObject result
+    {
+        {"stars", m_Stars.size()},
+        {"update", median(times)}
+    };
+#ifdef KSTARS_COUNT_ALLOCATIONS
+    result.insert("allocations", median(allocations));
+#endif
+    record(QString("JIT update %1").arg(QTest::currentDataTag()), result);
+}
+
+void BenchmarkSkyMap::benchmarkProjection_data()
+{
+    QTest::addColumn<int>("projection");
+
+    QTest::newRow("Lambert") << 0;
+    QTest::newRow("AzimuthalEquidistant") << 1;
+    QTest::newRow("Orthographic") << 2;
+    QTest::newRow("Equirectangular") << 3;
+    QTest::newRow("Stereographic") << 4;
+    QTest::newRow("Gnomonic") << 5;
+}
+
+void BenchmarkSkyMap::benchmarkProjection()
+{
+    QFETCH(int, projection);
+
+    if (m_Stars.isEmpty())
+        QSKIP("No named stars loaded.");
+
+    setView(projection, 2000.0, 5.5, 0.0);
+    advanceTime(0);
+    for (auto &star : m_Stars)
+        star.JITupdate();
+
+    const Projector *projector = m_Map->projector();
+    QVector<double> times;
+    int visible = 0;
+    for (int i = 0; i < m_Frames; i++)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        visible = 0;
+        for (const auto &star : m_Stars)
+        {
+            bool onVisibleHemisphere = false;
+            const QPointF point = projector->toScreen(&star, true, &onVisibleHemisphere);
+            if (onVisibleHemisphere && projector->onScreen(point))
+                visible++;
+        }
+
+        times.append(timer.nsecsElapsed() / 1e6);
+    }
+
+    record(QString("projection %1").arg(QTest::currentDataTag()), QJsonObject
+    {
+        {"stars", m_Stars.size()},
+        {"visible", visible},
+        {"toScreen", median(times)}
+    });
+}
+
+void BenchmarkSkyMap::compareWithBaseline()
+{
+    QString filename = QString::fromLocal8Bit(qgetenv("KSTARS_BENCHMARK_BASELINE"));
+    if (filename.isEmpty())
+        filename = QDir::current().filePath("benchmark_skymap_baseline.json");
+
+    QFile file(filename);
+    if (qgetenv("KSTARS_BENCHMARK_UPDATE") == "1")
+    {
+        QVERIFY2(file.open(QIODevice::WriteOnly | QIODevice::Truncate), qPrintable(file.errorString()));
+        file.write(QJsonDocument(m_Results).toJson());
+        qInfo() << "Wrote benchmark baseline" << filename;
+        return;
+    }
+
+    // A run without a baseline compares nothing, so it must not pass
+    QVERIFY2(file.exists(), qPrintable(QString("Missing benchmark baseline %1, create it with KSTARS_BENCHMARK_UPDATE=1")
+                                       .arg(filename)));
+
+    QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(file.errorString()));
+    const QJsonObject baseline = QJsonDocument::fromJson(file.readAll()).object();
+    QVERIFY2(!baseline.isEmpty(), qPrintable(QString("Invalid benchmark baseline %1").arg(filename)));
+
+    bool ok = false;
+    double tolerance = qgetenv("KSTARS_BENCHMARK_TOLERANCE").toDouble(&ok);
+    if (!ok || tolerance < 0)
+        tolerance = 0.25;
+
+    QStringList regressions;
+    for (auto benchmark = m_Results.constBegin(); benchmark != m_Results.constEnd(); ++benchmark)
+    {
+        const QJsonObject reference = baseline.value(benchmark.key()).toObject();
+        const QJsonObject result = benchmark.value().toObject();
+        for (auto value = result.constBegin(); value != result.constEnd(); ++value)
+        {
+            // New benchmarks and values only counted on this platform have nothing to compare with
+            if (!reference.contains(value.key()))
+                continue;
+
+            const QString &key = value.key();
+            if (key == "stars" || key == "visible")
+                continue;
+
+            const double expected = reference.value(key).toDouble();
+            const double actual = value.value().toDouble();
+            const bool isAllocation = key.endsWith("allocations");
+            const double limit = isAllocation ? expected * (1 + ALLOCATION_TOLERANCE) + ALLOCATION_SLACK :
+                                 expected * (1 + tolerance) + TIME_SLACK;
+            if (actual > limit)
+                regressions << QString("%1 / %2: %3 instead of %4").arg(benchmark.key(), key).arg(actual, 0, 'f', 2)
+                            .arg(expected, 0, 'f', 2);
+        }
+    }
+
+    if (!regressions.isEmpty())
+        QFAIL(qPrintable("Sky map performance regressed against " + filename + ":\n" + regressions.join('\n')));
+}
+
+int main(int argc, char *argv[])
+{
+    // The sky map is a widget, but nothing is shown
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication::setAttribute(Qt::AA_Use96Dpi, true);
+    QApplication app(argc, argv);
+    app.setApplicationName("kstars");
+    app.setOrganizationDomain("kde.org");
+
+    // Keep the configuration and the user database of the benchmark apart from the user's
+    QStandardPaths::setTestModeEnabled(true);
+
+    BenchmarkSkyMap benchmark;
+    return QTest::qExec(&benchmark, argc, argv);
+}
@@ -0,0 +1,69 @@
+/*  KStars sky map render benchmark
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QJsonObject>
+#include <QObject>
+#include <QVector>
+
+class SkyMap;
+class StarObject;
+
+/**
+ * @class BenchmarkSkyMap
+ * @short Renders the sky map offscreen with the installed catalogs and times every sky component.
+ *
+ * Each row of benchmarkRender changes one parameter of a default view: projection, zoom, focus,
+ * time step between frames or catalog depth. The median frame time, the time of each component
+ * and, with glibc, the number of heap allocations are compared with a baseline of an earlier run.
+ *
+ * Environment:
+ * - KSTARS_BENCHMARK_FRAMES: frames per row, 5 by default.
+ * - KSTARS_BENCHMARK_BASELINE: baseline file, benchmark_skymap_baseline.json in the working directory by default.
+ *   The benchmark fails if it is missing.
+ * - KSTARS_BENCHMARK_UPDATE=1: write the baseline with this run instead of comparing.
+ * - KSTARS_BENCHMARK_TOLERANCE: allowed relative slowdown, 0.25 by default.
+ * - KSTARS_BENCHMARK_OUTPUT: write the results of this run to this file.
+ */
+class BenchmarkSkyMap : public QObject
+{
+        Q_OBJECT
+
+    public:
+        BenchmarkSkyMap();
+        ~BenchmarkSkyMap() override = default;
+
+    private slots:
+        void initTestCase();
+        void cleanupTestCase();
+
+        void benchmarkRender_data();
+        void benchmarkRender();
+
+        void benchmarkJITUpdate_data();
+        void benchmarkJITUpdate();
+
+        void benchmarkProjection_data();
+        void benchmarkProjection();
+
+    private:
+        // Move the clock and recompute the coordinates like SkyMap does for every frame
+        void advanceTime(double seconds);
+        void setView(int projection, double zoom, double ra, double dec);
+        // Draw all sky components into the image, as SkyMapQDraw::paintEvent does
+        void renderFrame();
+        void record(const QString &name, const QJsonObject &result);
+        void compareWithBaseline();
+
+        SkyMap *m_Map { nullptr };
+        QVector<StarObject> m_Stars;
+        int m_Frames { 5 };
+        QJsonObject m_Results;
+};
@@ -585,4 +585,129 @@ void TestSkyPoint::testUpdateCoords()
 
 }
 
+void TestSkyPoint::testBatchTransforms()
+{
+    // The batch conversions must agree with the single point versions
+    const int count = 1000;
+    KSNumbers num(KStarsDateTime::fromString("2021-01-24T00:00").djd());
+    const dms LST(231.7), lat(48.2);
+    CachingDms cachedLST(LST), cachedLat(lat);
+
+    std::vector<double> ra(count), dec(count);
+    std::vector<float> raF(count), decF(count);
+    QList<SkyPoint> points;
+    qsrand(42);
+    for (int i = 0; i < count; i++)
+    {
+        ra[i]  = 2.0 * dms::PI * qrand() / RAND_MAX;
+        dec[i] = asin(2.0 * qrand() / RAND_MAX - 1.0);
+        raF[i]  = ra[i];
+        decF[i] = dec[i];
+
+        SkyPoint sp;
+        sp.setRA0(ra[i] / dms::DegToRad / 15.0);
+        sp.setDec0(dec[i] / dms::DegToRad);
+        points.append(sp);
+    }
+
+    SkyPoint::UnitVectors<double> j2000, ofDate;
+    SkyPoint::toUnitVectors(ra.data(), dec.data(), count, j2000);
+    SkyPoint::precess(&num, j2000, ofDate);
+
+    std::vector<double> raDate(count), decDate(count);
+    SkyPoint::fromUnitVectors(ofDate, raDate.data(), decDate.data());
+
+    std::vector<double> alt(count), az(count), ecLong(count), ecLat(count), galLong(count), galLat(count);
+    SkyPoint::EquatorialToHorizontal(ofDate, LST, lat, alt.data(), az.data());
+    SkyPoint::findEcliptic(ofDate, *num.obliquity(), ecLong.data(), ecLat.data());
+    SkyPoint::Equatorial1950ToGalactic(j2000, galLong.data(), galLat.data());
+
+    SkyPoint::UnitVectors<float> j2000F;
+    std::vector<float> altF(count), azF(count);
+    SkyPoint::toUnitVectors(raF.data(), decF.data(), count, j2000F);
+    SkyPoint::EquatorialToHorizontal(j2000F, LST, lat, altF.data(), azF.data());
+
+    // Differences of longitudes on the sky, in degrees
+    auto longitudeError = [](double a, double b, double latitude) -> double
+    {
+        double difference = fabs(a - b);
+        difference = std::min(difference, 2.0 * dms::PI - difference);
+        return difference * cos(latitude) / dms::DegToRad;
+    };
+
+    QVector<SkyPoint *> pointers;
+    for (int i = 0; i < count; i++)
+    {
+        SkyPoint &sp = points[i];
+        pointers.append(&sp);
+
+        sp.precess(&num);
+        QVERIFY(longitudeError(raDate[i], sp.ra().radians(), sp.dec().radians()) < 1e-9);
+        QVERIFY(fabs(decDate[i] - sp.dec().radians()) / dms::DegToRad < 1e-9);
+
+        sp.EquatorialToHorizontal(&cachedLST, &cachedLat);
+        QVERIFY(fabs(alt[i] - sp.alt().radians()) / dms::DegToRad < 1e-9);
+        QVERIFY(longitudeError(az[i], sp.az().radians(), sp.alt().radians()) < 1e-6);
+
+        dms longitude, latitude;
+        sp.findEcliptic(num.obliquity(), longitude, latitude);
+        QVERIFY(longitudeError(ecLong[i], longitude.radians(), latitude.radians()) < 1e-9);
+        QVERIFY(fabs(ecLat[i] - latitude.radians()) / dms::DegToRad < 1e-9);
+
+        SkyPoint b1950(ra[i] / dms::DegToRad / 15.0, dec[i] / dms::DegToRad);
+        b1950.Equatorial1950ToGalactic(longitude, latitude);
+        QVERIFY(longitudeError(galLong[i], longitude.radians(), latitude.radians()) < 1e-9);
+        QVERIFY(fabs(galLat[i] - latitude.radians()) / dms::DegToRad < 1e-9);
+
+        // The float path is for display, a few tenths of an arcsecond are fine
+        SkyPoint catalog(ra[i] / dms::DegToRad / 15.0, dec[i] / dms::DegToRad);
+        catalog.EquatorialToHorizontal(&cachedLST, &cachedLat);
+        QVERIFY(fabs(altF[i] - catalog.alt().radians()) / dms::DegToRad < 1e-4);
+        QVERIFY(longitudeError(azF[i], catalog.az().radians(), catalog.alt().radians()) < 1e-4);
+    }
+
+    // The SkyPoint overload writes the same Alt/Az as one call per point
+    SkyPoint::EquatorialToHorizontal(pointers.data(), count, &cachedLST, &cachedLat);
+    for (int i = 0; i < count; i++)
+    {
+        QVERIFY(fabs(alt[i] - pointers[i]->alt().radians()) / dms::DegToRad < 1e-9);
+        QVERIFY(longitudeError(az[i], pointers[i]->az().radians(), pointers[i]->alt().radians()) < 1e-6);
+    }
+}
+
+void TestSkyPoint::testApparentFromJ2000()
+{
+    // updateCoords() uses the precession-nutation matrix of KSNumbers, which must agree with
+    // applying precess(), nutate() and aberrate() one after the other
+    Options::setUseRelativistic(false);
+
+    // The step by step nutation is a first order expansion in tan(Dec), stay clear of the poles
+    const double maxDec = 80.0;
+    const double tolerance = 0.1 / 3600.0; // degrees
+
+    qsrand(7);
+    for (const char *date : { "1950-06-01T00:00", "2000-01-01T12:00", "2021-01-24T00:00", "2050-12-31T18:00" })
+    {
+        KSNumbers num(KStarsDateTime::fromString(date).djd());
+
+        for (int i = 0; i < 1000; i++)
+        {
+            const double ra  = 24.0 * qrand() / RAND_MAX;
+            const double dec = maxDec * (2.0 * qrand() / RAND_MAX - 1.0);
+
+            SkyPoint stepwise(ra, dec);
+            stepwise.precess(&num);
+            stepwise.nutate(&num);
+            stepwise.aberrate(&num);
+
+            SkyPoint fused(ra, dec);
+            fused.updateCoordsNow(&num);
+
+            const double error = fused.angularDistanceTo(&stepwise).Degrees();
+            QVERIFY2(error < tolerance, qPrintable(QString("%1: RA %2 Dec %3 differs by %4 arcsec")
+                                                  .arg(date).arg(ra).arg(dec).arg(error * 3600.0)));
+        }
+    }
+}
+
 QTEST_GUILESS_MAIN(TestSkyPoint)
@@ -72,6 +72,10 @@ class TestSkyPoint : public QObject
         
         void testUpdateCoords();
 
+        void testBatchTransforms();
+
+        void testApparentFromJ2000();
+
     private:
         bool useRelativistic {false};
 };
@@ -0,0 +1,111 @@
+/*  KStars Ephemeris Cache tests
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testksephemeriscache.h"
+
+#include "ksephemeriscache.h"
+#include "kstarsdatetime.h"
+#include "skyobjects/ksmoon.h"
+#include "skyobjects/ksplanet.h"
+
+#include <QtTest>
+
+#include <cmath>
+
+namespace
+{
+// A hundred days of 2020
+const long double START_JD = 2458850.5l;
+const long double STOP_JD  = 2458950.5l;
+
+// Largest distance between a fit and the series in AU, below 0.01" for the planets and 1" for the Moon
+const double MAX_ERROR = 1e-8;
+
+void rectangular(const EclipticPosition &position, double xyz[3])
+{
+    double sinLong, cosLong, sinLat, cosLat;
+    position.longitude.SinCos(sinLong, cosLong);
+    position.latitude.SinCos(sinLat, cosLat);
+
+    xyz[0] = position.radius * cosLat * cosLong;
+    xyz[1] = position.radius * cosLat * sinLong;
+    xyz[2] = position.radius * sinLat;
+}
+}
+
+TestKSEphemerisCache::TestKSEphemerisCache(QObject *parent) : QObject(parent)
+{
+}
+
+void TestKSEphemerisCache::initTestCase()
+{
+    // Fit from scratch, without touching the cache of the user
+    QStandardPaths::setTestModeEnabled(true);
+
+    KSPlanet mars(i18n("Mars"));
+    KSMoon moon;
+    if (!mars.loadData() || !moon.loadData())
+        QSKIP("KStars data is not installed, cannot evaluate the series.");
+
+    KSEphemerisCache::Instance()->clear();
+    KSEphemerisCache::Instance()->request(QVector<KSEphemerisCache::Body>() << KSEphemerisCache::EARTH
+                                          << KSEphemerisCache::MARS << KSEphemerisCache::MOON,
+                                          START_JD, STOP_JD).waitForFinished();
+
+    QVERIFY(KSEphemerisCache::Instance()->errorBound() < MAX_ERROR);
+}
+
+void TestKSEphemerisCache::testFits_data()
+{
+    QTest::addColumn<int>("body");
+
+    QTest::newRow("Earth") << int(KSEphemerisCache::EARTH);
+    QTest::newRow("Mars") << int(KSEphemerisCache::MARS);
+    QTest::newRow("Moon") << int(KSEphemerisCache::MOON);
+}
+
+void TestKSEphemerisCache::testFits()
+{
+    QFETCH(int, body);
+
+    KSPlanet earth(i18n("Earth"));
+    KSPlanet mars(i18n("Mars"));
+    KSMoon moon;
+    QVERIFY(earth.loadData() && mars.loadData() && moon.loadData());
+
+    // Not a multiple of the segment lengths, so the instants fall anywhere in the segments
+    for (long double jd = START_JD; jd < STOP_JD; jd += 0.3141592l)
+    {
+        EclipticPosition fitted, series;
+        QVERIFY(KSEphemerisCache::Instance()->ecliptic(static_cast<KSEphemerisCache::Body>(body), jd, fitted));
+
+        if (body == KSEphemerisCache::MOON)
+            moon.calcEcliptic(double(jd - J2000) / 36525.0, series);
+        else
+            (body == KSEphemerisCache::EARTH ? earth : mars).calcEclipticSeries(double(jd - J2000) / 365250.0, series);
+
+        double a[3], b[3];
+        rectangular(fitted, a);
+        rectangular(series, b);
+        const double distance = std::sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) +
+                                          (a[2] - b[2]) * (a[2] - b[2]));
+        QVERIFY2(distance < MAX_ERROR, qPrintable(QString("JD %1: %2 AU").arg(double(jd), 0, 'f', 4).arg(distance)));
+    }
+}
+
+void TestKSEphemerisCache::testOutsideSpan()
+{
+    // Instants which were not requested use the series
+    EclipticPosition position;
+    QVERIFY(!KSEphemerisCache::Instance()->ecliptic(KSEphemerisCache::MARS, STOP_JD + 5 * KSEphemerisCache::BLOCK_DAYS,
+            position));
+    QVERIFY(!KSEphemerisCache::Instance()->ecliptic(KSEphemerisCache::JUPITER, START_JD, position));
+}
+
+QTEST_GUILESS_MAIN(TestKSEphemerisCache)
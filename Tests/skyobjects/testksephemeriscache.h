@@ -0,0 +1,32 @@
+/*  KStars Ephemeris Cache tests
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestKSEphemerisCache
+ * @short Compares the Chebyshev fits of the ephemeris cache with the series they replace.
+ */
+class TestKSEphemerisCache : public QObject
+{
+        Q_OBJECT
+
+    public:
+        explicit TestKSEphemerisCache(QObject *parent = nullptr);
+
+    private slots:
+        void initTestCase();
+
+        void testFits_data();
+        void testFits();
+
+        void testOutsideSpan();
+};
@@ -0,0 +1,105 @@
+/*  KStars conjunction and eclipse search tests
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "testksconjunct.h"
+
+#include "ksconjunct.h"
+#include "kstarsdata.h"
+#include "kstarsdatetime.h"
+#include "eclipsetool/lunareclipsehandler.h"
+#include "skyobjects/ksplanetbase.h"
+
+#include <QtTest>
+
+namespace
+{
+long double julianDay(const QDateTime &utc)
+{
+    return KStarsDateTime(utc).djd();
+}
+
+QString dateString(long double jd)
+{
+    return KStarsDateTime(jd).toString(Qt::ISODate);
+}
+}
+
+TestKSConjunct::TestKSConjunct(QObject *parent) : QObject(parent)
+{
+}
+
+void TestKSConjunct::initTestCase()
+{
+    KStarsData *data = KStarsData::Create();
+    QVERIFY(data != nullptr);
+    if (!data->initialize())
+        QSKIP("KStars data is not installed, cannot compute planet positions.");
+
+    data->setLocationFromOptions();
+}
+
+void TestKSConjunct::testConjunction_data()
+{
+    QTest::addColumn<int>("planet1");
+    QTest::addColumn<int>("planet2");
+    QTest::addColumn<QDateTime>("expected");
+    QTest::addColumn<double>("separation");
+
+    // Great conjunction, closest approach at 18:20 UT, 6.1' apart
+    QTest::newRow("Jupiter-Saturn 2020") << int(KSPlanetBase::JUPITER) << int(KSPlanetBase::SATURN)
+                                         << QDateTime(QDate(2020, 12, 21), QTime(18, 20), Qt::UTC) << 6.1 / 60.0;
+}
+
+void TestKSConjunct::testConjunction()
+{
+    QFETCH(int, planet1);
+    QFETCH(int, planet2);
+    QFETCH(QDateTime, expected);
+    QFETCH(double, separation);
+
+    SkyObject_s object1(KSPlanetBase::createPlanet(planet1));
+    KSPlanetBase_s object2(KSPlanetBase::createPlanet(planet2));
+
+    KSConjunct conjunct;
+    conjunct.setObject1(object1);
+    conjunct.setObject2(object2);
+    conjunct.setMaxSeparation(dms(2.0));
+
+    // A year around the conjunction, the planets do not come that close again
+    const long double expectedJD = julianDay(expected);
+    const QMap<long double, dms> approaches = conjunct.findClosestApproach(expectedJD - 180, expectedJD + 180);
+    QCOMPARE(approaches.size(), 1);
+
+    const long double jd = approaches.firstKey();
+    QVERIFY2(qAbs(double(jd - expectedJD)) < 0.1, qPrintable(dateString(jd)));
+    QVERIFY2(qAbs(approaches.first().Degrees() - separation) < 0.02, qPrintable(approaches.first().toDMSString()));
+}
+
+void TestKSConjunct::testLunarEclipses()
+{
+    LunarEclipseHandler handler;
+    const EclipseHandler::EclipseVector eclipses =
+        handler.computeEclipses(julianDay(QDateTime(QDate(2022, 1, 1), QTime(0, 0), Qt::UTC)),
+                                julianDay(QDateTime(QDate(2022, 12, 31), QTime(0, 0), Qt::UTC)));
+
+    // The two total eclipses of 2022, at greatest eclipse
+    const QVector<QDateTime> expected = QVector<QDateTime>() << QDateTime(QDate(2022, 5, 16), QTime(4, 11), Qt::UTC)
+                                        << QDateTime(QDate(2022, 11, 8), QTime(10, 59), Qt::UTC);
+    QCOMPARE(eclipses.size(), expected.size());
+
+    for (int i = 0; i < expected.size(); i++)
+    {
+        const long double jd = eclipses[i]->getJD();
+        // Half an hour
+        QVERIFY2(qAbs(double(jd - julianDay(expected[i]))) < 0.02, qPrintable(dateString(jd)));
+        QCOMPARE(eclipses[i]->getType(), EclipseEvent::FULL);
+    }
+}
+
+QTEST_MAIN(TestKSConjunct)
@@ -0,0 +1,32 @@
+/*  KStars conjunction and eclipse search tests
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include <QObject>
+
+/**
+ * @class TestKSConjunct
+ * @short Compares the approaches found by ApproachSolver with published conjunctions and eclipses.
+ */
+class TestKSConjunct : public QObject
+{
+        Q_OBJECT
+
+    public:
+        explicit TestKSConjunct(QObject *parent = nullptr);
+
+    private slots:
+        void initTestCase();
+
+        void testConjunction_data();
+        void testConjunction();
+
+        void testLunarEclipses();
+};
@@ -24,11 +24,14 @@
 #include "starobject.h"
 #include "deepskyobject.h"
 #include "skycomponent.h"
+#include "skymesh.h"
 
+#include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QSqlField>
-#include <QSqlQuery>
 #include <QSqlRecord>
 #include <QSqlTableModel>
+#include <QThread>
 
 #include <catalog_debug.h>
 
@@ -65,6 +68,7 @@ bool CatalogDB::Initialize()
         {
             FirstRun();
         }
+        CreateIndexes();
     }
     skydb_.close();
     return true;
@@ -126,6 +130,26 @@ void CatalogDB::FirstRun()
     qCWarning(KSTARS_CATALOG) << "Additional Sky Catalog Database rebuilt.";
 }
 
+void CatalogDB::CreateIndexes()
+{
+    QVector<QString> indexes;
+    // Fuzzy matches of new entries
+    indexes.append("CREATE INDEX IF NOT EXISTS DSOPosition ON DSO (RA, Dec)");
+    // Objects of a catalog by trixel
+    indexes.append("CREATE INDEX IF NOT EXISTS DesignationTrixel ON ObjectDesignation (id_Catalog, Trixel)");
+    // Custom entries by name
+    indexes.append("CREATE INDEX IF NOT EXISTS DesignationLongName ON ObjectDesignation (id_Catalog, LongName)");
+
+    for (int i = 0; i < indexes.count(); ++i)
+    {
+        QSqlQuery query(skydb_);
+        if (!query.exec(indexes[i]))
+        {
+            qCWarning(KSTARS_CATALOG) << query.lastError();
+        }
+    }
+}
+
 CatalogDB::~CatalogDB()
 {
     skydb_.close();
@@ -261,40 +285,59 @@ void CatalogDB::ClearDSOEntries(int catalog_id)
 }
 
 int CatalogDB::FindFuzzyEntry(const double ra, const double dec, const double magnitude)
+{
+    InsertQueries queries(skydb_);
+    return _FindFuzzyEntry(ra, dec, magnitude, queries.fuzzy);
+}
+
+int CatalogDB::_FindFuzzyEntry(const double ra, const double dec, const double magnitude, QSqlQuery &fuzzy)
 {
     /*
      * FIXME (spacetime): Match the incoming entry with the ones from the db
      * with certain fuzz. If found, store it in rowuid
      * This Fuzz has not been established after due discussion
     */
-    //skydb_.open();
-    QSqlTableModel dsoentries(nullptr, skydb_);
-
-    QString filter = "((RA - " + QString().setNum(ra) +
-                     ") between -0.0016 and 0.0016) and "
-                     "((Dec - " +
-                     QString().setNum(dec) +
-                     ") between -0.0016 and 0.0016) and"
-                     "((Magnitude - " +
-                     QString().setNum(magnitude) + ") between -0.1 and 0.1)";
-    //   qDebug() << filter;
-    dsoentries.setTable("DSO");
-    dsoentries.setFilter(filter);
-    dsoentries.select();
-
-    int entry_count   = dsoentries.rowCount();
-    QSqlRecord record = dsoentries.record(0);
+    // Ranges rather than differences, so the position index is used
+    fuzzy.bindValue(":ra0", ra - 0.0016);
+    fuzzy.bindValue(":ra1", ra + 0.0016);
+    fuzzy.bindValue(":dec0", dec - 0.0016);
+    fuzzy.bindValue(":dec1", dec + 0.0016);
+    fuzzy.bindValue(":mag0", magnitude - 0.1);
+    fuzzy.bindValue(":mag1", magnitude + 0.1);
 
     int returnval = -1;
-    if (entry_count > 0)
-        returnval = record.value("UID").toInt();
+    if (!fuzzy.exec())
+        qCWarning(KSTARS_CATALOG) << fuzzy.lastError();
+    else if (fuzzy.next())
+        returnval = fuzzy.value(0).toInt();
 
-    dsoentries.clear();
-    //skydb_.close();
-    //   qDebug() << returnval;
+    fuzzy.finish();
     return returnval;
 }
 
+CatalogDB::InsertQueries::InsertQueries(const QSqlDatabase &db) : fuzzy(db), dso(db), designation(db), designationNextID(db)
+{
+    fuzzy.setForwardOnly(true);
+    fuzzy.prepare("SELECT UID FROM DSO WHERE RA BETWEEN :ra0 AND :ra1 AND Dec BETWEEN :dec0 AND :dec1"
+                  " AND Magnitude BETWEEN :mag0 AND :mag1 LIMIT 1");
+
+    // I will not use QSQLTableModel as I need to execute a query to find
+    // out the lastInsertId
+    dso.prepare("INSERT INTO DSO (RA, Dec, Type, Magnitude, PositionAngle,"
+                " MajorAxis, MinorAxis, Flux) VALUES (:RA, :Dec, :Type,"
+                " :Magnitude, :PositionAngle, :MajorAxis, :MinorAxis,"
+                " :Flux)");
+
+    designation.prepare("INSERT INTO ObjectDesignation (id_Catalog, UID_DSO, LongName"
+                        ", IDNumber, Trixel) VALUES (:catid, :rowuid, :longname, :id, :trixel)");
+
+    //qWarning() << "FIXME: This query has not been tested!!!!";
+    designationNextID.prepare("INSERT INTO ObjectDesignation (id_Catalog, UID_DSO, LongName"
+                              ", IDNumber, Trixel) VALUES (:catid, :rowuid, :longname,"
+                              "(SELECT MAX(ISNULL(IDNumber,1))+1 FROM ObjectDesignation WHERE id_Catalog = :catid),"
+                              " :trixel)");
+}
+
 bool CatalogDB::AddEntry(const CatalogEntryData &catalog_entry, int catid)
 {
     if (!skydb_.open())
@@ -303,12 +346,16 @@ bool CatalogDB::AddEntry(const CatalogEntryData &catalog_entry, int catid)
         qCWarning(KSTARS_CATALOG) << LastError();
         return false;
     }
-    bool retVal = _AddEntry(catalog_entry, catid);
+    bool retVal;
+    {
+        InsertQueries queries(skydb_);
+        retVal = _AddEntry(catalog_entry, catid, queries);
+    }
     skydb_.close();
     return retVal;
 }
 
-bool CatalogDB::_AddEntry(const CatalogEntryData &catalog_entry, int catid)
+bool CatalogDB::_AddEntry(const CatalogEntryData &catalog_entry, int catid, InsertQueries &queries)
 {
     // Verification step
     // If RA, Dec are Null, it denotes an invalid object and should not be written
@@ -317,28 +364,19 @@ bool CatalogDB::_AddEntry(const CatalogEntryData &catalog_entry, int catid)
         qCWarning(KSTARS_CATALOG) << "Catalog ID " << catid << " is invalid! Cannot add object.";
         return false;
     }
-    if (catalog_entry.ra == KSParser::EBROKEN_DOUBLE || catalog_entry.ra == 0.0 || std::isnan(catalog_entry.ra) ||
-        catalog_entry.dec == KSParser::EBROKEN_DOUBLE || catalog_entry.dec == 0.0 || std::isnan(catalog_entry.dec))
+    if (catalog_entry.ra == 0.0 || std::isnan(catalog_entry.ra) || catalog_entry.dec == 0.0 ||
+        std::isnan(catalog_entry.dec))
     {
         qCWarning(KSTARS_CATALOG) << "Attempt to add incorrect ra & dec with ID:" << catalog_entry.ID
                  << " Long Name: " << catalog_entry.long_name;
         return false;
     }
-    // Part 1: Adding in DSO table
-    // I will not use QSQLTableModel as I need to execute a query to find
-    // out the lastInsertId
-
-    // Part 2: Fuzzy Match or Create New Entry
-    int rowuid = FindFuzzyEntry(catalog_entry.ra, catalog_entry.dec, catalog_entry.magnitude);
-    //skydb_.open();
+    // Part 1: Fuzzy Match or Create New Entry in DSO table
+    int rowuid = _FindFuzzyEntry(catalog_entry.ra, catalog_entry.dec, catalog_entry.magnitude, queries.fuzzy);
 
     if (rowuid == -1) //i.e. No fuzzy match found. Proceed to add new entry
     {
-        QSqlQuery add_query(skydb_);
-        add_query.prepare("INSERT INTO DSO (RA, Dec, Type, Magnitude, PositionAngle,"
-                          " MajorAxis, MinorAxis, Flux) VALUES (:RA, :Dec, :Type,"
-                          " :Magnitude, :PositionAngle, :MajorAxis, :MinorAxis,"
-                          " :Flux)");
+        QSqlQuery &add_query = queries.dso;
         add_query.bindValue(":RA", catalog_entry.ra);
         add_query.bindValue(":Dec", catalog_entry.dec);
         add_query.bindValue(":Type", catalog_entry.type);
@@ -352,45 +390,29 @@ bool CatalogDB::_AddEntry(const CatalogEntryData &catalog_entry, int catid)
             qCWarning(KSTARS_CATALOG) << "Custom Catalog Insert Query FAILED!";
             qCWarning(KSTARS_CATALOG) << add_query.lastQuery();
             qCWarning(KSTARS_CATALOG) << add_query.lastError();
+            return false;
         }
 
         // Find UID of the Row just added
         rowuid = add_query.lastInsertId().toInt();
-        add_query.clear();
     }
     int ID = catalog_entry.ID;
 
-    /* TODO(spacetime)
-     * Possible Bugs in QSQL Db with SQLite
-     * 1) Unless the db is closed and opened again, the next queries
-     *    fail.
-     * 2) unless I clear the resources, db close fails. The doc says
-     *    this is to be rarely used.
-     */
-
-    // Find ID of catalog
-    //skydb_.close();
-    //catid = FindCatalog(catalog_entry.catalog_name);
-
-    // Part 3: Add in Object Designation
-    //skydb_.open();
-    QSqlQuery add_od(skydb_);
-    if (ID >= 0)
+    // Part 2: Add in Object Designation, with the trixel of the catalog coordinates
+    QVariant trixel(QVariant::Int);
+    if (SkyMesh *mesh = SkyMesh::Instance())
     {
-        add_od.prepare("INSERT INTO ObjectDesignation (id_Catalog, UID_DSO, LongName"
-                       ", IDNumber) VALUES (:catid, :rowuid, :longname, :id)");
-        add_od.bindValue(":id", ID);
-    }
-    else
-    {
-        //qWarning() << "FIXME: This query has not been tested!!!!";
-        add_od.prepare("INSERT INTO ObjectDesignation (id_Catalog, UID_DSO, LongName"
-                       ", IDNumber) VALUES (:catid, :rowuid, :longname,"
-                       "(SELECT MAX(ISNULL(IDNumber,1))+1 FROM ObjectDesignation WHERE id_Catalog = :catid) )");
+        SkyPoint position(dms(catalog_entry.ra), dms(catalog_entry.dec));
+        trixel = mesh->index(&position);
     }
+
+    QSqlQuery &add_od = ID >= 0 ? queries.designation : queries.designationNextID;
+    if (ID >= 0)
+        add_od.bindValue(":id", ID);
     add_od.bindValue(":catid", catid);
     add_od.bindValue(":rowuid", rowuid);
     add_od.bindValue(":longname", catalog_entry.long_name);
+    add_od.bindValue(":trixel", trixel);
     bool retVal = true;
     if (!add_od.exec())
     {
@@ -399,8 +421,6 @@ bool CatalogDB::_AddEntry(const CatalogEntryData &catalog_entry, int catid)
         qWarning() << skydb_.lastError();
         retVal = false;
     }
-    add_od.clear();
-    //skydb_.close();
 
     return retVal;
 }
@@ -535,47 +555,72 @@ bool CatalogDB::AddCatalogContents(const QString &fname)
 
         /*
           * Now 'Columns' should be a StringList of the Header contents
-          * Hence, we 1) Convert the Columns to a KSParser compatible format
-          *           2) Use KSParser to read stuff and store in DB
+          * Hence, we 1) Bind the Columns to the fields of a row
+          *           2) Use KSRecordParser to read stuff and store in DB
           */
 
-        // Part 1) Conversion to KSParser compatible format
-        QList<QPair<QString, KSParser::DataTypes>> sequence = buildParserSequence(columns);
+        // Part 1) Binding of the columns
+        CatalogRow row;
+        QVector<KSRecordParser::Column> parser_columns = buildParserColumns(columns, row);
 
         // Part 2) Read file and store into DB
-        KSParser catalog_text_parser(filename, '#', sequence, delimiter);
+        KSRecordParser catalog_text_parser(filename, '#', parser_columns, delimiter);
 
         int catid = FindCatalog(catalog_name);
 
+        QElapsedTimer timer;
+        timer.start();
+        int rows = 0;
+        bool success = true;
+
         skydb_.open();
         skydb_.transaction();
-
-        QHash<QString, QVariant> row_content;
-        while (catalog_text_parser.HasNextRow())
         {
-            row_content = catalog_text_parser.ReadNextRow();
+            InsertQueries queries(skydb_);
 
             CatalogEntryData catalog_entry;
+            catalog_entry.catalog_name = catalog_name;
+            while (success && catalog_text_parser.readRow())
+            {
+                dms read_ra(row.ra.toString(), false);
+                dms read_dec(row.dec.toString(), true);
+                catalog_entry.ID             = row.ID;
+                catalog_entry.long_name      = row.name.toString();
+                catalog_entry.ra             = read_ra.Degrees();
+                catalog_entry.dec            = read_dec.Degrees();
+                catalog_entry.type           = row.type;
+                catalog_entry.magnitude      = row.magnitude;
+                catalog_entry.position_angle = row.position_angle;
+                catalog_entry.major_axis     = row.major_axis;
+                catalog_entry.minor_axis     = row.minor_axis;
+                catalog_entry.flux           = row.flux;
+
+                // A catalog is added completely or not at all
+                success = _AddEntry(catalog_entry, catid, queries);
+                if (success)
+                    rows++;
+                else
+                    qCWarning(KSTARS_CATALOG) << "Cannot add row" << rows + 1 << "of catalog" << catalog_name;
+            }
+        }
+
+        if (success && !skydb_.commit())
+        {
+            qCWarning(KSTARS_CATALOG) << "Cannot add catalog" << catalog_name << LastError();
+            success = false;
+        }
 
-            dms read_ra(row_content["RA"].toString(), false);
-            dms read_dec(row_content["Dc"].toString(), true);
-            //qDebug()<<row_content["Nm"].toString();
-            catalog_entry.catalog_name   = catalog_name;
-            catalog_entry.ID             = row_content["ID"].toInt();
-            catalog_entry.long_name      = row_content["Nm"].toString();
-            catalog_entry.ra             = read_ra.Degrees();
-            catalog_entry.dec            = read_dec.Degrees();
-            catalog_entry.type           = row_content["Tp"].toInt();
-            catalog_entry.magnitude      = row_content["Mg"].toFloat();
-            catalog_entry.position_angle = row_content["PA"].toFloat();
-            catalog_entry.major_axis     = row_content["Mj"].toFloat();
-            catalog_entry.minor_axis     = row_content["Mn"].toFloat();
-            catalog_entry.flux           = row_content["Flux"].toFloat();
-
-            _AddEntry(catalog_entry, catid);
+        if (!success)
+        {
+            skydb_.rollback();
+            skydb_.close();
+            // Also remove the catalog entry added with the header
+            RemoveCatalog(catalog_name);
+            return false;
         }
 
-        skydb_.commit();
+        qCInfo(KSTARS_CATALOG) << "Added" << rows << "objects to catalog" << catalog_name << "in" << timer.elapsed()
+                               << "ms";
         skydb_.close();
     }
     return true;
@@ -891,20 +936,141 @@ void CatalogDB::GetCatalogData(const QString &catalog_name, CatalogData &load_ca
     skydb_.close();
 }
 
+namespace
+{
+// Columns read by CreateObject()
+const char OBJECT_COLUMNS[] = "SELECT Epoch, Type, RA, Dec, Magnitude, Prefix, "
+                              "IDNumber, LongName, MajorAxis, MinorAxis, "
+                              "PositionAngle, Flux, Trixel FROM ObjectDesignation JOIN DSO "
+                              "JOIN Catalog WHERE ";
+
+// Name and long name of an object as shown in KStars
+void designate(bool includeCatalogDesignation, const QString &prefix, int id_number_in_catalog, QString &name,
+               QString &lname)
+{
+    if (!includeCatalogDesignation && !lname.isEmpty())
+    {
+        name  = lname;
+        lname = QString();
+    }
+    else
+        name = prefix + ' ' + QString::number(id_number_in_catalog);
+}
+}
+
+QSqlDatabase CatalogDB::threadConnection()
+{
+    if (QThread::currentThread() == QCoreApplication::instance()->thread())
+        return skydb_;
+
+    // Connections can only be used by the thread that created them
+    const QString name = QString("skydb_%1").arg(reinterpret_cast<quintptr>(QThread::currentThread()));
+    if (QSqlDatabase::contains(name))
+        return QSqlDatabase::database(name, false);
+    return QSqlDatabase::cloneDatabase(skydb_, name);
+}
+
+SkyObject *CatalogDB::CreateObject(const QSqlQuery &query, CatalogComponent *catalog_ptr,
+                                   bool includeCatalogDesignation, QList<QPair<int, QString>> &object_names,
+                                   int &trixel)
+{
+    int cat_epoch       = query.value(0).toInt();
+    unsigned char iType = query.value(1).toInt();
+    dms RA(query.value(2).toDouble());
+    dms Dec(query.value(3).toDouble());
+    float mag                = query.value(4).toFloat();
+    QString catPrefix        = query.value(5).toString();
+    int id_number_in_catalog = query.value(6).toInt();
+    QString lname            = query.value(7).toString();
+    float a                  = query.value(8).toFloat();
+    float b                  = query.value(9).toFloat();
+    float PA                 = query.value(10).toFloat();
+    float flux               = query.value(11).toFloat();
+    QVariant storedTrixel    = query.value(12);
+    QString name;
+
+    designate(includeCatalogDesignation, catPrefix, id_number_in_catalog, name, lname);
+
+    SkyPoint t;
+    t.set(RA, Dec);
+
+    if (cat_epoch == 1950)
+    {
+        // Assume B1950 epoch
+        t.B1950ToJ2000(); // t.ra() and t.dec() are now J2000.0
+        // coordinates
+    }
+    else if (cat_epoch == 2000)
+    {
+        // Do nothing
+        {
+        }
+    }
+    else
+    {
+        // FIXME: What should we do?
+        // FIXME: This warning will be printed for each line in the
+        //        catalog rather than once for the entire catalog
+        qWarning() << "Unknown epoch while dealing with custom "
+                      "catalog. Will ignore the epoch and assume"
+                      " J2000.0";
+    }
+
+    RA  = t.ra();
+    Dec = t.dec();
+
+    // Stored trixels are those of the catalog coordinates
+    trixel = (cat_epoch == 2000 && !storedTrixel.isNull()) ? storedTrixel.toInt() : -1;
+
+    // FIXME: It is a bad idea to create objects in one class
+    // (using new) and delete them in another! The objects created
+    // here are usually deleted by CatalogComponent! See
+    // CatalogComponent::loadData for more information!
+
+    SkyObject *object = nullptr;
+    if (iType == 0) // Add a star
+    {
+        object = new StarObject(RA, Dec, mag, lname);
+    }
+    else // Add a deep-sky object
+    {
+        DeepSkyObject *o = new DeepSkyObject(iType, RA, Dec, mag, name, QString(), lname, catPrefix, a, b, -PA);
+
+        o->setFlux(flux);
+        o->setCustomCatalog(catalog_ptr);
+
+        object = o;
+
+        // Add name to the list of object names
+        if (!name.isEmpty())
+        {
+            object_names.append(qMakePair<int, QString>(iType, name));
+        }
+    }
+
+    if (!lname.isEmpty() && lname != name)
+    {
+        object_names.append(qMakePair<int, QString>(iType, lname));
+    }
+
+    return object;
+}
+
 void CatalogDB::GetAllObjects(const QString &catalog, QList<SkyObject *> &sky_list,
                               QList<QPair<int, QString>> &object_names, CatalogComponent *catalog_ptr,
-                              bool includeCatalogDesignation)
+                              bool includeCatalogDesignation, QVector<int> *trixels)
 {
     qDeleteAll(sky_list);
     sky_list.clear();
+    if (trixels)
+        trixels->clear();
     QString selected_catalog = QString::number(FindCatalog(catalog));
 
     skydb_.open();
     QSqlQuery get_query(skydb_);
-    get_query.prepare("SELECT Epoch, Type, RA, Dec, Magnitude, Prefix, "
-                      "IDNumber, LongName, MajorAxis, MinorAxis, "
-                      "PositionAngle, Flux FROM ObjectDesignation JOIN DSO "
-                      "JOIN Catalog WHERE Catalog.id = :catID AND "
+    // Rows are read once, in order
+    get_query.setForwardOnly(true);
+    get_query.prepare(QString(OBJECT_COLUMNS) + "Catalog.id = :catID AND "
                       "ObjectDesignation.id_Catalog = Catalog.id AND "
                       "ObjectDesignation.UID_DSO = DSO.UID");
     get_query.bindValue(":catID", selected_catalog);
@@ -921,129 +1087,118 @@ void CatalogDB::GetAllObjects(const QString &catalog, QList<SkyObject *> &sky_li
 
     while (get_query.next())
     {
-        int cat_epoch       = get_query.value(0).toInt();
-        unsigned char iType = get_query.value(1).toInt();
-        dms RA(get_query.value(2).toDouble());
-        dms Dec(get_query.value(3).toDouble());
-        float mag                = get_query.value(4).toFloat();
-        QString catPrefix        = get_query.value(5).toString();
-        int id_number_in_catalog = get_query.value(6).toInt();
-        QString lname            = get_query.value(7).toString();
-        float a                  = get_query.value(8).toFloat();
-        float b                  = get_query.value(9).toFloat();
-        float PA                 = get_query.value(10).toFloat();
-        float flux               = get_query.value(11).toFloat();
-        QString name;
-
-        if (!includeCatalogDesignation && !lname.isEmpty())
-        {
-            name  = lname;
-            lname = QString();
-        }
-        else
-            name = catPrefix + ' ' + QString::number(id_number_in_catalog);
+        int trixel = -1;
+        sky_list.append(CreateObject(get_query, catalog_ptr, includeCatalogDesignation, object_names, trixel));
+        if (trixels)
+            trixels->append(trixel);
+    }
 
-        SkyPoint t;
-        t.set(RA, Dec);
+    get_query.clear();
+    skydb_.close();
+}
 
-        if (cat_epoch == 1950)
-        {
-            // Assume B1950 epoch
-            t.B1950ToJ2000(); // t.ra() and t.dec() are now J2000.0
-            // coordinates
-        }
-        else if (cat_epoch == 2000)
-        {
-            // Do nothing
-            {
-            }
-        }
-        else
+void CatalogDB::GetTrixelObjects(int catalog_id, int trixel, QList<SkyObject *> &sky_list,
+                                 CatalogComponent *catalog_ptr, bool includeCatalogDesignation)
+{
+    QSqlDatabase db = threadConnection();
+    db.open();
+    {
+        QSqlQuery get_query(db);
+        get_query.setForwardOnly(true);
+        // Uses the (id_Catalog, Trixel) index
+        get_query.prepare(QString(OBJECT_COLUMNS) + "ObjectDesignation.id_Catalog = :catID AND "
+                          "ObjectDesignation.Trixel = :trixel AND "
+                          "Catalog.id = ObjectDesignation.id_Catalog AND "
+                          "ObjectDesignation.UID_DSO = DSO.UID");
+        get_query.bindValue(":catID", catalog_id);
+        get_query.bindValue(":trixel", trixel);
+
+        if (!get_query.exec())
         {
-            // FIXME: What should we do?
-            // FIXME: This warning will be printed for each line in the
-            //        catalog rather than once for the entire catalog
-            qWarning() << "Unknown epoch while dealing with custom "
-                          "catalog. Will ignore the epoch and assume"
-                          " J2000.0";
+            qCWarning(KSTARS_CATALOG) << get_query.lastQuery();
+            qCWarning(KSTARS_CATALOG) << get_query.lastError();
         }
 
-        RA  = t.ra();
-        Dec = t.dec();
-
-        // FIXME: It is a bad idea to create objects in one class
-        // (using new) and delete them in another! The objects created
-        // here are usually deleted by CatalogComponent! See
-        // CatalogComponent::loadData for more information!
-
-        if (iType == 0) // Add a star
+        // The names are already known from GetObjectNames()
+        QList<QPair<int, QString>> object_names;
+        while (get_query.next())
         {
-            StarObject *o = new StarObject(RA, Dec, mag, lname);
-
-            sky_list.append(o);
+            int objectTrixel = -1;
+            sky_list.append(CreateObject(get_query, catalog_ptr, includeCatalogDesignation, object_names, objectTrixel));
         }
-        else // Add a deep-sky object
-        {
-            DeepSkyObject *o = new DeepSkyObject(iType, RA, Dec, mag, name, QString(), lname, catPrefix, a, b, -PA);
+    }
+    db.close();
+}
 
-            o->setFlux(flux);
-            o->setCustomCatalog(catalog_ptr);
+void CatalogDB::GetObjectNames(const QString &catalog, QVector<ObjectName> &names, bool includeCatalogDesignation)
+{
+    names.clear();
+    QString selected_catalog = QString::number(FindCatalog(catalog));
 
-            sky_list.append(o);
+    skydb_.open();
+    QSqlQuery get_query(skydb_);
+    get_query.setForwardOnly(true);
+    get_query.prepare("SELECT Epoch, Type, Prefix, IDNumber, LongName, Trixel FROM ObjectDesignation JOIN DSO "
+                      "JOIN Catalog WHERE Catalog.id = :catID AND "
+                      "ObjectDesignation.id_Catalog = Catalog.id AND "
+                      "ObjectDesignation.UID_DSO = DSO.UID");
+    get_query.bindValue(":catID", selected_catalog);
 
-            // Add name to the list of object names
-            if (!name.isEmpty())
-            {
-                object_names.append(qMakePair<int, QString>(iType, name));
-            }
-        }
+    if (!get_query.exec())
+    {
+        qCWarning(KSTARS_CATALOG) << get_query.lastQuery();
+        qCWarning(KSTARS_CATALOG) << get_query.lastError();
+    }
 
-        if (!lname.isEmpty() && lname != name)
-        {
-            object_names.append(qMakePair<int, QString>(iType, lname));
-        }
+    while (get_query.next())
+    {
+        ObjectName object;
+        object.type     = get_query.value(1).toInt();
+        object.longname = get_query.value(4).toString();
+        designate(includeCatalogDesignation, get_query.value(2).toString(), get_query.value(3).toInt(), object.name,
+                  object.longname);
+        // Stars are named after their long name only, see CreateObject()
+        if (object.type == 0)
+            object.name = object.longname;
+        const QVariant trixel = get_query.value(5);
+        object.trixel = (get_query.value(0).toInt() == 2000 && !trixel.isNull()) ? trixel.toInt() : -1;
+        names.append(object);
     }
 
     get_query.clear();
     skydb_.close();
 }
 
-QList<QPair<QString, KSParser::DataTypes>> CatalogDB::buildParserSequence(const QStringList &Columns)
+QVector<KSRecordParser::Column> CatalogDB::buildParserColumns(const QStringList &Columns, CatalogRow &row)
 {
-    QList<QPair<QString, KSParser::DataTypes>> sequence;
-    QStringList::const_iterator iter = Columns.begin();
+    QVector<KSRecordParser::Column> columns;
 
-    while (iter != Columns.end())
+    for (const QString &column : Columns)
     {
         // Available Types: ID RA Dc Tp Nm Mg Flux Mj Mn PA Ig
-        KSParser::DataTypes current_type;
-
-        if (*iter == QString("ID"))
-            current_type = KSParser::D_QSTRING;
-        else if (*iter == QString("RA"))
-            current_type = KSParser::D_QSTRING;
-        else if (*iter == QString("Dc"))
-            current_type = KSParser::D_QSTRING;
-        else if (*iter == QString("Tp"))
-            current_type = KSParser::D_INT;
-        else if (*iter == QString("Nm"))
-            current_type = KSParser::D_QSTRING;
-        else if (*iter == QString("Mg"))
-            current_type = KSParser::D_FLOAT;
-        else if (*iter == QString("Flux"))
-            current_type = KSParser::D_FLOAT;
-        else if (*iter == QString("Mj"))
-            current_type = KSParser::D_FLOAT;
-        else if (*iter == QString("Mn"))
-            current_type = KSParser::D_FLOAT;
-        else if (*iter == QString("PA"))
-            current_type = KSParser::D_FLOAT;
-        else if (*iter == QString("Ig"))
-            current_type = KSParser::D_SKIP;
-
-        sequence.append(qMakePair(*iter, current_type));
-        ++iter;
+        if (column == QLatin1String("ID"))
+            columns.append(&row.ID);
+        else if (column == QLatin1String("RA"))
+            columns.append(&row.ra);
+        else if (column == QLatin1String("Dc"))
+            columns.append(&row.dec);
+        else if (column == QLatin1String("Tp"))
+            columns.append(&row.type);
+        else if (column == QLatin1String("Nm"))
+            columns.append(&row.name);
+        else if (column == QLatin1String("Mg"))
+            columns.append(&row.magnitude);
+        else if (column == QLatin1String("Flux"))
+            columns.append(&row.flux);
+        else if (column == QLatin1String("Mj"))
+            columns.append(&row.major_axis);
+        else if (column == QLatin1String("Mn"))
+            columns.append(&row.minor_axis);
+        else if (column == QLatin1String("PA"))
+            columns.append(&row.position_angle);
+        else
+            columns.append(KSRecordParser::Column()); // Ig
     }
 
-    return sequence;
+    return columns;
 }
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "ksparser.h"
+#include "ksrecordparser.h"
 
 #include <KLocalizedString>
 #if !defined(ANDROID)
@@ -26,6 +27,8 @@
 
 #include <QSqlDatabase>
 #include <QSqlError>
+#include <QSqlQuery>
+#include <QVector>
 
 class SkyObject;
 class CatalogComponent;
@@ -89,6 +92,10 @@ class CatalogDB
     /**
      * @short Add contents of custom catalog to the program database
      *
+     * The rows are streamed from the file and inserted with statements prepared once, in a single
+     * transaction. The trixel of every object is stored with its designation. If a row cannot be
+     * added, the transaction is rolled back and the catalog is removed.
+     *
      * @p filename the name of the file containing the data to be read
      * @return true if catalog was successfully added
      */
@@ -126,12 +133,51 @@ class CatalogDB
      * the designations "Misc 1", "Misc 2" etc. So the only proper designations are the
      * long name. When this is the case, this flag is set to false, and the catalog designation
      * (cat_prefix + cat_id) will not be included in the object_names returned.
+     * @param trixels If not null, assigned the trixel of each object of sky_list, or -1 if the
+     * trixel was not stored or the catalog is not in J2000 coordinates.
      *
      * @return void
      **/
     void GetAllObjects(const QString &catalog_name, QList<SkyObject *> &sky_list,
                        QList<QPair<int, QString>> &object_names, CatalogComponent *catalog_pointer,
-                       bool includeCatalogDesignation = true);
+                       bool includeCatalogDesignation = true, QVector<int> *trixels = nullptr);
+
+    /** @short Names of an object of a catalog and the trixel it is stored with, see GetObjectNames() */
+    struct ObjectName
+    {
+        int type { 0 };
+        QString name;
+        QString longname;
+        // -1 if the trixel was not stored or the catalog is not in J2000 coordinates
+        int trixel { -1 };
+    };
+
+    /**
+     * @brief Reads the names of the objects of a catalog without creating the objects.
+     * The names are those of the objects created by GetAllObjects() and GetTrixelObjects().
+     *
+     * @param catalog_name Name of the catalog
+     * @param names Names of every object of the catalog (assigns)
+     * @param includeCatalogDesignation see GetAllObjects()
+     * @return void
+     **/
+    void GetObjectNames(const QString &catalog_name, QVector<ObjectName> &names, bool includeCatalogDesignation = true);
+
+    /**
+     * @brief Creates the objects of a catalog stored with the given trixel, using the
+     * index on (id_Catalog, Trixel).
+     *
+     * @note May be called on a worker thread, which then uses a connection of its own.
+     *
+     * @param catalog_id DB generated catalog ID
+     * @param trixel Trixel of the objects
+     * @param sky_list The objects are appended to this list
+     * @param catalog_pointer see GetAllObjects()
+     * @param includeCatalogDesignation see GetAllObjects()
+     * @return void
+     **/
+    void GetTrixelObjects(int catalog_id, int trixel, QList<SkyObject *> &sky_list, CatalogComponent *catalog_pointer,
+                          bool includeCatalogDesignation = true);
 
     /**
      * @brief Get information about the catalog like Prefix etc
@@ -193,6 +239,20 @@ class CatalogDB
     void AddCatalog(const CatalogData &catalog_data);
 
   private:
+    /**
+     * @short Statements used to add entries, prepared once for all rows of an import
+     **/
+    struct InsertQueries
+    {
+        explicit InsertQueries(const QSqlDatabase &db);
+
+        QSqlQuery fuzzy;
+        QSqlQuery dso;
+        QSqlQuery designation;
+        // Used when the entry has no ID number
+        QSqlQuery designationNextID;
+    };
+
     /**
      * @brief Used to add a cross referenced entry into the database
      *
@@ -201,9 +261,34 @@ class CatalogDB
      *
      * @param catalog_entry Data structure with entry details
      * @param catid Category ID in the database
+     * @param queries Statements prepared on the opened DB
      * @return false if adding was unsuccessful
      **/
-    bool _AddEntry(const CatalogEntryData &catalog_entry, int catid);
+    bool _AddEntry(const CatalogEntryData &catalog_entry, int catid, InsertQueries &queries);
+
+    /**
+     * @brief Creates the object of the current row of a query of the object columns
+     *
+     * @param object_names The names of the object are appended
+     * @param trixel Assigned the stored trixel, or -1, see GetAllObjects()
+     * @return SkyObject* the new object, owned by the caller
+     **/
+    SkyObject *CreateObject(const QSqlQuery &query, CatalogComponent *catalog_pointer, bool includeCatalogDesignation,
+                            QList<QPair<int, QString>> &object_names, int &trixel);
+
+    /**
+     * @brief Returns the connection to the database for the current thread
+     *
+     * @return QSqlDatabase skydb_ on the main thread, a clone of it on other threads
+     **/
+    QSqlDatabase threadConnection();
+
+    /**
+     * @brief Fuzzy match of an entry with the prepared query
+     *
+     * @return int UID of the matching row, -1 if none found
+     **/
+    int _FindFuzzyEntry(const double ra, const double dec, const double magnitude, QSqlQuery &fuzzy);
 
     /**
      * @brief Database object for the sky object. Assigned and Initialized by Initialize()
@@ -236,14 +321,30 @@ class CatalogDB
      **/
     bool ParseCatalogInfoToDB(const QStringList &lines, QStringList &columns, QString &catalog_name, char &delimiter);
 
+    /** @short Fields of a row of a custom catalog file, those missing from the header stay 0. */
+    struct CatalogRow
+    {
+        int ID { 0 };
+        KSRecordParser::Text ra;
+        KSRecordParser::Text dec;
+        int type { 0 };
+        KSRecordParser::Text name;
+        float magnitude { 0 };
+        float flux { 0 };
+        float major_axis { 0 };
+        float minor_axis { 0 };
+        float position_angle { 0 };
+    };
+
     /**
-     * @brief Prepares the sequence required by KSParser according to header.
-     * Information on the sequence is stored inside the header
+     * @brief Binds the columns of a custom catalog file to the fields of a row.
+     * Information on the columns is stored inside the header
      *
      * @param Columns List of the columns names as strings
-     * @return QList of the format usable by KSParser
+     * @param row Receives the fields of every row
+     * @return QVector of the format usable by KSRecordParser
      **/
-    QList<QPair<QString, KSParser::DataTypes>> buildParserSequence(const QStringList &Columns);
+    QVector<KSRecordParser::Column> buildParserColumns(const QStringList &Columns, CatalogRow &row);
 
     /**
      * @brief Clears out the DSO table for the given catalog ID
@@ -259,4 +360,12 @@ class CatalogDB
      * @return void
      **/
     void FirstRun();
+
+    /**
+     * @brief Creates the indexes used for fuzzy matches and lookups by catalog and trixel,
+     * if the database does not have them yet
+     *
+     * @return void
+     **/
+    void CreateIndexes();
 };
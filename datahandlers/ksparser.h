@@ -43,6 +43,8 @@
  * In case of failure, the parser returns a Dummy Row. So if you see the
  * string "Null" in the returned QHash, it signifies the parserencountered an
  * unexpected error.
+ *
+ * @sa KSRecordParser, which reads rows into typed fields of the caller without allocating.
  **/
 class KSParser
 {
@@ -0,0 +1,414 @@
+/*  KStars Record Parser
+    Typed parser of CSV and fixed-width text files.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#include "ksrecordparser.h"
+
+#include <QDebug>
+#include <QtAlgorithms>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KSRECORDPARSER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+// Powers of ten which are exact doubles
+const double POWERS_OF_TEN[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+                               };
+const int MAX_EXACT_POWER = 22;
+
+// Digits which fit into the mantissa accumulator
+const int MAX_DIGITS = 19;
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// Returns the first a or b in [p, end), or end. Scans 16 bytes at once where SSE2 is available.
+const char *findEither(const char *p, const char *end, char a, char b)
+{
+#ifdef KSRECORDPARSER_SSE2
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    for (; end - p >= 16; p += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+        if (mask != 0)
+            return p + qCountTrailingZeroBits(quint32(mask));
+    }
+#endif
+    for (; p < end; ++p)
+    {
+        if (*p == a || *p == b)
+            return p;
+    }
+    return end;
+}
+
+const char *nextLine(const char *p, const char *end)
+{
+    const char *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    return eol != nullptr ? eol + 1 : end;
+}
+
+/*
+ * Converts a decimal number without locale or allocation. The first 19 significant digits are
+ * scaled by exact powers of ten, which is within one unit in the last place of the correctly
+ * rounded value, and exact for the digits of the catalogs where long double is wider than double.
+ */
+bool parseDouble(const char *p, const char *end, double &value)
+{
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-'))
+        negative = (*p++ == '-');
+
+    const int length = end - p;
+    if (length == 3 && qstrnicmp(p, "nan", 3) == 0)
+    {
+        value = std::numeric_limits<double>::quiet_NaN();
+        return true;
+    }
+    if ((length == 3 && qstrnicmp(p, "inf", 3) == 0) || (length == 8 && qstrnicmp(p, "infinity", 8) == 0))
+    {
+        value = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+        return true;
+    }
+
+    quint64 mantissa = 0;
+    int digits       = 0;
+    int exponent     = 0;
+    bool any         = false;
+
+    for (; p < end && isDigit(*p); ++p)
+    {
+        any = true;
+        if (digits < MAX_DIGITS)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += (mantissa != 0);
+        }
+        else
+            exponent++;
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && isDigit(*p); ++p)
+        {
+            any = true;
+            if (digits < MAX_DIGITS)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += (mantissa != 0);
+                exponent--;
+            }
+        }
+    }
+    if (!any)
+        return false;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool negativeExponent = false;
+        if (p < end && (*p == '+' || *p == '-'))
+            negativeExponent = (*p++ == '-');
+        if (p == end || !isDigit(*p))
+            return false;
+
+        int explicitExponent = 0;
+        for (; p < end && isDigit(*p); ++p)
+        {
+            // Anything larger under- or overflows anyway
+            if (explicitExponent < 10000)
+                explicitExponent = explicitExponent * 10 + (*p - '0');
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+    if (p != end)
+        return false;
+
+    // The mantissa is exact in a long double where it is wider than a double
+    long double scaled = mantissa;
+    if (mantissa != 0)
+    {
+        for (; exponent > MAX_EXACT_POWER && !std::isinf(scaled); exponent -= MAX_EXACT_POWER)
+            scaled *= POWERS_OF_TEN[MAX_EXACT_POWER];
+        for (; exponent < -MAX_EXACT_POWER && scaled != 0; exponent += MAX_EXACT_POWER)
+            scaled /= POWERS_OF_TEN[MAX_EXACT_POWER];
+        if (exponent >= 0 && exponent <= MAX_EXACT_POWER)
+            scaled *= POWERS_OF_TEN[exponent];
+        else if (exponent < 0 && exponent >= -MAX_EXACT_POWER)
+            scaled /= POWERS_OF_TEN[-exponent];
+    }
+    value = double(scaled);
+    if (negative)
+        value = -value;
+    return true;
+}
+
+bool parseInt(const char *p, const char *end, int &value)
+{
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-'))
+        negative = (*p++ == '-');
+    if (p == end)
+        return false;
+
+    qint64 magnitude = 0;
+    for (; p < end; ++p)
+    {
+        if (!isDigit(*p))
+            return false;
+        magnitude = magnitude * 10 + (*p - '0');
+        if (magnitude > qint64(std::numeric_limits<int>::max()) + 1)
+            return false;
+    }
+    if (!negative && magnitude > std::numeric_limits<int>::max())
+        return false;
+
+    value = int(negative ? -magnitude : magnitude);
+    return true;
+}
+}
+
+KSRecordParser::Text KSRecordParser::Text::trimmed() const
+{
+    const char *begin = data;
+    const char *end   = data + size;
+    while (begin < end && isSpace(*begin))
+        ++begin;
+    while (end > begin && isSpace(end[-1]))
+        --end;
+    return Text(begin, end - begin);
+}
+
+int KSRecordParser::Text::toInt(bool *ok) const
+{
+    const Text text = trimmed();
+    int value       = 0;
+    const bool valid = parseInt(text.data, text.data + text.size, value);
+    if (ok != nullptr)
+        *ok = valid;
+    return valid ? value : 0;
+}
+
+double KSRecordParser::Text::toDouble(bool *ok) const
+{
+    const Text text = trimmed();
+    double value    = 0;
+    const bool valid = parseDouble(text.data, text.data + text.size, value);
+    if (ok != nullptr)
+        *ok = valid;
+    return valid ? value : 0;
+}
+
+KSRecordParser::KSRecordParser(const QString &filename, char comment_char, const QVector<Column> &columns,
+                               char delimiter)
+    : m_Comment(comment_char), m_Delimiter(delimiter), m_Columns(columns), m_Fields(columns.size())
+{
+    Q_ASSERT(delimiter != 0 && delimiter != '\n' && delimiter != '"');
+    open(filename);
+}
+
+KSRecordParser::KSRecordParser(const QString &filename, char comment_char, const QVector<Column> &columns,
+                               const QVector<int> &widths)
+    : m_Comment(comment_char), m_Columns(columns), m_Widths(widths), m_Fields(columns.size())
+{
+    if (columns.size() != widths.size() + 1)
+    {
+        // The last field has no width
+        qWarning() << "Unequal fields and widths, cannot parse" << filename;
+        Q_ASSERT(false);
+        return;
+    }
+
+    for (int width : widths)
+        m_MinLength += width;
+
+    open(filename);
+}
+
+void KSRecordParser::open(const QString &filename)
+{
+    m_File.setFileName(filename);
+    if (!m_File.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Unable to open file: " << filename;
+        return;
+    }
+
+    const qint64 size = m_File.size();
+    const uchar *data = size > 0 ? m_File.map(0, size) : nullptr;
+    if (data != nullptr)
+    {
+        m_Begin = reinterpret_cast<const char *>(data);
+        m_End   = m_Begin + size;
+    }
+    else
+    {
+        m_Buffer = m_File.readAll();
+        m_File.close();
+        m_Begin = m_Buffer.constData();
+        m_End   = m_Begin + m_Buffer.size();
+    }
+    m_Cursor = m_Begin;
+}
+
+bool KSRecordParser::readRow()
+{
+    if (!isOpen())
+        return false;
+
+    while (m_Cursor < m_End)
+    {
+        if (m_Delimiter != 0 ? splitCSVRow() : splitFixedWidthRow())
+        {
+            for (int i = 0; i < m_Columns.size(); i++)
+                store(i, m_Fields[i]);
+            return true;
+        }
+    }
+    return false;
+}
+
+double KSRecordParser::progress() const
+{
+    if (m_Begin == m_End)
+        return 1;
+    return double(m_Cursor - m_Begin) / double(m_End - m_Begin);
+}
+
+bool KSRecordParser::splitCSVRow()
+{
+    const char *p = m_Cursor;
+    if (*p == m_Comment || *p == '\n' || *p == '\r')
+    {
+        m_Cursor = nextLine(p, m_End);
+        return false;
+    }
+
+    // The end of a quoted field
+    auto isFieldEnd = [this](const char *s)
+    {
+        return s == m_End || *s == m_Delimiter || *s == '\n' || (*s == '\r' && (s + 1 == m_End || s[1] == '\n'));
+    };
+
+    const int columns = m_Columns.size();
+    int count         = 0;
+    for (;;)
+    {
+        Text field;
+        const char *stop = nullptr;
+        if (p < m_End && *p == '"')
+        {
+            // Quoted fields end at a quote followed by the delimiter or the end of the line, so
+            // they can hold delimiters and quotes. Without one, the field runs to the end of the line.
+            const char *s = p + 1;
+            for (;;)
+            {
+                s = findEither(s, m_End, '"', '\n');
+                if (s == m_End || *s == '\n' || isFieldEnd(s + 1))
+                    break;
+                ++s;
+            }
+            field = Text(p + 1, s - p - 1);
+            stop  = s;
+            if (s < m_End && *s == '"')
+            {
+                stop = s + 1;
+                if (stop < m_End && *stop == '\r')
+                    ++stop;
+            }
+        }
+        else
+        {
+            stop  = findEither(p, m_End, m_Delimiter, '\n');
+            field = Text(p, stop - p);
+        }
+
+        const bool lastField = (stop == m_End || *stop == '\n');
+        if (lastField && field.size > 0 && field.data[field.size - 1] == '\r')
+            field.size--;
+
+        if (count < columns)
+            m_Fields[count] = field;
+        count++;
+
+        if (lastField)
+        {
+            m_Cursor = (stop == m_End) ? m_End : stop + 1;
+            break;
+        }
+        // Past the delimiter
+        p = stop + 1;
+    }
+
+    return count == columns;
+}
+
+bool KSRecordParser::splitFixedWidthRow()
+{
+    const char *begin = m_Cursor;
+    const char *end   = static_cast<const char *>(std::memchr(begin, '\n', m_End - begin));
+    m_Cursor          = (end != nullptr) ? end + 1 : m_End;
+    if (end == nullptr)
+        end = m_End;
+    if (end > begin && end[-1] == '\r')
+        --end;
+
+    if (begin == end || *begin == m_Comment || end - begin < m_MinLength)
+        return false;
+
+    const char *p = begin;
+    for (int i = 0; i < m_Widths.size(); i++)
+    {
+        m_Fields[i] = Text(p, m_Widths[i]).trimmed();
+        p += m_Widths[i];
+    }
+    m_Fields.last() = Text(p, end - p).trimmed();
+    return true;
+}
+
+void KSRecordParser::store(int column, const Text &text) const
+{
+    const Column &binding = m_Columns[column];
+    switch (binding.m_Type)
+    {
+        case Column::INT:
+            *static_cast<int *>(binding.m_Field) = text.toInt();
+            break;
+        case Column::FLOAT:
+            *static_cast<float *>(binding.m_Field) = text.toFloat();
+            break;
+        case Column::DOUBLE:
+            *static_cast<double *>(binding.m_Field) = text.toDouble();
+            break;
+        case Column::TEXT:
+            *static_cast<Text *>(binding.m_Field) = text;
+            break;
+        case Column::SKIP:
+            break;
+    }
+}
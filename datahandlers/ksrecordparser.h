@@ -0,0 +1,167 @@
+/*  KStars Record Parser
+    Typed parser of CSV and fixed-width text files.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QLatin1String>
+#include <QString>
+#include <QVector>
+
+/**
+ * @class KSRecordParser
+ * @short Reads the rows of a CSV or fixed-width text file into fields of the caller.
+ *
+ * The columns are bound to variables of the caller when the parser is built, and every call of
+ * readRow() converts the next row straight into them, without building a hash of QVariants. The
+ * file is memory-mapped and string columns are returned as Text views into it, so reading a row
+ * does not allocate. Usage:
+ *
+ * @code
+ * KSRecordParser::Text name;
+ * double ra = 0, dec = 0;
+ * KSRecordParser parser(filename, '#', { &name, {}, &ra, &dec });
+ * while (parser.readRow())
+ *     add(name.toString(), ra, dec);
+ * @endcode
+ *
+ * The rows are split like KSParser does: comment lines and rows with a wrong number of fields are
+ * skipped, CSV fields may be quoted to hold delimiters, fixed-width fields are trimmed and the last
+ * one runs to the end of the line. Numbers which cannot be converted, or are empty, are read as 0.
+ */
+class KSRecordParser
+{
+    public:
+        /** @short A field of the current row, valid until the parser is destroyed. */
+        struct Text
+        {
+            Text() = default;
+            Text(const char *data, int size) : data(data), size(size) {}
+
+            const char *data { nullptr };
+            int size { 0 };
+
+            bool isEmpty() const
+            {
+                return size == 0;
+            }
+
+            /** @return the field without leading and trailing whitespace. */
+            Text trimmed() const;
+
+            QLatin1String latin1() const
+            {
+                return QLatin1String(data, size);
+            }
+
+            /** @return the field decoded from UTF-8. */
+            QString toString() const
+            {
+                return QString::fromUtf8(data, size);
+            }
+
+            /** @return the field as a number, or 0 if it is not one. Whitespace around it is ignored. */
+            int toInt(bool *ok = nullptr) const;
+            double toDouble(bool *ok = nullptr) const;
+            float toFloat(bool *ok = nullptr) const
+            {
+                return float(toDouble(ok));
+            }
+        };
+
+        /** @short Binds a column to a variable of the caller, a default Column skips it. */
+        class Column
+        {
+            public:
+                Column() = default;
+                Column(int *field) : m_Type(INT), m_Field(field) {}
+                Column(float *field) : m_Type(FLOAT), m_Field(field) {}
+                Column(double *field) : m_Type(DOUBLE), m_Field(field) {}
+                Column(Text *field) : m_Type(TEXT), m_Field(field) {}
+
+            private:
+                friend class KSRecordParser;
+                enum Type
+                {
+                    SKIP,
+                    INT,
+                    FLOAT,
+                    DOUBLE,
+                    TEXT
+                };
+
+                Type m_Type { SKIP };
+                void *m_Field { nullptr };
+        };
+
+        /**
+         * @brief Parser of a CSV file.
+         * @param filename full path of the file
+         * @param comment_char lines starting with it are skipped
+         * @param columns one binding per field of a row, rows with another number of fields are skipped
+         * @param delimiter separator of the fields
+         */
+        KSRecordParser(const QString &filename, char comment_char, const QVector<Column> &columns,
+                       char delimiter = ',');
+
+        /**
+         * @brief Parser of a fixed-width file.
+         * @param filename full path of the file
+         * @param comment_char lines starting with it are skipped
+         * @param columns one binding per field of a row
+         * @param widths widths of all fields but the last one, which runs to the end of the line. Shorter
+         * lines are skipped.
+         */
+        KSRecordParser(const QString &filename, char comment_char, const QVector<Column> &columns,
+                       const QVector<int> &widths);
+
+        /** @return false if the file cannot be read. */
+        bool isOpen() const
+        {
+            return m_Begin != nullptr;
+        }
+
+        /**
+         * @brief Reads the next row into the bound fields.
+         * @return false when there are no more rows, the fields are then left unchanged.
+         */
+        bool readRow();
+
+        /** @return the fraction of the file which has been read. */
+        double progress() const;
+
+    private:
+        Q_DISABLE_COPY(KSRecordParser)
+
+        void open(const QString &filename);
+        bool splitCSVRow();
+        bool splitFixedWidthRow();
+        void store(int column, const Text &text) const;
+
+        QFile m_File;
+        // Used when the file cannot be mapped
+        QByteArray m_Buffer;
+
+        const char *m_Begin { nullptr };
+        const char *m_Cursor { nullptr };
+        const char *m_End { nullptr };
+
+        char m_Comment { 0 };
+        // 0 for fixed-width files
+        char m_Delimiter { 0 };
+        QVector<Column> m_Columns;
+        QVector<int> m_Widths;
+        int m_MinLength { 0 };
+        // Fields of the current row
+        QVector<Text> m_Fields;
+};
@@ -0,0 +1,171 @@
+/*  KStars Altitude Curves
+    Altitude and azimuth of many targets at evenly spaced times.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#include "altitudecurves.h"
+
+#include "geolocation.h"
+#include "skyobjects/skypoint.h"
+
+#include <QCache>
+#include <QMutex>
+
+#include <algorithm>
+
+namespace
+{
+struct CurveKey
+{
+    double latitude;
+    double longitude;
+    double startJD;
+    double stepHours;
+    int samples;
+    double ra;
+    double dec;
+
+    bool operator==(const CurveKey &other) const
+    {
+        return latitude == other.latitude && longitude == other.longitude && startJD == other.startJD &&
+               stepHours == other.stepHours && samples == other.samples && ra == other.ra && dec == other.dec;
+    }
+};
+
+uint qHash(const CurveKey &key, uint seed = 0)
+{
+    seed = ::qHash(key.latitude, seed) ^ (::qHash(key.longitude, seed) * 31);
+    seed = ::qHash(key.startJD, seed) ^ (::qHash(key.samples, seed) * 31);
+    return ::qHash(key.ra, seed) ^ (::qHash(key.dec, seed) * 31) ^ ::qHash(key.stepHours, seed);
+}
+
+struct Curve
+{
+    std::vector<double> altitudes;
+    std::vector<double> azimuths;
+};
+
+// Cost is the number of samples, this keeps a few thousand curves of a day
+const int CACHE_SAMPLES = 1 << 20;
+
+QMutex &cacheMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QCache<CurveKey, Curve> &curveCache()
+{
+    static QCache<CurveKey, Curve> cache(CACHE_SAMPLES);
+    return cache;
+}
+}
+
+AltitudeCurves::AltitudeCurves(const GeoLocation *geo, const KStarsDateTime &startUT, double stepHours, int samples,
+                               bool useCache)
+    : m_Geo(geo), m_StartJD(startUT.djd()), m_StepHours(stepHours), m_Samples(std::max(samples, 0)), m_UseCache(useCache)
+{
+    // Computed once for all targets
+    m_LST.reserve(m_Samples);
+    for (int i = 0; i < m_Samples; i++)
+        m_LST.push_back(CachingDms(geo->GSTtoLST(startUT.addSecs(i * stepHours * 3600.0).gst())));
+}
+
+void AltitudeCurves::compute(const QVector<const SkyPoint *> &targets)
+{
+    m_Targets = targets.size();
+    m_ComputedTargets = 0;
+    m_Altitudes.assign(m_Targets * m_Samples, 0);
+    m_Azimuths.assign(m_Targets * m_Samples, 0);
+
+    if (m_Samples == 0)
+        return;
+
+    auto keyOf = [this](const SkyPoint * target) -> CurveKey
+    {
+        CurveKey key;
+        key.latitude  = m_Geo->lat()->Degrees();
+        key.longitude = m_Geo->lng()->Degrees();
+        key.startJD   = m_StartJD;
+        key.stepHours = m_StepHours;
+        key.samples   = m_Samples;
+        key.ra        = target->ra().Degrees();
+        key.dec       = target->dec().Degrees();
+        return key;
+    };
+
+    QVector<int> missing;
+    if (!m_UseCache)
+    {
+        for (int i = 0; i < m_Targets; i++)
+            missing.append(i);
+    }
+    else
+    {
+        QMutexLocker locker(&cacheMutex());
+        for (int i = 0; i < m_Targets; i++)
+        {
+            const Curve *curve = curveCache().object(keyOf(targets[i]));
+            if (curve == nullptr)
+            {
+                missing.append(i);
+                continue;
+            }
+
+            std::copy(curve->altitudes.begin(), curve->altitudes.end(), m_Altitudes.begin() + i * m_Samples);
+            std::copy(curve->azimuths.begin(), curve->azimuths.end(), m_Azimuths.begin() + i * m_Samples);
+        }
+    }
+
+    if (missing.isEmpty())
+        return;
+
+    const int count = missing.size();
+    m_ComputedTargets = count;
+    std::vector<double> ra(count), dec(count);
+    for (int j = 0; j < count; j++)
+    {
+        ra[j]  = targets[missing[j]]->ra().radians();
+        dec[j] = targets[missing[j]]->dec().radians();
+    }
+
+    SkyPoint::UnitVectors<double> vectors;
+    SkyPoint::toUnitVectors(ra.data(), dec.data(), count, vectors);
+
+    // One pass over the targets per sample
+    std::vector<double> alt(count), az(count);
+    for (int i = 0; i < m_Samples; i++)
+    {
+        SkyPoint::EquatorialToHorizontal(vectors, m_LST[i], *m_Geo->lat(), alt.data(), az.data());
+        for (int j = 0; j < count; j++)
+        {
+            m_Altitudes[missing[j] * m_Samples + i] = alt[j] / dms::DegToRad;
+            m_Azimuths[missing[j] * m_Samples + i]  = az[j] / dms::DegToRad;
+        }
+    }
+
+    if (!m_UseCache)
+        return;
+
+    QMutexLocker locker(&cacheMutex());
+    for (int j = 0; j < count; j++)
+    {
+        Curve *curve = new Curve;
+        curve->altitudes.assign(altitudes(missing[j]), altitudes(missing[j]) + m_Samples);
+        curve->azimuths.assign(azimuths(missing[j]), azimuths(missing[j]) + m_Samples);
+        curveCache().insert(keyOf(targets[missing[j]]), curve, m_Samples);
+    }
+}
+
+void AltitudeCurves::clearCache()
+{
+    QMutexLocker locker(&cacheMutex());
+    curveCache().clear();
+}
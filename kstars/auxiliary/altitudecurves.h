@@ -0,0 +1,108 @@
+/*  KStars Altitude Curves
+    Altitude and azimuth of many targets at evenly spaced times.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#pragma once
+
+#include "cachingdms.h"
+#include "kstarsdatetime.h"
+
+#include <QVector>
+
+#include <vector>
+
+class GeoLocation;
+class SkyPoint;
+
+/**
+ * @class AltitudeCurves
+ * @short Computes the altitude and azimuth of N targets at M evenly spaced times in one pass.
+ *
+ * The local sidereal time of every sample is computed once and shared by all targets, which are
+ * converted together by the batch SkyPoint::EquatorialToHorizontal(). Targets keep their current RA
+ * and Dec during the whole span, like in the altitude plots of the observation planner.
+ *
+ * Curves are cached by site, times and target coordinates, so redrawing a plot only computes the
+ * targets which were added or whose date or site changed. Searches which sample a span once, like
+ * the scheduler, should not fill the cache.
+ */
+class AltitudeCurves
+{
+    public:
+        /**
+         * @param geo location of the observer
+         * @param startUT universal time of the first sample
+         * @param stepHours hours between samples
+         * @param samples number of samples of every curve
+         * @param useCache whether curves are read from and added to the cache
+         */
+        AltitudeCurves(const GeoLocation *geo, const KStarsDateTime &startUT, double stepHours, int samples,
+                       bool useCache = true);
+
+        int samples() const
+        {
+            return m_Samples;
+        }
+
+        int targets() const
+        {
+            return m_Targets;
+        }
+
+        /** @return the number of targets of the last compute() which were not found in the cache. */
+        int computedTargets() const
+        {
+            return m_ComputedTargets;
+        }
+
+        /** @return the local sidereal time of a sample. */
+        const CachingDms &lst(int sample) const
+        {
+            return m_LST[sample];
+        }
+
+        /** @brief compute Compute the curves of the targets, replacing those of an earlier call. */
+        void compute(const QVector<const SkyPoint *> &targets);
+
+        /** @return samples() altitudes of a target in degrees. */
+        const double *altitudes(int target) const
+        {
+            return m_Altitudes.data() + target * m_Samples;
+        }
+
+        /** @return samples() azimuths of a target in degrees. */
+        const double *azimuths(int target) const
+        {
+            return m_Azimuths.data() + target * m_Samples;
+        }
+
+        double altitude(int target, int sample) const
+        {
+            return m_Altitudes[target * m_Samples + sample];
+        }
+
+        /** Forget all cached curves. */
+        static void clearCache();
+
+    private:
+        const GeoLocation *m_Geo { nullptr };
+        double m_StartJD { 0 };
+        double m_StepHours { 0 };
+        int m_Samples { 0 };
+        int m_Targets { 0 };
+        int m_ComputedTargets { 0 };
+        bool m_UseCache { true };
+
+        std::vector<CachingDms> m_LST;
+        // Row major, one row of samples per target
+        std::vector<double> m_Altitudes;
+        std::vector<double> m_Azimuths;
+};
@@ -0,0 +1,227 @@
+/*  KStars Profiler
+    Scoped timers and counters exported as Chrome trace events.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#include "ksprofiler.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QThread>
+
+#include <algorithm>
+
+#include <kstars_debug.h>
+
+namespace
+{
+QByteArray jsonString(const QString &text)
+{
+    QByteArray result("\"");
+    for (char c : text.toUtf8())
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+            result += c;
+        }
+        else if (c >= 0 && c < 0x20)
+            result += "\\u00" + QByteArray::number(c, 16).rightJustified(2, '0');
+        else
+            result += c;
+    }
+    result += '"';
+    return result;
+}
+}
+
+QAtomicInt KSProfiler::s_Enabled(0);
+quint64 (*KSProfiler::s_AllocationCounter)() = nullptr;
+
+KSProfiler *KSProfiler::Instance()
+{
+    static KSProfiler profiler;
+    return &profiler;
+}
+
+KSProfiler::KSProfiler()
+{
+    m_Clock.start();
+}
+
+void KSProfiler::setEnabled(bool enabled)
+{
+    // Create the clock before the first scope reads it
+    Instance();
+    s_Enabled.store(enabled ? 1 : 0);
+}
+
+void KSProfiler::setAllocationCounter(quint64 (*counter)())
+{
+    s_AllocationCounter = counter;
+}
+
+void KSProfiler::clear()
+{
+    QMutexLocker locker(&m_Mutex);
+    m_Events.clear();
+    m_Statistics.clear();
+    m_DroppedEvents = 0;
+}
+
+void KSProfiler::addEvent(const char *category, const QString &name, qint64 start, qint64 duration,
+                          quint64 allocations)
+{
+    append(EVENT_SCOPE, category, name, start, duration, allocations);
+}
+
+void KSProfiler::counter(const char *category, const QString &name, qint64 value)
+{
+    if (!isEnabled())
+        return;
+
+    append(EVENT_COUNTER, category, name, timestamp(), value, 0);
+}
+
+void KSProfiler::append(EventType type, const char *category, const QString &name, qint64 start, qint64 value,
+                        quint64 allocations)
+{
+    const Qt::HANDLE handle = QThread::currentThreadId();
+
+    QMutexLocker locker(&m_Mutex);
+
+    Statistics &stats = m_Statistics[QLatin1String(category)][name];
+    stats.type = type;
+    stats.count++;
+    stats.last = value;
+    stats.total += value;
+    stats.maximum = std::max(stats.maximum, value);
+    stats.allocations += allocations;
+
+    if (m_Events.size() >= MAX_EVENTS)
+    {
+        m_DroppedEvents++;
+        return;
+    }
+
+    auto thread = m_Threads.find(handle);
+    if (thread == m_Threads.end())
+        thread = m_Threads.insert(handle, m_Threads.size() + 1);
+
+    Event event;
+    event.type = type;
+    event.category = category;
+    event.name = name;
+    event.start = start;
+    event.value = value;
+    event.allocations = allocations;
+    event.thread = thread.value();
+    m_Events.append(event);
+}
+
+bool KSProfiler::writeTrace(const QString &filename) const
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qCWarning(KSTARS) << "Cannot write profiling trace to" << filename << file.errorString();
+        return false;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QMutexLocker locker(&m_Mutex);
+
+    // Written by hand, a QJsonDocument of a million events takes far more memory than the events
+    QByteArray line;
+    file.write("{\"traceEvents\":[\n");
+    for (int i = 0; i < m_Events.size(); i++)
+    {
+        const Event &event = m_Events[i];
+        line.clear();
+        line += "{\"name\":";
+        line += jsonString(event.name);
+        line += ",\"cat\":\"";
+        line += event.category;
+        line += "\",\"pid\":";
+        line += QByteArray::number(pid);
+        line += ",\"tid\":";
+        line += QByteArray::number(event.thread);
+        line += ",\"ts\":";
+        line += QByteArray::number(event.start / 1000.0, 'f', 3);
+        if (event.type == EVENT_SCOPE)
+        {
+            line += ",\"ph\":\"X\",\"dur\":";
+            line += QByteArray::number(event.value / 1000.0, 'f', 3);
+            if (s_AllocationCounter)
+            {
+                line += ",\"args\":{\"allocations\":";
+                line += QByteArray::number(event.allocations);
+                line += '}';
+            }
+            line += '}';
+        }
+        else
+        {
+            line += ",\"ph\":\"C\",\"args\":{\"value\":";
+            line += QByteArray::number(event.value);
+            line += "}}";
+        }
+        if (i + 1 < m_Events.size())
+            line += ',';
+        line += '\n';
+        file.write(line);
+    }
+    file.write("],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":");
+    file.write(QByteArray::number(m_DroppedEvents));
+    file.write("}}\n");
+
+    return file.error() == QFile::NoError;
+}
+
+QJsonObject KSProfiler::statistics() const
+{
+    QMutexLocker locker(&m_Mutex);
+
+    QJsonObject result;
+    for (auto category = m_Statistics.constBegin(); category != m_Statistics.constEnd(); ++category)
+    {
+        QJsonObject entries;
+        for (auto entry = category.value().constBegin(); entry != category.value().constEnd(); ++entry)
+        {
+            const Statistics &stats = entry.value();
+            if (stats.type == EVENT_COUNTER)
+            {
+                entries.insert(entry.key(), QJsonObject
+                {
+                    {"count", static_cast<double>(stats.count)},
+                    {"value", static_cast<double>(stats.last)}
+                });
+            }
+            else
+            {
+                QJsonObject scope
+                {
+                    {"count", static_cast<double>(stats.count)},
+                    {"last", stats.last / 1e6},
+                    {"average", stats.total / 1e6 / stats.count},
+                    {"max", stats.maximum / 1e6}
+                };
+                if (s_AllocationCounter)
+                    scope.insert("allocations", static_cast<double>(stats.allocations) / stats.count);
+                entries.insert(entry.key(), scope);
+            }
+        }
+        result.insert(category.key(), entries);
+    }
+
+    result.insert("droppedEvents", static_cast<double>(m_DroppedEvents));
+    return result;
+}
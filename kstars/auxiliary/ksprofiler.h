@@ -0,0 +1,187 @@
+/*  KStars Profiler
+    Scoped timers and counters exported as Chrome trace events.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/**
+ * @class KSProfiler
+ * @short Collects timing events of startup, sky map drawing and the Ekos pipelines.
+ *
+ * Code is instrumented with KSPROFILE_SCOPE, which records how long the enclosing scope took,
+ * and KSProfiler::counter(). While the profiler is disabled, both cost a single atomic load.
+ *
+ * Recorded events can be written as a Chrome trace (JSON array format), which chrome://tracing
+ * and the Perfetto UI open directly. Running statistics of every scope are kept as well, so
+ * e.g. the time each sky component takes to draw can be queried while KStars runs.
+ *
+ * All functions are thread safe.
+ */
+class KSProfiler
+{
+    public:
+        static KSProfiler *Instance();
+
+        static bool isEnabled()
+        {
+            return s_Enabled.load() != 0;
+        }
+
+        /** Start or stop recording. Events recorded so far are kept. */
+        void setEnabled(bool enabled);
+
+        /** Discard all recorded events and statistics. */
+        void clear();
+
+        /**
+         * @brief setAllocationCounter Record the number of heap allocations of every scope.
+         * @param counter returns the number of allocations so far, or nullptr to stop counting.
+         * KStars does not count its allocations, benchmarks install a counter around malloc.
+         */
+        static void setAllocationCounter(quint64 (*counter)());
+
+        /** @return allocations so far if a counter is installed, otherwise 0. */
+        static quint64 allocations()
+        {
+            return s_AllocationCounter ? s_AllocationCounter() : 0;
+        }
+
+        /** @return nanoseconds since the profiler was created. */
+        qint64 timestamp() const
+        {
+            return m_Clock.nsecsElapsed();
+        }
+
+        /**
+         * @brief addEvent Record a completed scope.
+         * @param category group of the event, e.g. "draw" or "startup".
+         * @param start timestamp() when the scope was entered.
+         * @param duration nanoseconds spent in the scope.
+         * @param allocations heap allocations made in the scope.
+         */
+        void addEvent(const char *category, const QString &name, qint64 start, qint64 duration,
+                      quint64 allocations = 0);
+
+        /** @brief counter Record the current value of a counter, e.g. the number of stars drawn. */
+        void counter(const char *category, const QString &name, qint64 value);
+
+        /**
+         * @brief writeTrace Write the recorded events in the Chrome trace event format.
+         * @return false if the file cannot be written.
+         */
+        bool writeTrace(const QString &filename) const;
+
+        /**
+         * @return per category and name: number of calls and the last, average and maximum time in
+         * milliseconds of scopes, or the last value of counters. Scopes include their average number
+         * of allocations if an allocation counter is installed.
+         */
+        QJsonObject statistics() const;
+
+        // Events beyond this are counted as dropped so a forgotten profiler cannot eat all memory
+        static constexpr int MAX_EVENTS { 1000000 };
+
+    private:
+        KSProfiler();
+
+        typedef enum
+        {
+            EVENT_SCOPE,
+            EVENT_COUNTER
+        } EventType;
+
+        struct Event
+        {
+            EventType type;
+            const char *category;
+            QString name;
+            qint64 start;
+            // Duration of scopes, value of counters
+            qint64 value;
+            quint64 allocations;
+            int thread;
+        };
+
+        struct Statistics
+        {
+            EventType type { EVENT_SCOPE };
+            quint64 count { 0 };
+            qint64 last { 0 };
+            qint64 total { 0 };
+            qint64 maximum { 0 };
+            quint64 allocations { 0 };
+        };
+
+        void append(EventType type, const char *category, const QString &name, qint64 start, qint64 value,
+                    quint64 allocations);
+
+        static QAtomicInt s_Enabled;
+        static quint64 (*s_AllocationCounter)();
+
+        QElapsedTimer m_Clock;
+
+        mutable QMutex m_Mutex;
+        QVector<Event> m_Events;
+        QHash<QString, QHash<QString, Statistics>> m_Statistics;
+        // Small numbers are easier to read in the trace viewers than thread handles
+        QHash<Qt::HANDLE, int> m_Threads;
+        quint64 m_DroppedEvents { 0 };
+};
+
+/**
+ * @class KSProfileScope
+ * @short Records the time between its construction and destruction. Use KSPROFILE_SCOPE.
+ */
+class KSProfileScope
+{
+    public:
+        KSProfileScope(const char *category, const QString &name) : m_Category(category)
+        {
+            if (KSProfiler::isEnabled())
+            {
+                m_Name = name;
+                m_Allocations = KSProfiler::allocations();
+                m_Start = KSProfiler::Instance()->timestamp();
+            }
+        }
+
+        ~KSProfileScope()
+        {
+            if (m_Start >= 0)
+            {
+                KSProfiler *profiler = KSProfiler::Instance();
+                const qint64 duration = profiler->timestamp() - m_Start;
+                profiler->addEvent(m_Category, m_Name, m_Start, duration, KSProfiler::allocations() - m_Allocations);
+            }
+        }
+
+    private:
+        Q_DISABLE_COPY(KSProfileScope)
+
+        const char *m_Category;
+        QString m_Name;
+        qint64 m_Start { -1 };
+        quint64 m_Allocations { 0 };
+};
+
+#define KSPROFILE_CONCAT_(a, b) a##b
+#define KSPROFILE_CONCAT(a, b) KSPROFILE_CONCAT_(a, b)
+
+/** Time the rest of the enclosing scope, e.g. KSPROFILE_SCOPE("draw", QStringLiteral("Stars")); */
+#define KSPROFILE_SCOPE(category, name) KSProfileScope KSPROFILE_CONCAT(ksProfileScope, __LINE__)(category, name)
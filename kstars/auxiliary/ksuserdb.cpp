@@ -191,6 +191,16 @@ bool KSUserDB::Initialize()
             if (!query.exec(columnQuery))
                 qCWarning(KSTARS) << query.lastError();
         }
+
+        // Add master bias and flat frames to the dark library, existing frames are darks (FRAME_DARK)
+        if (currentDBVersion < 307)
+        {
+            QSqlQuery query(m_UserDB);
+            if (!query.exec("ALTER TABLE darkframe ADD COLUMN type INTEGER DEFAULT 2"))
+                qCWarning(KSTARS) << query.lastError();
+            if (!query.exec("ALTER TABLE darkframe ADD COLUMN filter TEXT DEFAULT NULL"))
+                qCWarning(KSTARS) << query.lastError();
+        }
     }
     m_UserDB.close();
     return true;
@@ -326,7 +336,8 @@ bool KSUserDB::RebuildDB()
 
     tables.append("CREATE TABLE IF NOT EXISTS darkframe (id INTEGER DEFAULT NULL PRIMARY KEY AUTOINCREMENT, ccd TEXT "
                   "NOT NULL, chip INTEGER DEFAULT 0, binX INTEGER, binY INTEGER, temperature REAL, duration REAL, "
-                  "filename TEXT NOT NULL, timestamp DATETIME DEFAULT CURRENT_TIMESTAMP)");
+                  "filename TEXT NOT NULL, timestamp DATETIME DEFAULT CURRENT_TIMESTAMP, type INTEGER DEFAULT 2, "
+                  "filter TEXT DEFAULT NULL)");
 
     tables.append("CREATE TABLE IF NOT EXISTS hips (ID TEXT NOT NULL UNIQUE,"
                   "obs_title TEXT NOT NULL, obs_description TEXT NOT NULL, hips_order TEXT NOT NULL,"
@@ -78,6 +78,7 @@ class KSUserDB
          ******************************* Dark Library****************************
          ************************************************************************/
 
+        // Master bias and flat frames are kept with the darks, "type" is the CCDFrameType of a frame
         void AddDarkFrame(const QVariantMap &oneFrame);
         bool DeleteDarkFrame(const QString &filename);
         void GetAllDarkFrames(QList<QVariantMap> &darkFrames);
@@ -379,5 +380,5 @@ class KSUserDB
         /** XML reader for importing old formats **/
         QXmlStreamReader *reader_ { nullptr };
 
-        static const uint16_t SCHEMA_VERSION = 306;
+        static const uint16_t SCHEMA_VERSION = 307;
 };
@@ -16,7 +16,9 @@
 
 #include "skyobjectlistmodel.h"
 
+#include "kstarsdata.h"
 #include "skyobject.h"
+#include "skycomponents/skymapcomposite.h"
 
 SkyObjectListModel::SkyObjectListModel(QObject *parent) : QAbstractListModel(parent)
 {
@@ -55,7 +57,7 @@ QVariant SkyObjectListModel::data(const QModelIndex &index, int role) const
     }
     else if (role == SkyObjectRole)
     {
-        return qVariantFromValue((void *)skyObjects[index.row()].second);
+        return qVariantFromValue((void *)KStarsData::Instance()->skyComposite()->objectOf(skyObjects[index.row()]));
     }
     return QVariant();
 }
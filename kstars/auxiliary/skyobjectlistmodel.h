@@ -24,7 +24,8 @@ class SkyObject;
 /**
  * @class SkyObjectListModel
  * A model used in Find Object Dialog in QML. Each entry is a QString (name of object) and pointer to
- * SkyObject itself
+ * SkyObject itself. The pointer is nullptr for objects which are created on demand, see
+ * SkyMapComposite::objectOf().
  *
  * @short Model that is used in Find Object Dialog
  * @author Artem Fedoskin, Jason Harris
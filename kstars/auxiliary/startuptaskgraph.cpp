@@ -0,0 +1,321 @@
+/*  KStars Startup Task Graph
+    Runs the startup loaders concurrently, ordered by their dependencies.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#include "startuptaskgraph.h"
+
+#include "ksprofiler.h"
+
+#include <QtConcurrent>
+
+#include <kstars_debug.h>
+
+StartupTaskGraph::StartupTaskGraph(QObject *parent) : QObject(parent)
+{
+}
+
+StartupTaskGraph::~StartupTaskGraph()
+{
+    // Worker tasks write into the data of the owner
+    for (auto &task : m_Tasks)
+        task.future.waitForFinished();
+}
+
+void StartupTaskGraph::addTask(const QString &name, const QStringList &dependencies, Affinity affinity,
+                               const std::function<bool()> &task, Priority priority)
+{
+    Q_ASSERT(!m_Started);
+
+    if (m_TaskIndex.contains(name))
+    {
+        qCWarning(KSTARS) << "Startup task" << name << "is already defined.";
+        return;
+    }
+
+    Task newTask;
+    newTask.name = name;
+    newTask.affinity = affinity;
+    newTask.priority = priority;
+    newTask.function = task;
+
+    m_TaskIndex[name] = m_Tasks.size();
+    m_DependencyNames[name] = dependencies;
+    m_Tasks.append(newTask);
+}
+
+bool StartupTaskGraph::resolveDependencies()
+{
+    for (auto &task : m_Tasks)
+    {
+        for (const auto &name : m_DependencyNames.value(task.name))
+        {
+            const int index = m_TaskIndex.value(name, -1);
+            if (index < 0)
+            {
+                qCCritical(KSTARS) << "Startup task" << task.name << "depends on unknown task" << name;
+                m_FailedTask = task.name;
+                return false;
+            }
+
+            // run() would return before the dependency is done
+            if (task.priority == Required && m_Tasks[index].priority == Deferred)
+            {
+                qCCritical(KSTARS) << "Required startup task" << task.name << "depends on deferred task" << name;
+                m_FailedTask = task.name;
+                return false;
+            }
+
+            task.dependencies.append(index);
+        }
+    }
+
+    return true;
+}
+
+bool StartupTaskGraph::run()
+{
+    if (m_Started)
+        return m_FailedTask.isEmpty();
+
+    m_Started = true;
+
+    if (resolveDependencies() == false)
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_Blocking = true;
+    while (true)
+    {
+        schedule(false);
+
+        if (!m_FailedTask.isEmpty())
+        {
+            if (m_Running == 0)
+                break;
+        }
+        else if (requiredFinished())
+            break;
+        else if (m_Running == 0)
+        {
+            // Nothing is running, so the remaining required tasks depend on each other
+            for (const auto &task : m_Tasks)
+            {
+                if (task.priority == Required && task.state == TASK_PENDING)
+                {
+                    qCCritical(KSTARS) << "Startup task" << task.name << "has circular dependencies.";
+                    m_FailedTask = task.name;
+                    break;
+                }
+            }
+            break;
+        }
+
+        // Workers append their result and wake us under the mutex, so no completion is missed
+        QMutexLocker locker(&m_CompletedMutex);
+        if (m_Completed.isEmpty())
+            m_CompletedCondition.wait(&m_CompletedMutex);
+    }
+    m_Blocking = false;
+
+    qCInfo(KSTARS) << "Required startup tasks finished in" << timer.elapsed() << "ms";
+
+    if (!m_FailedTask.isEmpty())
+        return false;
+
+    // Deferred main thread tasks run from the event loop once the user interface is up
+    QMetaObject::invokeMethod(this, "processCompleted", Qt::QueuedConnection);
+    return true;
+}
+
+void StartupTaskGraph::processCompleted()
+{
+    // run() schedules the tasks itself until it returns
+    if (m_Blocking || !m_Started)
+        return;
+
+    schedule(true);
+
+    if (!m_Finished && allFinished())
+    {
+        m_Finished = true;
+        emit finished();
+    }
+}
+
+void StartupTaskGraph::schedule(bool runDeferredMainTasks)
+{
+    // Main thread tasks may process events, which must not start tasks behind our back
+    if (m_Scheduling)
+        return;
+
+    m_Scheduling = true;
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = collectCompleted();
+
+        if (!m_FailedTask.isEmpty())
+            break;
+
+        // Start the workers first so they overlap with the main thread task below
+        for (int i = 0; i < m_Tasks.size(); i++)
+        {
+            Task &task = m_Tasks[i];
+            if (task.affinity != WorkerThread || !isReady(task))
+                continue;
+
+            task.state = TASK_RUNNING;
+            task.timer.start();
+            m_Running++;
+            emit taskStarted(task.name);
+
+            std::function<bool()> function = task.function;
+            const QString name = task.name;
+            task.future = QtConcurrent::run([this, i, function, name]()
+            {
+                bool success = false;
+                {
+                    KSPROFILE_SCOPE("startup", name);
+                    success = function();
+                }
+
+                QMutexLocker locker(&m_CompletedMutex);
+                m_Completed.append(qMakePair(i, success));
+                m_CompletedCondition.wakeAll();
+                QMetaObject::invokeMethod(this, "processCompleted", Qt::QueuedConnection);
+            });
+            changed = true;
+        }
+
+        for (int i = 0; i < m_Tasks.size(); i++)
+        {
+            Task &task = m_Tasks[i];
+            if (task.affinity != MainThread || !isReady(task) ||
+                    (task.priority == Deferred && !runDeferredMainTasks))
+                continue;
+
+            task.state = TASK_RUNNING;
+            task.timer.start();
+            emit taskStarted(task.name);
+            bool success = false;
+            {
+                KSPROFILE_SCOPE("startup", task.name);
+                success = task.function();
+            }
+            complete(i, success);
+            changed = true;
+            // Start the workers that waited for this task before running the next one
+            break;
+        }
+    }
+
+    m_Scheduling = false;
+}
+
+bool StartupTaskGraph::isReady(const Task &task) const
+{
+    if (task.state != TASK_PENDING)
+        return false;
+
+    for (int index : task.dependencies)
+    {
+        if (m_Tasks[index].state != TASK_DONE)
+            return false;
+    }
+
+    return true;
+}
+
+bool StartupTaskGraph::collectCompleted()
+{
+    QList<QPair<int, bool>> completed;
+    {
+        QMutexLocker locker(&m_CompletedMutex);
+        completed.swap(m_Completed);
+    }
+
+    for (const auto &result : completed)
+    {
+        m_Running--;
+        complete(result.first, result.second);
+    }
+
+    return !completed.isEmpty();
+}
+
+void StartupTaskGraph::complete(int index, bool success)
+{
+    Task &task = m_Tasks[index];
+    task.state = success ? TASK_DONE : TASK_FAILED;
+
+    qCDebug(KSTARS) << "Startup task" << task.name << (success ? "finished in" : "failed after")
+                    << task.timer.elapsed() << "ms";
+
+    if (success)
+        return;
+
+    if (task.priority == Required)
+    {
+        qCCritical(KSTARS) << "Required startup task" << task.name << "failed.";
+        if (m_FailedTask.isEmpty())
+            m_FailedTask = task.name;
+    }
+    else
+        qCWarning(KSTARS) << "Deferred startup task" << task.name << "failed.";
+
+    // Skip everything that depends on the failed task
+    bool skipped = true;
+    while (skipped)
+    {
+        skipped = false;
+        for (auto &other : m_Tasks)
+        {
+            if (other.state != TASK_PENDING)
+                continue;
+
+            for (int dependency : other.dependencies)
+            {
+                const State state = m_Tasks[dependency].state;
+                if (state == TASK_FAILED || state == TASK_SKIPPED)
+                {
+                    other.state = TASK_SKIPPED;
+                    skipped = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+bool StartupTaskGraph::requiredFinished() const
+{
+    for (const auto &task : m_Tasks)
+    {
+        if (task.priority == Required && (task.state == TASK_PENDING || task.state == TASK_RUNNING))
+            return false;
+    }
+
+    return true;
+}
+
+bool StartupTaskGraph::allFinished() const
+{
+    for (const auto &task : m_Tasks)
+    {
+        if (task.state == TASK_PENDING || task.state == TASK_RUNNING)
+            return false;
+    }
+
+    return true;
+}
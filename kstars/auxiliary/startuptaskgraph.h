@@ -0,0 +1,144 @@
+/*  KStars Startup Task Graph
+    Runs the startup loaders concurrently, ordered by their dependencies.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <functional>
+
+/**
+ * @class StartupTaskGraph
+ * @short Dependency graph of the loaders that run while KStars starts.
+ *
+ * Each task names the tasks it depends on and is started as soon as all of them succeeded.
+ * Worker tasks run on the global thread pool, so loaders that only read files or private
+ * database connections overlap with each other and with the main thread. Main thread tasks
+ * are for loaders that create QObjects, touch the sky mesh or show dialogs.
+ *
+ * run() blocks without processing events and returns once every required task finished, so
+ * the user interface can come up.
+ * Deferred tasks keep running afterwards, main thread ones from the event loop. A required
+ * task cannot depend on a deferred one.
+ *
+ * If a task fails, the tasks depending on it are skipped. A failed required task stops
+ * the graph and run() returns false.
+ */
+class StartupTaskGraph : public QObject
+{
+        Q_OBJECT
+
+    public:
+        typedef enum
+        {
+            WorkerThread,
+            MainThread
+        } Affinity;
+
+        typedef enum
+        {
+            Required,
+            Deferred
+        } Priority;
+
+        explicit StartupTaskGraph(QObject *parent = nullptr);
+        /** Waits for the worker tasks that are still running. */
+        ~StartupTaskGraph() override;
+
+        /**
+         * @brief addTask Add a task to the graph. Tasks must be added before run().
+         * @param name unique name of the task, used by the dependencies of other tasks.
+         * @param dependencies names of the tasks that must succeed before this one starts.
+         * @param affinity thread the task runs on.
+         * @param task function returning false if the task failed.
+         * @param priority whether run() waits for the task.
+         */
+        void addTask(const QString &name, const QStringList &dependencies, Affinity affinity,
+                     const std::function<bool()> &task, Priority priority = Required);
+
+        /**
+         * @brief run Run the tasks until all required ones finished.
+         * @return false if a required task failed or cannot run because of its dependencies.
+         */
+        bool run();
+
+        /** @return name of the first required task that failed. */
+        const QString &failedTask() const
+        {
+            return m_FailedTask;
+        }
+
+    signals:
+        /** Emitted on the main thread when a task starts, also for worker tasks. */
+        void taskStarted(const QString &name);
+
+        /** Emitted once all tasks, including the deferred ones, are done. */
+        void finished();
+
+    private slots:
+        void processCompleted();
+
+    private:
+        typedef enum
+        {
+            TASK_PENDING,
+            TASK_RUNNING,
+            TASK_DONE,
+            TASK_FAILED,
+            TASK_SKIPPED
+        } State;
+
+        struct Task
+        {
+            QString name;
+            QList<int> dependencies;
+            Affinity affinity { WorkerThread };
+            Priority priority { Required };
+            std::function<bool()> function;
+            State state { TASK_PENDING };
+            QFuture<void> future;
+            QElapsedTimer timer;
+        };
+
+        bool resolveDependencies();
+        // Start ready tasks until nothing changes.
+        void schedule(bool runDeferredMainTasks);
+        bool isReady(const Task &task) const;
+        bool collectCompleted();
+        void complete(int index, bool success);
+        bool requiredFinished() const;
+        bool allFinished() const;
+
+        QVector<Task> m_Tasks;
+        QHash<QString, int> m_TaskIndex;
+        QHash<QString, QStringList> m_DependencyNames;
+
+        // Results of worker tasks, handed over to the main thread
+        QMutex m_CompletedMutex;
+        QWaitCondition m_CompletedCondition;
+        QList<QPair<int, bool>> m_Completed;
+
+        int m_Running { 0 };
+        bool m_Started { false };
+        bool m_Blocking { false };
+        bool m_Scheduling { false };
+        bool m_Finished { false };
+        QString m_FailedTask;
+};
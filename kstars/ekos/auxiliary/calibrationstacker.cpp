@@ -0,0 +1,551 @@
+/*  Ekos Calibration Frame Stacker
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#include "calibrationstacker.h"
+
+#include "ksprofiler.h"
+#include "fitsviewer/fitsdata.h"
+
+#include <QDir>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// Below this many pixels per tile, combining on several threads costs more than it saves.
+const int PARALLEL_COMBINE_PIXELS = 256 * 256;
+
+// Rejection passes of the sigma-clipped mean.
+const int MAX_CLIPPING_ITERATIONS = 5;
+
+template <typename T>
+void convertToFloat(const uint8_t *buffer, uint32_t samples, float *output)
+{
+    const T *input = reinterpret_cast<const T *>(buffer);
+    for (uint32_t i = 0; i < samples; i++)
+        output[i] = static_cast<float>(input[i]);
+}
+
+// Equivalent BITPIX of the FITSData pixel types.
+int dataTypeToBITPIX(uint32_t dataType)
+{
+    switch (dataType)
+    {
+        case TBYTE:
+            return BYTE_IMG;
+        case TSHORT:
+            return SHORT_IMG;
+        case TUSHORT:
+            return USHORT_IMG;
+        case TLONG:
+            return LONG_IMG;
+        case TULONG:
+            return ULONG_IMG;
+        case TLONGLONG:
+            return LONGLONG_IMG;
+        case TDOUBLE:
+            return DOUBLE_IMG;
+        case TFLOAT:
+        default:
+            return FLOAT_IMG;
+    }
+}
+
+// Integer masters must be clamped, cfitsio reports an overflow error otherwise.
+void clampToBITPIX(int bitpix, float *buffer, int count)
+{
+    double low = 0, high = 0;
+    switch (bitpix)
+    {
+        case BYTE_IMG:
+            high = std::numeric_limits<uint8_t>::max();
+            break;
+        case SHORT_IMG:
+            low = std::numeric_limits<int16_t>::min();
+            high = std::numeric_limits<int16_t>::max();
+            break;
+        case USHORT_IMG:
+            high = std::numeric_limits<uint16_t>::max();
+            break;
+        case LONG_IMG:
+            low = std::numeric_limits<int32_t>::min();
+            high = std::numeric_limits<int32_t>::max();
+            break;
+        case ULONG_IMG:
+            high = std::numeric_limits<uint32_t>::max();
+            break;
+        default:
+            return;
+    }
+
+    for (int i = 0; i < count; i++)
+        buffer[i] = static_cast<float>(std::min(high, std::max(low, static_cast<double>(buffer[i]))));
+}
+
+// Acquisition keywords of the first frame that also describe the master.
+struct CopiedKeyword
+{
+    const char *key;
+    int type;
+    const char *comment;
+};
+const CopiedKeyword COPIED_KEYWORDS[] =
+{
+    { "EXPTIME", TDOUBLE, "Total Exposure Time (s)" },
+    { "CCD-TEMP", TDOUBLE, "CCD Temperature (Celsius)" },
+    { "XBINNING", TINT, "Binning factor in width" },
+    { "YBINNING", TINT, "Binning factor in height" },
+    { "GAIN", TDOUBLE, "Gain" },
+    { "OFFSET", TDOUBLE, "Offset" },
+    { "INSTRUME", TSTRING, "CCD Name" },
+    { "FILTER", TSTRING, "Filter" }
+};
+
+QVariantMap readKeywords(const FITSData *data)
+{
+    QVariantMap keywords;
+    for (const CopiedKeyword &keyword : COPIED_KEYWORDS)
+    {
+        QVariant value;
+        if (data->getRecordValue(keyword.key, value) && value.isValid())
+            keywords[keyword.key] = value;
+    }
+    return keywords;
+}
+
+QVariantMap readKeywords(fitsfile *fptr)
+{
+    QVariantMap keywords;
+    for (const CopiedKeyword &keyword : COPIED_KEYWORDS)
+    {
+        int status = 0;
+        if (keyword.type == TSTRING)
+        {
+            char value[FLEN_VALUE] = {0};
+            if (fits_read_key(fptr, TSTRING, keyword.key, value, nullptr, &status) == 0)
+                keywords[keyword.key] = QString::fromLatin1(value);
+        }
+        else
+        {
+            double value = 0;
+            if (fits_read_key(fptr, TDOUBLE, keyword.key, &value, nullptr, &status) == 0)
+                keywords[keyword.key] = value;
+        }
+    }
+    return keywords;
+}
+
+void writeKeywords(fitsfile *fptr, const QVariantMap &keywords, int *status)
+{
+    for (const CopiedKeyword &keyword : COPIED_KEYWORDS)
+    {
+        if (!keywords.contains(keyword.key))
+            continue;
+
+        const QVariant &value = keywords[keyword.key];
+        bool ok = true;
+        if (keyword.type == TSTRING)
+        {
+            QByteArray text = value.toString().toLatin1();
+            fits_update_key(fptr, TSTRING, keyword.key, text.data(), keyword.comment, status);
+        }
+        else if (keyword.type == TINT)
+        {
+            int number = qRound(value.toDouble(&ok));
+            if (ok)
+                fits_update_key(fptr, TINT, keyword.key, &number, keyword.comment, status);
+        }
+        else
+        {
+            double number = value.toDouble(&ok);
+            if (ok)
+                fits_update_key(fptr, TDOUBLE, keyword.key, &number, keyword.comment, status);
+        }
+    }
+}
+
+QString fitsErrorMessage(int status)
+{
+    char message[FLEN_STATUS] = {0};
+    fits_get_errstatus(status, message);
+    return QString::fromLatin1(message);
+}
+}
+
+namespace Ekos
+{
+CalibrationStacker::CalibrationStacker()
+{
+}
+
+bool CalibrationStacker::start(CCDFrameType frameType, Method method, double sigma, qint64 memoryLimit)
+{
+    reset();
+
+    m_FrameType   = frameType;
+    m_Method      = method;
+    m_Sigma       = sigma;
+    m_MemoryLimit = memoryLimit;
+
+    m_Scratch.reset(new QTemporaryFile(QDir::tempPath() + QDir::separator() + "kstars_stack_XXXXXX.raw"));
+    if (!m_Scratch->open())
+    {
+        m_ErrorMessage = m_Scratch->errorString();
+        m_Scratch.reset();
+        return false;
+    }
+
+    return true;
+}
+
+void CalibrationStacker::reset()
+{
+    m_Scratch.reset();
+    m_FrameBuffer.clear();
+    m_Count = 0;
+    m_Width = m_Height = 0;
+    m_Channels = 1;
+    m_BITPIX = 0;
+    m_ReferenceLevel = 0;
+    m_Keywords.clear();
+    m_ErrorMessage.clear();
+}
+
+bool CalibrationStacker::addFrame(const FITSData *data)
+{
+    KSPROFILE_SCOPE("ekos", QStringLiteral("CalibrationStacker::addFrame"));
+
+    const FITSImage::Statistic &stats = data->getStatistics();
+    const uint32_t samples = stats.samples_per_channel * stats.channels;
+    const uint8_t *buffer = data->getImageBuffer();
+
+    m_FrameBuffer.resize(samples);
+
+    switch (stats.dataType)
+    {
+        case TBYTE:
+            convertToFloat<uint8_t>(buffer, samples, m_FrameBuffer.data());
+            break;
+        case TSHORT:
+            convertToFloat<int16_t>(buffer, samples, m_FrameBuffer.data());
+            break;
+        case TUSHORT:
+            convertToFloat<uint16_t>(buffer, samples, m_FrameBuffer.data());
+            break;
+        case TLONG:
+            convertToFloat<int32_t>(buffer, samples, m_FrameBuffer.data());
+            break;
+        case TULONG:
+            convertToFloat<uint32_t>(buffer, samples, m_FrameBuffer.data());
+            break;
+        case TFLOAT:
+            convertToFloat<float>(buffer, samples, m_FrameBuffer.data());
+            break;
+        case TLONGLONG:
+            convertToFloat<int64_t>(buffer, samples, m_FrameBuffer.data());
+            break;
+        case TDOUBLE:
+            convertToFloat<double>(buffer, samples, m_FrameBuffer.data());
+            break;
+        default:
+            m_ErrorMessage = QString("Unsupported pixel type %1").arg(stats.dataType);
+            return false;
+    }
+
+    if (m_Count == 0)
+        m_Keywords = readKeywords(data);
+
+    return appendFrame(stats.width, stats.height, stats.channels, dataTypeToBITPIX(stats.dataType));
+}
+
+bool CalibrationStacker::addFrame(const QString &filename)
+{
+    fitsfile *fptr = nullptr;
+    int status = 0, bitpix = 0, naxis = 0, anynull = 0;
+    long naxes[3] = {1, 1, 1};
+
+    // Use open diskfile as it does not use extended file names
+    if (fits_open_diskfile(&fptr, filename.toLocal8Bit(), READONLY, &status) ||
+            fits_get_img_equivtype(fptr, &bitpix, &status) ||
+            fits_get_img_dim(fptr, &naxis, &status) ||
+            fits_get_img_size(fptr, 3, naxes, &status))
+    {
+        m_ErrorMessage = fitsErrorMessage(status);
+        if (fptr)
+        {
+            status = 0;
+            fits_close_file(fptr, &status);
+        }
+        return false;
+    }
+
+    if (naxis < 2 || naxis > 3)
+    {
+        m_ErrorMessage = QString("Unsupported number of axes %1 in %2").arg(naxis).arg(filename);
+        fits_close_file(fptr, &status);
+        return false;
+    }
+
+    const long samples = naxes[0] * naxes[1] * (naxis == 3 ? naxes[2] : 1);
+    m_FrameBuffer.resize(samples);
+
+    if (fits_read_img(fptr, TFLOAT, 1, samples, nullptr, m_FrameBuffer.data(), &anynull, &status))
+    {
+        m_ErrorMessage = fitsErrorMessage(status);
+        status = 0;
+        fits_close_file(fptr, &status);
+        return false;
+    }
+
+    if (m_Count == 0)
+        m_Keywords = readKeywords(fptr);
+
+    fits_close_file(fptr, &status);
+
+    return appendFrame(naxes[0], naxes[1], naxis == 3 ? naxes[2] : 1, bitpix);
+}
+
+bool CalibrationStacker::appendFrame(uint16_t width, uint16_t height, uint8_t channels, int bitpix)
+{
+    if (!m_Scratch)
+    {
+        m_ErrorMessage = "Stacking was not started";
+        return false;
+    }
+
+    if (m_Count == 0)
+    {
+        m_Width = width;
+        m_Height = height;
+        m_Channels = channels;
+        m_BITPIX = bitpix;
+    }
+    else if (width != m_Width || height != m_Height || channels != m_Channels)
+    {
+        m_ErrorMessage = QString("Frame size %1x%2x%3 does not match %4x%5x%6").arg(width).arg(height).arg(channels)
+                         .arg(m_Width).arg(m_Height).arg(m_Channels);
+        return false;
+    }
+
+    // Flats change level with the sky or panel brightness, so bring them to the level of the first one
+    if (m_FrameType == FRAME_FLAT)
+    {
+        double sum = 0;
+        for (const float value : m_FrameBuffer)
+            sum += value;
+        const double level = sum / m_FrameBuffer.size();
+
+        if (m_Count == 0)
+            m_ReferenceLevel = level;
+        else if (level > 0)
+        {
+            const float scale = static_cast<float>(m_ReferenceLevel / level);
+            for (float &value : m_FrameBuffer)
+                value *= scale;
+        }
+    }
+
+    const qint64 bytes = static_cast<qint64>(m_FrameBuffer.size()) * sizeof(float);
+    if (m_Scratch->write(reinterpret_cast<const char *>(m_FrameBuffer.constData()), bytes) != bytes)
+    {
+        m_ErrorMessage = m_Scratch->errorString();
+        return false;
+    }
+
+    m_Count++;
+    return true;
+}
+
+float CalibrationStacker::combinePixel(QVector<float> &samples) const
+{
+    int n = samples.size();
+
+    if (m_Method == STACK_MEDIAN)
+    {
+        float *middle = samples.data() + n / 2;
+        std::nth_element(samples.data(), middle, samples.data() + n);
+        if (n % 2)
+            return *middle;
+
+        // Average with the largest value of the lower half
+        const float lower = *std::max_element(samples.data(), middle);
+        return (lower + *middle) / 2;
+    }
+
+    // Reject outliers until none are left, keeping at least three samples.
+    // With fewer than three frames nothing is rejected and this is a plain mean.
+    float *values = samples.data();
+    double mean = 0;
+    for (int iteration = 0; ; iteration++)
+    {
+        double sum = 0, squaredSum = 0;
+        for (int i = 0; i < n; i++)
+        {
+            sum += values[i];
+            squaredSum += static_cast<double>(values[i]) * values[i];
+        }
+        // The mean of the samples kept so far, also after the last rejection pass
+        mean = sum / n;
+        if (iteration == MAX_CLIPPING_ITERATIONS)
+            break;
+
+        const double stddev = std::sqrt(std::max(0.0, squaredSum / n - mean * mean));
+        if (stddev <= 0 || n < 3)
+            break;
+
+        const double threshold = m_Sigma * stddev;
+        int kept = 0;
+        for (int i = 0; i < n; i++)
+        {
+            if (std::fabs(values[i] - mean) <= threshold)
+                values[kept++] = values[i];
+        }
+
+        if (kept == n || kept < 3)
+            break;
+        n = kept;
+    }
+
+    return static_cast<float>(mean);
+}
+
+void CalibrationStacker::combineRows(const float *tile, int firstRow, int rows, int tileRows, float *output) const
+{
+    const int frameStride = tileRows * m_Width;
+    QVector<float> samples(m_Count);
+
+    for (int pixel = firstRow * m_Width; pixel < (firstRow + rows) * m_Width; pixel++)
+    {
+        for (int frame = 0; frame < m_Count; frame++)
+            samples[frame] = tile[frame * frameStride + pixel];
+
+        output[pixel] = combinePixel(samples);
+    }
+}
+
+bool CalibrationStacker::finish(const QString &filename)
+{
+    KSPROFILE_SCOPE("ekos", QStringLiteral("CalibrationStacker::finish"));
+
+    if (!m_Scratch || m_Count == 0)
+    {
+        m_ErrorMessage = "No frames to combine";
+        return false;
+    }
+
+    m_FrameBuffer.clear();
+    m_FrameBuffer.squeeze();
+
+    if (!m_Scratch->flush())
+    {
+        m_ErrorMessage = m_Scratch->errorString();
+        return false;
+    }
+
+    // Channel planes follow each other, so the frame is handled as channels * height rows.
+    const int totalRows = m_Height * m_Channels;
+    const qint64 rowBytes = static_cast<qint64>(m_Width) * sizeof(float);
+    const qint64 frameBytes = rowBytes * totalRows;
+    // The tile holds the rows of every frame plus the combined rows
+    const int tileRows = static_cast<int>(std::max<qint64>(1, std::min<qint64>(totalRows,
+                                          m_MemoryLimit / (rowBytes * (m_Count + 1)))));
+
+    QVector<float> tile(tileRows * m_Width * m_Count);
+    QVector<float> combined(tileRows * m_Width);
+
+    fitsfile *fptr = nullptr;
+    int status = 0;
+    long naxes[3] = {m_Width, m_Height, m_Channels};
+
+    if (fits_create_file(&fptr, QString("!%1").arg(filename).toLocal8Bit(), &status) ||
+            fits_create_img(fptr, m_BITPIX, m_Channels == 1 ? 2 : 3, naxes, &status))
+    {
+        m_ErrorMessage = fitsErrorMessage(status);
+        if (fptr)
+        {
+            status = 0;
+            fits_close_file(fptr, &status);
+        }
+        return false;
+    }
+
+    for (int firstRow = 0; firstRow < totalRows; firstRow += tileRows)
+    {
+        const int rows = std::min(tileRows, totalRows - firstRow);
+        const qint64 bytes = rowBytes * rows;
+
+        // Gather the rows of this tile from every frame
+        for (int frame = 0; frame < m_Count; frame++)
+        {
+            char *destination = reinterpret_cast<char *>(tile.data() + frame * tileRows * m_Width);
+            if (!m_Scratch->seek(frame * frameBytes + firstRow * rowBytes) || m_Scratch->read(destination, bytes) != bytes)
+            {
+                m_ErrorMessage = m_Scratch->errorString();
+                fits_close_file(fptr, &status);
+                return false;
+            }
+        }
+
+        const int nThreads = (rows * m_Width >= PARALLEL_COMBINE_PIXELS) ?
+                             qMax(1, std::min(QThread::idealThreadCount(), rows)) : 1;
+        const int tRows = rows / nThreads;
+        QList<QFuture<void>> futures;
+        for (int i = 0; i < nThreads; i++)
+        {
+            const int startRow = i * tRows;
+            const int threadRows = (i == nThreads - 1) ? (rows - startRow) : tRows;
+            if (nThreads == 1)
+                combineRows(tile.constData(), startRow, threadRows, tileRows, combined.data());
+            else
+                futures.append(QtConcurrent::run([ =, &tile, &combined]()
+            {
+                combineRows(tile.constData(), startRow, threadRows, tileRows, combined.data());
+            }));
+        }
+
+        for (auto &oneFuture : futures)
+            oneFuture.waitForFinished();
+
+        clampToBITPIX(m_BITPIX, combined.data(), rows * m_Width);
+
+        if (fits_write_img(fptr, TFLOAT, static_cast<LONGLONG>(firstRow) * m_Width + 1, static_cast<LONGLONG>(rows) * m_Width,
+                           combined.data(), &status))
+        {
+            m_ErrorMessage = fitsErrorMessage(status);
+            status = 0;
+            fits_close_file(fptr, &status);
+            return false;
+        }
+    }
+
+    const char *imageType = (m_FrameType == FRAME_FLAT) ? "Master Flat" : (m_FrameType == FRAME_BIAS) ? "Master Bias" :
+                            "Master Dark";
+    const char *combineType = (m_Method == STACK_MEDIAN) ? "MEDIAN" : "SIGMA_CLIPPED_MEAN";
+    int count = m_Count;
+    fits_update_key(fptr, TSTRING, "IMAGETYP", const_cast<char *>(imageType), "Type of image", &status);
+    fits_update_key(fptr, TINT, "NCOMBINE", &count, "Number of combined frames", &status);
+    fits_update_key(fptr, TSTRING, "COMBTYPE", const_cast<char *>(combineType), "Combination method", &status);
+    writeKeywords(fptr, m_Keywords, &status);
+    fits_close_file(fptr, &status);
+
+    if (status)
+    {
+        m_ErrorMessage = fitsErrorMessage(status);
+        return false;
+    }
+
+    // The scratch file can be many gigabytes, release it right away
+    m_Scratch.reset();
+    return true;
+}
+}
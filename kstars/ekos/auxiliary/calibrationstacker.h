@@ -0,0 +1,123 @@
+/*  Ekos Calibration Frame Stacker
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+ */
+
+#pragma once
+
+#include "indi/indicommon.h"
+
+#include <QString>
+#include <QTemporaryFile>
+#include <QVariantMap>
+#include <QVector>
+
+#include <memory>
+
+class FITSData;
+
+namespace Ekos
+{
+/**
+ * @class CalibrationStacker
+ * @short Combines dark, bias or flat frames into a master calibration frame.
+ *
+ * Frames are ingested one at a time as they arrive. Each frame is converted to floating point
+ * and appended to a scratch file, so only one frame is held in memory while capturing.
+ * When the master is requested, the scratch file is read back in tiles of rows that fit the
+ * memory limit, and every pixel is combined with a sigma-clipped mean or a median before the
+ * tile is written to the output FITS file.
+ *
+ * Flat frames are scaled to the mean level of the first flat before they are combined.
+ * The acquisition keywords of the first frame (exposure, temperature, binning, gain, offset,
+ * camera and filter) are copied into the master.
+ *
+ * The stacker does not depend on the GUI, so all functions may be called from a worker thread.
+ */
+class CalibrationStacker
+{
+    public:
+        typedef enum
+        {
+            STACK_SIGMA_CLIPPED_MEAN,
+            STACK_MEDIAN
+        } Method;
+
+        CalibrationStacker();
+        ~CalibrationStacker() = default;
+
+        /**
+         * @brief start Begin a new master frame, discarding any previously ingested frames.
+         * @param frameType FRAME_DARK, FRAME_BIAS or FRAME_FLAT.
+         * @param method how each pixel is combined.
+         * @param sigma rejection threshold of the sigma-clipped mean, in standard deviations.
+         * @param memoryLimit maximum number of bytes used for one tile while combining.
+         * @return false if the scratch file cannot be created.
+         */
+        bool start(CCDFrameType frameType, Method method = STACK_SIGMA_CLIPPED_MEAN, double sigma = 3,
+                   qint64 memoryLimit = 256 * 1024 * 1024);
+
+        /** @brief addFrame Ingest a loaded frame. The frame must have the size of the first one. */
+        bool addFrame(const FITSData *data);
+
+        /** @brief addFrame Ingest the first image of the FITS file @a filename. */
+        bool addFrame(const QString &filename);
+
+        /**
+         * @brief finish Combine all ingested frames and write the master to @a filename.
+         * The master keeps the pixel type of the first frame. The scratch file is released afterwards.
+         */
+        bool finish(const QString &filename);
+
+        /** @brief reset Discard all ingested frames. */
+        void reset();
+
+        /** @return number of frames ingested since start(). */
+        int count() const
+        {
+            return m_Count;
+        }
+
+        CCDFrameType frameType() const
+        {
+            return m_FrameType;
+        }
+
+        const QString &errorMessage() const
+        {
+            return m_ErrorMessage;
+        }
+
+    private:
+        // Append m_FrameBuffer to the scratch file, checking the geometry against the first frame.
+        bool appendFrame(uint16_t width, uint16_t height, uint8_t channels, int bitpix);
+        // Combine rows [firstRow, firstRow + rows) of the tile into output.
+        void combineRows(const float *tile, int firstRow, int rows, int tileRows, float *output) const;
+        float combinePixel(QVector<float> &samples) const;
+
+        std::unique_ptr<QTemporaryFile> m_Scratch;
+        QVector<float> m_FrameBuffer;
+
+        CCDFrameType m_FrameType { FRAME_DARK };
+        Method m_Method { STACK_SIGMA_CLIPPED_MEAN };
+        double m_Sigma { 3 };
+        qint64 m_MemoryLimit { 256 * 1024 * 1024 };
+
+        int m_Count { 0 };
+        uint16_t m_Width { 0 };
+        uint16_t m_Height { 0 };
+        uint8_t m_Channels { 1 };
+        // FITS BITPIX of the first frame, the master uses the same pixel type.
+        int m_BITPIX { 0 };
+        // Mean level of the first flat, subsequent flats are scaled to it.
+        double m_ReferenceLevel { 0 };
+        // Acquisition keywords of the first frame, written to the master.
+        QVariantMap m_Keywords;
+
+        QString m_ErrorMessage;
+};
+}
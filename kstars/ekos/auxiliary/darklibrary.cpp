@@ -14,10 +14,37 @@
 
 #include "kstars.h"
 #include "kspaths.h"
+#include "ksprofiler.h"
 #include "kstarsdata.h"
 #include "fitsviewer/fitsdata.h"
 #include "fitsviewer/fitsview.h"
 
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+namespace
+{
+// Below this many samples, splitting the subtraction across threads costs more than it saves.
+const uint32_t PARALLEL_SUBTRACT_SAMPLES = 512 * 512;
+
+// Subtract the dark rows from the light rows, clamping at zero.
+// light - min(light, dark) has no branch, so the compiler vectorizes the inner loop.
+template <typename T>
+void subtractRows(T *lightBuffer, T const *darkBuffer, int lightW, int darkW, int rows)
+{
+    for (int i = 0; i < rows; i++)
+    {
+        for (int j = 0; j < lightW; j++)
+            lightBuffer[j] -= std::min(lightBuffer[j], darkBuffer[j]);
+
+        lightBuffer += lightW;
+        darkBuffer += darkW;
+    }
+}
+}
+
 namespace Ekos
 {
 DarkLibrary *DarkLibrary::_DarkLibrary = nullptr;
@@ -48,89 +75,148 @@ DarkLibrary::DarkLibrary(QObject *parent) : QObject(parent)
 
 DarkLibrary::~DarkLibrary()
 {
+    m_StackFuture.waitForFinished();
+    m_MasterFuture.waitForFinished();
 }
 
 void DarkLibrary::refreshFromDB()
 {
     KStarsData::Instance()->userdb()->GetAllDarkFrames(darkFrames);
+    // Dark frames might have been removed from the library
+    darkCache.clear();
+}
+
+QSharedPointer<FITSData> DarkLibrary::findCachedDark(const DarkSettings &settings)
+{
+    for (int i = 0; i < darkCache.size(); i++)
+    {
+        if (matches(darkCache[i].frame, settings))
+        {
+            // Most recently used goes last
+            darkCache.move(i, darkCache.size() - 1);
+            return darkCache.last().data;
+        }
+    }
+
+    return QSharedPointer<FITSData>();
+}
+
+void DarkLibrary::cacheDark(const QVariantMap &frame, const QSharedPointer<FITSData> &data)
+{
+    removeCachedDark(frame["filename"].toString());
+
+    while (darkCache.size() >= MAX_CACHED_DARKS)
+        darkCache.removeFirst();
+
+    DarkCacheEntry entry;
+    entry.frame = frame;
+    entry.data = data;
+    darkCache.append(entry);
+}
+
+void DarkLibrary::removeCachedDark(const QString &filename)
+{
+    for (int i = darkCache.size() - 1; i >= 0; i--)
+    {
+        if (darkCache[i].frame["filename"].toString() == filename)
+            darkCache.removeAt(i);
+    }
+}
+
+DarkLibrary::DarkSettings DarkLibrary::darkSettings(ISD::CCDChip *targetChip, double duration)
+{
+    DarkSettings settings;
+
+    settings.ccd = targetChip->getCCD()->getDeviceName();
+    settings.chip = static_cast<int>(targetChip->getType());
+    targetChip->getBinning(&settings.binX, &settings.binY);
+    settings.cooled = targetChip->getCCD()->hasCooler();
+    if (settings.cooled)
+        targetChip->getCCD()->getTemperature(&settings.temperature);
+    settings.duration = duration;
+
+    return settings;
+}
+
+bool DarkLibrary::matches(const QVariantMap &frame, const DarkSettings &settings)
+{
+    // Master bias and flat frames are in the library too
+    if (frame["type"].toInt() != FRAME_DARK)
+        return false;
+
+    // First check CCD name matches and check if we are on the correct chip
+    if (frame["ccd"].toString() != settings.ccd || frame["chip"].toInt() != settings.chip)
+        return false;
+
+    // Then check if binning is the same
+    if (frame["binX"].toInt() != settings.binX || frame["binY"].toInt() != settings.binY)
+        return false;
+
+    // Then check for temperature
+    // TODO make this configurable value, the threshold
+    if (settings.cooled && fabs(frame["temperature"].toDouble() - settings.temperature) > Options::maxDarkTemperatureDiff())
+        return false;
+
+    // Then check for duration
+    // TODO make this value configurable
+    if (fabs(frame["duration"].toDouble() - settings.duration) > 0.05)
+        return false;
+
+    // Finally check if the duration is acceptable, frames added in this session have no timestamp yet
+    QDateTime frameTime = QDateTime::fromString(frame["timestamp"].toString(), Qt::ISODate);
+    return frameTime.isValid() == false || frameTime.daysTo(QDateTime::currentDateTime()) <= Options::darkLibraryDuration();
 }
 
 bool DarkLibrary::getDarkFrame(ISD::CCDChip *targetChip, double duration, QSharedPointer<FITSData> &darkData)
 {
+    const DarkSettings settings = darkSettings(targetChip, duration);
+
+    // Preview and guide loops ask for the same dark frame over and over, the
+    // decoded frame is reused as long as it still matches the settings.
+    QSharedPointer<FITSData> cachedData = findCachedDark(settings);
+    if (cachedData)
+    {
+        darkData = cachedData;
+        return true;
+    }
+
     for (auto &map : darkFrames)
     {
-        // First check CCD name matches and check if we are on the correct chip
-        if (map["ccd"].toString() == targetChip->getCCD()->getDeviceName() &&
-                map["chip"].toInt() == static_cast<int>(targetChip->getType()))
-        {
-            int binX, binY;
-            targetChip->getBinning(&binX, &binY);
+        if (matches(map, settings) == false)
+            continue;
 
-            // Then check if binning is the same
-            if (map["binX"].toInt() == binX && map["binY"].toInt() == binY)
-            {
-                // Then check for temperature
-                if (targetChip->getCCD()->hasCooler())
-                {
-                    double temperature = 0;
-                    targetChip->getCCD()->getTemperature(&temperature);
-                    // TODO make this configurable value, the threshold
-                    if (fabs(map["temperature"].toDouble() - temperature) > Options::maxDarkTemperatureDiff())
-                        continue;
-                }
-
-                // Then check for duration
-                // TODO make this value configurable
-                if (fabs(map["duration"].toDouble() - duration) > 0.05)
-                    continue;
-
-                // Finally check if the duration is acceptable
-                QDateTime frameTime = QDateTime::fromString(map["timestamp"].toString(), Qt::ISODate);
-                if (frameTime.daysTo(QDateTime::currentDateTime()) > Options::darkLibraryDuration())
-                    continue;
-
-                QString filename = map["filename"].toString();
-
-                if (darkFiles.contains(filename))
-                {
-                    darkData = darkFiles[filename];
-                    return true;
-                }
+        QString filename = map["filename"].toString();
 
-                // Finally we made it, let's put it in the hash
-                if (loadDarkFile(filename))
-                {
-                    darkData = darkFiles[filename];
-                    return true;
-                }
-                else
-                {
-                    // Remove bad dark frame
-                    emit newLog(i18n("Removing bad dark frame file %1", filename));
-                    darkFiles.remove(filename);
-                    QFile::remove(filename);
-                    KStarsData::Instance()->userdb()->DeleteDarkFrame(filename);
-                    return false;
-                }
-            }
+        // Finally we made it, let's put it in the cache
+        if (loadDarkFile(filename, darkData))
+        {
+            cacheDark(map, darkData);
+            return true;
+        }
+        else
+        {
+            // Remove bad dark frame
+            emit newLog(i18n("Removing bad dark frame file %1", filename));
+            removeCachedDark(filename);
+            QFile::remove(filename);
+            KStarsData::Instance()->userdb()->DeleteDarkFrame(filename);
+            return false;
         }
     }
 
     return false;
 }
 
-bool DarkLibrary::loadDarkFile(const QString &filename)
+bool DarkLibrary::loadDarkFile(const QString &filename, QSharedPointer<FITSData> &darkData)
 {
-    QSharedPointer<FITSData> darkData;
     darkData.reset(new FITSData(), &QObject::deleteLater);
 
     bool rc = darkData->loadFromFile(filename);
 
-    if (rc)
-        darkFiles[filename] = darkData;
-    else
+    if (!rc)
     {
         emit newLog(i18n("Failed to load dark frame file %1", filename));
+        darkData.clear();
     }
 
     return rc;
@@ -150,30 +236,50 @@ bool DarkLibrary::saveDarkFile(const QSharedPointer<FITSData> data)
         return false;
     }
 
-    darkFiles[path] = data;
+    addDarkFrame(path, data);
+
+    emit newLog(i18n("Dark frame saved to %1", path));
+
+    return true;
+}
+
+void DarkLibrary::addDarkFrame(const QString &path, const QSharedPointer<FITSData> &data)
+{
+    QVariantMap map = frameInfo(subtractParams.targetChip, subtractParams.duration);
+    map["filename"] = path;
+
+    // Supersedes the cached dark frame of the same settings
+    cacheDark(map, data);
+
+    darkFrames.append(map);
+
+    KStarsData::Instance()->userdb()->AddDarkFrame(map);
+}
 
+QVariantMap DarkLibrary::frameInfo(ISD::CCDChip *targetChip, double duration)
+{
     QVariantMap map;
     int binX, binY;
     double temperature = 0;
 
-    subtractParams.targetChip->getBinning(&binX, &binY);
-    subtractParams.targetChip->getCCD()->getTemperature(&temperature);
+    targetChip->getBinning(&binX, &binY);
+    targetChip->getCCD()->getTemperature(&temperature);
 
-    map["ccd"]         = subtractParams.targetChip->getCCD()->getDeviceName();
-    map["chip"]        = static_cast<int>(subtractParams.targetChip->getType());
+    map["ccd"]         = targetChip->getCCD()->getDeviceName();
+    map["chip"]        = static_cast<int>(targetChip->getType());
     map["binX"]        = binX;
     map["binY"]        = binY;
     map["temperature"] = temperature;
-    map["duration"]    = subtractParams.duration;
-    map["filename"]    = path;
+    map["duration"]    = duration;
+    map["type"]        = static_cast<int>(FRAME_DARK);
 
-    darkFrames.append(map);
-
-    emit newLog(i18n("Dark frame saved to %1", path));
-
-    KStarsData::Instance()->userdb()->AddDarkFrame(map);
+    return map;
+}
 
-    return true;
+CalibrationStacker::Method DarkLibrary::combineMethod()
+{
+    return (Options::calibrationCombineMethod() == CalibrationStacker::STACK_MEDIAN) ? CalibrationStacker::STACK_MEDIAN :
+           CalibrationStacker::STACK_SIGMA_CLIPPED_MEAN;
 }
 
 void DarkLibrary::subtract(const QSharedPointer<FITSData> &darkData, const QSharedPointer<FITSData> &lightData,
@@ -282,39 +388,58 @@ void DarkLibrary::subtract(const QSharedPointer<FITSData> &darkData, const QShar
         return;
     }
 
-    T *lightBuffer = reinterpret_cast<T *>(lightData->getWritableImageBuffer());
+    const FITSImage::Statistic &lightStats = lightData->getStatistics();
+    const FITSImage::Statistic &darkStats  = darkData->getStatistics();
+
     int lightW      = lightData->width();
     int lightH      = lightData->height();
+    int darkW       = darkData->width();
+    int darkH       = darkData->height();
 
-    int darkW      = darkData->width();
-    int darkoffset = offsetX + offsetY * darkW;
-    T const *darkBuffer  = reinterpret_cast<T const*>(darkData->getImageBuffer()) + darkoffset;
-
-    for (int i = 0; i < lightH; i++)
+    // The light frame may be a subframe of the dark frame, but it must fit inside it.
+    if (lightStats.dataType != darkStats.dataType || offsetX + lightW > darkW || offsetY + lightH > darkH)
     {
-        for (int j = 0; j < lightW; j++)
-            lightBuffer[j] = (lightBuffer[j] > darkBuffer[j]) ? (lightBuffer[j] - darkBuffer[j]) : 0;
-
-        lightBuffer += lightW;
-        darkBuffer += darkW;
+        emit newLog(i18n("Dark frame does not match the image size or type, skipping dark subtraction."));
+        emit darkFrameCompleted(false);
+        return;
     }
 
-#if 0
-    int lightOffset = 0;
-    for (int i = 0; i < lightH; i++)
+    KSPROFILE_SCOPE("ekos", QStringLiteral("DarkLibrary::subtract"));
+
+    // Only the region of the dark frame under the light subframe is read.
+    T *lightChannel = reinterpret_cast<T *>(lightData->getWritableImageBuffer());
+    T const *darkChannel = reinterpret_cast<T const*>(darkData->getImageBuffer()) + offsetX + offsetY * darkW;
+    const int channels = std::min(lightStats.channels, darkStats.channels);
+    const int nThreads = (lightStats.samples_per_channel >= PARALLEL_SUBTRACT_SAMPLES) ?
+                         qMax(1, std::min(QThread::idealThreadCount(), lightH)) : 1;
+
+    QList<QFuture<void>> futures;
+    for (int channel = 0; channel < channels; channel++)
     {
-        for (int j = 0; j < lightW; j++)
+        // Split the rows evenly between threads, the last one takes the remainder
+        const int tRows = lightH / nThreads;
+        for (int i = 0; i < nThreads; i++)
         {
-            if (lightBuffer[j + lightOffset] > darkBuffer[j + darkoffset])
-                lightBuffer[j + lightOffset] -= darkBuffer[j + darkoffset];
+            const int startRow = i * tRows;
+            const int rows = (i == nThreads - 1) ? (lightH - startRow) : tRows;
+            T *lightBuffer = lightChannel + startRow * lightW;
+            T const *darkBuffer = darkChannel + startRow * darkW;
+
+            if (nThreads == 1)
+                subtractRows<T>(lightBuffer, darkBuffer, lightW, darkW, rows);
             else
-                lightBuffer[j + lightOffset] = 0;
+                futures.append(QtConcurrent::run([ = ]()
+            {
+                subtractRows<T>(lightBuffer, darkBuffer, lightW, darkW, rows);
+            }));
         }
 
-        lightOffset += lightW;
-        darkoffset += darkW;
+        lightChannel += lightStats.samples_per_channel;
+        darkChannel += darkStats.samples_per_channel;
     }
-#endif
+
+    for (auto &oneFuture : futures)
+        oneFuture.waitForFinished();
 
     lightData->applyFilter(filter);
     if (filter == FITS_NONE)
@@ -483,7 +608,16 @@ void DarkLibrary::captureAndSubtract(ISD::CCDChip *targetChip, const QSharedPoin
 
     connect(targetChip->getCCD(), &ISD::CCD::newImage, this, &DarkLibrary::processImage);
 
-    emit newLog(i18n("Capturing dark frame..."));
+    if (Options::darkLibraryFramesCount() > 1)
+    {
+        // A previous master dark might still be combining
+        m_StackFuture.waitForFinished();
+        m_StackFailed = !m_Stacker.start(FRAME_DARK, combineMethod());
+        m_StackedFrames = 0;
+        emit newLog(i18n("Capturing dark frame 1 of %1...", Options::darkLibraryFramesCount()));
+    }
+    else
+        emit newLog(i18n("Capturing dark frame..."));
 
     targetChip->capture(duration);
 }
@@ -502,11 +636,169 @@ void DarkLibrary::processImage(const QSharedPointer<FITSData> &calibrationData)
 
     emit newLog(i18n("Dark frame received."));
 
+    if (Options::darkLibraryFramesCount() > 1)
+    {
+        stackDarkFrame(calibrationData);
+        return;
+    }
+
     saveDarkFile(calibrationData);
     subtract(calibrationData, subtractParams.targetData, subtractParams.targetChip->getCaptureFilter(),
              subtractParams.offsetX, subtractParams.offsetY);
 }
 
+void DarkLibrary::stackDarkFrame(const QSharedPointer<FITSData> &calibrationData)
+{
+    const int framesCount = static_cast<int>(Options::darkLibraryFramesCount());
+
+    // Writing the frame to the scratch file overlaps with the next exposure
+    QFuture<void> previous = m_StackFuture;
+    m_StackFuture = QtConcurrent::run([this, previous, calibrationData]() mutable
+    {
+        previous.waitForFinished();
+        if (m_StackFailed == false && m_Stacker.addFrame(calibrationData.data()) == false)
+            m_StackFailed = true;
+    });
+
+    if (++m_StackedFrames < framesCount)
+    {
+        connect(subtractParams.targetChip->getCCD(), &ISD::CCD::newImage, this, &DarkLibrary::processImage);
+        emit newLog(i18n("Capturing dark frame %1 of %2...", m_StackedFrames + 1, framesCount));
+        subtractParams.targetChip->capture(subtractParams.duration);
+        return;
+    }
+
+    QString ts = QDateTime::currentDateTime().toString("yyyy-MM-ddThh-mm-ss");
+    QString path = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + "darks/masterdark_" + ts + ".fits";
+
+    emit newLog(i18n("Combining %1 dark frames...", framesCount));
+
+    previous = m_StackFuture;
+    m_StackFuture = QtConcurrent::run([this, previous, path]() mutable
+    {
+        previous.waitForFinished();
+        if (m_StackFailed == false && m_Stacker.finish(path) == false)
+            m_StackFailed = true;
+    });
+
+    QFutureWatcher<void> *watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, path]()
+    {
+        watcher->deleteLater();
+        processMasterDark(path);
+    });
+    watcher->setFuture(m_StackFuture);
+}
+
+void DarkLibrary::processMasterDark(const QString &path)
+{
+    // Ekos was reset while combining
+    if (subtractParams.targetChip == nullptr)
+    {
+        m_Stacker.reset();
+        return;
+    }
+
+    QSharedPointer<FITSData> darkData;
+    if (m_StackFailed || !loadDarkFile(path, darkData))
+    {
+        emit newLog(i18n("Failed to create master dark frame: %1", m_Stacker.errorMessage()));
+        m_Stacker.reset();
+        emit darkFrameCompleted(false);
+        return;
+    }
+
+    m_Stacker.reset();
+    addDarkFrame(path, darkData);
+    emit newLog(i18n("Master dark frame saved to %1", path));
+
+    subtract(darkData, subtractParams.targetData, subtractParams.targetChip->getCaptureFilter(),
+             subtractParams.offsetX, subtractParams.offsetY);
+}
+
+void DarkLibrary::addMasterFrame(ISD::CCDChip *targetChip, CCDFrameType frameType, const QString &filter, double duration,
+                                 const QSharedPointer<FITSData> &data)
+{
+    QVariantMap map = frameInfo(targetChip, duration);
+    map["type"]   = static_cast<int>(frameType);
+    map["filter"] = filter;
+
+    // The temperature drifts a little between frames of the same master
+    bool sameMaster = (m_MasterFrames > 0);
+    for (const QString &key : QStringList() << "ccd" << "chip" << "binX" << "binY" << "duration" << "type" << "filter")
+        sameMaster = sameMaster && (m_MasterInfo.value(key) == map.value(key));
+
+    if (sameMaster == false)
+    {
+        // The frames of an interrupted job are dropped
+        m_MasterFuture.waitForFinished();
+        m_MasterFailed = !m_MasterStacker.start(frameType, combineMethod());
+        m_MasterFrames = 0;
+        m_MasterInfo = map;
+    }
+
+    m_MasterFrames++;
+
+    QFuture<void> previous = m_MasterFuture;
+    m_MasterFuture = QtConcurrent::run([this, previous, data]() mutable
+    {
+        previous.waitForFinished();
+        if (m_MasterFailed == false && m_MasterStacker.addFrame(data.data()) == false)
+            m_MasterFailed = true;
+    });
+}
+
+void DarkLibrary::finishMasterFrame()
+{
+    if (m_MasterFrames == 0)
+        return;
+
+    const bool isFlat = (m_MasterInfo["type"].toInt() == FRAME_FLAT);
+    QString ts = QDateTime::currentDateTime().toString("yyyy-MM-ddThh-mm-ss");
+    QString path = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + "darks/" +
+                   (isFlat ? "masterflat_" : "masterbias_") + ts + ".fits";
+
+    QVariantMap map = m_MasterInfo;
+    map["filename"] = path;
+
+    emit newLog(isFlat ? i18n("Combining %1 flat frames...", m_MasterFrames) :
+                i18n("Combining %1 bias frames...", m_MasterFrames));
+    m_MasterFrames = 0;
+
+    // The error message is taken on the worker, a new master may restart the stacker before the result is handled
+    QFuture<void> previous = m_MasterFuture;
+    QFuture<QString> result = QtConcurrent::run([this, previous, path]() mutable -> QString
+    {
+        previous.waitForFinished();
+        if (m_MasterFailed == false && m_MasterStacker.finish(path))
+            return QString();
+        const QString message = m_MasterStacker.errorMessage();
+        m_MasterStacker.reset();
+        return message.isEmpty() ? QString("Unknown error") : message;
+    });
+    m_MasterFuture = result;
+
+    QFutureWatcher<QString> *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, map, isFlat]()
+    {
+        watcher->deleteLater();
+
+        const QString errorMessage = watcher->result();
+        if (errorMessage.isEmpty() == false)
+        {
+            emit newLog(isFlat ? i18n("Failed to create master flat frame: %1", errorMessage) :
+                        i18n("Failed to create master bias frame: %1", errorMessage));
+            return;
+        }
+
+        darkFrames.append(map);
+        KStarsData::Instance()->userdb()->AddDarkFrame(map);
+        emit newLog(isFlat ? i18n("Master flat frame saved to %1", map["filename"].toString()) :
+                    i18n("Master bias frame saved to %1", map["filename"].toString()));
+    });
+    watcher->setFuture(result);
+}
+
 void DarkLibrary::setRemoteCap(ISD::GDInterface *remoteCap)
 {
     if (m_RemoteCap)
@@ -537,5 +829,7 @@ void DarkLibrary::reset()
     subtractParams.offsetY     = 0;
     subtractParams.targetChip  = nullptr;
     subtractParams.targetData.clear();
+    // Skip the frames still waiting to be stacked
+    m_StackFailed = true;
 }
 }
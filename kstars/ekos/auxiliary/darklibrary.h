@@ -9,11 +9,15 @@
 
 #pragma once
 
+#include "calibrationstacker.h"
 #include "indi/indiccd.h"
 #include "indi/indicap.h"
 
+#include <QFuture>
 #include <QObject>
 
+#include <atomic>
+
 namespace Ekos
 {
 /**
@@ -39,6 +43,15 @@ class DarkLibrary : public QObject
                                 FITSScale filter, uint16_t offsetX, uint16_t offsetY);
         void refreshFromDB();
 
+        /**
+         * @brief addMasterFrame Ingest a bias or flat frame of a capture job into a master frame.
+         * Frames with other settings than the previous ones start a new master.
+         */
+        void addMasterFrame(ISD::CCDChip *targetChip, CCDFrameType frameType, const QString &filter, double duration,
+                            const QSharedPointer<FITSData> &data);
+        /** @brief finishMasterFrame Combine the ingested frames and add the master to the library. */
+        void finishMasterFrame();
+
         void setRemoteCap(ISD::GDInterface *remoteCap);
         void removeDevice(ISD::GDInterface *device);
 
@@ -57,15 +70,53 @@ class DarkLibrary : public QObject
 
         static DarkLibrary *_DarkLibrary;
 
-        bool loadDarkFile(const QString &filename);
+        // Library entry of a frame captured by targetChip with the current settings, without file name.
+        static QVariantMap frameInfo(ISD::CCDChip *targetChip, double duration);
+        static CalibrationStacker::Method combineMethod();
+
+        bool loadDarkFile(const QString &filename, QSharedPointer<FITSData> &darkData);
         bool saveDarkFile(const QSharedPointer<FITSData> data);
+        void addDarkFrame(const QString &path, const QSharedPointer<FITSData> &data);
+
+        // Combine the captured dark frames into a master dark once all of them are ingested.
+        void stackDarkFrame(const QSharedPointer<FITSData> &calibrationData);
+        void processMasterDark(const QString &path);
+
+        // Settings a dark frame must match to be subtracted from a frame of targetChip.
+        struct DarkSettings
+        {
+            QString ccd;
+            int chip { 0 };
+            int binX { 1 };
+            int binY { 1 };
+            bool cooled { false };
+            double temperature { 0 };
+            double duration { 0 };
+        };
+        static DarkSettings darkSettings(ISD::CCDChip *targetChip, double duration);
+        // Whether the library entry frame is a dark frame recent enough for settings.
+        static bool matches(const QVariantMap &frame, const DarkSettings &settings);
+
+        // Decoded dark frames are looked up by settings before the library is searched.
+        QSharedPointer<FITSData> findCachedDark(const DarkSettings &settings);
+        void cacheDark(const QVariantMap &frame, const QSharedPointer<FITSData> &data);
+        void removeCachedDark(const QString &filename);
 
         template <typename T>
         void subtract(const QSharedPointer<FITSData> &darkData, const QSharedPointer<FITSData> &lightData, FITSScale filter,
                       uint16_t offsetX, uint16_t offsetY);
 
         QList<QVariantMap> darkFrames;
-        QHash<QString, QSharedPointer<FITSData>> darkFiles;
+
+        // Decoded dark frames, least recently used first.
+        struct DarkCacheEntry
+        {
+            // Library entry the data was loaded from
+            QVariantMap frame;
+            QSharedPointer<FITSData> data;
+        };
+        QList<DarkCacheEntry> darkCache;
+        static constexpr int MAX_CACHED_DARKS { 4 };
 
         struct
         {
@@ -77,6 +128,20 @@ class DarkLibrary : public QObject
             FITSScale filter;
         } subtractParams;
 
+        // Dark frames are ingested and combined on a worker thread, one after the other.
+        CalibrationStacker m_Stacker;
+        QFuture<void> m_StackFuture;
+        // Set by the worker when a frame cannot be stacked, and by reset() to skip the pending frames.
+        std::atomic_bool m_StackFailed { false };
+        int m_StackedFrames { 0 };
+
+        // Bias and flat frames of capture jobs, combined in the same way as the dark frames.
+        CalibrationStacker m_MasterStacker;
+        QFuture<void> m_MasterFuture;
+        std::atomic_bool m_MasterFailed { false };
+        int m_MasterFrames { 0 };
+        QVariantMap m_MasterInfo;
+
         bool m_TelescopeCovered { false };
         bool m_ConfirmationPending { false };
 
@@ -781,6 +781,7 @@ void Capture::stop(CaptureState targetState)
 
     calibrationStage = CAL_NONE;
     m_State            = targetState;
+    m_NextExposureStarted = false;
 
     // Turn off any calibration light, IF they were turned on by Capture module
     if (currentDustCap && dustCapLightEnabled)
@@ -797,6 +798,7 @@ void Capture::stop(CaptureState targetState)
     if (meridianFlipStage == MF_NONE || meridianFlipStage >= MF_COMPLETED)
         secondsLabel->clear();
     disconnect(currentCCD, &ISD::CCD::newImage, this, &Ekos::Capture::processData);
+    disconnect(currentCCD, &ISD::CCD::newImageDownloaded, this, &Ekos::Capture::processImageDownloaded);
     disconnect(currentCCD, &ISD::CCD::newExposureValue, this,  &Ekos::Capture::setExposureProgress);
     //    disconnect(currentCCD, &ISD::CCD::previewFITSGenerated, this, &Ekos::Capture::setGeneratedPreviewFITS);
     disconnect(currentCCD, &ISD::CCD::ready, this, &Ekos::Capture::ready);
@@ -1682,7 +1684,9 @@ void Capture::processData(const QSharedPointer<FITSData> &data)
         // currentCCD->isLooping driver side looping (without any delays, next capture starts after driver reads data)
         if (data && m_isLooping == false && currentCCD->isLooping() == false)
         {
-            disconnect(currentCCD, &ISD::CCD::newImage, this, &Ekos::Capture::processData);
+            // Keep listening if the next exposure is already running
+            if (m_NextExposureStarted == false)
+                disconnect(currentCCD, &ISD::CCD::newImage, this, &Ekos::Capture::processData);
 
             if (useGuideHead == false && darkSubCheck->isChecked() && activeJob->isPreview())
             {
@@ -1721,6 +1725,61 @@ void Capture::processData(const QSharedPointer<FITSData> &data)
     setCaptureComplete();
 }
 
+void Capture::processImageDownloaded(ISD::CCDChip *chip)
+{
+    if (chip != targetChip || canStartNextExposureEarly() == false)
+        return;
+
+    m_EarlyDownloadTime = downloadTimer.elapsed() / 1000.0;
+    downloadProgressTimer.stop();
+
+    // Saving, statistics and the preview of the downloaded image are completed by processData()
+    // while the camera is already exposing the next frame.
+    qCDebug(KSTARS_EKOS_CAPTURE) << "Image downloaded, starting next exposure while it is being processed.";
+    m_NextExposureStarted = true;
+    captureImage();
+}
+
+bool Capture::canStartNextExposureEarly()
+{
+    if (Options::pipelineCapture() == false || m_NextExposureStarted)
+        return false;
+
+    // Only regular light frame sequences, previews, framing and calibration frames keep their own flow
+    if (activeJob == nullptr || activeJob->isPreview() || activeJob->getFrameType() != FRAME_LIGHT ||
+            m_isLooping || currentCCD->isLooping() || m_State != CAPTURE_CAPTURING)
+        return false;
+
+    // The job must have at least one more frame after the one just downloaded
+    if (activeJob->getCompleted() + 1 >= activeJob->getCount())
+        return false;
+
+    // Something has to happen between both frames
+    if (seqDelay > 0 || activeJob->getScript(SCRIPT_POST_CAPTURE).isEmpty() == false)
+        return false;
+
+    if (suspendGuideOnDownload || guideState == GUIDE_SUSPENDED)
+        return false;
+
+    if (meridianFlipStage != MF_NONE || m_TelescopeCoveredDarkExposure || m_TelescopeCoveredFlatExposure)
+        return false;
+
+    // Dithering or focusing would be due before the next frame (@see checkLightFramePendingTasks())
+    if ((Options::ditherEnabled() || Options::ditherNoGuiding()) && ditherCounter <= 1)
+        return false;
+
+    if (isInSequenceFocus && inSequenceFocusCounter <= 1)
+        return false;
+
+    if (limitRefocusS->isChecked() && getRefocusEveryNTimerElapsedSec() >= limitRefocusN->value() * 60)
+        return false;
+
+    if (isTemperatureDeltaCheckActive && focusTemperatureDelta > limitFocusDeltaTN->value())
+        return false;
+
+    return true;
+}
+
 /**
  * @brief Manage the capture process after a captured image has been successfully downloaded from the camera.
  *
@@ -1737,8 +1796,12 @@ void Capture::processData(const QSharedPointer<FITSData> &data)
  */
 IPState Capture::setCaptureComplete()
 {
-    captureTimeout.stop();
-    m_CaptureTimeoutCounter = 0;
+    // If the next exposure was started early, the capture timeout is already guarding it
+    if (m_NextExposureStarted == false)
+    {
+        captureTimeout.stop();
+        m_CaptureTimeoutCounter = 0;
+    }
 
     downloadProgressTimer.stop();
 
@@ -1752,7 +1815,7 @@ IPState Capture::setCaptureComplete()
         return IPS_OK;
     }
 
-    if (currentCCD->isLooping() == false)
+    if (currentCCD->isLooping() == false && m_NextExposureStarted == false)
     {
         disconnect(currentCCD, &ISD::CCD::newExposureValue, this, &Ekos::Capture::setExposureProgress);
         DarkLibrary::Instance()->disconnect(this);
@@ -1764,7 +1827,8 @@ IPState Capture::setCaptureComplete()
     {
         //This determines the time since the image started downloading
         //Then it gets the estimated time left and displays it in the log.
-        double currentDownloadTime = downloadTimer.elapsed() / 1000.0;
+        // If the next exposure was started early, the download was timed when the image arrived
+        double currentDownloadTime = m_NextExposureStarted ? m_EarlyDownloadTime : downloadTimer.elapsed() / 1000.0;
         downloadTimes << currentDownloadTime;
         QString dLTimeString = QString::number(currentDownloadTime, 'd', 2);
         QString estimatedTimeString = QString::number(getEstimatedDownloadTime(), 'd', 2);
@@ -1772,7 +1836,8 @@ IPState Capture::setCaptureComplete()
     }
 
 
-    secondsLabel->setText(i18n("Complete."));
+    if (m_NextExposureStarted == false)
+        secondsLabel->setText(i18n("Complete."));
     // Do not display notifications for very short captures
     if (activeJob->getExposure() >= 1)
         KSNotification::event(QLatin1String("EkosCaptureImageReceived"), i18n("Captured image received"),
@@ -1800,7 +1865,9 @@ IPState Capture::setCaptureComplete()
     }
 
     // check if pausing has been requested
-    if (checkPausing() == true)
+    // If the next exposure is already running, pausing takes place once it completes
+    const bool pausePlanned = (m_State == CAPTURE_PAUSE_PLANNED);
+    if (m_NextExposureStarted == false && checkPausing() == true)
     {
         pauseFunction = &Capture::setCaptureComplete;
         return IPS_BUSY;
@@ -1812,6 +1879,12 @@ IPState Capture::setCaptureComplete()
         activeJob->setCompleted(activeJob->getCompleted() + 1);
         /* Decrease the counter for in-sequence focusing */
         inSequenceFocusCounter--;
+
+        /* Bias and flat frames of the job are combined into a master for the dark library */
+        if (Options::calibrationMasters() && m_ImageData &&
+                (activeJob->getFrameType() == FRAME_BIAS || activeJob->getFrameType() == FRAME_FLAT))
+            DarkLibrary::Instance()->addMasterFrame(activeJob->getActiveChip(), activeJob->getFrameType(),
+                                                    activeJob->getFilterName(), activeJob->getExposure(), m_ImageData);
     }
 
     /* Decrease the dithering counter */
@@ -1863,6 +1936,15 @@ IPState Capture::setCaptureComplete()
 
     currentImgCountOUT->setText(QString("%L1").arg(activeJob->getCompleted()));
 
+    // The next exposure is already running, there is nothing to resume
+    if (m_NextExposureStarted)
+    {
+        m_NextExposureStarted = false;
+        m_State = pausePlanned ? CAPTURE_PAUSE_PLANNED : CAPTURE_CAPTURING;
+        emit newStatus(m_State);
+        return IPS_OK;
+    }
+
     // Check if we need to execute post capture script first
     const QString postCaptureScript = activeJob->getScript(SCRIPT_POST_CAPTURE);
     if (postCaptureScript.isEmpty() == false)
@@ -1907,6 +1989,13 @@ void Capture::processJobCompletionStage2()
 {
     activeJob->done();
 
+    if (Options::calibrationMasters() && activeJob->isPreview() == false &&
+            (activeJob->getFrameType() == FRAME_BIAS || activeJob->getFrameType() == FRAME_FLAT))
+    {
+        connect(DarkLibrary::Instance(), &DarkLibrary::newLog, this, &Ekos::Capture::appendLogText, Qt::UniqueConnection);
+        DarkLibrary::Instance()->finishMasterFrame();
+    }
+
     if (activeJob->isPreview() == false)
     {
         int index = jobs.indexOf(activeJob);
@@ -2275,6 +2364,7 @@ void Capture::captureImage()
     }
 
     connect(currentCCD, &ISD::CCD::newImage, this, &Ekos::Capture::processData, Qt::UniqueConnection);
+    connect(currentCCD, &ISD::CCD::newImageDownloaded, this, &Ekos::Capture::processImageDownloaded, Qt::UniqueConnection);
     //connect(currentCCD, &ISD::CCD::previewFITSGenerated, this, &Ekos::Capture::setGeneratedPreviewFITS, Qt::UniqueConnection);
 
     if (activeJob->getFrameType() == FRAME_FLAT)
@@ -2509,6 +2599,14 @@ void Capture::setExposureProgress(ISD::CCDChip * tChip, double value, IPState st
 
         appendLogText(i18n("Capture failed. Check INDI Control Panel for details."));
 
+        // The failed image was received while the next exposure was already running,
+        // stop that exposure so that the retry does not overlap with it.
+        if (m_NextExposureStarted)
+        {
+            m_NextExposureStarted = false;
+            targetChip->abortExposure();
+        }
+
         if (retries == 3)
         {
             abort();
@@ -562,6 +562,13 @@ class Capture : public QWidget, public Ui::Capture
              */
         void processData(const QSharedPointer<FITSData> &data);
 
+        /**
+             * @brief processImageDownloaded Start the next exposure of the active job as soon as the
+             * camera delivered the current image, while that image is still being saved and processed.
+             * @param chip chip that delivered the image
+             */
+        void processImageDownloaded(ISD::CCDChip *chip);
+
         /**
              * @brief checkCCD Refreshes the CCD information in the capture module.
              * @param CCDNum The CCD index in the CCD combo box to select as the active CCD.
@@ -768,6 +775,13 @@ class Capture : public QWidget, public Ui::Capture
         // Capture
         IPState setCaptureComplete();
 
+        /**
+         * @brief Check whether the next exposure can start before the current image is processed.
+         * This is the case when the next frame would be captured right away anyway, i.e. no delay,
+         * script, dithering, focusing, meridian flip or guiding resume is due between both frames.
+         */
+        bool canStartNextExposureEarly();
+
         // capture scripts
         void scriptFinished(int exitCode, QProcess::ExitStatus status);
 
@@ -1106,6 +1120,10 @@ class Capture : public QWidget, public Ui::Capture
         QList<double> downloadTimes;
         QElapsedTimer downloadTimer;
         QTimer downloadProgressTimer;
+
+        // True while the next exposure runs and the image downloaded before it is still processed
+        bool m_NextExposureStarted { false };
+        double m_EarlyDownloadTime { 0 };
         void processGuidingFailed();
 };
 }
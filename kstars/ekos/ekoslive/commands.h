@@ -38,6 +38,7 @@ enum COMMANDS
     NEW_POLAR_STATE,
     NEW_DOME_STATE,
     NEW_CAP_STATE,
+    NEW_MEDIA_STATE,
     NEW_PREVIEW_IMAGE,
     NEW_VIDEO_FRAME,
     NEW_ALIGN_FRAME,
@@ -209,6 +210,7 @@ static QMap<COMMANDS, QString> const commands =
     {NEW_POLAR_STATE, "new_polar_state"},
     {NEW_DOME_STATE, "new_dome_state"},
     {NEW_CAP_STATE, "new_cap_state"},
+    {NEW_MEDIA_STATE, "new_media_state"},
     {NEW_PREVIEW_IMAGE, "new_preview_image"},
     {NEW_VIDEO_FRAME, "new_video_frame"},
     {NEW_ALIGN_FRAME, "new_align_frame"},
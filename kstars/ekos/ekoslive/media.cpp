@@ -32,8 +32,11 @@ Media::Media(Ekos::Manager * manager): m_Manager(manager)
     connect(&m_WebSocket, static_cast<void(QWebSocket::*)(QAbstractSocket::SocketError)>(&QWebSocket::error), this,
             &Media::onError);
 
+    connect(&m_WebSocket, &QWebSocket::bytesWritten, this, &Media::processBytesWritten);
+
     connect(this, &Media::newMetadata, this, &Media::uploadMetadata);
     connect(this, &Media::newImage, this, &Media::uploadImage);
+    connect(&m_Encoder, &MediaEncoder::encoded, this, &Media::uploadEncodedImage);
 }
 
 void Media::connectServer()
@@ -90,6 +93,11 @@ void Media::onDisconnected()
 
     m_sendBlobs = true;
 
+    // Frames waiting for the old connection are stale by now
+    m_Encoder.clear();
+    m_PendingBytes = 0;
+    m_Encoder.setCongested(false);
+
     for (const QString &oneFile : temporaryFiles)
         QFile::remove(oneFile);
     temporaryFiles.clear();
@@ -127,6 +135,8 @@ void Media::onTextReceived(const QString &message)
         extension = payload["ext"].toString();
     else if (command == commands[SET_BLOBS])
         m_sendBlobs = msgObj["payload"].toBool();
+    else if (command == commands[GET_STATES])
+        sendResponse(commands[NEW_MEDIA_STATE], encoderStatistics());
 }
 
 void Media::onBinaryReceived(const QByteArray &message)
@@ -166,9 +176,13 @@ void Media::sendPreviewImage(const QSharedPointer<FITSData> &data, const QString
 
     m_UUID = uuid;
 
-    previewImage.reset(new FITSView());
-    previewImage->loadData(data);
-    sendImage();
+    const QString ext = "jpg";
+    const bool lowBandwidth = !m_Options[OPTION_SET_HIGH_BANDWIDTH] || m_UUID[0] == "+";
+
+    // The image is downsampled while it is stretched on the encoder thread
+    m_Encoder.encode(MediaEncoder::STREAM_IMAGE, data.data(), imageMetadata(data.data(), ext),
+                     lowBandwidth ? HB_WIDTH / 2 : HB_WIDTH,
+                     lowBandwidth ? HB_IMAGE_QUALITY / 2 : HB_IMAGE_QUALITY);
 }
 
 void Media::sendPreviewImage(const QString &filename, const QString &uuid)
@@ -176,11 +190,15 @@ void Media::sendPreviewImage(const QString &filename, const QString &uuid)
     if (m_isConnected == false || m_Options[OPTION_SET_IMAGE_TRANSFER] == false || m_sendBlobs == false)
         return;
 
-    m_UUID = uuid;
-
-    previewImage.reset(new FITSView());
-    connect(previewImage.get(), &FITSView::loaded, this, &Media::sendImage);
-    previewImage->loadFile(filename);
+    QSharedPointer<FITSData> data(new FITSData(), &QObject::deleteLater);
+    QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, data, uuid]()
+    {
+        watcher->deleteLater();
+        if (watcher->result())
+            sendPreviewImage(data, uuid);
+    });
+    watcher->setFuture(data->loadFromFile(filename));
 }
 
 void Media::sendPreviewImage(FITSView * view, const QString &uuid)
@@ -193,25 +211,14 @@ void Media::sendPreviewImage(FITSView * view, const QString &uuid)
     upload(view);
 }
 
-void Media::sendImage()
-{
-    QtConcurrent::run(this, &Media::upload, previewImage.get());
-}
-
-void Media::upload(FITSView * view)
+QByteArray Media::imageMetadata(const FITSData * imageData, const QString &ext)
 {
-    QString ext = "jpg";
-    QByteArray jpegData;
-    QBuffer buffer(&jpegData);
-    buffer.open(QIODevice::WriteOnly);
-
     //    QString uuid;
     //    // Only send UUID for non-temporary compressed file or non-tempeorary files
     //    if  ( (imageData->isCompressed() && imageData->compressedFilename().startsWith(QDir::tempPath()) == false) ||
     //            (imageData->isTempFile() == false))
     //        uuid = m_UUID;
 
-    const FITSData * imageData = view->getImageData();
     QString resolution = QString("%1x%2").arg(imageData->width()).arg(imageData->height());
     QString sizeBytes = KFormat().formatByteSize(imageData->size());
     QVariant xbin(1), ybin(1), exposure(0), focal_length(0), gain(0), pixel_size(0), aperture(0);
@@ -241,92 +248,55 @@ void Media::upload(FITSView * view)
         {"ext", ext}
     };
 
-    // First METADATA_PACKET bytes of the binary data is always allocated
-    // to the metadata
-    // the rest to the image data.
+    // The metadata must fit in its packet, long FITS header values give up the optional entries first
     QByteArray meta = QJsonDocument(metadata).toJson(QJsonDocument::Compact);
-    meta = meta.leftJustified(METADATA_PACKET, 0);
-    buffer.write(meta);
-
-    // For low bandwidth images
-    if (!m_Options[OPTION_SET_HIGH_BANDWIDTH] || m_UUID[0] == "+")
-    {
-        QPixmap scaledImage = view->getDisplayPixmap().scaledToWidth(HB_WIDTH / 2, Qt::FastTransformation);
-        scaledImage.save(&buffer, ext.toLatin1().constData(), HB_IMAGE_QUALITY / 2);
-        //ext = "jpg";
-    }
-    // For high bandwidth images
-    else
+    for (const char *key : {"aperture", "focal_length", "gain", "pixel_size", "exposure", "bin", "bpp", "size"})
     {
-        QImage scaledImage = view->getDisplayImage().scaledToWidth(HB_WIDTH, Qt::SmoothTransformation);
-        scaledImage.save(&buffer, ext.toLatin1().constData(), HB_IMAGE_QUALITY);
-        //ext = "png";
+        if (meta.size() <= METADATA_PACKET)
+            break;
+        metadata.remove(key);
+        meta = QJsonDocument(metadata).toJson(QJsonDocument::Compact);
     }
-    buffer.close();
 
-    emit newImage(jpegData);
+    return meta;
+}
+
+void Media::upload(FITSView * view)
+{
+    const FITSData * imageData = view->getImageData();
+    if (!imageData)
+        return;
 
-    //m_WebSocket.sendTextMessage(QJsonDocument(metadata).toJson(QJsonDocument::Compact));
-    //m_WebSocket.sendBinaryMessage(jpegData);
+    QString ext = "jpg";
+    const QByteArray metadata = imageMetadata(imageData, ext);
 
-    if (view == previewImage.get())
-        previewImage.reset();
+    // The view already holds the stretched image, only scaling and encoding are left to the encoder thread
+    // For low bandwidth images
+    if (!m_Options[OPTION_SET_HIGH_BANDWIDTH] || m_UUID[0] == "+")
+        m_Encoder.encode(MediaEncoder::STREAM_IMAGE, view->getDisplayPixmap().toImage(), metadata, HB_WIDTH / 2,
+                         HB_IMAGE_QUALITY / 2, false);
+    // For high bandwidth images
+    else
+        m_Encoder.encode(MediaEncoder::STREAM_IMAGE, view->getDisplayImage(), metadata, HB_WIDTH, HB_IMAGE_QUALITY, true);
 }
 
 void Media::sendUpdatedFrame(FITSView *view)
 {
     QString ext = "jpg";
-    QByteArray jpegData;
-    QBuffer buffer(&jpegData);
-    buffer.open(QIODevice::WriteOnly);
 
     const FITSData * imageData = view->getImageData();
 
     if (!imageData)
         return;
 
-    QString resolution = QString("%1x%2").arg(imageData->width()).arg(imageData->height());
-    QString sizeBytes = KFormat().formatByteSize(imageData->size());
-    QVariant xbin(1), ybin(1), exposure(0), focal_length(0), gain(0), pixel_size(0), aperture(0);
-    imageData->getRecordValue("XBINNING", xbin);
-    imageData->getRecordValue("YBINNING", ybin);
-    imageData->getRecordValue("EXPTIME", exposure);
-    imageData->getRecordValue("GAIN", gain);
-    imageData->getRecordValue("PIXSIZE1", pixel_size);
-    imageData->getRecordValue("FOCALLEN", focal_length);
-    imageData->getRecordValue("APTDIA", aperture);
-
-    // Account for binning
-    const double binned_pixel = pixel_size.toDouble() * xbin.toInt();
-    // Send everything as strings
-    QJsonObject metadata =
-    {
-        {"resolution", resolution},
-        {"size", sizeBytes},
-        {"bin", QString("%1x%2").arg(xbin.toString()).arg(ybin.toString())},
-        {"bpp", QString::number(imageData->bpp())},
-        {"uuid", m_UUID},
-        {"exposure", exposure.toString()},
-        {"focal_length", focal_length.toString()},
-        {"aperture", aperture.toString()},
-        {"gain", gain.toString()},
-        {"pixel_size", QString::number(binned_pixel, 'f', 4)},
-        {"ext", ext}
-    };
-
-    // First METADATA_PACKET bytes of the binary data is always allocated
-    // to the metadata
-    // the rest to the image data.
-    QByteArray meta = QJsonDocument(metadata).toJson(QJsonDocument::Compact);
-    meta = meta.leftJustified(METADATA_PACKET, 0);
-    buffer.write(meta);
+    const QByteArray metadata = imageMetadata(imageData, ext);
 
     // For low bandwidth images
-    QPixmap scaledImage;
+    QPixmap scaledImage = view->getDisplayPixmap();
+    int width = HB_WIDTH / 2;
     // Align images
     if (correctionVector.isNull() == false)
     {
-        scaledImage = view->getDisplayPixmap();
         QPointF center = 0.5 * correctionVector.p1() + 0.5 * correctionVector.p2();
         uint32_t length = qMax(static_cast<uint32_t>(correctionVector.length()), 100u);
         QRect boundingRectable;
@@ -338,16 +308,13 @@ void Media::sendUpdatedFrame(FITSView *view)
         emit newBoundingRect(boundingRectable, scaledImage.size());
 
         scaledImage = scaledImage.copy(boundingRectable);
+        // Cropped region is sent as is
+        width = scaledImage.width();
     }
     else
-    {
-        scaledImage = view->getDisplayPixmap().scaledToWidth(HB_WIDTH / 2, Qt::FastTransformation);
         emit newBoundingRect(QRect(), QSize());
-    }
 
-    scaledImage.save(&buffer, ext.toLatin1().constData(), HB_IMAGE_QUALITY);
-    buffer.close();
-    emit newImage(jpegData);
+    m_Encoder.encode(MediaEncoder::STREAM_IMAGE, scaledImage.toImage(), metadata, width, HB_IMAGE_QUALITY, false);
 }
 
 void Media::sendVideoFrame(const QSharedPointer<QImage> &frame)
@@ -356,13 +323,13 @@ void Media::sendVideoFrame(const QSharedPointer<QImage> &frame)
         return;
 
     int32_t width = m_Options[OPTION_SET_HIGH_BANDWIDTH] ? HB_WIDTH : HB_WIDTH / 2;
-    QByteArray image;
-    QBuffer buffer(&image);
-    buffer.open(QIODevice::WriteOnly);
 
-    QImage videoImage = (frame->width() > width) ? frame->scaledToWidth(width) : *frame;
+    // Size of the frame once scaled by the encoder
+    QSize videoSize = frame->size();
+    if (frame->width() > width)
+        videoSize = QSize(width, qRound(frame->height() * static_cast<double>(width) / frame->width()));
 
-    QString resolution = QString("%1x%2").arg(videoImage.width()).arg(videoImage.height());
+    QString resolution = QString("%1x%2").arg(videoSize.width()).arg(videoSize.height());
 
     // First METADATA_PACKET bytes of the binary data is always allocated
     // to the metadata
@@ -372,18 +339,10 @@ void Media::sendVideoFrame(const QSharedPointer<QImage> &frame)
         {"resolution", resolution},
         {"ext", "jpg"}
     };
-    QByteArray meta = QJsonDocument(metadata).toJson(QJsonDocument::Compact);;
-    meta = meta.leftJustified(METADATA_PACKET, 0);
-    buffer.write(meta);
 
-    QImageWriter writer;
-    writer.setDevice(&buffer);
-    writer.setFormat("JPG");
-    writer.setCompression(6);
-    writer.write(videoImage);
-    buffer.close();
-
-    m_WebSocket.sendBinaryMessage(image);
+    // Frames are dropped by the encoder if it or the connection cannot keep up
+    m_Encoder.encode(MediaEncoder::STREAM_VIDEO, *frame, QJsonDocument(metadata).toJson(QJsonDocument::Compact), width, -1,
+                     false);
 }
 
 void Media::registerCameras()
@@ -415,6 +374,20 @@ void Media::uploadImage(const QByteArray &image)
     m_WebSocket.sendBinaryMessage(image);
 }
 
+void Media::uploadEncodedImage(MediaEncoder::Stream stream, const QByteArray &image)
+{
+    Q_UNUSED(stream)
+
+    m_PendingBytes += m_WebSocket.sendBinaryMessage(image);
+    m_Encoder.setCongested(m_PendingBytes > MAX_PENDING_BYTES);
+}
+
+void Media::processBytesWritten(qint64 bytes)
+{
+    m_PendingBytes = qMax<qint64>(0, m_PendingBytes - bytes);
+    m_Encoder.setCongested(m_PendingBytes > MAX_PENDING_BYTES);
+}
+
 void Media::processNewBLOB(IBLOB *bp)
 {
     Q_UNUSED(bp)
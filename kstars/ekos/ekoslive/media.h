@@ -17,6 +17,7 @@
 
 #include "ekos/ekos.h"
 #include "ekos/manager.h"
+#include "mediaencoder.h"
 
 class FITSView;
 
@@ -44,6 +45,12 @@ class Media : public QObject
 
         void registerCameras();
 
+        /** @return encoded and dropped frames count, and encode latency of the media channel, sent in reply to get_states. */
+        QJsonObject encoderStatistics() const
+        {
+            return m_Encoder.statistics();
+        }
+
         // Ekos Media Message to User
         //void sendPreviewJPEG(const QString &filename, QJsonObject metadata);
         void sendPreviewImage(const QString &filename, const QString &uuid);
@@ -94,17 +101,20 @@ class Media : public QObject
         void onTextReceived(const QString &message);
         void onBinaryReceived(const QByteArray &message);
 
-        // Send image
-        void sendImage();
-
         // Metadata and Image upload
         void uploadMetadata(const QByteArray &metadata);
         void uploadImage(const QByteArray &image);
+        void uploadEncodedImage(MediaEncoder::Stream stream, const QByteArray &image);
+        void processBytesWritten(qint64 bytes);
 
     private:
         void upload(FITSView * view);
+        QByteArray imageMetadata(const FITSData * imageData, const QString &ext);
 
         QWebSocket m_WebSocket;
+        MediaEncoder m_Encoder;
+        // Bytes handed to the websocket but not written to the network yet
+        qint64 m_PendingBytes { 0 };
         QJsonObject m_AuthResponse;
         uint16_t m_ReconnectTries {0};
         Ekos::Manager * m_Manager { nullptr };
@@ -112,7 +122,6 @@ class Media : public QObject
         QString m_UUID;
 
         QMap<int, bool> m_Options;
-        std::unique_ptr<FITSView> previewImage;
 
         QString extension;
         QStringList temporaryFiles;
@@ -138,6 +147,9 @@ class Media : public QObject
         static const uint16_t RECONNECT_MAX_TRIES = 720;
 
         // Binary Metadata Size
-        static const uint16_t METADATA_PACKET = 256;
+        static const uint16_t METADATA_PACKET = MediaEncoder::METADATA_PACKET;
+
+        // Video frames are dropped while more than this is waiting to be sent
+        static const qint64 MAX_PENDING_BYTES = 2 * 1024 * 1024;
 };
 }
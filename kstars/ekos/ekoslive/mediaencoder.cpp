@@ -0,0 +1,243 @@
+/*  Ekos Live Media Encoder
+
+    Copyright (C) 2026 agent <agent@local>
+
+    Encodes images for the media channel
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "mediaencoder.h"
+
+#include "ekos_debug.h"
+#include "ksprofiler.h"
+#include "fitsviewer/fitsdata.h"
+#include "fitsviewer/stretch.h"
+
+#include <QBuffer>
+#include <QImageWriter>
+#include <QtConcurrent>
+
+namespace EkosLive
+{
+
+MediaEncoder::MediaEncoder(QObject *parent) : QObject(parent)
+{
+    // Metadata and a JPEG preview fit in here without reallocating
+    for (auto &channel : m_Channels)
+        channel.buffer.reserve(512 * 1024);
+}
+
+MediaEncoder::~MediaEncoder()
+{
+    // Workers write into the channel buffers
+    for (auto &channel : m_Channels)
+        channel.future.waitForFinished();
+}
+
+void MediaEncoder::encode(Stream stream, const FITSData *data, const QByteArray &metadata, int width, int quality)
+{
+    const FITSImage::Statistic &stats = data->getStatistics();
+    if (data->getImageBuffer() == nullptr || stats.width == 0 || stats.height == 0)
+        return;
+
+    Job job;
+    // The data may be processed or reloaded on the GUI thread while the frame waits or is encoded
+    job.pixels = QByteArray(reinterpret_cast<const char *>(data->getImageBuffer()),
+                            static_cast<int>(stats.samples_per_channel * stats.channels * stats.bytesPerPixel));
+    job.dataWidth = stats.width;
+    job.dataHeight = stats.height;
+    job.dataChannels = stats.channels;
+    job.dataType = static_cast<int>(stats.dataType);
+    job.metadata = metadata;
+    job.width = width;
+    job.quality = quality;
+    submit(stream, job);
+}
+
+void MediaEncoder::encode(Stream stream, const QImage &image, const QByteArray &metadata, int width, int quality,
+                          bool smooth)
+{
+    Job job;
+    job.image = image;
+    job.metadata = metadata;
+    job.width = width;
+    job.quality = quality;
+    job.smooth = smooth;
+    submit(stream, job);
+}
+
+void MediaEncoder::submit(Stream stream, const Job &job)
+{
+    // Receivers read the first METADATA_PACKET bytes as JSON, truncated metadata cannot be parsed
+    if (job.metadata.size() > METADATA_PACKET)
+    {
+        qCWarning(KSTARS_EKOS) << "Ekos Live metadata exceeds" << METADATA_PACKET << "bytes, dropping frame:" << job.metadata;
+        m_Dropped++;
+        return;
+    }
+
+    // No point in encoding video frames that would wait behind the previous ones
+    if (stream == STREAM_VIDEO && m_Congested)
+    {
+        m_Dropped++;
+        return;
+    }
+
+    Channel &channel = m_Channels[stream];
+
+    if (channel.busy)
+    {
+        // Only the latest frame is worth sending
+        if (channel.hasPending)
+        {
+            m_Dropped++;
+            m_Superseded++;
+            qCDebug(KSTARS_EKOS) << "Ekos Live" << stream << "frame superseded by a newer one," << m_Superseded << "so far";
+        }
+        channel.pending = job;
+        channel.pending.timer.start();
+        channel.hasPending = true;
+        return;
+    }
+
+    Job newJob = job;
+    newJob.timer.start();
+    start(stream, newJob);
+}
+
+void MediaEncoder::start(Stream stream, const Job &job)
+{
+    Channel &channel = m_Channels[stream];
+    channel.busy = true;
+
+    QByteArray *buffer = &channel.buffer;
+    QImage *stretchImage = &channel.stretchImage;
+    channel.future = QtConcurrent::run([job, buffer, stretchImage]()
+    {
+        return run(job, *buffer, *stretchImage);
+    });
+
+    QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, stream, job]()
+    {
+        watcher->deleteLater();
+        finish(stream, job, watcher->result());
+    });
+    watcher->setFuture(channel.future);
+}
+
+void MediaEncoder::finish(Stream stream, const Job &job, bool success)
+{
+    Channel &channel = m_Channels[stream];
+    channel.busy = false;
+
+    if (success)
+    {
+        m_LastLatency = job.timer.nsecsElapsed() / 1e6;
+        m_TotalLatency += m_LastLatency;
+        m_MaximumLatency = std::max(m_MaximumLatency, m_LastLatency);
+        m_Encoded++;
+
+        // Receivers send the payload right away, so the buffer is not shared by the next frame
+        emit encoded(stream, channel.buffer);
+    }
+
+    if (channel.hasPending)
+    {
+        channel.hasPending = false;
+        Job next = channel.pending;
+        channel.pending = Job();
+        start(stream, next);
+    }
+}
+
+void MediaEncoder::clear()
+{
+    for (auto &channel : m_Channels)
+    {
+        if (channel.hasPending)
+            m_Dropped++;
+        channel.hasPending = false;
+        channel.pending = Job();
+    }
+}
+
+QJsonObject MediaEncoder::statistics() const
+{
+    QJsonObject stats =
+    {
+        {"encoded", static_cast<int>(m_Encoded)},
+        {"dropped", static_cast<int>(m_Dropped)},
+        {"superseded", static_cast<int>(m_Superseded)},
+        {"latency", m_LastLatency},
+        {"latency_avg", m_Encoded > 0 ? m_TotalLatency / m_Encoded : 0.0},
+        {"latency_max", m_MaximumLatency}
+    };
+
+    return stats;
+}
+
+bool MediaEncoder::run(const Job &job, QByteArray &buffer, QImage &stretchImage)
+{
+    KSPROFILE_SCOPE("ekos", QStringLiteral("MediaEncoder::encode"));
+
+    QImage scaledImage;
+
+    if (job.pixels.isEmpty() == false)
+    {
+        const uint8_t *pixels = reinterpret_cast<const uint8_t *>(job.pixels.constData());
+
+        // Stretch only every n-th pixel in both directions instead of scaling the stretched image
+        const int width = std::max(1, job.width);
+        const int sampling = std::max(1, (job.dataWidth + width - 1) / width);
+        const int w = (job.dataWidth + sampling - 1) / sampling;
+        const int h = (job.dataHeight + sampling - 1) / sampling;
+
+        if (stretchImage.width() != w || stretchImage.height() != h ||
+                (job.dataChannels == 1) != (stretchImage.format() == QImage::Format_Indexed8))
+        {
+            if (job.dataChannels == 1)
+            {
+                stretchImage = QImage(w, h, QImage::Format_Indexed8);
+                stretchImage.setColorCount(256);
+                for (int i = 0; i < 256; i++)
+                    stretchImage.setColor(i, qRgb(i, i, i));
+            }
+            else
+                stretchImage = QImage(w, h, QImage::Format_RGB32);
+        }
+
+        Stretch stretch(job.dataWidth, job.dataHeight, job.dataChannels, job.dataType);
+        stretch.setParams(stretch.computeParams(pixels));
+        stretch.run(pixels, &stretchImage, sampling);
+        scaledImage = stretchImage;
+    }
+    else if (job.image.isNull())
+        return false;
+    else if (job.image.width() > job.width)
+        scaledImage = job.image.scaledToWidth(job.width, job.smooth ? Qt::SmoothTransformation : Qt::FastTransformation);
+    else
+        scaledImage = job.image;
+
+    // Keeps the reserved capacity
+    buffer.resize(0);
+    QBuffer device(&buffer);
+    device.open(QIODevice::WriteOnly);
+
+    // First METADATA_PACKET bytes of the binary data is always allocated
+    // to the metadata
+    // the rest to the image data.
+    device.write(job.metadata.leftJustified(METADATA_PACKET, 0));
+
+    QImageWriter writer(&device, "JPG");
+    writer.setQuality(job.quality);
+    const bool rc = writer.write(scaledImage);
+    device.close();
+
+    return rc;
+}
+}
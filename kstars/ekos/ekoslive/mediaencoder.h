@@ -0,0 +1,137 @@
+/*  Ekos Live Media Encoder
+
+    Copyright (C) 2026 agent <agent@local>
+
+    Encodes images for the media channel
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QImage>
+#include <QJsonObject>
+#include <QObject>
+
+class FITSData;
+
+namespace EkosLive
+{
+/**
+ * @class MediaEncoder
+ * @short Bounded JPEG encoding pipeline for the Ekos Live media channel.
+ *
+ * Each stream encodes at most one frame at a time on a worker thread and keeps at most one
+ * frame waiting. A new frame replaces the waiting one, so under load the remote client gets
+ * the latest frame instead of a backlog. While the connection is congested, video frames are
+ * dropped before they are encoded.
+ *
+ * FITS images are downsampled while they are stretched, so the stretch only touches the pixels
+ * that are sent. The worker stretches a copy of the pixels taken when the frame is submitted, as
+ * the FITSData may be modified on the GUI thread in the meantime. The encode buffers of each stream
+ * are reused from one frame to the next.
+ *
+ * Encoded payloads start with the metadata padded to METADATA_PACKET bytes, followed by the JPEG data.
+ * Frames whose metadata does not fit in METADATA_PACKET bytes are rejected.
+ */
+class MediaEncoder : public QObject
+{
+        Q_OBJECT
+
+    public:
+        enum Stream
+        {
+            STREAM_IMAGE,
+            STREAM_VIDEO,
+            STREAM_COUNT
+        };
+        Q_ENUM(Stream)
+
+        explicit MediaEncoder(QObject *parent = nullptr);
+        ~MediaEncoder() override;
+
+        /**
+         * @brief encode Stretch and encode a FITS image.
+         * @param data image data, its pixels are copied before this returns.
+         * @param metadata JSON metadata sent ahead of the image.
+         * @param width maximum width of the encoded image.
+         * @param quality JPEG quality 0 to 100.
+         */
+        void encode(Stream stream, const FITSData *data, const QByteArray &metadata, int width, int quality);
+
+        /**
+         * @brief encode Scale and encode an image that is already rendered.
+         * @param smooth use smooth instead of fast scaling.
+         */
+        void encode(Stream stream, const QImage &image, const QByteArray &metadata, int width, int quality, bool smooth);
+
+        /** @brief setCongested Drop video frames while the connection cannot keep up. */
+        void setCongested(bool congested)
+        {
+            m_Congested = congested;
+        }
+
+        /** @brief clear Discard the waiting frames, e.g. after the connection dropped. */
+        void clear();
+
+        /**
+         * @return number of encoded frames, dropped frames, and encode latency in milliseconds.
+         * Frames replaced by a newer frame while waiting are counted as dropped and as superseded.
+         */
+        QJsonObject statistics() const;
+
+        // Binary Metadata Size
+        static const uint16_t METADATA_PACKET = 256;
+
+    signals:
+        void encoded(MediaEncoder::Stream stream, const QByteArray &payload);
+
+    private:
+        struct Job
+        {
+            // Snapshot of the FITS pixels, empty for rendered images
+            QByteArray pixels;
+            int dataWidth { 0 };
+            int dataHeight { 0 };
+            int dataChannels { 1 };
+            int dataType { 0 };
+            QImage image;
+            QByteArray metadata;
+            int width { 0 };
+            int quality { 0 };
+            bool smooth { false };
+            QElapsedTimer timer;
+        };
+
+        struct Channel
+        {
+            bool busy { false };
+            bool hasPending { false };
+            Job pending;
+            QFuture<bool> future;
+            // Reused across frames, only touched by the worker while busy
+            QByteArray buffer;
+            QImage stretchImage;
+        };
+
+        void submit(Stream stream, const Job &job);
+        void start(Stream stream, const Job &job);
+        void finish(Stream stream, const Job &job, bool success);
+        static bool run(const Job &job, QByteArray &buffer, QImage &stretchImage);
+
+        Channel m_Channels[STREAM_COUNT];
+        bool m_Congested { false };
+
+        uint32_t m_Encoded { 0 };
+        uint32_t m_Dropped { 0 };
+        uint32_t m_Superseded { 0 };
+        double m_TotalLatency { 0 };
+        double m_MaximumLatency { 0 };
+        double m_LastLatency { 0 };
+};
+}
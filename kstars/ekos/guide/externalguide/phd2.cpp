@@ -40,30 +40,30 @@ PHD2::PHD2()
 
     //This list of available PHD Events is on https://github.com/OpenPHDGuiding/phd2/wiki/EventMonitoring
 
-    events["Version"]                 = Version;
-    events["LockPositionSet"]         = LockPositionSet;
-    events["Calibrating"]             = Calibrating;
-    events["CalibrationComplete"]     = CalibrationComplete;
-    events["StarSelected"]            = StarSelected;
-    events["StartGuiding"]            = StartGuiding;
-    events["Paused"]                  = Paused;
-    events["StartCalibration"]        = StartCalibration;
-    events["AppState"]                = AppState;
-    events["CalibrationFailed"]       = CalibrationFailed;
-    events["CalibrationDataFlipped"]  = CalibrationDataFlipped;
-    events["LoopingExposures"]        = LoopingExposures;
-    events["LoopingExposuresStopped"] = LoopingExposuresStopped;
-    events["SettleBegin"]             = SettleBegin;
-    events["Settling"]                = Settling;
-    events["SettleDone"]              = SettleDone;
-    events["StarLost"]                = StarLost;
-    events["GuidingStopped"]          = GuidingStopped;
-    events["Resumed"]                 = Resumed;
-    events["GuideStep"]               = GuideStep;
-    events["GuidingDithered"]         = GuidingDithered;
-    events["LockPositionLost"]        = LockPositionLost;
-    events["Alert"]                   = Alert;
-    events["GuideParamChange"]        = GuideParamChange;
+    decoder.registerEvent("Version",                  Version);
+    decoder.registerEvent("LockPositionSet",          LockPositionSet);
+    decoder.registerEvent("Calibrating",              Calibrating);
+    decoder.registerEvent("CalibrationComplete",      CalibrationComplete);
+    decoder.registerEvent("StarSelected",             StarSelected);
+    decoder.registerEvent("StartGuiding",             StartGuiding);
+    decoder.registerEvent("Paused",                   Paused);
+    decoder.registerEvent("StartCalibration",         StartCalibration);
+    decoder.registerEvent("AppState",                 AppState);
+    decoder.registerEvent("CalibrationFailed",        CalibrationFailed);
+    decoder.registerEvent("CalibrationDataFlipped",   CalibrationDataFlipped);
+    decoder.registerEvent("LoopingExposures",         LoopingExposures);
+    decoder.registerEvent("LoopingExposuresStopped",  LoopingExposuresStopped);
+    decoder.registerEvent("SettleBegin",              SettleBegin);
+    decoder.registerEvent("Settling",                 Settling);
+    decoder.registerEvent("SettleDone",               SettleDone);
+    decoder.registerEvent("StarLost",                 StarLost);
+    decoder.registerEvent("GuidingStopped",           GuidingStopped);
+    decoder.registerEvent("Resumed",                  Resumed);
+    decoder.registerEvent("GuideStep",                GuideStep);
+    decoder.registerEvent("GuidingDithered",          GuidingDithered);
+    decoder.registerEvent("LockPositionLost",         LockPositionLost);
+    decoder.registerEvent("Alert",                    Alert);
+    decoder.registerEvent("GuideParamChange",         GuideParamChange);
 
     //This list of available PHD Methods is on https://github.com/OpenPHDGuiding/phd2/wiki/EventMonitoring
     //Only some of the methods are implemented.  The ones that say COMMAND_RECEIVED simply return a 0 saying the command was received.
@@ -204,6 +204,9 @@ void PHD2::ResetConnectionState()
     isSettling = false;
     isDitherActive = false;
 
+    // drop any partial message left over from the previous connection
+    decoder.clear();
+
     ditherTimer->stop();
     abortTimer->stop();
 
@@ -264,11 +267,33 @@ void PHD2::displayError(QAbstractSocket::SocketError socketError)
 
 void PHD2::readPHD2()
 {
-    while (!tcpSocket->atEnd() && tcpSocket->canReadLine())
+    decoder.append(tcpSocket);
+
+    // Lines are views into the decoder buffer, they are valid until the next append
+    QByteArray line;
+    while (decoder.nextLine(line))
     {
-        QByteArray line = tcpSocket->readLine();
-        if (line.isEmpty())
+        QLatin1String eventName;
+        if (PHD2EventDecoder::messageType(line, eventName) == PHD2EventDecoder::MESSAGE_EVENT)
+        {
+            const int eventType = decoder.eventId(eventName);
+            if (eventType < 0)
+            {
+                emit newLog(i18n("Unknown PHD2 event: %1", QString(eventName)));
+                continue;
+            }
+
+            processPHD2Event(static_cast<PHD2Event>(eventType), line);
             continue;
+        }
+
+        // Star images come with every guide frame and are several kilobytes, read them straight from the line too
+        if (pendingRpcResultType == STAR_IMAGE && PHD2EventDecoder::hasValue(line, "result") &&
+                !PHD2EventDecoder::hasValue(line, "error"))
+        {
+            processStarImageResult(line);
+            continue;
+        }
 
         QJsonParseError qjsonError;
 
@@ -283,29 +308,28 @@ void PHD2::readPHD2()
 
         QJsonObject jsonObj = jdoc.object();
 
-        if (jsonObj.contains("Event"))
-            processPHD2Event(jsonObj, line);
-        else if (jsonObj.contains("error"))
+        if (jsonObj.contains("error"))
             processPHD2Error(jsonObj, line);
         else if (jsonObj.contains("result"))
             processPHD2Result(jsonObj, line);
     }
 }
 
-void PHD2::processPHD2Event(const QJsonObject &jsonEvent, const QByteArray &line)
+void PHD2::processPHD2Event(PHD2Event eventType, const QByteArray &line)
 {
     if (Options::verboseLogging())
         qCDebug(KSTARS_EKOS_GUIDE) << "PHD2: event:" << line;
 
-    QString eventName = jsonEvent["Event"].toString();
+    event = eventType;
 
-    if (!events.contains(eventName))
+    // GuideStep arrives every frame and only carries scalars, read them straight from the line
+    if (event == GuideStep)
     {
-        emit newLog(i18n("Unknown PHD2 event: %1", eventName));
+        processGuideStep(line);
         return;
     }
 
-    event = events.value(eventName);
+    QJsonObject jsonEvent = QJsonDocument::fromJson(line).object();
 
     switch (event)
     {
@@ -435,79 +459,8 @@ void PHD2::processPHD2Event(const QJsonObject &jsonEvent, const QByteArray &line
             break;
 
         case GuideStep:
-        {
-            // If we lost the guide star, let the state timer update our state
-            // Sometimes PHD2 is actually not guiding at that time, so we'll either resume or abort
-            if (state == LOSTLOCK)
-                emit newLog(i18n("PHD2: Star found, guiding is resuming..."));
-
-            if (isDitherActive)
-                return;
-
-            double diff_ra_pixels, diff_de_pixels, diff_ra_arcsecs, diff_de_arcsecs, pulse_ra, pulse_dec, snr;
-            QString RADirection, DECDirection;
-            diff_ra_pixels = jsonEvent["RADistanceRaw"].toDouble();
-            diff_de_pixels = jsonEvent["DECDistanceRaw"].toDouble();
-            pulse_ra = jsonEvent["RADuration"].toDouble();
-            pulse_dec = jsonEvent["DECDuration"].toDouble();
-            RADirection = jsonEvent["RADirection"].toString();
-            DECDirection = jsonEvent["DECDirection"].toString();
-            snr = jsonEvent["SNR"].toDouble();
-
-            if (RADirection == "East")
-                pulse_ra = -pulse_ra;  //West Direction is Positive, East is Negative
-            if (DECDirection == "South")
-                pulse_dec = -pulse_dec; //South Direction is Negative, North is Positive
-
-            //If the pixelScale is properly set from PHD2, the second block of code is not needed, but if not, we will attempt to calculate the ra and dec error without it.
-            if (pixelScale != 0)
-            {
-                diff_ra_arcsecs = diff_ra_pixels * pixelScale;
-                diff_de_arcsecs = diff_de_pixels * pixelScale;
-            }
-            else
-            {
-                diff_ra_arcsecs = 206.26480624709 * diff_ra_pixels * ccdPixelSizeX / mountFocalLength;
-                diff_de_arcsecs = 206.26480624709 * diff_de_pixels * ccdPixelSizeY / mountFocalLength;
-            }
-
-            if (std::isfinite(snr))
-                emit newSNR(snr);
-
-            if (std::isfinite(diff_ra_arcsecs) && std::isfinite(diff_de_arcsecs))
-            {
-                errorLog.append(QPointF(diff_ra_arcsecs, diff_de_arcsecs));
-                if(errorLog.size() > 50)
-                    errorLog.remove(0);
-
-                emit newAxisDelta(diff_ra_arcsecs, diff_de_arcsecs);
-                emit newAxisPulse(pulse_ra, pulse_dec);
-
-                // Does PHD2 real a sky background or num-stars measure?
-                emit guideStats(diff_ra_arcsecs, diff_de_arcsecs, pulse_ra, pulse_dec,
-                                std::isfinite(snr) ? snr : 0, 0, 0);
-
-                double total_sqr_RA_error = 0.0;
-                double total_sqr_DE_error = 0.0;
-
-                for (auto &point : errorLog)
-                {
-                    total_sqr_RA_error += point.x() * point.x();
-                    total_sqr_DE_error += point.y() * point.y();
-                }
-
-                emit newAxisSigma(sqrt(total_sqr_RA_error / errorLog.size()), sqrt(total_sqr_DE_error / errorLog.size()));
-
-            }
-            //Note that if it is receiving full size remote images, it should not get the guide star image.
-            //But if it is not getting the full size images, or if the current camera is not in Ekos, it should get the guide star image
-            //If we are getting the full size image, we will want to know the lock position for the image that loads in the viewer.
-            if ( Options::guideSubframeEnabled() || currentCameraIsNotInEkos )
-                requestStarImage(32); //This requests a star image for the guide view.  32 x 32 pixels
-            else
-                requestLockPosition();
-        }
-        break;
+            // Handled by processGuideStep()
+            break;
 
         case GuidingDithered:
             break;
@@ -538,6 +491,81 @@ void PHD2::processPHD2Event(const QJsonObject &jsonEvent, const QByteArray &line
     }
 }
 
+void PHD2::processGuideStep(const QByteArray &line)
+{
+    // If we lost the guide star, let the state timer update our state
+    // Sometimes PHD2 is actually not guiding at that time, so we'll either resume or abort
+    if (state == LOSTLOCK)
+        emit newLog(i18n("PHD2: Star found, guiding is resuming..."));
+
+    if (isDitherActive)
+        return;
+
+    double diff_ra_pixels, diff_de_pixels, diff_ra_arcsecs, diff_de_arcsecs, pulse_ra, pulse_dec, snr;
+    diff_ra_pixels = PHD2EventDecoder::doubleValue(line, "RADistanceRaw");
+    diff_de_pixels = PHD2EventDecoder::doubleValue(line, "DECDistanceRaw");
+    pulse_ra = PHD2EventDecoder::doubleValue(line, "RADuration");
+    pulse_dec = PHD2EventDecoder::doubleValue(line, "DECDuration");
+    snr = PHD2EventDecoder::doubleValue(line, "SNR");
+
+    // Directions are compared in place, no QString is built for them
+    const QLatin1String RADirection = PHD2EventDecoder::stringValue(line, "RADirection");
+    const QLatin1String DECDirection = PHD2EventDecoder::stringValue(line, "DECDirection");
+
+    if (RADirection == QLatin1String("East"))
+        pulse_ra = -pulse_ra;  //West Direction is Positive, East is Negative
+    if (DECDirection == QLatin1String("South"))
+        pulse_dec = -pulse_dec; //South Direction is Negative, North is Positive
+
+    //If the pixelScale is properly set from PHD2, the second block of code is not needed, but if not, we will attempt to calculate the ra and dec error without it.
+    if (pixelScale != 0)
+    {
+        diff_ra_arcsecs = diff_ra_pixels * pixelScale;
+        diff_de_arcsecs = diff_de_pixels * pixelScale;
+    }
+    else
+    {
+        diff_ra_arcsecs = 206.26480624709 * diff_ra_pixels * ccdPixelSizeX / mountFocalLength;
+        diff_de_arcsecs = 206.26480624709 * diff_de_pixels * ccdPixelSizeY / mountFocalLength;
+    }
+
+    if (std::isfinite(snr))
+        emit newSNR(snr);
+
+    if (std::isfinite(diff_ra_arcsecs) && std::isfinite(diff_de_arcsecs))
+    {
+        errorLog.append(QPointF(diff_ra_arcsecs, diff_de_arcsecs));
+        if(errorLog.size() > 50)
+            errorLog.remove(0);
+
+        emit newAxisDelta(diff_ra_arcsecs, diff_de_arcsecs);
+        emit newAxisPulse(pulse_ra, pulse_dec);
+
+        // Does PHD2 real a sky background or num-stars measure?
+        emit guideStats(diff_ra_arcsecs, diff_de_arcsecs, pulse_ra, pulse_dec,
+                        std::isfinite(snr) ? snr : 0, 0, 0);
+
+        double total_sqr_RA_error = 0.0;
+        double total_sqr_DE_error = 0.0;
+
+        for (auto &point : errorLog)
+        {
+            total_sqr_RA_error += point.x() * point.x();
+            total_sqr_DE_error += point.y() * point.y();
+        }
+
+        emit newAxisSigma(sqrt(total_sqr_RA_error / errorLog.size()), sqrt(total_sqr_DE_error / errorLog.size()));
+
+    }
+    //Note that if it is receiving full size remote images, it should not get the guide star image.
+    //But if it is not getting the full size images, or if the current camera is not in Ekos, it should get the guide star image
+    //If we are getting the full size image, we will want to know the lock position for the image that loads in the viewer.
+    if ( Options::guideSubframeEnabled() || currentCameraIsNotInEkos )
+        requestStarImage(32); //This requests a star image for the guide view.  32 x 32 pixels
+    else
+        requestLockPosition();
+}
+
 void PHD2::processPHD2State(const QString &phd2State)
 {
     if (phd2State == "Stopped")
@@ -852,12 +880,9 @@ void PHD2::processPHD2Result(const QJsonObject &jsonObj, const QByteArray &line)
         //get_sensor_temperature
 
         case STAR_IMAGE:                            //get_star_image
-        {
             starImageRequested = false;
-            QJsonObject jsonResult = jsonObj["result"].toObject();
-            processStarImage(jsonResult);
+            processStarImage(line);
             break;
-        }
 
         //get_use_subframes
 
@@ -973,11 +998,31 @@ void PHD2::setGuideView(FITSView *guideView)
     guideFrame = guideView;
 }
 
-void PHD2::processStarImage(const QJsonObject &jsonStarFrame)
+void PHD2::processStarImageResult(const QByteArray &line)
+{
+    if (Q_UNLIKELY(!PHD2EventDecoder::hasValue(line, "id")))
+        qCDebug(KSTARS_EKOS_GUIDE) << "PHD2: ignoring unexpected response with no id";
+    else
+    {
+        const int id = static_cast<int>(PHD2EventDecoder::doubleValue(line, "id"));
+        if (takeRequestFromList(id) == STAR_IMAGE)
+        {
+            // don't spam the log with image data
+            qCDebug(KSTARS_EKOS_GUIDE) << "PHD2: received star image response, id" << id;
+            starImageRequested = false;
+            processStarImage(line);
+        }
+    }
+
+    // send the next pending call
+    sendNextRpcCall();
+}
+
+void PHD2::processStarImage(const QByteArray &line)
 {
     //The width and height of the received PHD2 Star Image
-    int width =  jsonStarFrame["width"].toInt();
-    int height = jsonStarFrame["height"].toInt();
+    int width =  static_cast<int>(PHD2EventDecoder::doubleValue(line, "width", 0, "result"));
+    int height = static_cast<int>(PHD2EventDecoder::doubleValue(line, "height", 0, "result"));
 
     //This section sets up the FITS File
     fitsfile *fptr = nullptr;
@@ -1007,14 +1052,22 @@ void PHD2::processStarImage(const QJsonObject &jsonStarFrame)
     exposure = 1;
     fits_update_key(fptr, TLONG, "EXPOSURE", &exposure, "Total Exposure Time", &status);
 
-    //This section takes the Pixels from the JSON Document
-    //Then it converts from base64 to a QByteArray
-    //Then it creates a datastream from the QByteArray to the pixel array for the FITS File
-    QByteArray converted = QByteArray::fromBase64(jsonStarFrame["pixels"].toString().toLocal8Bit());
+    //This section takes the Pixels from the raw JSON line
+    //Then it decodes them from base64 into the reusable pixel buffer for the FITS File
+    PHD2EventDecoder::base64Value(line, "pixels", starImagePixels, "result");
 
     //This finishes up and closes the FITS file
     nelements = naxes[0] * naxes[1];
-    if (fits_write_img(fptr, TUSHORT, fpixel, nelements, converted.data(), &status))
+    if (starImagePixels.size() < nelements * static_cast<long>(sizeof(uint16_t)))
+    {
+        qCWarning(KSTARS_EKOS_GUIDE) << "PHD2: star image is truncated, expected" << nelements << "pixels.";
+        status = 0;
+        fits_close_file(fptr, &status);
+        free(fits_buffer);
+        return;
+    }
+
+    if (fits_write_img(fptr, TUSHORT, fpixel, nelements, starImagePixels.data(), &status))
     {
         fits_get_errstatus(status, error_status);
         qCWarning(KSTARS_EKOS_GUIDE) << "fits_write_img failed:" << error_status;
@@ -1535,8 +1588,11 @@ PHD2::PHD2ResultType PHD2::takeRequestFromList(const QJsonObject &response)
         return NO_RESULT;
     }
 
-    int id = response["id"].toInt();
+    return takeRequestFromList(response["id"].toInt());
+}
 
+PHD2::PHD2ResultType PHD2::takeRequestFromList(int id)
+{
     if (Q_UNLIKELY(id != pendingRpcId))
     {
         // RPC id mismatch -- this should never happen, something is
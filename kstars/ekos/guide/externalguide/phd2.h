@@ -11,6 +11,7 @@
 
 #include "../guideinterface.h"
 #include "fitsviewer/fitsview.h"
+#include "phd2eventdecoder.h"
 
 #include <QAbstractSocket>
 #include <QJsonArray>
@@ -218,19 +219,23 @@ private slots:
         void sendRpcCall(QJsonObject &call, PHD2ResultType resultType);
         void sendNextRpcCall();
 
-        void processPHD2Event(const QJsonObject &jsonEvent, const QByteArray &rawResult);
+        void processPHD2Event(PHD2Event eventType, const QByteArray &rawResult);
+        void processGuideStep(const QByteArray &rawResult);
         void processPHD2Result(const QJsonObject &jsonObj, const QByteArray &rawResult);
-        void processStarImage(const QJsonObject &jsonStarFrame);
+        void processStarImageResult(const QByteArray &rawResult);
+        void processStarImage(const QByteArray &rawResult);
         void processPHD2State(const QString &phd2State);
         void handlePHD2AppState(PHD2State state);
         void processPHD2Error(const QJsonObject &jsonError, const QByteArray &rawResult);
 
         PHD2ResultType takeRequestFromList(const QJsonObject &response);
+        PHD2ResultType takeRequestFromList(int id);
 
         QTcpSocket *tcpSocket { nullptr };
         int nextRpcId { 1 };
 
-        QHash<QString, PHD2Event> events;                     // maps event name to event type
+        PHD2EventDecoder decoder;                             // splits the stream and maps event names to event types
+        QByteArray starImagePixels;                           // decoded star image, reused between frames
         QHash<QString, PHD2ResultType> methodResults;         // maps method name to result type
 
         int pendingRpcId;                         // ID of outstanding RPC call
@@ -0,0 +1,331 @@
+/*  Ekos PHD2 Event Decoder
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#include "phd2eventdecoder.h"
+
+#include <QIODevice>
+
+#include <cstring>
+
+namespace
+{
+inline bool isJsonSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline const char *skipSpaces(const char *p, const char *end)
+{
+    while (p < end && isJsonSpace(*p))
+        ++p;
+    return p;
+}
+
+// Returns the position past the string starting at the quote p, or nullptr if it is not terminated.
+const char *skipString(const char *p, const char *end)
+{
+    for (++p; p < end; ++p)
+    {
+        if (*p == '\\')
+            ++p;
+        else if (*p == '"')
+            return p + 1;
+    }
+    return nullptr;
+}
+
+// Returns the position past the JSON value starting at p, or nullptr if the value is truncated.
+const char *skipValue(const char *p, const char *end)
+{
+    if (p < end && *p == '"')
+        return skipString(p, end);
+
+    if (p < end && (*p == '{' || *p == '['))
+    {
+        int depth = 0;
+        while (p < end)
+        {
+            if (*p == '"')
+            {
+                p = skipString(p, end);
+                if (p == nullptr)
+                    return nullptr;
+                continue;
+            }
+            if (*p == '{' || *p == '[')
+                ++depth;
+            else if ((*p == '}' || *p == ']') && --depth == 0)
+                return p + 1;
+            ++p;
+        }
+        return nullptr;
+    }
+
+    // Numbers, true, false and null
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && !isJsonSpace(*p))
+        ++p;
+    return p;
+}
+
+// Returns the value of the member @a key of the object starting at p, members of nested objects are skipped.
+const char *findMember(const char *p, const char *end, const char *key, int keyLength)
+{
+    p = skipSpaces(p, end);
+    if (p == end || *p != '{')
+        return nullptr;
+
+    p = skipSpaces(p + 1, end);
+    while (p < end && *p == '"')
+    {
+        const char *name = p + 1;
+        p = skipString(p, end);
+        if (p == nullptr)
+            return nullptr;
+        const bool match = (p - 1 - name == keyLength) && memcmp(name, key, keyLength) == 0;
+
+        p = skipSpaces(p, end);
+        if (p == end || *p != ':')
+            return nullptr;
+        p = skipSpaces(p + 1, end);
+        if (p == end)
+            return nullptr;
+
+        if (match)
+            return p;
+
+        p = skipValue(p, end);
+        if (p == nullptr)
+            return nullptr;
+        p = skipSpaces(p, end);
+        if (p == end || *p != ',')
+            return nullptr;
+        p = skipSpaces(p + 1, end);
+    }
+
+    return nullptr;
+}
+
+// Returns the 6-bit value of a base64 digit, -1 for characters that are skipped.
+inline int base64Digit(char c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A';
+    if (c >= 'a' && c <= 'z')
+        return c - 'a' + 26;
+    if (c >= '0' && c <= '9')
+        return c - '0' + 52;
+    if (c == '+' || c == '-')
+        return 62;
+    if (c == '/' || c == '_')
+        return 63;
+    return -1;
+}
+}
+
+namespace Ekos
+{
+PHD2EventDecoder::PHD2EventDecoder()
+{
+    // A GuideStep event is around 400 bytes, star images are a few kilobytes.
+    buffer.reserve(16384);
+}
+
+void PHD2EventDecoder::registerEvent(const char *name, int id)
+{
+    events.insert(QByteArray(name), id);
+}
+
+void PHD2EventDecoder::clear()
+{
+    // Keep the reserved capacity for the next connection
+    buffer.resize(0);
+    readOffset = 0;
+    scanOffset = 0;
+}
+
+void PHD2EventDecoder::compact()
+{
+    if (readOffset == 0)
+        return;
+
+    // Move the pending partial line to the front, the capacity is reused
+    const int pending = buffer.size() - readOffset;
+    if (pending > 0)
+        memmove(buffer.data(), buffer.constData() + readOffset, pending);
+    buffer.resize(pending);
+    scanOffset -= readOffset;
+    readOffset = 0;
+}
+
+void PHD2EventDecoder::append(const char *data, int size)
+{
+    if (size <= 0)
+        return;
+
+    compact();
+    buffer.append(data, size);
+}
+
+void PHD2EventDecoder::append(QIODevice *device)
+{
+    const qint64 available = device->bytesAvailable();
+    if (available <= 0)
+        return;
+
+    compact();
+
+    const int oldSize = buffer.size();
+    buffer.resize(oldSize + static_cast<int>(available));
+    const qint64 received = device->read(buffer.data() + oldSize, available);
+    buffer.resize(oldSize + static_cast<int>(qMax<qint64>(0, received)));
+}
+
+bool PHD2EventDecoder::nextLine(QByteArray &line)
+{
+    while (true)
+    {
+        const int end = buffer.indexOf('\n', scanOffset);
+        if (end < 0)
+        {
+            scanOffset = buffer.size();
+            return false;
+        }
+
+        const int start = readOffset;
+        int length = end - start;
+        if (length > 0 && buffer.at(end - 1) == '\r')
+            --length;
+
+        readOffset = scanOffset = end + 1;
+
+        if (length <= 0)
+            continue;
+
+        line = QByteArray::fromRawData(buffer.constData() + start, length);
+        return true;
+    }
+}
+
+PHD2EventDecoder::MessageType PHD2EventDecoder::messageType(const QByteArray &line, QLatin1String &name)
+{
+    const char *end = line.constData() + line.size();
+    const char *p = findMember(line.constData(), end, "Event", 5);
+    if (p == nullptr || *p != '"')
+        return MESSAGE_UNKNOWN;
+
+    const char *nameStart = p + 1;
+    p = skipString(p, end);
+    if (p == nullptr)
+        return MESSAGE_UNKNOWN;
+
+    name = QLatin1String(nameStart, static_cast<int>(p - 1 - nameStart));
+    return MESSAGE_EVENT;
+}
+
+int PHD2EventDecoder::eventId(const QLatin1String &name) const
+{
+    // fromRawData does not copy, the lookup only hashes the bytes in place
+    return events.value(QByteArray::fromRawData(name.data(), name.size()), -1);
+}
+
+const char *PHD2EventDecoder::findValue(const QByteArray &line, const char *key, const char *parent)
+{
+    const char *p = line.constData();
+    const char *end = p + line.size();
+
+    if (parent != nullptr)
+    {
+        p = findMember(p, end, parent, static_cast<int>(strlen(parent)));
+        if (p == nullptr)
+            return nullptr;
+    }
+
+    return findMember(p, end, key, static_cast<int>(strlen(key)));
+}
+
+bool PHD2EventDecoder::hasValue(const QByteArray &line, const char *key)
+{
+    return findValue(line, key) != nullptr;
+}
+
+double PHD2EventDecoder::doubleValue(const QByteArray &line, const char *key, double defaultValue, const char *parent)
+{
+    const char *p = findValue(line, key, parent);
+    if (p == nullptr)
+        return defaultValue;
+
+    const char *end = skipValue(p, line.constData() + line.size());
+    if (end == nullptr)
+        return defaultValue;
+
+    // JSON numbers are locale independent, as is QByteArray::toDouble. Strings and null are not numbers.
+    bool ok = false;
+    const double value = QByteArray::fromRawData(p, static_cast<int>(end - p)).toDouble(&ok);
+    return ok ? value : defaultValue;
+}
+
+QLatin1String PHD2EventDecoder::stringValue(const QByteArray &line, const char *key)
+{
+    const char *p = findValue(line, key);
+    if (p == nullptr || *p != '"')
+        return QLatin1String();
+
+    const char *end = line.constData() + line.size();
+    const char *start = ++p;
+    while (p < end && *p != '"')
+        p += (*p == '\\') ? 2 : 1;
+
+    if (p >= end)
+        return QLatin1String();
+
+    return QLatin1String(start, static_cast<int>(p - start));
+}
+
+bool PHD2EventDecoder::base64Value(const QByteArray &line, const char *key, QByteArray &output, const char *parent)
+{
+    const char *p = findValue(line, key, parent);
+    if (p == nullptr || *p != '"')
+        return false;
+
+    const char *end = line.constData() + line.size();
+    const char *start = ++p;
+    const char *stop = static_cast<const char *>(memchr(start, '"', end - start));
+    if (stop == nullptr)
+        return false;
+
+    // reserve() marks the capacity as reserved, so shrinking below keeps the allocation
+    const int maxLength = static_cast<int>((stop - start) * 3 / 4 + 3);
+    if (output.capacity() < maxLength)
+        output.reserve(maxLength);
+    output.resize(maxLength);
+
+    char *out = output.data();
+    quint32 accumulator = 0;
+    int bits = 0, length = 0;
+
+    // Unknown characters, padding and the backslash of "\/" escapes are skipped
+    for (p = start; p < stop; ++p)
+    {
+        const int digit = base64Digit(*p);
+        if (digit < 0)
+            continue;
+
+        accumulator = (accumulator << 6) | static_cast<quint32>(digit);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            out[length++] = static_cast<char>((accumulator >> bits) & 0xFF);
+        }
+    }
+
+    output.resize(length);
+    return true;
+}
+}
@@ -0,0 +1,114 @@
+/*  Ekos PHD2 Event Decoder
+    Copyright (C) 2026 agent <agent@local>
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+class QIODevice;
+
+namespace Ekos
+{
+/**
+ * @class PHD2EventDecoder
+ * Incremental decoder for the PHD2 JSON-RPC event stream.
+ *
+ * PHD2 sends one JSON message per line. The decoder accumulates the raw socket
+ * bytes in a single growing buffer and hands out complete lines as views into
+ * that buffer, so no memory is allocated per message once the buffer reached its
+ * working size. Event names are interned at registration time and resolved with
+ * one hash lookup on the raw bytes, and the scalar fields of high-rate events such
+ * as GuideStep, as well as star image responses, can be read directly from the line
+ * without building a QJsonDocument.
+ *
+ * Line views returned by nextLine() stay valid until the next call to append().
+ */
+class PHD2EventDecoder
+{
+    public:
+        enum MessageType
+        {
+            MESSAGE_UNKNOWN,
+            MESSAGE_EVENT,
+        };
+
+        PHD2EventDecoder();
+
+        /** @brief Map the PHD2 event @a name to the caller-defined identifier @a id. */
+        void registerEvent(const char *name, int id);
+
+        /** @brief Read every byte currently available on @a device into the line buffer. */
+        void append(QIODevice *device);
+
+        /** @brief Append @a size raw bytes to the line buffer. */
+        void append(const char *data, int size);
+
+        /**
+         * @brief Extract the next complete line.
+         * @param line receives a view of the line, without its terminator.
+         * @return false when no complete line is buffered.
+         */
+        bool nextLine(QByteArray &line);
+
+        /** @brief Discard any buffered data, e.g. after the connection dropped. */
+        void clear();
+
+        /**
+         * @brief Classify @a line, PHD2 events carry their name in the top-level "Event" key.
+         * @param name receives a view of the event name if the line is an event, valid as long as @a line.
+         */
+        static MessageType messageType(const QByteArray &line, QLatin1String &name);
+
+        /** @return the identifier registered for @a name, or -1 if the event is not known. */
+        int eventId(const QLatin1String &name) const;
+
+        /** @return whether @a line has the top-level @a key, whatever its value. */
+        static bool hasValue(const QByteArray &line, const char *key);
+
+        /**
+         * @brief Read the numeric value of top-level @a key in @a line.
+         * @param parent if set, @a key is looked up in the object value of top-level key @a parent.
+         * @return @a defaultValue if the key is missing or not a number.
+         */
+        static double doubleValue(const QByteArray &line, const char *key, double defaultValue = 0,
+                                  const char *parent = nullptr);
+
+        /**
+         * @brief Read the string value of top-level @a key in @a line as a view into the line.
+         * Escape sequences are not interpreted, which is fine for the identifiers PHD2 sends.
+         */
+        static QLatin1String stringValue(const QByteArray &line, const char *key);
+
+        /**
+         * @brief Decode the base64 string value of @a key into @a output.
+         * The capacity of @a output is kept across calls so repeated star images reuse the same storage.
+         * @param parent if set, @a key is looked up in the object value of top-level key @a parent.
+         * @return false if the key is missing.
+         */
+        static bool base64Value(const QByteArray &line, const char *key, QByteArray &output, const char *parent = nullptr);
+
+        /** @return number of bytes allocated for the line buffer. */
+        int capacity() const
+        {
+            return buffer.capacity();
+        }
+
+    private:
+        void compact();
+        static const char *findValue(const QByteArray &line, const char *key, const char *parent = nullptr);
+
+        QByteArray buffer;
+        int readOffset { 0 };
+        int scanOffset { 0 };
+
+        QHash<QByteArray, int> events;
+};
+}
@@ -9,6 +9,7 @@
 
 #include "schedulerjob.h"
 
+#include "altitudecurves.h"
 #include "dms.h"
 #include "kstarsdata.h"
 #include "skymapcomposite.h"
@@ -921,39 +922,46 @@ QDateTime SchedulerJob::calculateAltitudeTime(QDateTime const &when) const
 
     double const SETTING_ALTITUDE_CUTOFF = Options::settingAltitudeCutoff();
 
-    // Within the next 24 hours, search when the job target matches the altitude and moon constraints
-    for (unsigned int minute = 0; minute < 24 * 60; minute++)
-    {
-        KStarsDateTime const ltOffset(ltWhen.addSecs(minute * 60));
-
-        // Update RA/DEC of the target for the current fraction of the day
-        KSNumbers numbers(ltOffset.djd());
-        o.updateCoordsNow(&numbers);
+    // Update RA/DEC of the target once, precession does not move it noticeably within a day
+    KSNumbers numbers(ltWhen.djd());
+    o.updateCoordsNow(&numbers);
 
-        // Compute local sidereal time for the current fraction of the day, calculate altitude
-        CachingDms const LST = geo->GSTtoLST(geo->LTtoUT(ltOffset).gst());
-        o.EquatorialToHorizontal(&LST, geo->lat());
-        double const altitude = o.alt().Degrees();
+    // Within the next 24 hours, search when the job target matches the altitude and moon constraints.
+    // Altitudes are computed an hour at a time, so the search stops early when the target is up soon.
+    // They are searched once, so they do not go through the curve cache.
+    int const CHUNK_MINUTES = 60;
+    for (int chunk = 0; chunk < 24 * 60; chunk += CHUNK_MINUTES)
+    {
+        AltitudeCurves curves(geo, ut.addSecs(chunk * 60), 1 / 60.0, CHUNK_MINUTES, false);
+        curves.compute(QVector<const SkyPoint *>() << &o);
 
-        if (getMinAltitude() <= altitude)
+        for (int sample = 0; sample < curves.samples(); sample++)
         {
-            // Don't test proximity to dawn in this situation, we only cater for altitude here
+            int const minute = chunk + sample;
+            KStarsDateTime const ltOffset(ltWhen.addSecs(minute * 60));
 
-            // Continue searching if Moon separation is not good enough
-            if (0 < getMinMoonSeparation() && getMoonSeparationScore(ltOffset) < 0)
-                continue;
+            double const altitude = curves.altitude(0, sample);
 
-            // Continue searching if target is setting and under the cutoff
-            double offset = LST.Hours() - o.ra().Hours();
-            if (24.0 <= offset)
-                offset -= 24.0;
-            else if (offset < 0.0)
-                offset += 24.0;
-            if (0.0 <= offset && offset < 12.0)
-                if (altitude - SETTING_ALTITUDE_CUTOFF < getMinAltitude())
+            if (getMinAltitude() <= altitude)
+            {
+                // Don't test proximity to dawn in this situation, we only cater for altitude here
+
+                // Continue searching if Moon separation is not good enough
+                if (0 < getMinMoonSeparation() && getMoonSeparationScore(ltOffset) < 0)
                     continue;
 
-            return ltOffset;
+                // Continue searching if target is setting and under the cutoff
+                double offset = curves.lst(sample).Hours() - o.ra().Hours();
+                if (24.0 <= offset)
+                    offset -= 24.0;
+                else if (offset < 0.0)
+                    offset += 24.0;
+                if (0.0 <= offset && offset < 12.0)
+                    if (altitude - SETTING_ALTITUDE_CUTOFF < getMinAltitude())
+                        continue;
+
+                return ltOffset;
+            }
         }
     }
 
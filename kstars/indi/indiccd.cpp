@@ -17,6 +17,7 @@
 #include "driverinfo.h"
 #include "guimanager.h"
 #include "kspaths.h"
+#include "ksprofiler.h"
 #include "kstars.h"
 #include "kstarsdata.h"
 #include "Options.h"
@@ -909,10 +910,9 @@ CCD::~CCD()
 {
     if (m_ImageViewerWindow)
         m_ImageViewerWindow->close();
-    if (fileWriteThread.isRunning())
-        fileWriteThread.waitForFinished();
-    if (fileWriteBuffer != nullptr)
-        delete [] fileWriteBuffer;
+    // Images are still being written to disk
+    for (auto &image : m_PendingImages)
+        image.result.waitForFinished();
 }
 
 void CCD::setBLOBManager(const char *device, INDI::Property *prop)
@@ -1435,48 +1435,103 @@ bool CCD::generateFilename(const QString &format, bool batch_mode, QString *file
     return true;
 }
 
-bool CCD::writeImageFile(const QString &filename, IBLOB *bp, bool is_fits)
+void CCD::enqueueImage(CCDChip *targetChip, IBLOB *bp, const QString &filename, const QString &extension,
+                       bool is_fits, bool load)
 {
-    // TODO: Not yet threading the writes for non-fits files.
-    // Would need to deal with the raw conversion, etc.
-    if (is_fits)
+    // Bound the number of images in flight. If the disk or the CPU cannot keep up
+    // with the camera, wait for the oldest image before accepting a new one.
+    while (m_PendingImages.size() >= MAX_PENDING_IMAGES && m_ProcessingPendingImages == false)
     {
-        // Check if the last write is still ongoing, and if so wait.
-        // It is using the fileWriteBuffer.
-        if (fileWriteThread.isRunning())
-        {
-            fileWriteThread.waitForFinished();
-        }
+        m_PendingImages.first().result.waitForFinished();
+        processPendingImages();
+    }
 
-        // Wait until the file is written before overwritting the filename.
-        fileWriteFilename = filename;
+    PendingImage image;
+    image.chip = targetChip;
+    image.filename = filename;
+    // The chip may be switched to another mode before the image is delivered
+    image.captureMode = targetChip->getCaptureMode();
+    image.captureFilter = targetChip->getCaptureFilter();
+    image.batchMode = targetChip->isBatchMode();
 
-        // Will write blob data in a separate thread, and can't depend on the blob
-        // memory, so copy it first.
+    // The blob memory belongs to the INDI client, so copy it first, reusing a previous buffer if possible.
+    if (m_FreeImageBuffers.isEmpty() == false)
+        image.buffer = m_FreeImageBuffers.takeLast();
+    image.buffer.resize(bp->size);
+    memcpy(image.buffer.data(), bp->blob, bp->size);
 
-        // Check buffer size.
-        if (fileWriteBufferSize != bp->size)
-        {
-            if (fileWriteBuffer != nullptr)
-                delete [] fileWriteBuffer;
-            fileWriteBufferSize = bp->size;
-            fileWriteBuffer = new char[fileWriteBufferSize];
-        }
+    if (load)
+    {
+        image.data.reset(new FITSData(image.captureMode), &QObject::deleteLater);
+        image.data->setProperty("device", getDeviceName());
+        image.data->setProperty("blobVector", bp->bvp->name);
+        image.data->setProperty("blobElement", bp->name);
+        image.data->setProperty("chip", targetChip->getType());
+    }
 
-        // Copy memory, and write file on a separate thread.
-        // Probably too late to return an error if the file couldn't write.
-        memcpy(fileWriteBuffer, bp->blob, bp->size);
-        fileWriteThread = QtConcurrent::run(WriteImageFileInternal, fileWriteFilename,
-                                            fileWriteBuffer, bp->size, is_fits, filter);
+    char *buffer = image.buffer.data();
+    const int size = image.buffer.size();
+    const QString fitsFilter = is_fits ? filter : QString();
+    QSharedPointer<FITSData> data = image.data;
+    if (is_fits)
         filter = "";
-    }
-    else
+
+    // The buffer is owned by the pending image until it is delivered, the worker only reads it.
+    image.result = QtConcurrent::run([ = ]()
     {
-        if (!WriteImageFileInternal(filename, static_cast<char*>(bp->blob), bp->size,
-                                    false, filter))
+        KSPROFILE_SCOPE("ekos", QStringLiteral("CCD::saveImage"));
+
+        if (!WriteImageFileInternal(filename, buffer, size, is_fits, fitsFilter))
             return false;
+
+        if (data.isNull())
+            return true;
+
+        // Silent, this does not run on the GUI thread
+        return data->loadFromBuffer(QByteArray::fromRawData(buffer, size), extension, filename, true);
+    });
+
+    QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher]()
+    {
+        watcher->deleteLater();
+        processPendingImages();
+    });
+    watcher->setFuture(image.result);
+
+    m_PendingImages.append(image);
+}
+
+void CCD::processPendingImages()
+{
+    // Receivers of newImage may wait for another image, do not deliver recursively
+    if (m_ProcessingPendingImages)
+        return;
+
+    m_ProcessingPendingImages = true;
+
+    while (m_PendingImages.isEmpty() == false && m_PendingImages.first().result.isFinished())
+    {
+        PendingImage image = m_PendingImages.takeFirst();
+
+        if (image.result.result() == false)
+        {
+            // If saving or reading the blob fails, we treat it the same as exposure failure
+            // and recapture again if possible
+            qCCritical(KSTARS_INDI) << "failed processing image" << image.filename;
+            emit newExposureValue(image.chip, 0, IPS_ALERT);
+        }
+        else if (image.data.isNull())
+            emit newImage(nullptr);
+        else
+            handleImage(image.chip, image.filename, nullptr, image.data, image.captureMode, image.captureFilter,
+                        image.batchMode);
+
+        if (m_FreeImageBuffers.size() < MAX_PENDING_IMAGES)
+            m_FreeImageBuffers.append(image.buffer);
     }
-    return true;
+
+    m_ProcessingPendingImages = false;
 }
 
 void CCD::setupFITSViewerWindows()
@@ -1565,10 +1620,8 @@ void CCD::processBLOB(IBLOB *bp)
     // Create file name for sequences.
     if (targetChip->isBatchMode())
     {
-        // If either generating file name or writing the image file fails
-        // then return
-        if (!generateFilename(format, targetChip->isBatchMode(), &filename) ||
-                !writeImageFile(filename, bp, BType == BLOB_FITS))
+        // If generating file name fails then return
+        if (!generateFilename(format, targetChip->isBatchMode(), &filename))
         {
             emit BLOBUpdated(nullptr);
             return;
@@ -1674,6 +1727,8 @@ void CCD::processBLOB(IBLOB *bp)
     }
 #endif
 
+    // Sequence images are saved and loaded on a worker thread, and newImageDownloaded
+    // lets the capture module start the next exposure in the meantime.
     // Load FITS if either:
     // #1 FITS Viewer is set to enabled.
     // #2 This is a preview, so we MUST open FITS Viewer even if disabled.
@@ -1684,19 +1739,25 @@ void CCD::processBLOB(IBLOB *bp)
     // 2. FITS Viewer is disabled; and
     // 3. Batch mode is enabled.
     // 4. Summary view is false.
-    if ((targetChip->getCaptureMode() == FITS_NORMAL || targetChip->getCaptureMode() == FITS_CALIBRATE) &&
-            Options::useFITSViewer() == false &&
-            Options::useSummaryPreview() == false &&
-            targetChip->isBatchMode())
+    if (targetChip->isBatchMode())
     {
+        bool load = !((targetChip->getCaptureMode() == FITS_NORMAL || targetChip->getCaptureMode() == FITS_CALIBRATE) &&
+                      Options::useFITSViewer() == false &&
+                      Options::useSummaryPreview() == false);
+
+        enqueueImage(targetChip, bp, filename, shortFormat, BType == BLOB_FITS, load);
         emit BLOBUpdated(bp);
-        emit newImage(nullptr);
+        emit newImageDownloaded(targetChip);
         return;
     }
 
     QSharedPointer<FITSData> blob_data;
     QByteArray buffer = QByteArray::fromRawData(reinterpret_cast<char *>(bp->blob), bp->size);
     blob_data.reset(new FITSData(targetChip->getCaptureMode()), &QObject::deleteLater);
+    blob_data->setProperty("device", getDeviceName());
+    blob_data->setProperty("blobVector", bp->bvp->name);
+    blob_data->setProperty("blobElement", bp->name);
+    blob_data->setProperty("chip", targetChip->getType());
     if (!blob_data->loadFromBuffer(buffer, shortFormat, filename, false))
     {
         // If reading the blob fails, we treat it the same as exposure failure
@@ -1706,49 +1767,42 @@ void CCD::processBLOB(IBLOB *bp)
         return;
     }
 
-    handleImage(targetChip, filename, bp, blob_data);
+    handleImage(targetChip, filename, bp, blob_data, targetChip->getCaptureMode(), targetChip->getCaptureFilter(),
+                targetChip->isBatchMode());
     //    else
     //        emit BLOBUpdated(bp);
 }
 
-void CCD::handleImage(CCDChip *targetChip, const QString &filename, IBLOB *bp, QSharedPointer<FITSData> data)
+void CCD::handleImage(CCDChip *targetChip, const QString &filename, IBLOB *bp, QSharedPointer<FITSData> data,
+                      FITSMode captureMode, FITSScale captureFilter, bool batchMode)
 {
-    FITSMode captureMode = targetChip->getCaptureMode();
-
     // Get or Create FITSViewer if we are using FITSViewer
     // or if capture mode is calibrate since for now we are forced to open the file in the viewer
     // this should be fixed in the future and should only use FITSData
-    if (Options::useFITSViewer() || targetChip->isBatchMode() == false)
+    if (Options::useFITSViewer() || batchMode == false)
     {
         if (m_FITSViewerWindow.isNull() && (captureMode == FITS_NORMAL || captureMode == FITS_CALIBRATE))
             setupFITSViewerWindows();
     }
 
-    // Add metadata
-    data->setProperty("device", getDeviceName());
-    data->setProperty("blobVector", bp->bvp->name);
-    data->setProperty("blobElement", bp->name);
-    data->setProperty("chip", targetChip->getType());
-
     switch (captureMode)
     {
         case FITS_NORMAL:
         case FITS_CALIBRATE:
         {
-            if (Options::useFITSViewer() || targetChip->isBatchMode() == false)
+            if (Options::useFITSViewer() || batchMode == false)
             {
                 bool success = false;
                 int tabIndex = -1;
                 int *tabID = (captureMode == FITS_NORMAL) ? &normalTabID : &calibrationTabID;
                 QUrl fileURL = QUrl::fromLocalFile(filename);
-                FITSScale captureFilter = targetChip->getCaptureFilter();
                 if (*tabID == -1 || Options::singlePreviewFITS() == false)
                 {
                     // If image is preview and we should display all captured images in a
                     // single tab called "Preview", then set the title to "Preview",
                     // Otherwise, the title will be the captured image name
                     QString previewTitle;
-                    if (targetChip->isBatchMode() == false && Options::singlePreviewFITS())
+                    if (batchMode == false && Options::singlePreviewFITS())
                     {
                         // If we are displaying all images from all cameras in a single FITS
                         // Viewer window, then we prefix the camera name to the "Preview" string
@@ -1778,7 +1832,9 @@ void CCD::handleImage(CCDChip *targetChip, const QString &filename, IBLOB *bp, Q
                     m_FITSViewerWindow->raise();
             }
 
-            emit BLOBUpdated(bp);
+            // Sequence images already reported their blob when they arrived
+            if (bp)
+                emit BLOBUpdated(bp);
             emit newImage(data);
         }
         break;
@@ -1786,20 +1842,20 @@ void CCD::handleImage(CCDChip *targetChip, const QString &filename, IBLOB *bp, Q
         case FITS_FOCUS:
         case FITS_GUIDE:
         case FITS_ALIGN:
-            loadImageInView(bp, targetChip, data);
+            loadImageInView(bp, targetChip, data, captureMode, captureFilter, batchMode);
             break;
     }
 }
 
-void CCD::loadImageInView(IBLOB *bp, ISD::CCDChip *targetChip, const QSharedPointer<FITSData> &data)
+void CCD::loadImageInView(IBLOB *bp, ISD::CCDChip *targetChip, const QSharedPointer<FITSData> &data, FITSMode mode,
+                          FITSScale captureFilter, bool batchMode)
 {
-    FITSMode mode = targetChip->getCaptureMode();
     FITSView *view = targetChip->getImageView(mode);
     //QString filename = QString(static_cast<const char *>(bp->aux2));
 
     if (view)
     {
-        view->setFilter(targetChip->getCaptureFilter());
+        view->setFilter(captureFilter);
         //if (!view->loadFITSFromData(data, filename))
         if (!view->loadData(data))
         {
@@ -1811,11 +1867,12 @@ void CCD::loadImageInView(IBLOB *bp, ISD::CCDChip *targetChip, const QSharedPoin
         // Image in preview mode, or useFITSViewer is true; AND
         // Image type is either NORMAL or CALIBRATION since the rest have their dedicated windows.
         // NORMAL is used for raw INDI drivers without Ekos.
-        if ( (Options::useFITSViewer() || targetChip->isBatchMode() == false) &&
+        if ( (Options::useFITSViewer() || batchMode == false) &&
                 (mode == FITS_NORMAL || mode == FITS_CALIBRATE))
             m_FITSViewerWindow->show();
 
-        emit BLOBUpdated(bp);
+        if (bp)
+            emit BLOBUpdated(bp);
         emit newImage(data);
     }
 }
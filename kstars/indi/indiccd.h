@@ -360,16 +360,24 @@ class CCD : public DeviceDecorator
         void ready();
         void captureFailed();
         void newImage(const QSharedPointer<FITSData> &data);
+        // Emitted as soon as a sequence image arrived, before it is saved and loaded.
+        void newImageDownloaded(ISD::CCDChip *chip);
 
     private:
         void processStream(IBLOB *bp);
-        void loadImageInView(IBLOB *bp, ISD::CCDChip *targetChip, const QSharedPointer<FITSData> &data);
+        void loadImageInView(IBLOB *bp, ISD::CCDChip *targetChip, const QSharedPointer<FITSData> &data, FITSMode mode,
+                             FITSScale captureFilter, bool batchMode);
         bool generateFilename(const QString &format, bool batch_mode, QString *filename);
-        // Saves an image to disk on a separate thread.
-        bool writeImageFile(const QString &filename, IBLOB *bp, bool is_fits);
+        // Saves a sequence image to disk and loads it on a worker thread.
+        void enqueueImage(CCDChip *targetChip, IBLOB *bp, const QString &filename, const QString &extension,
+                          bool is_fits, bool load);
+        // Delivers the sequence images whose processing completed, in the order they were received.
+        void processPendingImages();
         // Creates or finds the FITSViewer.
         void setupFITSViewerWindows();
-        void handleImage(CCDChip *targetChip, const QString &filename, IBLOB *bp, QSharedPointer<FITSData> data);
+        // The capture mode, filter and batch mode are those of the chip when the image arrived.
+        void handleImage(CCDChip *targetChip, const QString &filename, IBLOB *bp, QSharedPointer<FITSData> data,
+                         FITSMode captureMode, FITSScale captureFilter, bool batchMode);
 
         QString filter;
         bool ISOMode { true };
@@ -418,10 +426,23 @@ class CCD : public DeviceDecorator
         QMap<QString, double> m_ExposurePresets;
         QPair<double, double> m_ExposurePresetsMinMax;
 
-        // Used when writing the image fits file to disk in a separate thread.
-        char *fileWriteBuffer { nullptr };
-        int fileWriteBufferSize { 0 };
-        QString fileWriteFilename;
-        QFuture<void> fileWriteThread;
+        // Sequence images being written to disk and loaded in a separate thread.
+        // New images wait for the oldest one when the queue is full.
+        static constexpr int MAX_PENDING_IMAGES { 3 };
+        struct PendingImage
+        {
+            QByteArray buffer;
+            QFuture<bool> result;
+            QSharedPointer<FITSData> data;
+            CCDChip *chip { nullptr };
+            QString filename;
+            FITSMode captureMode { FITS_NORMAL };
+            FITSScale captureFilter { FITS_NONE };
+            bool batchMode { true };
+        };
+        QList<PendingImage> m_PendingImages;
+        // Copy buffers of delivered images, reused for the next ones.
+        QList<QByteArray> m_FreeImageBuffers;
+        bool m_ProcessingPendingImages { false };
 };
 }
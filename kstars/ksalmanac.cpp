@@ -22,6 +22,43 @@
 #include "ksnumbers.h"
 #include "kstarsdata.h"
 
+#include <QCache>
+#include <QCoreApplication>
+#include <QTimer>
+
+namespace
+{
+struct NightKey
+{
+    double latitude;
+    double longitude;
+    double height;
+    // Universal time of the local midnight
+    double jd;
+
+    bool operator==(const NightKey &other) const
+    {
+        return latitude == other.latitude && longitude == other.longitude && height == other.height && jd == other.jd;
+    }
+};
+
+uint qHash(const NightKey &key, uint seed = 0)
+{
+    seed = ::qHash(key.latitude, seed) ^ (::qHash(key.longitude, seed) * 31);
+    return ::qHash(key.jd, seed) ^ (::qHash(key.height, seed) * 31);
+}
+
+NightKey keyOf(const GeoLocation *geo, const KStarsDateTime &dt)
+{
+    NightKey key;
+    key.latitude  = geo->lat()->Degrees();
+    key.longitude = geo->lng()->Degrees();
+    key.height    = geo->elevation();
+    key.jd        = dt.djd();
+    return key;
+}
+}
+
 KSAlmanac::KSAlmanac()
 {
     KStarsData *data = KStarsData::Instance();
@@ -35,13 +72,74 @@ KSAlmanac::KSAlmanac()
     QDateTime midnight = QDateTime(data->lt().date(), QTime());
     geo                = data->geo();
     dt                 = geo->LTtoUT(KStarsDateTime(midnight));
-    update();
+}
+
+// Nights are only ever touched from the GUI thread
+static QCache<NightKey, KSAlmanac::Events> &nightCache()
+{
+    // A few sites over a few months
+    static QCache<NightKey, KSAlmanac::Events> cache(1024);
+    return cache;
+}
+
+const KSAlmanac::Events &KSAlmanac::events()
+{
+    if (!m_Dirty)
+        return m_Events;
+
+    const NightKey key = keyOf(geo, dt);
+    if (const Events *cached = nightCache().object(key))
+    {
+        m_Events = *cached;
+    }
+    else
+    {
+        update();
+        nightCache().insert(key, new Events(m_Events));
+        prefetch();
+    }
+    m_Dirty = false;
+    return m_Events;
+}
+
+void KSAlmanac::prefetch() const
+{
+    if (QCoreApplication::instance() == nullptr)
+        return;
+
+    // The site may be gone by the time the nights are computed
+    const GeoLocation site     = *geo;
+    const KStarsDateTime local = site.UTtoLT(dt);
+    for (int night = 1; night <= PREFETCH_NIGHTS; night++)
+    {
+        // Converting the local midnight keeps the key of a night across daylight saving changes
+        const KStarsDateTime next = site.LTtoUT(KStarsDateTime(QDateTime(local.date().addDays(night), QTime())));
+
+        // The sun and moon are computed with the global Earth, so this stays on the GUI thread
+        QTimer::singleShot(0, QCoreApplication::instance(), [site, next]()
+        {
+            const NightKey key = keyOf(&site, next);
+            if (nightCache().contains(key))
+                return;
+
+            KSAlmanac almanac;
+            almanac.geo = &site;
+            almanac.dt  = next;
+            almanac.update();
+            nightCache().insert(key, new Events(almanac.m_Events));
+        });
+    }
+}
+
+void KSAlmanac::clearCache()
+{
+    nightCache().clear();
 }
 
 void KSAlmanac::update()
 {
-    RiseSetTime(&m_Sun, &SunRise, &SunSet, &SunRiseT, &SunSetT);
-    RiseSetTime(&m_Moon, &MoonRise, &MoonSet, &MoonRiseT, &MoonSetT);
+    RiseSetTime(&m_Sun, &m_Events.SunRise, &m_Events.SunSet, &m_Events.SunRiseT, &m_Events.SunSetT);
+    RiseSetTime(&m_Moon, &m_Events.MoonRise, &m_Events.MoonSet, &m_Events.MoonRiseT, &m_Events.MoonSetT);
     //    qDebug() << "Sun rise: " << SunRiseT.toString() << " Sun set: " << SunSetT.toString() << " Moon rise: " << MoonRiseT.toString() << " Moon set: " << MoonSetT.toString();
     findDawnDusk();
     findMoonPhase();
@@ -131,11 +229,11 @@ void KSAlmanac::findDawnDusk()
         du = (dusk + 24.0) / 24.0;
     }
 
-    DawnAstronomicalTwilight = da;
-    DuskAstronomicalTwilight = du;
+    m_Events.DawnAstronomicalTwilight = da;
+    m_Events.DuskAstronomicalTwilight = du;
 
-    SunMaxAlt = max_alt;
-    SunMinAlt = min_alt;
+    m_Events.SunMaxAlt = max_alt;
+    m_Events.SunMinAlt = min_alt;
 }
 
 void KSAlmanac::findMoonPhase()
@@ -147,28 +245,32 @@ void KSAlmanac::findMoonPhase()
     m_Sun.updateCoords(&num, true, geo->lat(), &LST, true); // We can abuse our own copy of the sun and/or moon
     m_Moon.updateCoords(&num, true, geo->lat(), &LST, true);
     m_Moon.findPhase(&m_Sun);
-    MoonPhase = m_Moon.phase().Degrees();
+    m_Events.MoonPhase = m_Moon.phase().Degrees();
+    m_Events.MoonIllum = m_Moon.illum();
+    m_Events.SunDec    = m_Sun.dec().Degrees();
 }
 
 void KSAlmanac::setDate(const KStarsDateTime *newdt)
 {
-    dt = *newdt;
-    update();
+    dt      = *newdt;
+    m_Dirty = true;
 }
 
 void KSAlmanac::setLocation(const GeoLocation *geo_)
 {
-    geo = geo_;
-    update();
+    geo     = geo_;
+    m_Dirty = true;
 }
 
 double KSAlmanac::sunZenithAngleToTime(double z)
 {
     // TODO: Correct for movement of the sun
-    double HA       = acos((cos(z * dms::DegToRad) - m_Sun.dec().sin() * geo->lat()->sin()) /
-                     (m_Sun.dec().cos() * geo->lat()->cos()));
-    double HASunset = acos((-m_Sun.dec().sin() * geo->lat()->sin()) / (m_Sun.dec().cos() * geo->lat()->cos()));
-    return SunSet + (HA - HASunset) / 24.0;
+    const Events &e = events();
+    const dms sunDec(e.SunDec);
+    double HA       = acos((cos(z * dms::DegToRad) - sunDec.sin() * geo->lat()->sin()) /
+                     (sunDec.cos() * geo->lat()->cos()));
+    double HASunset = acos((-sunDec.sin() * geo->lat()->sin()) / (sunDec.cos() * geo->lat()->cos()));
+    return e.SunSet + (HA - HASunset) / 24.0;
 }
 
 double KSAlmanac::findAltitude(const SkyPoint *p, double hour)
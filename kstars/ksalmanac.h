@@ -28,6 +28,12 @@
  *A class that implements methods to find sun rise, sun set, twilight
  *begin / end times, moon rise and moon set times.
  *
+ *The events of a night are computed once per site and date and shared by
+ *all instances, so the planning tools which show the same night do not
+ *compute it again. Changing the date or location only takes effect when a
+ *value is read. After a night is computed, the following nights of the same
+ *site are computed while the event loop is idle. Use it from the GUI thread.
+ *
  *@short Implement methods to find important times in a day
  *@author Prakash Mohan
  *@version 1.0
@@ -60,33 +66,33 @@ class KSAlmanac
          *All the functions returns the fraction of the day
          *as their return value
          */
-    inline double getSunRise() { return SunRise; }
-    inline double getSunSet() { return SunSet; }
-    inline double getMoonRise() { return MoonRise; }
-    inline double getMoonSet() { return MoonSet; }
-    inline double getDuskAstronomicalTwilight() { return DuskAstronomicalTwilight; }
-    inline double getDawnAstronomicalTwilight() { return DawnAstronomicalTwilight; }
+    inline double getSunRise() { return events().SunRise; }
+    inline double getSunSet() { return events().SunSet; }
+    inline double getMoonRise() { return events().MoonRise; }
+    inline double getMoonSet() { return events().MoonSet; }
+    inline double getDuskAstronomicalTwilight() { return events().DuskAstronomicalTwilight; }
+    inline double getDawnAstronomicalTwilight() { return events().DawnAstronomicalTwilight; }
 
     /**
          *These functions return the max and min altitude of the sun during the course of the day in degrees
          */
-    inline double getSunMaxAlt() { return SunMaxAlt; }
-    inline double getSunMinAlt() { return SunMinAlt; }
+    inline double getSunMaxAlt() { return events().SunMaxAlt; }
+    inline double getSunMinAlt() { return events().SunMinAlt; }
 
     /**
          *@return the moon phase in degrees at the given date/time. Ranges is [0, 180]
          */
-    inline double getMoonPhase() { return MoonPhase; }
+    inline double getMoonPhase() { return events().MoonPhase; }
 
     /**
          *@return get the moon illuminated fraction at the given date/time. Range is [0.,1.]
          */
-    inline double getMoonIllum() { return m_Moon.illum(); }
+    inline double getMoonIllum() { return events().MoonIllum; }
 
-    inline QTime sunRise() { return SunRiseT; }
-    inline QTime sunSet() { return SunSetT; }
-    inline QTime moonRise() { return MoonRiseT; }
-    inline QTime moonSet() { return MoonSetT; }
+    inline QTime sunRise() { return events().SunRiseT; }
+    inline QTime sunSet() { return events().SunSetT; }
+    inline QTime moonRise() { return events().MoonRiseT; }
+    inline QTime moonSet() { return events().MoonSetT; }
     // TODO: Implement:
     //    inline QTime duskAstronomicalTwilight() { return DuskAstronomicalTwilightT; }
     //    inline QTime dawnAstronomicalTwilight() { return DawnAstronomicalTwilightT; }
@@ -99,9 +105,43 @@ class KSAlmanac
          */
     double sunZenithAngleToTime(double z);
 
+    /**
+         *@short Forget the events of all nights computed so far
+         *@note Called by KStarsData whenever the location is set, as the site or its time zone may have been edited
+         */
+    static void clearCache();
+
+    /** Number of nights after a computed one which are computed in advance */
+    static constexpr int PREFETCH_NIGHTS { 3 };
+
+    /** The events of a night, as returned by the getters above */
+    struct Events
+    {
+        double SunRise { 0 };
+        double SunSet { 0 };
+        double MoonRise { 0 };
+        double MoonSet { 0 };
+        double DuskAstronomicalTwilight { 0 };
+        double DawnAstronomicalTwilight { 0 };
+        double SunMinAlt { 0 };
+        double SunMaxAlt { 0 };
+        double MoonPhase { 0 };
+        double MoonIllum { 0 };
+        // Declination of the sun at midnight, in degrees
+        double SunDec { 0 };
+        QTime SunRiseT, SunSetT, MoonRiseT, MoonSetT;
+    };
+
   private:
+    /** @return the events of the current date and location, computing them if they are not cached */
+    const Events &events();
+
+    /** Computes the events of the current date and location into m_Events */
     void update();
 
+    /** Computes the nights following the current one in the idle time of the event loop */
+    void prefetch() const;
+
     /**
           * This function computes the rise and set time for the given SkyObject. This is done in order to
           * have a common function for the computation of the Sun and Moon rise and set times.
@@ -131,14 +171,7 @@ class KSAlmanac
     KStarsDateTime dt;
 
     const GeoLocation *geo { nullptr };
-    double SunRise { 0 };
-    double SunSet { 0 };
-    double MoonRise { 0 };
-    double MoonSet { 0 };
-    double DuskAstronomicalTwilight { 0 };
-    double DawnAstronomicalTwilight { 0 };
-    double SunMinAlt { 0 };
-    double SunMaxAlt { 0 };
-    double MoonPhase { 0 };
-    QTime SunRiseT, SunSetT, MoonRiseT, MoonSetT, DuskAstronomicalTwilightT, DawnAstronomicalTwilightT;
+    Events m_Events;
+    // Set when the date or location changed since m_Events was filled
+    bool m_Dirty { true };
 };
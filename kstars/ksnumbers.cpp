@@ -377,4 +377,28 @@ void KSNumbers::updateValues(long double jd)
     {
         item *= UA2km;
     }
+
+    // Nutation rotates the mean equator of date to the true equator: about the equinox by the
+    // mean obliquity, about the ecliptic pole by -deltaEcLong and back by the true obliquity.
+    double sinOb, cosOb, sinTrueOb, cosTrueOb, sinPsi, cosPsi;
+    Obliquity.SinCos(sinOb, cosOb);
+    dms(Obliquity.Degrees() + deltaObliquity).SinCos(sinTrueOb, cosTrueOb);
+    dms(deltaEcLong).SinCos(sinPsi, cosPsi);
+
+    Eigen::Matrix3d nutation;
+    nutation(0, 0) = cosPsi;
+    nutation(0, 1) = -sinPsi * cosOb;
+    nutation(0, 2) = -sinPsi * sinOb;
+    nutation(1, 0) = sinPsi * cosTrueOb;
+    nutation(1, 1) = cosPsi * cosOb * cosTrueOb + sinOb * sinTrueOb;
+    nutation(1, 2) = cosPsi * sinOb * cosTrueOb - cosOb * sinTrueOb;
+    nutation(2, 0) = sinPsi * sinTrueOb;
+    nutation(2, 1) = cosPsi * cosOb * sinTrueOb - sinOb * cosTrueOb;
+    nutation(2, 2) = cosPsi * sinOb * sinTrueOb + cosOb * cosTrueOb;
+
+    // SkyPoint::precess() applies P1 to precess from J2000
+    PN.noalias() = nutation * P1;
+
+    const double speedOfLight = 299792.458; // km/s
+    Aberration.noalias() = PN * Eigen::Vector3d(vearth[0], vearth[1], vearth[2]) / speedOfLight;
 }
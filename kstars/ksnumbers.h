@@ -123,6 +123,18 @@ class KSNumbers
     inline const Eigen::Matrix3d &p1b() const { return P1B; }
     inline const Eigen::Matrix3d &p2b() const { return P2B; }
 
+    /**
+     * @return the rotation from J2000 to the true equator and equinox of date, i.e. precession
+     * followed by nutation in a single matrix.
+     */
+    inline const Eigen::Matrix3d &precessionNutation() const { return PN; }
+
+    /**
+     * @return the velocity of the Earth in units of the speed of light, in the true equatorial
+     * frame of date. Adding it to a unit vector of date applies the annual aberration.
+     */
+    inline const Eigen::Vector3d &aberration() const { return Aberration; }
+
     /**
      * @short compute constant values that need to be computed only once per instance of the application
      */
@@ -148,6 +160,8 @@ class KSNumbers
     double CX, SX, CY, SY, CZ, SZ;
     double CXB, SXB, CYB, SYB, CZB, SZB;
     Eigen::Matrix3d P1, P2, P1B, P2B;
+    Eigen::Matrix3d PN;
+    Eigen::Vector3d Aberration;
     double deltaObliquity, deltaEcLong;
     double e, T;
     long double days; // JD for which the last update was called
@@ -22,6 +22,7 @@
 
 #include "fov.h"
 #include "kactionmenu.h"
+#include "ksprofiler.h"
 #include "kstarsadaptor.h"
 #include "kstarsdata.h"
 #include "kstarssplash.h"
@@ -242,6 +243,8 @@ KStars::KStars(bool doSplash, bool clockrun, const QString &startdate)
     OriginalPalette = QApplication::palette();
     */
 
+    KSProfiler::Instance()->setEnabled(Options::profiling());
+
     //Initialize data.  When initialization is complete, it will run dataInitFinished()
     if (!m_KStarsData->initialize())
         return;
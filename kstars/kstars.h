@@ -493,6 +493,26 @@ class KStars : public KXmlGuiWindow
              */
         Q_SCRIPTABLE Q_NOREPLY void openFITS(const QUrl &imageUrl);
 
+        /** DBUS interface function.  Start or stop recording timing of startup, sky map drawing and Ekos pipelines.
+             * @note Set the Profiling option to record the startup as well.
+             */
+        Q_SCRIPTABLE Q_NOREPLY void setProfilingEnabled(bool enabled);
+
+        /** DBUS interface function.  Discard the recorded timing events and statistics. */
+        Q_SCRIPTABLE Q_NOREPLY void clearProfiling();
+
+        /** DBUS interface function.  Get the timing statistics as JSON.
+             * @return per category (e.g. "draw" for each sky component), the number of calls and the
+             * last, average and maximum time in milliseconds.
+             */
+        Q_SCRIPTABLE QString getProfilingStatistics();
+
+        /** DBUS interface function.  Write the recorded timing events as a Chrome trace.
+             * @param filename JSON file that can be opened with chrome://tracing or the Perfetto UI.
+             * @return true if the file was written.
+             */
+        Q_SCRIPTABLE bool writeProfilingTrace(const QString &filename);
+
         /** @}*/
 
     signals:
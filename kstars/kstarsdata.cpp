@@ -17,9 +17,12 @@
 
 #include "kstarsdata.h"
 
+#include "ksalmanac.h"
 #include "ksutils.h"
 #include "Options.h"
 #include "auxiliary/kspaths.h"
+#include "auxiliary/ksprofiler.h"
+#include "auxiliary/startuptaskgraph.h"
 #include "skycomponents/supernovaecomponent.h"
 #include "skycomponents/skymapcomposite.h"
 #include "ksnotification.h"
@@ -37,9 +40,10 @@
 #include <KMessageBox>
 #endif
 
+#include <QHash>
+#include <QSharedPointer>
 #include <QSqlQuery>
 #include <QSqlRecord>
-#include <QtConcurrent>
 
 #include "kstars_debug.h"
 
@@ -84,6 +88,13 @@ bool nonFatalErrorMessage(QString fname)
     return res == KMessageBox::Continue;
 #endif
 }
+
+// Lines of a URL file, read by a worker task
+struct URLFileData
+{
+    QStringList lines;
+    bool found { false };
+};
 }
 
 KStarsData *KStarsData::pinstance = nullptr;
@@ -121,6 +132,9 @@ KStarsData::~KStarsData()
 {
     Q_ASSERT(pinstance);
 
+    // Deferred startup tasks may still be reading
+    m_StartupTasks.reset();
+
     //delete locale;
     qDeleteAll(geoList);
     geoList.clear();
@@ -134,107 +148,197 @@ KStarsData::~KStarsData()
 
 bool KStarsData::initialize()
 {
+    // Worker tasks only fill containers that nobody reads before run() returns. Everything that
+    // creates QObjects, indexes the sky mesh or opens connections used later on stays on the main thread.
+    m_StartupTasks.reset(new StartupTaskGraph());
+
+    // Worker tasks cannot touch the splash screen, so the progress is reported when a task starts
+    QHash<QString, QString> progress;
+    progress["tzrules"]        = i18n("Reading time zone rules");
+    progress["citydb-upgrade"] = i18n("Upgrade existing user city db to support geographic elevation.");
+    progress["cities"]         = i18n("Loading city data");
+    progress["userdb"]         = i18n("Loading User Information");
+    progress["sky-milkyway"]   = i18n("Loading sky objects");
+    connect(m_StartupTasks.get(), &StartupTaskGraph::taskStarted, this, [this, progress](const QString &name)
+    {
+        if (progress.contains(name))
+            emit progressText(progress[name]);
+    });
+
     //Initialize CatalogDB//
-    catalogdb()->Initialize();
+    m_StartupTasks->addTask("catalogdb", QStringList(), StartupTaskGraph::MainThread, [this]() -> bool
+    {
+        catalogdb()->Initialize();
+        return true;
+    });
 
     //Load Time Zone Rules//
-    emit progressText(i18n("Reading time zone rules"));
-    if (!readTimeZoneRulebook())
+    m_StartupTasks->addTask("tzrules", QStringList(), StartupTaskGraph::WorkerThread, [this]() -> bool
     {
-        fatalErrorMessage("TZrules.dat");
-        return false;
-    }
+        return readTimeZoneRulebook();
+    });
 
+    m_StartupTasks->addTask("citydb-upgrade", QStringList(), StartupTaskGraph::WorkerThread, [this]() -> bool
+    {
+        upgradeCityDatabase();
+        return true;
+    });
 
-    emit progressText(i18n("Upgrade existing user city db to support geographic elevation."));
+    //Load Cities//
+    m_StartupTasks->addTask("cities", QStringList() << "tzrules" << "citydb-upgrade", StartupTaskGraph::WorkerThread,
+                            [this]() -> bool
+    {
+        return readCityData();
+    });
 
+    // The location dialog edits the user cities through this connection
+    m_StartupTasks->addTask("citydb-connection", QStringList() << "citydb-upgrade", StartupTaskGraph::MainThread,
+                            []() -> bool
+    {
+        QSqlDatabase mycitydb = QSqlDatabase::addDatabase("QSQLITE", "mycitydb");
+        QString dbfile = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + QDir::separator() + "mycitydb.sqlite";
+        if (QFile::exists(dbfile))
+            mycitydb.setDatabaseName(dbfile);
+        return true;
+    });
 
-    QString dbfile = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + QDir::separator() + "mycitydb.sqlite";
+    //Initialize User Database//
+    m_StartupTasks->addTask("userdb", QStringList(), StartupTaskGraph::MainThread, [this]() -> bool
+    {
+        m_ksuserdb.Initialize();
+        return true;
+    });
 
-    /// This code to add Height column to table city in mycitydb.sqlite is a transitional measure to support a meaningful
-    /// geographic elevation.
-    if (QFile::exists(dbfile))
+    //Initialize SkyMapComposite//
+    // Each group of sky components is its own task, "skycomposite" joins them
+    m_SkyComposite.reset(new SkyMapComposite());
+    const QStringList skyLoaders = m_SkyComposite->addLoaders(m_StartupTasks.get(), QStringList() << "catalogdb" << "userdb");
+    m_StartupTasks->addTask("skycomposite", skyLoaders, StartupTaskGraph::MainThread, []() -> bool
+    {
+        return true;
+    });
+
+#ifndef KSTARS_LITE
+    m_StartupTasks->addTask("advtree", QStringList(), StartupTaskGraph::WorkerThread, [this]() -> bool
     {
-        QSqlDatabase fixcitydb = QSqlDatabase::addDatabase("QSQLITE", "fixcitydb");
+        readADVTreeData();
+        return true;
+    });
+
+    //Initialize Observing List
+    m_StartupTasks->addTask("observinglist", QStringList() << "skycomposite", StartupTaskGraph::MainThread,
+                            [this]() -> bool
+    {
+        m_ObservingList = new ObservingList();
+        return true;
+    });
+#endif
 
-        fixcitydb.setDatabaseName(dbfile);
-        fixcitydb.open();
+    // Object links and logs are only needed by the popup menu and the details dialog,
+    // so they are attached once the user interface is up.
+    //Load Image URLs//
+    //Load Information URLs//
+    //#ifndef Q_OS_ANDROID
+    //On Android these 2 calls produce segfault. WARNING
+    const QStringList urlFiles = QStringList() << "image_url.dat" << "info_url.dat";
+    for (int type = 0; type < urlFiles.size(); type++)
+    {
+        const QString urlFile = urlFiles[type];
+        QSharedPointer<URLFileData> data(new URLFileData());
 
-        if (fixcitydb.tables().contains("city", Qt::CaseInsensitive))
+        // A missing file is reported by the main thread task, the worker cannot show dialogs
+        m_StartupTasks->addTask(urlFile, QStringList(), StartupTaskGraph::WorkerThread, [this, urlFile, data]() -> bool
         {
-            QSqlRecord r = fixcitydb.record("city");
-            if (!r.contains("Elevation"))
-            {
-                emit progressText(i18n("Adding \"Elevation\" column to city table."));
+            data->found = readURLFile(urlFile, data->lines);
+            return true;
+        });
 
-                QSqlQuery query(fixcitydb);
-                if (query.exec("alter table city add column Elevation real default -10;") == false)
-                {
-                    emit progressText(QString("failed to add Elevation column to city table in mycitydb.sqlite: &1").arg(
-                                          query.lastError().text()));
-                }
-            }
-            else
-            {
-                emit progressText(i18n("City table already contains \"Elevation\"."));
-            }
-        }
-        else
+        // Cancelling the error message aborts the startup
+        m_StartupTasks->addTask(urlFile + "-check", QStringList() << urlFile, StartupTaskGraph::MainThread,
+                                [urlFile, data]() -> bool
         {
-            emit progressText(i18n("City table missing from database."));
-        }
-        fixcitydb.close();
+            return data->found || nonFatalErrorMessage(urlFile);
+        });
+
+        m_StartupTasks->addTask(urlFile + "-links", QStringList() << "skycomposite" << urlFile + "-check",
+                                StartupTaskGraph::MainThread, [this, data, type]() -> bool
+        {
+            if (data->found)
+                applyURLData(data->lines, type);
+            return true;
+        }, StartupTaskGraph::Deferred);
     }
+    //#endif
 
+    m_StartupTasks->addTask("userlog", QStringList() << "skycomposite", StartupTaskGraph::MainThread, [this]() -> bool
+    {
+        return readUserLog();
+    }, StartupTaskGraph::Deferred);
 
-    //Load Cities//
-    emit progressText(i18n("Loading city data"));
-    if (!readCityData())
+    if (m_StartupTasks->run() == false)
     {
-        fatalErrorMessage("citydb.sqlite");
+        const QString &failedTask = m_StartupTasks->failedTask();
+        if (failedTask == "tzrules")
+            fatalErrorMessage("TZrules.dat");
+        else if (failedTask == "cities")
+            fatalErrorMessage("citydb.sqlite");
         return false;
     }
 
-    //Initialize User Database//
-    emit progressText(i18n("Loading User Information"));
-    m_ksuserdb.Initialize();
-
-    //Initialize SkyMapComposite//
-    emit progressText(i18n("Loading sky objects"));
-    m_SkyComposite.reset(new SkyMapComposite());
-    //Load Image URLs//
-    //#ifndef Q_OS_ANDROID
-    //On Android these 2 calls produce segfault. WARNING
-    emit progressText(i18n("Loading Image URLs"));
+    return true;
+}
 
-    if( !readURLData( "image_url.dat", 0 ) && !nonFatalErrorMessage( "image_url.dat" ) )
-        return false;
-    //QtConcurrent::run(this, &KStarsData::readURLData, QString("image_url.dat"), 0, false);
+void KStarsData::upgradeCityDatabase()
+{
+    // Runs on a worker thread, progress is only logged
+    qCDebug(KSTARS) << "Upgrade existing user city db to support geographic elevation.";
 
-    //Load Information URLs//
-    //emit progressText(i18n("Loading Information URLs"));
-    if( !readURLData( "info_url.dat", 1 ) && !nonFatalErrorMessage( "info_url.dat" ) )
-        return false;
-    QtConcurrent::run(this, &KStarsData::readURLData, QString("info_url.dat"), 1, false);
+    QString dbfile = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + QDir::separator() + "mycitydb.sqlite";
 
-    //#endif
-    //emit progressText( i18n("Loading Variable Stars" ) );
+    /// This code to add Height column to table city in mycitydb.sqlite is a transitional measure to support a meaningful
+    /// geographic elevation.
+    if (QFile::exists(dbfile))
+    {
+        {
+            QSqlDatabase fixcitydb = QSqlDatabase::addDatabase("QSQLITE", "fixcitydb");
 
-#ifndef KSTARS_LITE
-    //Initialize Observing List
-    m_ObservingList = new ObservingList();
-#endif
+            fixcitydb.setDatabaseName(dbfile);
+            fixcitydb.open();
 
-    readUserLog();
+            if (fixcitydb.tables().contains("city", Qt::CaseInsensitive))
+            {
+                QSqlRecord r = fixcitydb.record("city");
+                if (!r.contains("Elevation"))
+                {
+                    qCInfo(KSTARS) << "Adding \"Elevation\" column to city table.";
 
-#ifndef KSTARS_LITE
-    readADVTreeData();
-#endif
-    return true;
+                    QSqlQuery query(fixcitydb);
+                    if (query.exec("alter table city add column Elevation real default -10;") == false)
+                    {
+                        qCWarning(KSTARS) << "failed to add Elevation column to city table in mycitydb.sqlite:"
+                                          << query.lastError().text();
+                    }
+                }
+                else
+                {
+                    qCDebug(KSTARS) << "City table already contains \"Elevation\".";
+                }
+            }
+            else
+            {
+                qCWarning(KSTARS) << "City table missing from database.";
+            }
+            fixcitydb.close();
+        }
+        // Connections belong to the thread that added them
+        QSqlDatabase::removeDatabase("fixcitydb");
+    }
 }
 
 void KStarsData::updateTime(GeoLocation *geo, const bool automaticDSTchange)
 {
+    KSPROFILE_SCOPE("update", QStringLiteral("KStarsData::updateTime"));
+
     // sync LTime with the simulation clock
     LTime = geo->UTtoLT(ut());
     syncLST();
@@ -266,12 +370,14 @@ void KStarsData::updateTime(GeoLocation *geo, const bool automaticDSTchange)
         LastNumUpdate = KStarsDateTime(ut().djd());
         m_preUpdateNumID++;
         m_preUpdateNum = KSNumbers(num);
+        KSPROFILE_SCOPE("update", QStringLiteral("SkyMapComposite::update(precession)"));
         skyComposite()->update(&num);
     }
 
     if (std::abs(ut().djd() - LastPlanetUpdate.djd()) > 0.01)
     {
         LastPlanetUpdate = KStarsDateTime(ut().djd());
+        KSPROFILE_SCOPE("update", QStringLiteral("SkyMapComposite::updateSolarSystemBodies"));
         skyComposite()->updateSolarSystemBodies(&num);
     }
 
@@ -279,6 +385,7 @@ void KStarsData::updateTime(GeoLocation *geo, const bool automaticDSTchange)
     if (std::abs(ut().djd() - LastMoonUpdate.djd()) > 0.00069444)
     {
         LastMoonUpdate = ut();
+        KSPROFILE_SCOPE("update", QStringLiteral("SkyMapComposite::updateMoons"));
         skyComposite()->updateMoons(&num);
     }
 
@@ -289,7 +396,10 @@ void KStarsData::updateTime(GeoLocation *geo, const bool automaticDSTchange)
         LastSkyUpdate = ut();
         m_preUpdateID++;
         //omit KSNumbers arg == just update Alt/Az coords // <-- Eh? -- asimha. Looks like this behavior / ideology has changed drastically.
-        skyComposite()->update(&num);
+        {
+            KSPROFILE_SCOPE("update", QStringLiteral("SkyMapComposite::update"));
+            skyComposite()->update(&num);
+        }
 
         emit skyUpdate(clock()->isManualMode());
     }
@@ -425,6 +535,9 @@ void KStarsData::setLocation(const GeoLocation &l)
             Options::setDST(key);
     }
 
+    // The site or its time zone rule may have been edited, the nights computed for it are stale
+    KSAlmanac::clearCache();
+
     emit geoChanged();
 }
 
@@ -437,61 +550,34 @@ SkyObject *KStarsData::objectNamed(const QString &name)
 
 bool KStarsData::readCityData()
 {
-    QSqlDatabase citydb = QSqlDatabase::addDatabase("QSQLITE", "citydb");
-    QString dbfile      = KSPaths::locate(QStandardPaths::GenericDataLocation, "citydb.sqlite");
-    citydb.setDatabaseName(dbfile);
-    if (citydb.open() == false)
-    {
-        qCCritical(KSTARS) << "Unable to open city database file " << dbfile << citydb.lastError().text();
-        return false;
-    }
-
-    QSqlQuery get_query(citydb);
-
-    //get_query.prepare("SELECT * FROM city");
-    if (!get_query.exec("SELECT * FROM city"))
-    {
-        qCCritical(KSTARS) << get_query.lastError();
-        return false;
-    }
-
+    // Runs on a worker thread at startup. Connections belong to the thread that added them, so both
+    // are private to this function and removed before it returns. The location dialog uses "mycitydb".
     bool citiesFound = false;
-    // get_query.size() always returns -1 so we set citiesFound if at least one city is found
-    while (get_query.next())
-    {
-        citiesFound          = true;
-        QString name         = get_query.value(1).toString();
-        QString province     = get_query.value(2).toString();
-        QString country      = get_query.value(3).toString();
-        dms lat              = dms(get_query.value(4).toString());
-        dms lng              = dms(get_query.value(5).toString());
-        double TZ            = get_query.value(6).toDouble();
-        TimeZoneRule *TZrule = &(Rulebook[get_query.value(7).toString()]);
-        double elevation     = get_query.value(8).toDouble();
-
-        // appends city names to list
-        geoList.append(new GeoLocation(lng, lat, name, province, country, TZ, TZrule, elevation, true, 4));
-    }
-    citydb.close();
-
-    // Reading local database
-    QSqlDatabase mycitydb = QSqlDatabase::addDatabase("QSQLITE", "mycitydb");
-    dbfile = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + QDir::separator() + "mycitydb.sqlite";
-
-    if (QFile::exists(dbfile))
+    bool success     = true;
     {
-        mycitydb.setDatabaseName(dbfile);
-        if (mycitydb.open())
+        QSqlDatabase citydb = QSqlDatabase::addDatabase("QSQLITE", "readcitydb");
+        QString dbfile      = KSPaths::locate(QStandardPaths::GenericDataLocation, "citydb.sqlite");
+        citydb.setDatabaseName(dbfile);
+        if (citydb.open() == false)
+        {
+            qCCritical(KSTARS) << "Unable to open city database file " << dbfile << citydb.lastError().text();
+            success = false;
+        }
+        else
         {
-            QSqlQuery get_query(mycitydb);
+            QSqlQuery get_query(citydb);
 
+            //get_query.prepare("SELECT * FROM city");
             if (!get_query.exec("SELECT * FROM city"))
             {
-                qDebug() << get_query.lastError();
-                return false;
+                qCCritical(KSTARS) << get_query.lastError();
+                success = false;
             }
-            while (get_query.next())
+
+            // get_query.size() always returns -1 so we set citiesFound if at least one city is found
+            while (success && get_query.next())
             {
+                citiesFound          = true;
                 QString name         = get_query.value(1).toString();
                 QString province     = get_query.value(2).toString();
                 QString country      = get_query.value(3).toString();
@@ -502,13 +588,54 @@ bool KStarsData::readCityData()
                 double elevation     = get_query.value(8).toDouble();
 
                 // appends city names to list
-                geoList.append(new GeoLocation(lng, lat, name, province, country, TZ, TZrule, elevation, false, 4));
+                geoList.append(new GeoLocation(lng, lat, name, province, country, TZ, TZrule, elevation, true, 4));
+            }
+        }
+        citydb.close();
+    }
+    QSqlDatabase::removeDatabase("readcitydb");
+
+    if (!success)
+        return false;
+
+    // Reading local database
+    QString dbfile = KSPaths::writableLocation(QStandardPaths::GenericDataLocation) + QDir::separator() + "mycitydb.sqlite";
+
+    if (QFile::exists(dbfile))
+    {
+        {
+            QSqlDatabase mycitydb = QSqlDatabase::addDatabase("QSQLITE", "readmycitydb");
+            mycitydb.setDatabaseName(dbfile);
+            if (mycitydb.open())
+            {
+                QSqlQuery get_query(mycitydb);
+
+                if (!get_query.exec("SELECT * FROM city"))
+                {
+                    qDebug() << get_query.lastError();
+                    success = false;
+                }
+                while (success && get_query.next())
+                {
+                    QString name         = get_query.value(1).toString();
+                    QString province     = get_query.value(2).toString();
+                    QString country      = get_query.value(3).toString();
+                    dms lat              = dms(get_query.value(4).toString());
+                    dms lng              = dms(get_query.value(5).toString());
+                    double TZ            = get_query.value(6).toDouble();
+                    TimeZoneRule *TZrule = &(Rulebook[get_query.value(7).toString()]);
+                    double elevation     = get_query.value(8).toDouble();
+
+                    // appends city names to list
+                    geoList.append(new GeoLocation(lng, lat, name, province, country, TZ, TZrule, elevation, false, 4));
+                }
             }
             mycitydb.close();
         }
+        QSqlDatabase::removeDatabase("readmycitydb");
     }
 
-    return citiesFound;
+    return success && citiesFound;
 }
 
 bool KStarsData::readTimeZoneRulebook()
@@ -685,14 +812,18 @@ bool KStarsData::openUrlFile(const QString &urlfile, QFile &file)
     return fileFound;
 }
 
-// FIXME: This is a significant contributor to KStars start-up time
 bool KStarsData::readURLData(const QString &urlfile, int type, bool deepOnly)
 {
-#ifndef KSTARS_LITE
-    if (KStars::Closing)
-        return true;
-#endif
+    QStringList lines;
+    if (!readURLFile(urlfile, lines))
+        return false;
+
+    applyURLData(lines, type, deepOnly);
+    return true;
+}
 
+bool KStarsData::readURLFile(const QString &urlfile, QStringList &lines)
+{
     QFile file;
     if (!openUrlFile(urlfile, file))
         return false;
@@ -705,55 +836,59 @@ bool KStarsData::readURLData(const QString &urlfile, int type, bool deepOnly)
 
         //ignore comment lines
         if (!line.startsWith('#'))
-        {
+            lines.append(line);
+    }
+    file.close();
+    return true;
+}
+
+// FIXME: This is a significant contributor to KStars start-up time
+void KStarsData::applyURLData(const QStringList &lines, int type, bool deepOnly)
+{
+    for (const auto &line : lines)
+    {
 #ifndef KSTARS_LITE
-            if (KStars::Closing)
-            {
-                file.close();
-                return true;
-            }
+        if (KStars::Closing)
+            return;
 #endif
 
-            int idx      = line.indexOf(':');
-            QString name = line.left(idx);
-            if (name == "XXX")
-                continue;
-            QString sub   = line.mid(idx + 1);
-            idx           = sub.indexOf(':');
-            QString title = sub.left(idx);
-            QString url   = sub.mid(idx + 1);
-            // Dirty hack to fix things up for planets
-
-            //            if (name == "Mercury" || name == "Venus" || name == "Mars" || name == "Jupiter" || name == "Saturn" ||
-            //                    name == "Uranus" || name == "Neptune" /* || name == "Pluto" */)
-            //                o = skyComposite()->findByName(i18n(name.toLocal8Bit().data()));
-            //            else
-            SkyObject *o = skyComposite()->findByName(name);
-
-            if (!o)
-            {
-                qCWarning(KSTARS) << i18n("Object named %1 not found", name);
-            }
-            else
+        int idx      = line.indexOf(':');
+        QString name = line.left(idx);
+        if (name == "XXX")
+            continue;
+        QString sub   = line.mid(idx + 1);
+        idx           = sub.indexOf(':');
+        QString title = sub.left(idx);
+        QString url   = sub.mid(idx + 1);
+        // Dirty hack to fix things up for planets
+
+        //            if (name == "Mercury" || name == "Venus" || name == "Mars" || name == "Jupiter" || name == "Saturn" ||
+        //                    name == "Uranus" || name == "Neptune" /* || name == "Pluto" */)
+        //                o = skyComposite()->findByName(i18n(name.toLocal8Bit().data()));
+        //            else
+        SkyObject *o = skyComposite()->findByName(name);
+
+        if (!o)
+        {
+            qCWarning(KSTARS) << i18n("Object named %1 not found", name);
+        }
+        else
+        {
+            if (!deepOnly || (o->type() > 2 && o->type() < 9))
             {
-                if (!deepOnly || (o->type() > 2 && o->type() < 9))
+                if (type == 0) //image URL
                 {
-                    if (type == 0) //image URL
-                    {
-                        o->ImageList().append(url);
-                        o->ImageTitle().append(title);
-                    }
-                    else if (type == 1) //info URL
-                    {
-                        o->InfoList().append(url);
-                        o->InfoTitle().append(title);
-                    }
+                    o->ImageList().append(url);
+                    o->ImageTitle().append(title);
+                }
+                else if (type == 1) //info URL
+                {
+                    o->InfoList().append(url);
+                    o->InfoTitle().append(title);
                 }
             }
         }
     }
-    file.close();
-    return true;
 }
 
 // FIXME: Improve the user log system
@@ -32,6 +32,7 @@
 #include <QList>
 #include <QMap>
 #include <QKeySequence>
+#include <QStringList>
 
 #include <iostream>
 #include <memory>
@@ -51,6 +52,7 @@ class SkyMap;
 class SkyMapComposite;
 class SkyObject;
 class ObservingList;
+class StartupTaskGraph;
 class TimeZoneRule;
 
 #ifdef KSTARS_LITE
@@ -409,6 +411,9 @@ class KStarsData : public QObject
          */
         bool readCityData();
 
+        /** Add the elevation column to the city table of "mycitydb.sqlite" created by older versions. */
+        void upgradeCityDatabase();
+
         /** Read the data file that contains daylight savings time rules. */
         bool readTimeZoneRulebook();
 
@@ -458,6 +463,16 @@ class KStarsData : public QObject
          */
         bool readURLData(const QString &url, int type = 0, bool deepOnly = false);
 
+        /**
+         * @short Read the link lines of a URL file, without attaching them to the objects.
+         * Does not touch the sky composite, so it can run on a worker thread.
+         * @return true if the file was successfully read.
+         */
+        bool readURLFile(const QString &urlfile, QStringList &lines);
+
+        /** @short Attach the links read by readURLFile() to their objects. @see readURLData() */
+        void applyURLData(const QStringList &lines, int type = 0, bool deepOnly = false);
+
         /**
          * @short open a file containing URL links.
          * @param urlfile string representation of the filename to open
@@ -517,5 +532,8 @@ class KStarsData : public QObject
         quint32 m_preUpdateNumID, m_updateNumID;
         KSNumbers m_preUpdateNum, m_updateNum;
 
+        // Loaders of initialize(), deferred ones may still run after it returned
+        std::unique_ptr<StartupTaskGraph> m_StartupTasks;
+
         static KStarsData *pinstance;
 };
@@ -22,6 +22,7 @@
 #include "colorscheme.h"
 #include "eyepiecefield.h"
 #include "imageexporter.h"
+#include "ksprofiler.h"
 #include "ksdssdownloader.h"
 #include "kstarsdata.h"
 #include "observinglist.h"
@@ -1049,3 +1050,23 @@ void KStars::openFITS(const QUrl &imageURL)
     fv->loadFile(imageURL);
 #endif
 }
+
+void KStars::setProfilingEnabled(bool enabled)
+{
+    KSProfiler::Instance()->setEnabled(enabled);
+}
+
+void KStars::clearProfiling()
+{
+    KSProfiler::Instance()->clear();
+}
+
+QString KStars::getProfilingStatistics()
+{
+    return QJsonDocument(KSProfiler::Instance()->statistics()).toJson(QJsonDocument::Indented);
+}
+
+bool KStars::writeProfilingTrace(const QString &filename)
+{
+    return KSProfiler::Instance()->writeTrace(filename);
+}
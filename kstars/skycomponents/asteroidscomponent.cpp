@@ -21,6 +21,7 @@
 #include "kstars.h"
 #endif
 #include "ksfilereader.h"
+#include "ksrecordparser.h"
 #include "kstarsdata.h"
 #include "Options.h"
 #include "solarsystemcomposite.h"
@@ -98,39 +99,18 @@ void AsteroidsComponent::loadDataFromText()
 
     emitProgressText(i18n("Loading asteroids"));
 
-    QList<QPair<QString, KSParser::DataTypes>> sequence;
-    sequence.append(qMakePair(QString("full name"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("epoch_mjd"), KSParser::D_INT));
-    sequence.append(qMakePair(QString("q"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("a"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("e"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("i"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("w"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("om"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("ma"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("tp_calc"), KSParser::D_SKIP));
-    sequence.append(qMakePair(QString("orbit_id"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("H"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("G"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("neo"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("tp_calc"), KSParser::D_SKIP));
-    sequence.append(qMakePair(QString("M2"), KSParser::D_SKIP));
-    sequence.append(qMakePair(QString("diameter"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("extent"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("albedo"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("rot_period"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("per_y"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("moid"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("class"), KSParser::D_QSTRING));
-
-    KSParser asteroid_parser(filepath_txt, '#', sequence);
-
-    QHash<QString, QVariant> row_content;
-    while (asteroid_parser.HasNextRow())
+    KSRecordParser::Text full_name_field, orbit_id_field, neo_field, extent_field, class_field;
+
+    KSRecordParser asteroid_parser(filepath_txt, '#',
+    {
+        &full_name_field, &mJD, &q, &a, &e, &dble_i, &dble_w, &dble_N, &dble_M, {} /* tp_calc */,
+        &orbit_id_field, &H, &G, &neo_field, {} /* M1 */, {} /* M2 */, &diameter, &extent_field, &albedo,
+        &rot_period, &period, &earth_moid, &class_field
+    });
+
+    while (asteroid_parser.readRow())
     {
-        row_content = asteroid_parser.ReadNextRow();
-        full_name   = row_content["full name"].toString();
-        full_name   = full_name.trimmed();
+        full_name   = full_name_field.trimmed().toString();
         int catN    = full_name.section(' ', 0, 0).toInt();
 
         name = full_name.section(' ', 1, -1);
@@ -140,25 +120,10 @@ void AsteroidsComponent::loadDataFromText()
                 name == i18nc("Asteroid name (optional)", "Asterope"))
             name += i18n(" (Asteroid)");
 
-        mJD         = row_content["epoch_mjd"].toInt();
-        q           = row_content["q"].toDouble();
-        a           = row_content["a"].toDouble();
-        e           = row_content["e"].toDouble();
-        dble_i      = row_content["i"].toDouble();
-        dble_w      = row_content["w"].toDouble();
-        dble_N      = row_content["om"].toDouble();
-        dble_M      = row_content["ma"].toDouble();
-        orbit_id    = row_content["orbit_id"].toString();
-        H           = row_content["H"].toDouble();
-        G           = row_content["G"].toDouble();
-        neo         = row_content["neo"].toString() == "Y";
-        diameter    = row_content["diameter"].toFloat();
-        dimensions  = row_content["extent"].toString();
-        albedo      = row_content["albedo"].toFloat();
-        rot_period  = row_content["rot_period"].toFloat();
-        period      = row_content["per_y"].toFloat();
-        earth_moid  = row_content["moid"].toDouble();
-        orbit_class = row_content["class"].toString();
+        orbit_id    = orbit_id_field.toString();
+        neo         = neo_field.latin1() == QLatin1String("Y");
+        dimensions  = extent_field.toString();
+        orbit_class = class_field.toString();
 
         JD = static_cast<double>(mJD) + 2400000.5;
 
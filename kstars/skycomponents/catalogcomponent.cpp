@@ -23,6 +23,42 @@
 #include "skyobjects/starobject.h"
 #include "skyobjects/deepskyobject.h"
 #include "skycomponents/deepskycomponent.h"
+#include "skycomponents/skymesh.h"
+#include "htmesh/MeshIterator.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+
+#include <algorithm>
+
+namespace
+{
+// Brings the coordinates of a star or deep-sky object up to date
+template <typename T>
+void updateObject(T *obj, KStarsData *data)
+{
+    if (obj->updateID != data->updateID())
+    {
+        obj->updateID = data->updateID();
+        if (obj->updateNumID != data->updateNumID())
+        {
+            obj->updateCoords(data->updateNum());
+        }
+        obj->EquatorialToHorizontal(data->lst(), data->geo()->lat());
+    }
+}
+
+// Catalogs hold stars (type 0) or deep-sky objects
+void updateObject(SkyObject *obj, KStarsData *data)
+{
+    if (obj->type() == 0)
+        updateObject(static_cast<StarObject *>(obj), data);
+    else
+        updateObject(static_cast<DeepSkyObject *>(obj), data);
+}
+}
 
 CatalogComponent::CatalogComponent(SkyComposite *parent, const QString &catname, bool showerrs, int index,
                                    bool callLoadData)
@@ -63,9 +99,43 @@ void CatalogComponent::_loadData(bool includeCatalogDesignation)
     else
         emitProgressText(i18n("Loading internal catalog: %1", m_catName));
 
+    CatalogDB *db = KStarsData::Instance()->catalogdb();
+
+    m_IncludeCatalogDesignation = includeCatalogDesignation;
+    m_CatalogID = db->FindCatalog(m_catName);
+    m_TrixelIndex.clear();
+    m_NameIndex.clear();
+    m_Pending.clear();
+
+#ifndef KSTARS_LITE
+    if (m_LoadByTrixel)
+    {
+        QVector<CatalogDB::ObjectName> names;
+        db->GetObjectNames(m_catName, names, includeCatalogDesignation);
+
+        // Objects without a stored trixel can only be found by loading the whole catalog
+        auto unindexed = std::find_if(names.constBegin(), names.constEnd(),
+                                      [](const CatalogDB::ObjectName & name)
+        {
+            return name.trixel < 0;
+        });
+        if (!names.isEmpty() && unindexed == names.constEnd())
+        {
+            loadNames(names);
+            loadCatalogData();
+            return;
+        }
+    }
+#endif
+
     QList<QPair<int, QString>> names;
+    QVector<int> trixels;
+
+    db->GetAllObjects(m_catName, m_ObjectList, names, this, includeCatalogDesignation, &trixels);
+    m_ObjectCount = m_ObjectList.size();
 
-    KStarsData::Instance()->catalogdb()->GetAllObjects(m_catName, m_ObjectList, names, this, includeCatalogDesignation);
+    for (int i = 0; i < m_ObjectList.size(); i++)
+        indexObject(m_ObjectList[i], trixels[i]);
 
     for (const auto &name : names)
     {
@@ -141,6 +211,61 @@ void CatalogComponent::_loadData(bool includeCatalogDesignation)
     for (auto &list : objectNames())
         list.removeDuplicates();
 
+    loadCatalogData();
+}
+
+void CatalogComponent::loadNames(const QVector<CatalogDB::ObjectName> &names)
+{
+    m_ObjectCount = names.size();
+    m_Pending.resize(SkyMesh::Instance()->size());
+
+    // Names already listed, by type
+    QHash<int, QSet<QString>> listed;
+    for (const auto &object : names)
+    {
+        if (object.trixel < m_Pending.size())
+            m_Pending.setBit(object.trixel);
+
+        // The long name defaults to the name, like in SkyObject::setLongName()
+        QStringList designations;
+        if (!object.name.isEmpty())
+            designations << object.name;
+        if (!object.longname.isEmpty() && object.longname != object.name)
+            designations << object.longname;
+
+        for (const QString &name : designations)
+            m_NameIndex[name.toLower()] = object.trixel;
+
+        if (object.type > SkyObject::TYPE_UNKNOWN)
+            continue;
+
+        QVector<QPair<QString, const SkyObject *>> &objects = objectLists(object.type);
+        auto it = listed.find(object.type);
+        if (it == listed.end())
+        {
+            it = listed.insert(object.type, QSet<QString>());
+            for (const auto &entry : objects)
+                it.value().insert(entry.first);
+        }
+
+        for (const QString &name : designations)
+        {
+            objectNames(object.type).append(name);
+            // The objects are created on demand, see SkyComponent::objectLists()
+            if (!it.value().contains(name))
+            {
+                objects.append(QPair<QString, const SkyObject *>(name, nullptr));
+                it.value().insert(name);
+            }
+        }
+    }
+
+    for (auto &list : objectNames())
+        list.removeDuplicates();
+}
+
+void CatalogComponent::loadCatalogData()
+{
     CatalogData loaded_catalog_data;
     KStarsData::Instance()->catalogdb()->GetCatalogData(m_catName, loaded_catalog_data);
     m_catColor    = loaded_catalog_data.color;
@@ -148,45 +273,130 @@ void CatalogComponent::_loadData(bool includeCatalogDesignation)
     m_catFluxUnit = loaded_catalog_data.fluxunit;
 }
 
+void CatalogComponent::materialize(Trixel trixel)
+{
+    if (trixel >= m_Pending.size() || !m_Pending.testBit(trixel))
+        return;
+    m_Pending.clearBit(trixel);
+
+    QList<SkyObject *> objects;
+    KStarsData::Instance()->catalogdb()->GetTrixelObjects(m_CatalogID, trixel, objects, this,
+                                                          m_IncludeCatalogDesignation);
+    for (SkyObject *obj : objects)
+    {
+        m_ObjectList.append(obj);
+        indexObject(obj, trixel);
+    }
+}
+
+void CatalogComponent::indexObject(SkyObject *obj, Trixel trixel)
+{
+    if (trixel < 0)
+        trixel = SkyMesh::Instance()->index(obj);
+    m_TrixelIndex[trixel].append(obj);
+
+    for (const QString &name : QStringList() << obj->name() << obj->longname())
+    {
+        if (!name.isEmpty())
+            m_ObjectHash.insert(name.toLower(), obj);
+    }
+}
+
+void CatalogComponent::unindexObject(SkyObject *obj)
+{
+    auto it = m_TrixelIndex.find(SkyMesh::Instance()->index(obj));
+    if (it != m_TrixelIndex.end())
+        it.value().removeAll(obj);
+
+    for (const QString &name : QStringList() << obj->name() << obj->longname())
+    {
+        if (m_ObjectHash.value(name.toLower()) == obj)
+            m_ObjectHash.remove(name.toLower());
+    }
+}
+
 void CatalogComponent::update(KSNumbers *)
 {
-    if (selected())
+    if (!selected())
+        return;
+
+    KStarsData *data = KStarsData::Instance();
+#ifdef KSTARS_LITE
+    // The nodes of the catalog are updated from the objects at once
+    for (SkyObject *obj : m_ObjectList)
+        updateObject(obj, data);
+#else
+    // Only the objects of the visible trixels, the others are updated when they are searched
+    QMutexLocker locker(&m_Mutex);
+    MeshIterator region(SkyMesh::Instance(), DRAW_BUF);
+    while (region.hasNext())
     {
-        KStarsData *data = KStarsData::Instance();
-        foreach (SkyObject *obj, m_ObjectList)
+        Trixel trixel = region.next();
+        materialize(trixel);
+        updateTrixel(trixel, data);
+    }
+#endif
+    this->updateID = data->updateID();
+}
+
+void CatalogComponent::updateTrixel(Trixel trixel, KStarsData *data)
+{
+    auto it = m_TrixelIndex.constFind(trixel);
+    if (it == m_TrixelIndex.constEnd())
+        return;
+
+    for (SkyObject *obj : it.value())
+        updateObject(obj, data);
+}
+
+SkyObject *CatalogComponent::findByName(const QString &name)
+{
+    const QString key = name.toLower();
+
+    // Lookups also run on worker threads, e.g. in What's Interesting
+    QMutexLocker locker(&m_Mutex);
+    auto it = m_NameIndex.constFind(key);
+    if (it != m_NameIndex.constEnd())
+        materialize(it.value());
+
+    SkyObject *obj = m_ObjectHash.value(key);
+    // Coordinates are only updated on the GUI thread, which draws them
+    if (obj != nullptr && QThread::currentThread() == QCoreApplication::instance()->thread())
+        updateObject(obj, KStarsData::Instance());
+    return obj;
+}
+
+SkyObject *CatalogComponent::objectNearest(SkyPoint *p, double &maxrad)
+{
+    if (!selected())
+        return nullptr;
+
+    KStarsData *data = KStarsData::Instance();
+    SkyObject *oBest = nullptr;
+
+    // The aperture around p is set by SkyMapComposite::objectNearest()
+    QMutexLocker locker(&m_Mutex);
+    MeshIterator region(SkyMesh::Instance(), OBJ_NEAREST_BUF);
+    while (region.hasNext())
+    {
+        Trixel id = region.next();
+        materialize(id);
+        auto trixel = m_TrixelIndex.constFind(id);
+        if (trixel == m_TrixelIndex.constEnd())
+            continue;
+
+        for (SkyObject *obj : trixel.value())
         {
-            DeepSkyObject *dso = dynamic_cast<DeepSkyObject *>(obj);
-            StarObject *so     = dynamic_cast<StarObject *>(obj);
-            Q_ASSERT(dso || so); // We either have stars, or deep sky objects
-            if (dso)
+            updateObject(obj, data);
+            double r = obj->angularDistanceTo(p).Degrees();
+            if (r < maxrad)
             {
-                // Update the deep sky object if need be
-                if (dso->updateID != data->updateID())
-                {
-                    dso->updateID = data->updateID();
-                    if (dso->updateNumID != data->updateNumID())
-                    {
-                        dso->updateCoords(data->updateNum());
-                    }
-                    dso->EquatorialToHorizontal(data->lst(), data->geo()->lat());
-                }
-            }
-            else
-            {
-                // Do exactly the same thing for stars
-                if (so->updateID != data->updateID())
-                {
-                    so->updateID = data->updateID();
-                    if (so->updateNumID != data->updateNumID())
-                    {
-                        so->updateCoords(data->updateNum());
-                    }
-                    so->EquatorialToHorizontal(data->lst(), data->geo()->lat());
-                }
+                oBest  = obj;
+                maxrad = r;
             }
         }
-        this->updateID = data->updateID();
     }
+    return oBest;
 }
 
 void CatalogComponent::draw(SkyPainter *skyp)
@@ -197,12 +407,9 @@ void CatalogComponent::draw(SkyPainter *skyp)
     skyp->setBrush(Qt::NoBrush);
     skyp->setPen(QColor(m_catColor));
 
-    // Check if the coordinates have been updated
-    if (updateID != KStarsData::Instance()->updateID())
-        update(nullptr);
+    KStarsData *data = KStarsData::Instance();
 
     //Draw Custom Catalog objects
-    // FIXME: Improve using HTM!
 
     // N.B. Calls to Options::foo() don't might not get optimized to
     // inlining and so we should call them outside the loop for speed.
@@ -211,35 +418,50 @@ void CatalogComponent::draw(SkyPainter *skyp)
     auto sizeRescaling = dms::PI * zoomFactor / 10800.0;
     bool showUnknownMagObjects = Options::showUnknownMagObjects();
 
-    foreach (SkyObject *obj, m_ObjectList)
+    QMutexLocker locker(&m_Mutex);
+    MeshIterator region(SkyMesh::Instance(), DRAW_BUF);
+    while (region.hasNext())
     {
-        if (obj->type() == 0)
-        {
-            StarObject *starobj = static_cast<StarObject *>(obj);
-            // FIXME SKYPAINTER
-            skyp->drawPointSource(starobj, starobj->mag(), starobj->spchar());
-        }
-        else
+        Trixel id = region.next();
+        materialize(id);
+        auto trixel = m_TrixelIndex.constFind(id);
+        if (trixel == m_TrixelIndex.constEnd())
+            continue;
+
+        for (SkyObject *obj : trixel.value())
         {
-            // FIXME: this PA calc is totally different from the one that was
-            // in DeepSkyComponent which is now in SkyPainter .... O_o
-            //      --hdevalence
-            // PA for Deep-Sky objects is 90 + PA because major axis is
-            // horizontal at PA=0
-            // double pa = 90. + map->findPA( dso, o.x(), o.y() );
-            //
-            // ^ Not sure if above is still valid -- asimha 2016/08/16
-            DeepSkyObject *dso = static_cast<DeepSkyObject *>(obj);
-
-            // N.B. Code duplicated from DeepSkyComponent::draw()
-            float mag = dso->mag();
-            float size = dso->a() * sizeRescaling;
-            bool sizeCriterion = (size > 1.0 || zoomFactor > 2000.);
-            bool magCriterion  = (mag < maglim) || (showUnknownMagObjects && (std::isnan(mag) || mag > 36.0));
-            if (sizeCriterion && magCriterion)
-                skyp->drawDeepSkyObject(dso, true);
+            // All objects of the visible trixels are kept up to date, drawn or not
+            updateObject(obj, data);
+
+            if (obj->type() == 0)
+            {
+                StarObject *starobj = static_cast<StarObject *>(obj);
+                // FIXME SKYPAINTER
+                skyp->drawPointSource(starobj, starobj->mag(), starobj->spchar());
+            }
+            else
+            {
+                // FIXME: this PA calc is totally different from the one that was
+                // in DeepSkyComponent which is now in SkyPainter .... O_o
+                //      --hdevalence
+                // PA for Deep-Sky objects is 90 + PA because major axis is
+                // horizontal at PA=0
+                // double pa = 90. + map->findPA( dso, o.x(), o.y() );
+                //
+                // ^ Not sure if above is still valid -- asimha 2016/08/16
+                DeepSkyObject *dso = static_cast<DeepSkyObject *>(obj);
+
+                // N.B. Code duplicated from DeepSkyComponent::draw()
+                float mag = dso->mag();
+                float size = dso->a() * sizeRescaling;
+                bool sizeCriterion = (size > 1.0 || zoomFactor > 2000.);
+                bool magCriterion  = (mag < maglim) || (showUnknownMagObjects && (std::isnan(mag) || mag > 36.0));
+                if (sizeCriterion && magCriterion)
+                    skyp->drawDeepSkyObject(dso, true);
+            }
         }
     }
+    this->updateID = data->updateID();
 }
 
 bool CatalogComponent::getVisibility()
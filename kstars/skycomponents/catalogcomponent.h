@@ -17,9 +17,17 @@
 
 #pragma once
 
+#include "catalogdb.h"
 #include "listcomponent.h"
 #include "Options.h"
+#include "typedef.h"
 
+#include <QBitArray>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
+class KStarsData;
 struct stat;
 
 /**
@@ -51,8 +59,20 @@ class CatalogComponent : public ListComponent
      */
     void draw(SkyPainter *skyp) override;
 
+    /**
+     * @short Update the coordinates of the objects of the visible trixels.
+     * Other objects are updated when they are found by name or searched with objectNearest().
+     * KStars Lite updates all objects.
+     */
     void update(KSNumbers *num) override;
 
+    SkyObject *findByName(const QString &name) override;
+
+    SkyObject *objectNearest(SkyPoint *p, double &maxrad) override;
+
+    /** @return the number of objects of the catalog when it was loaded, created or not */
+    inline int objectCount() const { return m_ObjectCount; }
+
     /** @return the name of the catalog */
     inline QString name() const { return m_catName; }
 
@@ -88,13 +108,52 @@ class CatalogComponent : public ListComponent
     /** @short Load data into custom catalog */
     virtual void loadData() { _loadData(true); }
 
-    /** @short Load data into custom catalog */
+    /**
+     * @short Load data into custom catalog
+     *
+     * Only the names of the objects are read, the objects of a trixel are created when the
+     * trixel is drawn or searched, or one of its objects is found by name. Catalogs whose
+     * trixels are not stored, synced catalogs and KStars Lite create all objects at once.
+     */
     virtual void _loadData(bool includeCatalogDesignation);
 
+    /** @short Create the objects of a trixel if they are not created yet */
+    void materialize(Trixel trixel);
+
+    /**
+     * @short Add an object to the trixel index used for drawing
+     * @p trixel the trixel of the object, computed if it is negative
+     */
+    void indexObject(SkyObject *obj, Trixel trixel = -1);
+
+    /** @short Remove an object from the trixel index */
+    void unindexObject(SkyObject *obj);
+
+    /** @short Update the coordinates of the objects of a trixel */
+    void updateTrixel(Trixel trixel, KStarsData *data);
+
     // FIXME: There seems to be no way to remove catalogs from the program. -- asimha
 
     QString m_catName, m_catColor, m_catFluxFreq, m_catFluxUnit;
     bool m_Showerrs { false };
     int m_ccIndex { 0 };
     quint32 updateID { 0 };
+    // Objects of m_ObjectList by trixel, only the visible trixels are drawn and updated every frame
+    QHash<Trixel, QVector<SkyObject *>> m_TrixelIndex;
+    // Whether objects may be created per trixel, synced catalogs are edited at run time and keep all objects
+    bool m_LoadByTrixel { true };
+
+  private:
+    void loadNames(const QVector<CatalogDB::ObjectName> &names);
+    void loadCatalogData();
+
+    int m_CatalogID { -1 };
+    int m_ObjectCount { 0 };
+    bool m_IncludeCatalogDesignation { true };
+    // Trixels whose objects are not created yet
+    QBitArray m_Pending;
+    // Trixel of the objects, by lower case name
+    QHash<QString, Trixel> m_NameIndex;
+    // Objects are also created by lookups on worker threads
+    QMutex m_Mutex;
 };
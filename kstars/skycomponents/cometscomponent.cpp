@@ -21,6 +21,7 @@
 #include "kstars.h"
 #endif
 #include "ksfilereader.h"
+#include "ksrecordparser.h"
 #include "kspaths.h"
 #include "kstarsdata.h"
 #include "ksutils.h"
@@ -99,70 +100,33 @@ void CometsComponent::loadData()
     objectNames(SkyObject::COMET).clear();
     objectLists(SkyObject::COMET).clear();
 
-    QList<QPair<QString, KSParser::DataTypes>> sequence;
-    sequence.append(qMakePair(QString("full name"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("epoch_mjd"), KSParser::D_INT));
-    sequence.append(qMakePair(QString("q"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("e"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("i"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("w"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("om"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("tp_calc"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("orbit_id"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("neo"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("M1"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("M2"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("diameter"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("extent"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("albedo"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("rot_period"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("per_y"), KSParser::D_FLOAT));
-    sequence.append(qMakePair(QString("moid"), KSParser::D_DOUBLE));
-    sequence.append(qMakePair(QString("class"), KSParser::D_QSTRING));
-    sequence.append(qMakePair(QString("H"), KSParser::D_SKIP));
-    sequence.append(qMakePair(QString("G"), KSParser::D_SKIP));
+    bool neo;
+    double q, e, dble_i, dble_w, dble_N, Tp, earth_moid;
+    float M1, M2, K1, K2, diameter, albedo, rot_period, period;
+    KSRecordParser::Text name_field, orbit_id_field, neo_field, extent_field, class_field;
 
     QString file_name = KSPaths::locate(QStandardPaths::GenericDataLocation, QString("comets.dat"));
-    KSParser cometParser(file_name, '#', sequence);
+    KSRecordParser cometParser(file_name, '#',
+    {
+        &name_field, {} /* epoch_mjd */, &q, &e, &dble_i, &dble_w, &dble_N, &Tp, &orbit_id_field, &neo_field, &M1, &M2,
+        &diameter, &extent_field, &albedo, &rot_period, &period, &earth_moid, &class_field, &K1, &K2
+    });
 
-    QHash<QString, QVariant> row_content;
-    while (cometParser.HasNextRow())
+    while (cometParser.readRow())
     {
         KSComet *com = nullptr;
-        row_content  = cometParser.ReadNextRow();
-        name         = row_content["full name"].toString();
-        name         = name.trimmed();
-        bool neo;
-        double q, e, dble_i, dble_w, dble_N, Tp, earth_moid;
-        float M1, M2, K1, K2, diameter, albedo, rot_period, period;
-        q            = row_content["q"].toDouble();
-        e            = row_content["e"].toDouble();
-        dble_i       = row_content["i"].toDouble();
-        dble_w       = row_content["w"].toDouble();
-        dble_N       = row_content["om"].toDouble();
-        Tp           = row_content["tp_calc"].toDouble();
-        orbit_id     = row_content["orbit_id"].toString();
-        neo          = row_content["neo"] == "Y";
-
-        if (row_content["M1"].toFloat() == 0.0)
+        name         = name_field.trimmed().toString();
+        orbit_id     = orbit_id_field.toString();
+        neo          = neo_field.latin1() == QLatin1String("Y");
+
+        if (M1 == 0.0)
             M1 = 101.0;
-        else
-            M1 = row_content["M1"].toFloat();
 
-        if (row_content["M2"].toFloat() == 0.0)
+        if (M2 == 0.0)
             M2 = 101.0;
-        else
-            M2 = row_content["M2"].toFloat();
-
-        diameter    = row_content["diameter"].toFloat();
-        dimensions  = row_content["extent"].toString();
-        albedo      = row_content["albedo"].toFloat();
-        rot_period  = row_content["rot_period"].toFloat();
-        period      = row_content["per_y"].toFloat();
-        earth_moid  = row_content["moid"].toDouble();
-        orbit_class = row_content["class"].toString();
-        K1          = row_content["H"].toFloat();
-        K2          = row_content["G"].toFloat();
+
+        dimensions  = extent_field.toString();
+        orbit_class = class_field.toString();
 
         com = new KSComet(name, QString(), q, e, dms(dble_i), dms(dble_w), dms(dble_N), Tp, M1, M2, K1, K2);
         com->setOrbitID(orbit_id);
@@ -33,6 +33,21 @@
 
 #include <QHash>
 
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// The boundaries run along constant RA and Dec, so the lookup grid uses the same coordinates
+// as the polygons instead of HTM trixels, whose edges are great circles.
+constexpr int cellsPerHour   = 20;
+constexpr int cellsPerDegree = 2;
+constexpr int cellColumns    = 24 * cellsPerHour;
+constexpr int cellRows       = 180 * cellsPerDegree;
+// Widens boundary cells so points on a cell edge never see an unmarked boundary
+constexpr double cellEpsilon = 1e-9;
+}
+
 ConstellationBoundaryLines::ConstellationBoundaryLines(SkyComposite *parent)
     : NoPrecessIndex(parent, i18n("Constellation Boundaries"))
 {
@@ -87,7 +102,10 @@ ConstellationBoundaryLines::ConstellationBoundaryLines(SkyComposite *parent)
             lineList.reset();
 
             if (polyList.get())
+            {
                 appendPoly(polyList, idxFile, verbose);
+                m_polyLists.append(polyList);
+            }
             QString cName = line.mid(1);
             polyList.reset(new PolyList(cName));
             if (verbose == -1)
@@ -147,7 +165,12 @@ ConstellationBoundaryLines::ConstellationBoundaryLines(SkyComposite *parent)
     if (lineList.get())
         appendLine(lineList);
     if (polyList.get())
+    {
         appendPoly(polyList, idxFile, verbose);
+        m_polyLists.append(polyList);
+    }
+
+    buildCellOwners();
 }
 
 bool ConstellationBoundaryLines::selected()
@@ -203,10 +226,126 @@ void ConstellationBoundaryLines::appendPoly(const std::shared_ptr<PolyList> &pol
         printf("PolyList: %3d: %d\n", ++m_polyIndexCnt, indexHash.size());
 }
 
+void ConstellationBoundaryLines::buildCellOwners()
+{
+    // quint8 owners
+    if (m_polyLists.isEmpty() || m_polyLists.size() > 255)
+        return;
+
+    const double cellWidth  = 1.0 / cellsPerHour;
+    const double cellHeight = 1.0 / cellsPerDegree;
+
+    // Cells touched by an edge keep the polygon test
+    std::vector<bool> boundary(cellColumns * cellRows, false);
+    auto markEdge = [&](double x1, double y1, double x2, double y2)
+    {
+        if (std::max(x1, x2) + cellEpsilon < 0 || std::min(x1, x2) - cellEpsilon > 24.0)
+            return;
+
+        const int firstRow = std::max(0, int(std::floor((std::min(y1, y2) - cellEpsilon + 90.0) * cellsPerDegree)));
+        const int lastRow  = std::min(cellRows - 1, int(std::floor((std::max(y1, y2) + cellEpsilon + 90.0) * cellsPerDegree)));
+        for (int row = firstRow; row <= lastRow; row++)
+        {
+            // Part of the edge inside this row
+            double left = std::min(x1, x2), right = std::max(x1, x2);
+            if (y1 != y2)
+            {
+                const double bottom = -90.0 + row * cellHeight - cellEpsilon;
+                const double top    = bottom + cellHeight + 2 * cellEpsilon;
+                double t1 = (bottom - y1) / (y2 - y1), t2 = (top - y1) / (y2 - y1);
+                if (t1 > t2)
+                    std::swap(t1, t2);
+                t1 = std::max(t1, 0.0);
+                t2 = std::min(t2, 1.0);
+                left  = std::min(x1 + t1 * (x2 - x1), x1 + t2 * (x2 - x1));
+                right = std::max(x1 + t1 * (x2 - x1), x1 + t2 * (x2 - x1));
+            }
+
+            const int firstColumn = std::max(0, int(std::floor((left - cellEpsilon) * cellsPerHour)));
+            const int lastColumn  = std::min(cellColumns - 1, int(std::floor((right + cellEpsilon) * cellsPerHour)));
+            for (int column = firstColumn; column <= lastColumn; column++)
+                boundary[row * cellColumns + column] = true;
+        }
+    };
+
+    for (const auto &polyList : m_polyLists)
+    {
+        const QPolygonF &poly = *polyList->poly();
+        for (int i = 0; i < poly.size(); i++)
+        {
+            // containsPoint() closes the polygon
+            const QPointF &a = poly[i];
+            const QPointF &b = poly[(i + 1) % poly.size()];
+            markEdge(a.x(), a.y(), b.x(), b.y());
+            // ContainingPoly() tests RA > 12h against the negative RAs of wrapped polygons
+            if (polyList->wrapRA())
+                markEdge(a.x() + 24.0, a.y(), b.x() + 24.0, b.y());
+        }
+    }
+
+    // The switch to the wrapped RA happens inside this column
+    for (int row = 0; row < cellRows; row++)
+        boundary[row * cellColumns + 12 * cellsPerHour] = true;
+
+    // The remaining cells do not touch any edge, so their centre decides for the whole cell.
+    // Scan each row of centres with the even-odd rule of containsPoint().
+    m_cellOwner.fill(0, cellColumns * cellRows);
+    std::vector<std::vector<double>> crossings(m_polyLists.size());
+    for (int row = 0; row < cellRows; row++)
+    {
+        const double y = -90.0 + (row + 0.5) * cellHeight;
+
+        for (int p = 0; p < m_polyLists.size(); p++)
+        {
+            const QPolygonF &poly = *m_polyLists[p]->poly();
+            crossings[p].clear();
+            for (int i = 0; i < poly.size(); i++)
+            {
+                const QPointF &a = poly[i];
+                const QPointF &b = poly[(i + 1) % poly.size()];
+                if ((a.y() <= y) != (b.y() <= y))
+                    crossings[p].push_back(a.x() + (y - a.y()) * (b.x() - a.x()) / (b.y() - a.y()));
+            }
+            std::sort(crossings[p].begin(), crossings[p].end());
+        }
+
+        for (int column = 0; column < cellColumns; column++)
+        {
+            const int cell = row * cellColumns + column;
+            if (boundary[cell])
+                continue;
+
+            const double x = (column + 0.5) * cellWidth;
+            for (int p = 0; p < m_polyLists.size(); p++)
+            {
+                if (crossings[p].empty())
+                    continue;
+
+                const double testX = (x > 12.0 && m_polyLists[p]->wrapRA()) ? x - 24.0 : x;
+                const auto left = std::lower_bound(crossings[p].begin(), crossings[p].end(), testX) - crossings[p].begin();
+                if (left % 2 == 1)
+                {
+                    m_cellOwner[cell] = p + 1;
+                    break;
+                }
+            }
+        }
+    }
+}
+
 PolyList *ConstellationBoundaryLines::ContainingPoly(SkyPoint *p)
 {
     //printf("called ContainingPoly(p)\n");
 
+    if (!m_cellOwner.isEmpty())
+    {
+        const int column = qBound(0, int(p->ra().Hours() * cellsPerHour), cellColumns - 1);
+        const int row    = qBound(0, int((p->dec().Degrees() + 90.0) * cellsPerDegree), cellRows - 1);
+        const quint8 owner = m_cellOwner[row * cellColumns + column];
+        if (owner)
+            return m_polyLists[owner - 1].get();
+    }
+
     // we save the pointers in a hash because most often there is only one
     // constellation and we can avoid doing the expensive boundary calculations
     // and just return it if we know it is unique.  We can avoid this minor
@@ -218,6 +357,7 @@ PolyList *ConstellationBoundaryLines::ContainingPoly(SkyPoint *p)
 
     //printf("\n");
 
+    // Close to a boundary, test the polygons around p
     // the boundaries don't precess so we use index() not aperture()
     m_skyMesh->index(p, 1.0, IN_CONSTELL_BUF);
     MeshIterator region(m_skyMesh, IN_CONSTELL_BUF);
@@ -52,6 +52,10 @@ class ConstellationBoundaryLines : public NoPrecessIndex
     explicit ConstellationBoundaryLines(SkyComposite *parent);
     virtual ~ConstellationBoundaryLines() override = default;
 
+    /**
+     * @return the (optionally localized) name of the constellation containing p.
+     * Points away from the boundaries are found with a single table lookup.
+     */
     QString constellationName(SkyPoint *p);
 
     bool selected() override;
@@ -70,7 +74,19 @@ class ConstellationBoundaryLines : public NoPrecessIndex
 
     PolyList *ContainingPoly(SkyPoint *p);
 
+    /**
+     * @short fills m_cellOwner from the boundary polygons.
+     * The sky is divided into a grid of RA/Dec cells. Cells crossed by a boundary are left
+     * at 0, every other cell lies entirely inside one constellation and stores its number.
+     */
+    void buildCellOwners();
+
     SkyMesh *m_skyMesh { nullptr };
     PolyIndex m_polyIndex;
     int m_polyIndexCnt { 0 };
+
+    // All constellations in file order, m_cellOwner stores their index + 1
+    PolyListList m_polyLists;
+    // Owner of each cell, row by row from Dec -90, or 0 if the polygons must be tested
+    QVector<quint8> m_cellOwner;
 };
@@ -32,13 +32,17 @@
 #include "projections/projector.h"
 #include "skyobjects/deepskyobject.h"
 
-DeepSkyComponent::DeepSkyComponent(SkyComposite *parent) : SkyComponent(parent)
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QThread>
+
+DeepSkyComponent::DeepSkyComponent(SkyComposite *parent, std::unique_ptr<DeepSkyStore> store) : SkyComponent(parent)
 {
     m_skyMesh = SkyMesh::Instance();
     // Add labels
     for (int i = 0; i <= MAX_LINENUMBER_MAG; i++)
         m_labelList[i] = new LabelList;
-    loadData();
+    loadData(std::move(store));
 }
 
 DeepSkyComponent::~DeepSkyComponent()
@@ -70,311 +74,185 @@ void DeepSkyComponent::update(KSNumbers *)
 {
 }
 
-void DeepSkyComponent::loadData()
+std::unique_ptr<DeepSkyStore> DeepSkyComponent::openStore()
 {
-    KStarsData *data = KStarsData::Instance();
     //Check whether we need to concatenate a split NGC/IC catalog
     //(i.e., if user has downloaded the Steinicke catalog)
     mergeSplitFiles();
 
-    QList<QPair<QString, KSParser::DataTypes>> sequence;
-    QList<int> widths;
-    sequence.append(qMakePair(QString("Flag"), KSParser::D_QSTRING));
-    widths.append(1);
-
-    sequence.append(qMakePair(QString("ID"), KSParser::D_INT));
-    widths.append(4);
-
-    sequence.append(qMakePair(QString("suffix"), KSParser::D_QSTRING));
-    widths.append(1);
-
-    sequence.append(qMakePair(QString("RA_H"), KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("RA_M"), KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("RA_S"), KSParser::D_FLOAT));
-    widths.append(4);
-
-    sequence.append(qMakePair(QString("D_Sign"), KSParser::D_QSTRING));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("Dec_d"), KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("Dec_m"), KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("Dec_s"), KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("BMag"), KSParser::D_QSTRING));
-    widths.append(6);
-
-    sequence.append(qMakePair(QString("type"), KSParser::D_INT));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("a"), KSParser::D_FLOAT));
-    widths.append(6);
-
-    sequence.append(qMakePair(QString("b"), KSParser::D_FLOAT));
-    widths.append(6);
-
-    sequence.append(qMakePair(QString("pa"), KSParser::D_QSTRING));
-    widths.append(4);
-
-    sequence.append(qMakePair(QString("PGC"), KSParser::D_INT));
-    widths.append(7);
-
-    sequence.append(qMakePair(QString("other cat"), KSParser::D_QSTRING));
-    widths.append(4);
-
-    sequence.append(qMakePair(QString("other1"), KSParser::D_QSTRING));
-    widths.append(6);
-
-    sequence.append(qMakePair(QString("other2"), KSParser::D_QSTRING));
-    widths.append(6);
-
-    sequence.append(qMakePair(QString("Messr"), KSParser::D_QSTRING));
-    widths.append(2);
-
-    sequence.append(qMakePair(QString("MessrNum"), KSParser::D_INT));
-    widths.append(4);
-
-    sequence.append(qMakePair(QString("Longname"), KSParser::D_QSTRING));
-    //No width to be appended for last sequence object
-
     QString file_name = KSPaths::locate(QStandardPaths::GenericDataLocation, QString("ngcic.dat"));
-    KSParser deep_sky_parser(file_name, '#', sequence, widths);
-
-    deep_sky_parser.SetProgress(i18n("Loading NGC/IC objects"), 13444, 10);
     qCInfo(KSTARS) << "Loading NGC/IC objects";
 
-    QHash<QString, QVariant> row_content;
-    while (deep_sky_parser.HasNextRow())
+    std::unique_ptr<DeepSkyStore> store(new DeepSkyStore);
+    if (!store->open(file_name, SkyMesh::Instance()))
     {
-        row_content = deep_sky_parser.ReadNextRow();
-
-        QString iflag;
-        QString cat;
-        iflag = row_content["Flag"].toString().mid(0, 1); //check for NGC/IC catalog flag
-        /*
-        Q_ASSERT(iflag == "I" || iflag == "N" || iflag == " ");
-        // (spacetime): ^ Why an assert? Change in implementation of ksparser
-        //  might result in crash for no reason.
-        // n.b. We also allow non-NGC/IC objects which have a blank iflag
-        */
-
-        float mag(1000.0);
-        int type, ingc, imess(-1), pa;
-        int pgc, ugc;
-        QString ss, name, name2, longname;
-        QString cat2;
-
-        // Designation
-        if (iflag == "I")
-            cat = "IC";
-        else if (iflag == "N")
-            cat = "NGC";
-
-        ingc = row_content["ID"].toInt(); // NGC/IC catalog number
-        if (ingc == 0)
-            cat.clear(); //object is not in NGC or IC catalogs
-
-        QString suffix = row_content["suffix"].toString(); // multipliticity suffixes, eg: the 'A' in NGC 4945A
-
-        //Q_ASSERT(suffix.isEmpty() || (suffix.isEmpty() == false && suffix.at(0) > 0x40 && suffix.at(0) < 0x7B));
-
-        //coordinates
-        int rah     = row_content["RA_H"].toInt();
-        int ram     = row_content["RA_M"].toInt();
-        double ras  = row_content["RA_S"].toDouble();
-        QString sgn = row_content["D_Sign"].toString();
-        int dd      = row_content["Dec_d"].toInt();
-        int dm      = row_content["Dec_m"].toInt();
-        int ds      = row_content["Dec_s"].toInt();
-
-        if (!((0.0 <= rah && rah < 24.0) || (0.0 <= ram && ram < 60.0) || (0.0 <= ras && ras < 60.0) ||
-              (0.0 <= dd && dd <= 90.0) || (0.0 <= dm && dm < 60.0) || (0.0 <= ds && ds < 60.0)))
-        {
-            qCWarning(KSTARS) << "Bad coordinates while processing NGC/IC object: " << cat << ingc;
-            qCWarning(KSTARS) << "RA H:M:S = " << rah << ":" << ram << ":" << ras << "; Dec D:M:S = " << dd << ":" << dm << ":"
-                     << ds;
-        }
-
-        //Ignore lines with no coordinate values if not debugging
-        if (rah == 0 && ram == 0 && ras == 0)
-            continue;
-
-        //B magnitude
-        ss = row_content["BMag"].toString();
-        if (ss.isEmpty())
-        {
-            mag = 99.9f;
-        }
-        else
-        {
-            mag = ss.toFloat();
-        }
-
-        //object type
-        type = row_content["type"].toInt();
-
-        //major and minor axes
-        float a = row_content["a"].toFloat();
-        float b = row_content["b"].toFloat();
+        qCWarning(KSTARS) << "Cannot load NGC/IC objects from" << file_name;
+        store.reset();
+    }
+    return store;
+}
 
-        //position angle.  The catalog PA is zero when the Major axis
-        //is horizontal.  But we want the angle measured from North, so
-        //we set PA = 90 - pa.
-        ss = row_content["pa"].toString();
-        if (ss.isEmpty())
-        {
-            pa = 90;
-        }
-        else
-        {
-            pa = 90 - ss.toInt();
-        }
+void DeepSkyComponent::loadData(std::unique_ptr<DeepSkyStore> store)
+{
+    m_Store = store ? std::move(store) : openStore();
+    if (!m_Store)
+        return;
 
-        //PGC number
-        pgc = row_content["PGC"].toInt();
+    // Only the names are read now, so the objects can be found by name. The objects of a trixel
+    // are created when it is drawn or searched, or when one of its names is looked up.
+    m_Pending.resize(m_skyMesh->size());
+    for (int i = 0; i < m_Store->size(); i++)
+    {
+        const DeepSkyStore::Record &record = m_Store->record(i);
+        m_Pending.setBit(record.trixel);
+        if (record.hasName)
+            addNames(record, i);
+    }
 
-        //UGC number
-        if (row_content["other cat"].toString().trimmed() == "UGC")
-        {
-            ugc = row_content["other1"].toString().toInt();
-        }
-        else
-        {
-            ugc = 0;
-        }
+#ifdef KSTARS_LITE
+    // The nodes of the trixels are built once from the indexes
+    materializeAll();
+#endif
 
-        //Messier number
-        if (row_content["Messr"].toString().trimmed() == "M")
-        {
-            cat2 = cat;
-            if (ingc == 0)
-                cat2.clear();
-            cat   = 'M';
-            imess = row_content["MessrNum"].toInt();
-        }
+    for (auto &list : objectNames())
+        list.removeDuplicates();
+}
 
-        longname = row_content["Longname"].toString();
+DeepSkyObject *DeepSkyComponent::createObject(const DeepSkyStore::Record &record)
+{
+    QString name;
+    QString longname = QString::fromUtf8(m_Store->string(record.longname));
+    if (record.hasName)
+        name = i18nc("object name (optional)", m_Store->string(record.name));
+    else
+        name = i18nc("object name (optional)", i18n("Unnamed Object").toLatin1().constData());
+    if (!longname.isEmpty())
+        longname = i18nc("object name (optional)", m_Store->string(record.longname));
+
+    dms r;
+    r.setH(record.ra);
+    DeepSkyObject *o = new DeepSkyObject(record.type, r, dms(record.dec), record.mag, name,
+                                         QString::fromUtf8(m_Store->string(record.name2)), longname,
+                                         QString::fromLatin1(m_Store->string(record.catalog)), record.a, record.b,
+                                         record.pa, record.pgc, record.ugc);
+    KStarsData *data = KStarsData::Instance();
+    o->EquatorialToHorizontal(data->lst(), data->geo()->lat());
+    return o;
+}
 
-        dms r;
-        //r.setH(rah, ram, int(ras));
-        r.setH(rah+ram/60.0+ras/3600.0);
-        dms d(dd, dm, ds);
+void DeepSkyComponent::addNames(const DeepSkyStore::Record &record, int index)
+{
+    // Translated like the names of the objects in createObject()
+    const QString name     = i18nc("object name (optional)", m_Store->string(record.name));
+    const QString name2    = QString::fromUtf8(m_Store->string(record.name2));
+    QString longname       = QString::fromUtf8(m_Store->string(record.longname));
+    if (!longname.isEmpty())
+        longname = i18nc("object name (optional)", m_Store->string(record.longname));
+
+    // Add the name(s) to the name index for fast lookup
+    m_NameIndex[name.toLower()] = index;
+    if (!longname.isEmpty())
+        m_NameIndex[longname.toLower()] = index;
+    if (!name2.isEmpty())
+        m_NameIndex[name2.toLower()] = index;
+
+    // The object does not exist yet, SkyObjectListModel resolves it by name when it is selected
+    if (!name.isEmpty())
+    {
+        objectNames(record.type).append(name);
+        objectLists(record.type).append(QPair<QString, SkyObject *>(name, nullptr));
+    }
 
-        if (sgn == "-")
-        {
-            d.setD(-1.0 * d.Degrees());
-        }
+    if (!longname.isEmpty() && longname != name)
+    {
+        objectNames(record.type).append(longname);
+        objectLists(record.type).append(QPair<QString, SkyObject *>(longname, nullptr));
+    }
+}
 
-        bool hasName = true;
-        QString snum;
-        if (cat == "IC" || cat == "NGC")
-        {
-            snum.setNum(ingc);
-            name = cat + ' ' + ((suffix.isEmpty()) ? snum : (snum + suffix));
-        }
-        else if (cat == "M")
-        {
-            snum.setNum(imess);
-            name = cat + ' ' + snum; // Note: Messier has no suffixes
-            if (cat2 == "NGC" || cat2 == "IC")
-            {
-                snum.setNum(ingc);
-                name2 = cat2 + ' ' + ((suffix.isEmpty()) ? snum : (snum + suffix));
-            }
-            else
-            {
-                name2.clear();
-            }
-        }
-        else
-        {
-            if (!longname.isEmpty())
-                name = longname;
-            else
-            {
-                hasName = false;
-                name    = i18n("Unnamed Object");
-            }
-        }
+void DeepSkyComponent::addObject(DeepSkyObject *o, Trixel trixel, bool hasName)
+{
+    const QString name     = o->name();
+    const QString name2    = o->name2();
+    const QString longname = o->longname();
 
-        name = i18nc("object name (optional)", name.toLatin1().constData());
+    // The names were listed by addNames(). Objects without a name are not listed, they cannot be
+    // told apart by name.
+    if (hasName)
+    {
+        nameHash[name.toLower()] = o;
         if (!longname.isEmpty())
-            longname = i18nc("object name (optional)", longname.toLatin1().constData());
-
-        // create new deepskyobject
-        DeepSkyObject *o = nullptr;
-        if (type == 0)
-            type = 1; //Make sure we use CATALOG_STAR, not STAR
-        o = new DeepSkyObject(type, r, d, mag, name, name2, longname, cat, a, b, pa, pgc, ugc);
-        o->EquatorialToHorizontal(data->lst(), data->geo()->lat());
-
-        // Add the name(s) to the nameHash for fast lookup -jbb
-        if (hasName)
-        {
-            nameHash[name.toLower()] = o;
-            if (!longname.isEmpty())
-                nameHash[longname.toLower()] = o;
-            if (!name2.isEmpty())
-                nameHash[name2.toLower()] = o;
-        }
+            nameHash[longname.toLower()] = o;
+        if (!name2.isEmpty())
+            nameHash[name2.toLower()] = o;
+    }
 
-        Trixel trixel = m_skyMesh->index(o);
+    //Assign object to general DeepSkyObjects list,
+    //and a secondary list based on its catalog.
+    m_DeepSkyList.append(o);
+    appendIndex(o, &m_DeepSkyIndex, trixel);
 
-        //Assign object to general DeepSkyObjects list,
-        //and a secondary list based on its catalog.
-        m_DeepSkyList.append(o);
-        appendIndex(o, &m_DeepSkyIndex, trixel);
+    if (o->isCatalogM())
+    {
+        m_MessierList.append(o);
+        appendIndex(o, &m_MessierIndex, trixel);
+    }
+    else if (o->isCatalogNGC())
+    {
+        m_NGCList.append(o);
+        appendIndex(o, &m_NGCIndex, trixel);
+    }
+    else if (o->isCatalogIC())
+    {
+        m_ICList.append(o);
+        appendIndex(o, &m_ICIndex, trixel);
+    }
+    else
+    {
+        m_OtherList.append(o);
+        appendIndex(o, &m_OtherIndex, trixel);
+    }
+}
 
-        if (o->isCatalogM())
-        {
-            m_MessierList.append(o);
-            appendIndex(o, &m_MessierIndex, trixel);
-        }
-        else if (o->isCatalogNGC())
-        {
-            m_NGCList.append(o);
-            appendIndex(o, &m_NGCIndex, trixel);
-        }
-        else if (o->isCatalogIC())
-        {
-            m_ICList.append(o);
-            appendIndex(o, &m_ICIndex, trixel);
-        }
-        else
-        {
-            m_OtherList.append(o);
-            appendIndex(o, &m_OtherIndex, trixel);
-        }
+void DeepSkyComponent::materialize(Trixel trixel)
+{
+    if (trixel >= m_Pending.size() || !m_Pending.testBit(trixel))
+        return;
+    m_Pending.clearBit(trixel);
 
-        // JM: VERY INEFFICIENT. Disabling for now until we figure out how to deal with dups. QSet?
-        //if ( ! name.isEmpty() && !objectNames(type).contains(name))
-        if (!name.isEmpty())
-        {
-            objectNames(type).append(name);
-            objectLists(type).append(QPair<QString, SkyObject *>(name, o));
-        }
+    // The records of a trixel are ordered by magnitude, and so are the lists of the trixel
+    for (int i = m_Store->begin(trixel); i < m_Store->begin(trixel + 1); i++)
+    {
+        const DeepSkyStore::Record &record = m_Store->record(i);
+        addObject(createObject(record), trixel, record.hasName);
+    }
+}
 
-        //Add long name to the list of object names
-        //if ( ! longname.isEmpty() && longname != name  && !objectNames(type).contains(longname))
-        if (!longname.isEmpty() && longname != name)
+void DeepSkyComponent::updateObject(DeepSkyObject *obj)
+{
+    KStarsData *data = KStarsData::Instance();
+    if (obj->updateID != data->updateID())
+    {
+        obj->updateID = data->updateID();
+        if (obj->updateNumID != data->updateNumID())
         {
-            objectNames(type).append(longname);
-            objectLists(type).append(QPair<QString, SkyObject *>(longname, o));
+            obj->updateCoords(data->updateNum());
         }
-
-        deep_sky_parser.ShowProgress();
+        obj->EquatorialToHorizontal(data->lst(), data->geo()->lat());
     }
+}
 
-    for (auto &list : objectNames())
-        list.removeDuplicates();
+void DeepSkyComponent::materializeAll()
+{
+    for (Trixel trixel = 0; trixel < m_Pending.size(); trixel++)
+        materialize(trixel);
+}
+
+const QList<DeepSkyObject *> &DeepSkyComponent::objectList()
+{
+    QMutexLocker locker(&m_Mutex);
+    materializeAll();
+    return m_DeepSkyList;
 }
 
 void DeepSkyComponent::mergeSplitFiles()
@@ -485,9 +363,6 @@ void DeepSkyComponent::drawDeepSkyCatalog(SkyPainter *skyp, bool drawObject, Dee
     const Projector *proj = map->projector();
     KStarsData *data      = KStarsData::Instance();
 
-    UpdateID updateID    = data->updateID();
-    UpdateID updateNumID = data->updateNumID();
-
     skyp->setPen(data->colorScheme()->colorNamed(colorString));
     skyp->setBrush(Qt::NoBrush);
 
@@ -508,13 +383,15 @@ void DeepSkyComponent::drawDeepSkyCatalog(SkyPainter *skyp, bool drawObject, Dee
         labelMagLim = Options::magLimitDrawDeepSky();
 
     //DrawID drawID = m_skyMesh->drawID();
+    QMutexLocker locker(&m_Mutex);
     MeshIterator region(m_skyMesh, DRAW_BUF);
 
     auto zoomFactor = Options::zoomFactor();
     auto sizeRescaling = dms::PI * zoomFactor / 10800.0;
     while (region.hasNext())
     {
-        Trixel trixel       = region.next();
+        Trixel trixel = region.next();
+        materialize(trixel);
         DeepSkyList *dsList = dsIndex->value(trixel);
         if (dsList == nullptr)
             continue;
@@ -524,17 +401,15 @@ void DeepSkyComponent::drawDeepSkyCatalog(SkyPainter *skyp, bool drawObject, Dee
             //if ( obj->drawID == drawID ) continue;  // only draw each line once
             //obj->drawID = drawID;
 
-            if (obj->updateID != updateID)
-            {
-                obj->updateID = updateID;
-                if (obj->updateNumID != updateNumID)
-                {
-                    obj->updateCoords(data->updateNum());
-                }
-                obj->EquatorialToHorizontal(data->lst(), data->geo()->lat());
-            }
+            float mag = obj->mag();
+
+            // The objects of a trixel are ordered by magnitude. Fainter objects are updated when
+            // they are searched.
+            if (!showUnknownMagObjects && !(mag < float(m_zoomMagLimit)))
+                break;
+
+            updateObject(obj);
 
-            float mag  = obj->mag();
             float size = obj->a() * sizeRescaling;
 
             //only draw objects if flags set, it's bigger than 1 pixel (unless
@@ -600,23 +475,38 @@ void DeepSkyComponent::drawLabels()
 
 SkyObject *DeepSkyComponent::findByName(const QString &name)
 {
-    if (nameHash.contains(name.toLower()))
-        return nameHash[name.toLower()];
-    return nullptr;
+    const QString key = name.toLower();
+    auto it = m_NameIndex.constFind(key);
+    if (it == m_NameIndex.constEnd())
+        return nullptr;
+
+    // Lookups also run on worker threads, e.g. in What's Interesting
+    QMutexLocker locker(&m_Mutex);
+    materialize(m_Store->record(it.value()).trixel);
+    DeepSkyObject *obj = nameHash.value(key);
+    // Coordinates are only updated on the GUI thread, which draws them
+    if (obj != nullptr && QThread::currentThread() == QCoreApplication::instance()->thread())
+        updateObject(obj);
+    return obj;
 }
 
 void DeepSkyComponent::objectsInArea(QList<SkyObject *> &list, const SkyRegion &region)
 {
+    QMutexLocker locker(&m_Mutex);
     for (SkyRegion::const_iterator it = region.constBegin(); it != region.constEnd(); ++it)
     {
         Trixel trixel = it.key();
 
+        materialize(trixel);
         if (m_DeepSkyIndex.contains(trixel))
         {
             DeepSkyList *dsoList = m_DeepSkyIndex.value(trixel);
 
             for (auto &dso : *dsoList)
+            {
+                updateObject(dso);
                 list.append(dso);
+            }
         }
     }
 }
@@ -640,8 +530,21 @@ SkyObject *DeepSkyComponent::objectNearest(SkyPoint *p, double &maxrad)
     DeepSkyList *dsList;
     SkyObject *obj;
 
+    QMutexLocker locker(&m_Mutex);
     MeshIterator region(m_skyMesh, OBJ_NEAREST_BUF);
 
+    while (region.hasNext())
+    {
+        Trixel trixel = region.next();
+        materialize(trixel);
+        if (DeepSkyList *dsList = m_DeepSkyIndex.value(trixel))
+        {
+            for (auto &obj : *dsList)
+                updateObject(obj);
+        }
+    }
+
+    region.reset();
     while (region.hasNext())
     {
         dsList = m_ICIndex[region.next()];
@@ -17,9 +17,15 @@
 
 #pragma once
 
+#include "deepskystore.h"
 #include "skycomponent.h"
 #include "skylabel.h"
 
+#include <QBitArray>
+#include <QMutex>
+
+#include <memory>
+
 class QPointF;
 
 #ifdef KSTARS_LITE
@@ -55,7 +61,11 @@ class DeepSkyComponent : public SkyComponent
 #endif
 
   public:
-    explicit DeepSkyComponent(SkyComposite *);
+    /**
+     * @p parent the parent composite
+     * @p store the NGC/IC store opened by openStore(), it is opened here if it is null
+     */
+    explicit DeepSkyComponent(SkyComposite *parent, std::unique_ptr<DeepSkyStore> store = nullptr);
 
     ~DeepSkyComponent() override;
 
@@ -100,7 +110,11 @@ class DeepSkyComponent : public SkyComponent
 
     SkyObject *objectNearest(SkyPoint *p, double &maxrad) override;
 
-    const QList<DeepSkyObject *> &objectList() const { return m_DeepSkyList; }
+    /**
+     * @return all deep-sky objects
+     * @note Creates the objects which were not drawn or searched yet
+     */
+    const QList<DeepSkyObject *> &objectList();
 
     bool selected() override;
 
@@ -112,6 +126,13 @@ class DeepSkyComponent : public SkyComponent
      */
     static double determineDeepSkyMagnitudeLimit(void);
 
+    /**
+     * @short Open the store of the NGC/IC catalog, compiling it if needed
+     * @return the store, or nullptr if the catalog cannot be read
+     * @note Only touches files and the sky mesh index, so it can run on a worker thread
+     */
+    static std::unique_ptr<DeepSkyStore> openStore();
+
 
   private:
     /**
@@ -140,13 +161,36 @@ class DeepSkyComponent : public SkyComponent
      * @li 64-69    PGC Catalog number [int] can be blank
      * @li 71-75    UGC Catalog number [int] can be blank
      * @li 77-END   Common name [string] can be blank
-     * @return true if data file is successfully read.
+     *
+     * The file is read through a DeepSkyStore, see openStore(). Only the names are read at once,
+     * the objects of a trixel are created when it is first drawn or searched, or when one of its
+     * names is looked up.
      */
-    void loadData();
+    void loadData(std::unique_ptr<DeepSkyStore> store);
+
+    /** @short Create the object of a record of the store, with translated names. */
+    DeepSkyObject *createObject(const DeepSkyStore::Record &record);
+
+    /** @short Add the names of a record of the store to the name index and the lists of names. */
+    void addNames(const DeepSkyStore::Record &record, int index);
+
+    /** @short Add an object to the lists, indexes and the name hash. */
+    void addObject(DeepSkyObject *o, Trixel trixel, bool hasName);
+
+    /**
+     * @short Create the objects of a trixel if they were not created yet.
+     * @note Called with m_Mutex locked
+     */
+    void materialize(Trixel trixel);
+
+    /** @short Update the coordinates of an object if the time changed since its last update. */
+    void updateObject(DeepSkyObject *obj);
+
+    void materializeAll();
 
     void clearList(QList<DeepSkyObject *> &list);
 
-    void mergeSplitFiles();
+    static void mergeSplitFiles();
 
     void drawDeepSkyCatalog(SkyPainter *skyp, bool drawObject, DeepSkyIndex *dsIndex, const QString &colorString,
                             bool drawImage = false);
@@ -163,6 +207,14 @@ class DeepSkyComponent : public SkyComponent
     double m_zoomMagLimit { 0 };
 
     SkyMesh *m_skyMesh { nullptr };
+    std::unique_ptr<DeepSkyStore> m_Store;
+    // Trixels with objects which were not created yet
+    QBitArray m_Pending;
+    // Lower case names of the records, the objects are in nameHash once they are created
+    QHash<QString, int> m_NameIndex;
+    // Guards the creation of objects and the lists, indexes and nameHash it fills, as
+    // findByName() also runs on worker threads
+    QMutex m_Mutex;
     DeepSkyIndex m_DeepSkyIndex;
     DeepSkyIndex m_MessierIndex;
     DeepSkyIndex m_NGCIndex;
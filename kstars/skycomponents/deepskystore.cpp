@@ -0,0 +1,344 @@
+/*  KStars Deep Sky Store
+    Compiled binary form of the NGC/IC catalog.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#include "deepskystore.h"
+
+#include "ksrecordparser.h"
+#include "kspaths.h"
+#include "kstars_debug.h"
+#include "skymesh.h"
+#include "skyobjects/skypoint.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+const quint32 STORE_MAGIC   = 0x4b53444f; // "KSDO"
+const quint32 STORE_VERSION = 1;
+
+struct Header
+{
+    quint32 magic;
+    quint32 version;
+    quint32 count;
+    quint32 trixels;
+    qint64 sourceSize;
+    qint64 sourceModified;
+    quint32 stringsSize;
+    quint32 reserved;
+};
+
+static_assert(sizeof(Header) % 8 == 0, "Records must stay aligned");
+static_assert(sizeof(DeepSkyStore::Record) == 64, "Records have a fixed size");
+
+// Entries of the directory, padded so the records stay aligned
+int directorySize(int trixels)
+{
+    return (trixels + 2) & ~1;
+}
+
+class StringTable
+{
+    public:
+        StringTable()
+        {
+            // Offset 0 is the empty string
+            m_Data.append('\0');
+        }
+
+        quint32 add(const QString &string)
+        {
+            if (string.isEmpty())
+                return 0;
+
+            const QByteArray utf8 = string.toUtf8();
+            auto it = m_Offsets.constFind(utf8);
+            if (it != m_Offsets.constEnd())
+                return it.value();
+
+            const quint32 offset = m_Data.size();
+            m_Data.append(utf8).append('\0');
+            m_Offsets.insert(utf8, offset);
+            return offset;
+        }
+
+        const QByteArray &data() const
+        {
+            return m_Data;
+        }
+
+    private:
+        QByteArray m_Data;
+        QHash<QByteArray, quint32> m_Offsets;
+};
+}
+
+bool DeepSkyStore::open(const QString &source, SkyMesh *mesh)
+{
+    const QFileInfo info(source);
+    if (!info.exists())
+        return false;
+
+    m_File.setFileName(KSPaths::writableLocation(QStandardPaths::GenericCacheLocation) + info.completeBaseName() +
+                       ".dsostore");
+    if (m_File.open(QIODevice::ReadOnly))
+    {
+        const uchar *data = m_File.map(0, m_File.size());
+        if (data != nullptr && attach(data, m_File.size(), info, mesh->size()))
+            return true;
+        m_File.close();
+    }
+
+    qCInfo(KSTARS) << "Compiling" << source << "into" << m_File.fileName();
+
+    QByteArray compiled;
+    if (!compile(source, mesh, compiled))
+        return false;
+
+    QDir().mkpath(KSPaths::writableLocation(QStandardPaths::GenericCacheLocation));
+    QSaveFile file(m_File.fileName());
+    if (file.open(QIODevice::WriteOnly) && file.write(compiled) == compiled.size() && file.commit() &&
+            m_File.open(QIODevice::ReadOnly))
+    {
+        const uchar *data = m_File.map(0, m_File.size());
+        if (data != nullptr && attach(data, m_File.size(), info, mesh->size()))
+            return true;
+        m_File.close();
+    }
+
+    qCWarning(KSTARS) << "Cannot write" << m_File.fileName() << ", keeping the compiled catalog in memory.";
+    m_Memory = compiled;
+    return attach(reinterpret_cast<const uchar *>(m_Memory.constData()), m_Memory.size(), info, mesh->size());
+}
+
+bool DeepSkyStore::attach(const uchar *data, qint64 size, const QFileInfo &source, int trixels)
+{
+    if (size < static_cast<qint64>(sizeof(Header)))
+        return false;
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    if (header.magic != STORE_MAGIC || header.version != STORE_VERSION ||
+            header.trixels != static_cast<quint32>(trixels) || header.sourceSize != source.size() ||
+            header.sourceModified != source.lastModified().toMSecsSinceEpoch())
+        return false;
+
+    const qint64 recordsOffset = sizeof(Header) + directorySize(trixels) * sizeof(quint32);
+    const qint64 stringsOffset = recordsOffset + static_cast<qint64>(header.count) * sizeof(Record);
+    if (size != stringsOffset + header.stringsSize || header.stringsSize == 0 || data[size - 1] != '\0')
+    {
+        qCWarning(KSTARS) << "Deep sky store" << m_File.fileName() << "is damaged and ignored.";
+        return false;
+    }
+
+    m_Count     = header.count;
+    m_Directory = reinterpret_cast<const quint32 *>(data + sizeof(Header));
+    m_Records   = reinterpret_cast<const Record *>(data + recordsOffset);
+    m_Strings   = reinterpret_cast<const char *>(data + stringsOffset);
+    return true;
+}
+
+bool DeepSkyStore::compile(const QString &source, SkyMesh *mesh, QByteArray &data) const
+{
+    // suffix holds multiplicity suffixes, eg: the 'A' in NGC 4945A
+    KSRecordParser::Text flag, suffix, sgn, bmag, pa_field, other_cat, other1, messier, longname_field;
+    int ingc, rah, ram, dd, dm, ds, type, pgc, messier_number;
+    double ras;
+    float a, b;
+
+    KSRecordParser deep_sky_parser(source, '#',
+    {
+        &flag, &ingc, &suffix, &rah, &ram, &ras, &sgn, &dd, &dm, &ds, &bmag, &type, &a, &b, &pa_field, &pgc,
+        &other_cat, &other1, {} /* other2 */, &messier, &messier_number, &longname_field
+    },
+    // No width for the long name, which runs to the end of the line
+    { 1, 4, 1, 2, 2, 4, 2, 2, 2, 2, 6, 2, 6, 6, 4, 7, 4, 6, 6, 2, 4 });
+
+    QVector<Record> records;
+    StringTable strings;
+
+    while (deep_sky_parser.readRow())
+    {
+        QString cat;
+        float mag(1000.0);
+        int imess(-1), pa;
+        int ugc;
+        QString name, name2, longname;
+        QString cat2;
+
+        // Designation, from the NGC/IC catalog flag
+        if (flag.latin1() == QLatin1String("I"))
+            cat = "IC";
+        else if (flag.latin1() == QLatin1String("N"))
+            cat = "NGC";
+
+        if (ingc == 0)
+            cat.clear(); //object is not in NGC or IC catalogs
+
+        if (!((0.0 <= rah && rah < 24.0) || (0.0 <= ram && ram < 60.0) || (0.0 <= ras && ras < 60.0) ||
+              (0.0 <= dd && dd <= 90.0) || (0.0 <= dm && dm < 60.0) || (0.0 <= ds && ds < 60.0)))
+        {
+            qCWarning(KSTARS) << "Bad coordinates while processing NGC/IC object: " << cat << ingc;
+            qCWarning(KSTARS) << "RA H:M:S = " << rah << ":" << ram << ":" << ras << "; Dec D:M:S = " << dd << ":" << dm << ":"
+                     << ds;
+        }
+
+        //Ignore lines with no coordinate values if not debugging
+        if (rah == 0 && ram == 0 && ras == 0)
+            continue;
+
+        //B magnitude
+        if (bmag.isEmpty())
+        {
+            mag = 99.9f;
+        }
+        else
+        {
+            mag = bmag.toFloat();
+        }
+
+        //position angle.  The catalog PA is zero when the Major axis
+        //is horizontal.  But we want the angle measured from North, so
+        //we set PA = 90 - pa.
+        if (pa_field.isEmpty())
+        {
+            pa = 90;
+        }
+        else
+        {
+            pa = 90 - pa_field.toInt();
+        }
+
+        //UGC number
+        if (other_cat.latin1() == QLatin1String("UGC"))
+        {
+            ugc = other1.toInt();
+        }
+        else
+        {
+            ugc = 0;
+        }
+
+        //Messier number
+        if (messier.latin1() == QLatin1String("M"))
+        {
+            cat2 = cat;
+            if (ingc == 0)
+                cat2.clear();
+            cat   = 'M';
+            imess = messier_number;
+        }
+
+        longname = longname_field.toString();
+
+        dms r;
+        r.setH(rah+ram/60.0+ras/3600.0);
+        dms d(dd, dm, ds);
+
+        if (sgn.latin1() == QLatin1String("-"))
+        {
+            d.setD(-1.0 * d.Degrees());
+        }
+
+        bool hasName = true;
+        QString snum;
+        if (cat == "IC" || cat == "NGC")
+        {
+            snum.setNum(ingc);
+            name = cat + ' ' + ((suffix.isEmpty()) ? snum : (snum + suffix.toString()));
+        }
+        else if (cat == "M")
+        {
+            snum.setNum(imess);
+            name = cat + ' ' + snum; // Note: Messier has no suffixes
+            if (cat2 == "NGC" || cat2 == "IC")
+            {
+                snum.setNum(ingc);
+                name2 = cat2 + ' ' + ((suffix.isEmpty()) ? snum : (snum + suffix.toString()));
+            }
+        }
+        else
+        {
+            if (!longname.isEmpty())
+                name = longname;
+            else
+                hasName = false;
+        }
+
+        if (type == 0)
+            type = 1; //Make sure we use CATALOG_STAR, not STAR
+
+        const SkyPoint position(r, d);
+
+        Record record;
+        std::memset(&record, 0, sizeof(Record));
+        record.ra       = r.Hours();
+        record.dec      = d.Degrees();
+        record.mag      = mag;
+        record.a        = a;
+        record.b        = b;
+        record.pa       = pa;
+        record.pgc      = pgc;
+        record.ugc      = ugc;
+        record.name     = strings.add(name);
+        record.name2    = strings.add(name2);
+        record.longname = strings.add(longname);
+        record.catalog  = strings.add(cat);
+        record.trixel   = mesh->index(&position);
+        record.type     = type;
+        record.hasName  = hasName;
+        records.append(record);
+
+    }
+
+    if (records.isEmpty())
+        return false;
+
+    std::stable_sort(records.begin(), records.end(), [](const Record & a, const Record & b)
+    {
+        return a.trixel < b.trixel || (a.trixel == b.trixel && a.mag < b.mag);
+    });
+
+    const int trixels = mesh->size();
+    QVector<quint32> directory(directorySize(trixels), records.size());
+    for (int i = records.size() - 1; i >= 0; i--)
+        directory[records[i].trixel] = i;
+    // Trixels without records start where the next one does
+    for (int t = trixels - 1; t >= 0; t--)
+        directory[t] = std::min(directory[t], directory[t + 1]);
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    header.magic          = STORE_MAGIC;
+    header.version        = STORE_VERSION;
+    header.count          = records.size();
+    header.trixels        = trixels;
+    header.sourceSize     = QFileInfo(source).size();
+    header.sourceModified = QFileInfo(source).lastModified().toMSecsSinceEpoch();
+    header.stringsSize    = strings.data().size();
+
+    data.clear();
+    data.reserve(sizeof(Header) + directory.size() * sizeof(quint32) + records.size() * sizeof(Record) +
+                 strings.data().size());
+    data.append(reinterpret_cast<const char *>(&header), sizeof(Header));
+    data.append(reinterpret_cast<const char *>(directory.constData()), directory.size() * sizeof(quint32));
+    data.append(reinterpret_cast<const char *>(records.constData()), records.size() * sizeof(Record));
+    data.append(strings.data());
+    return true;
+}
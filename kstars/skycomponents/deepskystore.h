@@ -0,0 +1,103 @@
+/*  KStars Deep Sky Store
+    Compiled binary form of the NGC/IC catalog.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#pragma once
+
+#include "typedef.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+class QFileInfo;
+class SkyMesh;
+
+/**
+ * @class DeepSkyStore
+ * @short Fixed-size records of a deep-sky catalog, ordered by trixel and magnitude.
+ *
+ * The text catalog is parsed once and compiled into a binary file in the cache directory, which
+ * is memory-mapped by later sessions. It holds a directory of the records of every trixel, the
+ * records and a table of NUL-terminated UTF-8 strings. The records of a trixel are sorted by
+ * magnitude, brightest first.
+ *
+ * The file is compiled again when the size or modification time of the text catalog, or the
+ * level of the sky mesh changes. If it cannot be written, the compiled data is kept in memory.
+ */
+class DeepSkyStore
+{
+    public:
+        struct Record
+        {
+            double ra;  // hours
+            double dec; // degrees
+            float mag;
+            float a;
+            float b;
+            qint32 pa;
+            qint32 pgc;
+            qint32 ugc;
+            // Offsets into the string table, names are not translated
+            quint32 name;
+            quint32 name2;
+            quint32 longname;
+            quint32 catalog;
+            Trixel trixel;
+            qint8 type;
+            // Unnamed objects have an empty name
+            quint8 hasName;
+            quint8 reserved[2];
+        };
+
+        /**
+         * @brief open Map the compiled form of a text catalog, compiling it first if needed.
+         * @param source the ngcic.dat file
+         * @param mesh the sky mesh whose trixels index the records
+         * @return false if the catalog cannot be read.
+         */
+        bool open(const QString &source, SkyMesh *mesh);
+
+        int size() const
+        {
+            return m_Count;
+        }
+
+        const Record &record(int i) const
+        {
+            return m_Records[i];
+        }
+
+        /** @return the index of the first record of a trixel, records of the trixel end at begin(trixel + 1). */
+        int begin(Trixel trixel) const
+        {
+            return m_Directory[trixel];
+        }
+
+        /** @return a string of the table, valid while the store is open. */
+        const char *string(quint32 offset) const
+        {
+            return m_Strings + offset;
+        }
+
+    private:
+        bool compile(const QString &source, SkyMesh *mesh, QByteArray &data) const;
+        bool attach(const uchar *data, qint64 size, const QFileInfo &source, int trixels);
+
+        QFile m_File;
+        // Used when the compiled file cannot be written
+        QByteArray m_Memory;
+
+        int m_Count { 0 };
+        const quint32 *m_Directory { nullptr };
+        const Record *m_Records { nullptr };
+        const char *m_Strings { nullptr };
+};
@@ -19,6 +19,7 @@
 
 #include "byteorder.h"
 #include "kstarsdata.h"
+#include "ksprofiler.h"
 #include "Options.h"
 #ifndef KSTARS_LITE
 #include "skymap.h"
@@ -409,6 +410,17 @@ void DeepStarComponent::draw(SkyPainter *skyp)
         t_drawUnnamed += t.restart();
     }
     m_skyMesh->inDraw(false);
+
+    if (KSProfiler::isEnabled())
+    {
+        KSProfiler *profiler = KSProfiler::Instance();
+        const QString &name = dataFileName;
+        profiler->counter("draw", name + QLatin1String(" visible stars"), visibleStarCount);
+        profiler->counter("draw", name + QLatin1String(" trixels"), nTrixels);
+        profiler->counter("draw", name + QLatin1String(" LRU cache update ms"), t_updateCache);
+        profiler->counter("draw", name + QLatin1String(" dynamic load ms"), t_dynamicLoad);
+        profiler->counter("draw", name + QLatin1String(" unnamed stars ms"), t_drawUnnamed);
+    }
 #ifdef PROFILE_SINCOS
     trig_calls_here += dms::trig_function_calls;
     trig_redundancy_here += dms::redundant_trig_function_calls;
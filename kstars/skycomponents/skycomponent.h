@@ -192,6 +192,11 @@ class SkyComponent
 
     inline QStringList &objectNames(int type) { return getObjectNames()[type]; }
 
+    /**
+     * @return the names of the objects with the objects, by type
+     * @note The object of an entry is nullptr if the component creates it on demand, as
+     * DeepSkyComponent and CatalogComponent do. Readers get the objects through SkyMapComposite::objectOf().
+     */
     inline QHash<int, QVector<QPair<QString, const SkyObject *>>> &objectLists() { return getObjectLists(); }
 
     inline QVector<QPair<QString, const SkyObject *>> &objectLists(int type) { return getObjectLists()[type]; }
@@ -27,17 +27,13 @@
 #include "skymap.h"
 #include "projections/projector.h"
 
-//---------------------------------------------------------------------------//
-// A Little data container class
-//---------------------------------------------------------------------------//
-
-typedef struct LabelRun
+namespace
 {
-    LabelRun(int s, int e) : start(s), end(e) {}
-    int start;
-    int end;
-
-} LabelRun;
+// Forget the text widths of a font beyond this many labels, e.g. when star magnitudes change
+const int maxCachedWidths = 20000;
+// Fonts with cached widths. The size of the label font follows the zoom, so every zoom level adds one.
+const int maxCachedFonts = 4;
+}
 
 //----- Now for the main event ----------------------------------------------//
 
@@ -110,21 +106,13 @@ SkyLabeler::SkyLabeler()
 
 SkyLabeler::~SkyLabeler()
 {
-    for (auto &row : screenRows)
-    {
-        for (auto &item : *row)
-        {
-            delete item;
-        }
-        delete row;
-    }
 }
 
 bool SkyLabeler::drawGuideLabel(QPointF &o, const QString &text, double angle)
 {
     // Create bounding rectangle by rotating the (height x width) rectangle
     qreal h = m_fontMetrics.height();
-    qreal w = m_fontMetrics.width(text);
+    qreal w = textWidth(text);
     qreal s = sin(angle * dms::PI / 180.0);
     qreal c = cos(angle * dms::PI / 180.0);
 
@@ -171,13 +159,21 @@ bool SkyLabeler::drawGuideLabel(QPointF &o, const QString &text, double angle)
 
 bool SkyLabeler::drawNameLabel(SkyObject *obj, const QPointF &_p)
 {
+    double offset = obj->labelOffset();
+    QPointF p(_p.x() + offset, _p.y() + offset);
+
+    // Cheap rejection in crowded areas: the label would overlap a label where it starts,
+    // so there is no need to build and measure its text
+    if (!markRegion(p.x(), p.x(), p.y(), p.y() - m_fontMetrics.height(), false))
+    {
+        m_misses++;
+        return false;
+    }
+
     QString sLabel = obj->labelString();
     if (sLabel.isEmpty())
         return false;
 
-    double offset = obj->labelOffset();
-    QPointF p(_p.x() + offset, _p.y() + offset);
-
     if (!markText(p, sLabel))
     {
         return false;
@@ -202,6 +198,26 @@ void SkyLabeler::setFont(const QFont &font)
     m_drawFont = font;
 #endif
     m_fontMetrics = QFontMetrics(font);
+    m_fontKey     = font.key();
+}
+
+qreal SkyLabeler::textWidth(const QString &text)
+{
+    if (!m_textWidths.contains(m_fontKey) && m_textWidths.size() >= maxCachedFonts)
+        m_textWidths.clear();
+
+    QHash<QString, qreal> &widths = m_textWidths[m_fontKey];
+
+    auto width = widths.constFind(text);
+    if (width != widths.constEnd())
+        return width.value();
+
+    if (widths.size() >= maxCachedWidths)
+        widths.clear();
+
+    const qreal result = m_fontMetrics.width(text);
+    widths.insert(text, result);
+    return result;
 }
 
 void SkyLabeler::setPen(const QPen &pen)
@@ -237,7 +253,7 @@ void SkyLabeler::resetFont()
 void SkyLabeler::getMargins(const QString &text, float *left, float *right, float *top, float *bot)
 {
     float height     = m_fontMetrics.height();
-    float width      = m_fontMetrics.width(text);
+    float width      = textWidth(text);
     float sideMargin = m_fontMetrics.width("MM") + width / 2.0;
 
     // Create the margins within which it is okay to draw the label
@@ -275,59 +291,51 @@ void SkyLabeler::reset(SkyMap *skyMap)
     setZoomFont();
     m_skyFont     = m_p.font();
     m_fontMetrics = QFontMetrics(m_skyFont);
-    m_minDeltaX   = (int)m_fontMetrics.width("MMMMM");
+    m_fontKey     = m_skyFont.key();
+    m_minDeltaX   = qMax(1, (int)textWidth("MMMMM"));
 
     // ----- Set up Zoom Dependent Offset -----
     m_offset = SkyLabeler::ZoomOffset();
 
     // ----- Prepare Virtual Screen -----
+    resetScreen(skyMap->width(), skyMap->height());
+
+    //----- Clear out labelList -----
+    for (auto &item : labelList)
+    {
+        item.clear();
+    }
+}
+
+void SkyLabeler::resetScreen(int width, int height)
+{
     m_yScale = (m_fontMetrics.height() + 1.0);
 
-    int maxY = int(skyMap->height() / m_yScale);
+    int maxY = int(height / m_yScale);
     if (maxY < 1)
         maxY = 1; // prevents a crash below?
 
-    int m_maxX = skyMap->width();
-    m_size     = (maxY + 1) * m_maxX;
+    m_size = (maxY + 1) * width;
 
-    // Resize if needed:
-    if (maxY > m_maxY)
+    const int columns = width / m_minDeltaX + 1;
+    if (columns != m_columns || maxY != m_maxY)
     {
-        screenRows.resize(m_maxY);
-        for (int y = m_maxY; y <= maxY; y++)
-        {
-            screenRows.append(new LabelRow());
-        }
-        //printf("resize: %d -> %d, size:%d\n", m_maxY, maxY, screenRows.size());
+        m_columns = columns;
+        m_maxY    = maxY;
+        m_cells.clear();
+        m_cells.resize(m_columns * (m_maxY + 1));
     }
-
-    // Clear all pre-existing rows as needed
-
-    int minMaxY = (maxY < m_maxY) ? maxY : m_maxY;
-
-    for (int y = 0; y <= minMaxY; y++)
+    else
     {
-        LabelRow *row = screenRows[y];
-
-        for (auto &item : *row)
-        {
-            delete item;
-        }
-        row->clear();
+        // The cells keep their memory from one frame to the next
+        for (int cell : m_usedCells)
+            m_cells[cell].clear();
     }
-
-    // never decrease m_maxY:
-    if (m_maxY < maxY)
-        m_maxY = maxY;
+    m_usedCells.clear();
+    m_regions.clear();
 
     // reset the counters
-    m_marks = m_hits = m_misses = m_elements = 0;
-
-    //----- Clear out labelList -----
-    for (auto &item : labelList)
-    {
-        item.clear();
-    }
+    m_marks = m_hits = m_misses = 0;
 }
 
 #ifdef KSTARS_LITE
@@ -341,51 +349,13 @@ void SkyLabeler::reset()
     setZoomFont();
     m_skyFont     = m_drawFont;
     m_fontMetrics = QFontMetrics(m_skyFont);
-    m_minDeltaX   = (int)m_fontMetrics.width("MMMMM");
+    m_fontKey     = m_skyFont.key();
+    m_minDeltaX   = qMax(1, (int)textWidth("MMMMM"));
     // ----- Set up Zoom Dependent Offset -----
     m_offset = ZoomOffset();
 
     // ----- Prepare Virtual Screen -----
-    m_yScale = (m_fontMetrics.height() + 1.0);
-
-    int maxY = int(skyMap->height() / m_yScale);
-    if (maxY < 1)
-        maxY = 1; // prevents a crash below?
-
-    int m_maxX = skyMap->width();
-    m_size     = (maxY + 1) * m_maxX;
-
-    // Resize if needed:
-    if (maxY > m_maxY)
-    {
-        screenRows.resize(m_maxY);
-        for (int y = m_maxY; y <= maxY; y++)
-        {
-            screenRows.append(new LabelRow());
-        }
-        //printf("resize: %d -> %d, size:%d\n", m_maxY, maxY, screenRows.size());
-    }
-
-    // Clear all pre-existing rows as needed
-
-    int minMaxY = (maxY < m_maxY) ? maxY : m_maxY;
-
-    for (int y = 0; y <= minMaxY; y++)
-    {
-        LabelRow *row = screenRows[y];
-        for (int i = 0; i < row->size(); i++)
-        {
-            delete row->at(i);
-        }
-        row->clear();
-    }
-
-    // never decrease m_maxY:
-    if (m_maxY < maxY)
-        m_maxY = maxY;
-
-    // reset the counters
-    m_marks = m_hits = m_misses = m_elements = 0;
+    resetScreen(skyMap->width(), skyMap->height());
 
     //----- Clear out labelList -----
     for (int i = 0; i < labelList.size(); i++)
@@ -410,19 +380,14 @@ void SkyLabeler::draw(QPainter &p)
     //m_p.begin(&m_picture);
 }
 
-// We use Run Length Encoding to hold the information instead of an array of
-// chars.  This is both faster and smaller but the code is more complicated.
-//
-// This code is easy to break and hard to fix.
-
 bool SkyLabeler::markText(const QPointF &p, const QString &text)
 {
-    qreal maxX = p.x() + m_fontMetrics.width(text);
+    qreal maxX = p.x() + textWidth(text);
     qreal minY = p.y() - m_fontMetrics.height();
     return markRegion(p.x(), maxX, p.y(), minY);
 }
 
-bool SkyLabeler::markRegion(qreal left, qreal right, qreal top, qreal bot)
+bool SkyLabeler::markRegion(qreal left, qreal right, qreal top, qreal bot, bool mark)
 {
     if (m_maxY < 1)
     {
@@ -460,114 +425,47 @@ bool SkyLabeler::markRegion(qreal left, qreal right, qreal top, qreal bot)
         minY     = temp;
     }
 
+    // Cells covered by the region, regions off the screen go to the border cells
+    const int minColumn = qBound(0, minX / m_minDeltaX, m_columns - 1);
+    const int maxColumn = qBound(0, maxX / m_minDeltaX, m_columns - 1);
+
     // check to see if we overlap any existing label
-    // We must check all rows before we start marking
+    // We must check all cells before we start marking
     for (int y = minY; y <= maxY; y++)
     {
-        LabelRow *row = screenRows[y];
-        int i;
-        for (i = 0; i < row->size(); i++)
+        for (int column = minColumn; column <= maxColumn; column++)
         {
-            if (row->at(i)->end < minX)
-                continue; // skip past these
-            if (row->at(i)->start > maxX)
-                break;
-            m_misses++;
-            return false;
+            for (int index : m_cells[y * m_columns + column])
+            {
+                const LabelRegion &region = m_regions[index];
+                // Regions are only listed in the strips they cover
+                if (region.right < minX || region.left > maxX)
+                    continue;
+                if (mark)
+                    m_misses++;
+                return false;
+            }
         }
     }
 
+    if (!mark)
+        return true;
+
     m_hits++;
     m_marks += (maxX - minX + 1) * (maxY - minY + 1);
 
-    // Okay, there was no overlap so let's insert the current rectangle into
-    // screenRows.
+    // Okay, there was no overlap so let's add the region to the cells it covers
+    const int index = static_cast<int>(m_regions.size());
+    m_regions.push_back({ minX, maxX });
 
     for (int y = minY; y <= maxY; y++)
     {
-        LabelRow *row = screenRows[y];
-
-        // Simplest case: an empty row
-        if (row->size() < 1)
-        {
-            row->append(new LabelRun(minX, maxX));
-            m_elements++;
-            continue;
-        }
-
-        // Find out our place in the universe (or row).
-        // H'mm.  Maybe we could cache these numbers above.
-        int i;
-        for (i = 0; i < row->size(); i++)
-        {
-            if (row->at(i)->end >= minX)
-                break;
-        }
-
-        // i now points to first label PAST ours
-
-        // if we are first, append or merge at start of list
-        if (i == 0)
-        {
-            if (row->at(0)->start - maxX < m_minDeltaX)
-            {
-                row->at(0)->start = minX;
-            }
-            else
-            {
-                row->insert(0, new LabelRun(minX, maxX));
-                m_elements++;
-            }
-            continue;
-        }
-
-        // if we are past the last label, merge or append at end
-        else if (i == row->size())
-        {
-            if (minX - row->at(i - 1)->end < m_minDeltaX)
-            {
-                row->at(i - 1)->end = maxX;
-            }
-            else
-            {
-                row->append(new LabelRun(minX, maxX));
-                m_elements++;
-            }
-            continue;
-        }
-
-        // if we got here, we must insert or merge the new label
-        //  between [i-1] and [i]
-
-        bool mergeHead = (minX - row->at(i - 1)->end < m_minDeltaX);
-        bool mergeTail = (row->at(i)->start - maxX < m_minDeltaX);
-
-        // double merge => combine all 3 into one
-        if (mergeHead && mergeTail)
+        for (int column = minColumn; column <= maxColumn; column++)
         {
-            row->at(i - 1)->end = row->at(i)->end;
-            delete row->at(i);
-            row->removeAt(i);
-            m_elements--;
-        }
-
-        // Merge label with [i-1]
-        else if (mergeHead)
-        {
-            row->at(i - 1)->end = maxX;
-        }
-
-        // Merge label with [i]
-        else if (mergeTail)
-        {
-            row->at(i)->start = minX;
-        }
-
-        // insert between the two
-        else
-        {
-            row->insert(i, new LabelRun(minX, maxX));
-            m_elements++;
+            const int cell = y * m_columns + column;
+            if (m_cells[cell].empty())
+                m_usedCells.push_back(cell);
+            m_cells[cell].push_back(index);
         }
     }
 
@@ -687,8 +585,8 @@ void SkyLabeler::printInfo()
     printf("  hits=%d  misses=%d  ratio=%.1f%%\n", m_hits, m_misses, hitRatio());
     printf("  yScale=%.1f maxY=%d\n", m_yScale, m_maxY);
 
-    printf("  screenRows=%d elements=%d virtualSize=%.1f Kbytes\n", screenRows.size(), m_elements,
-           float(m_size) / 1024.0);
+    printf("  cells=%d usedCells=%d regions=%d virtualSize=%.1f Kbytes\n", int(m_cells.size()),
+           int(m_usedCells.size()), int(m_regions.size()), float(m_size) / 1024.0);
 
 //    static const char *labelName[NUM_LABEL_TYPES];
 //
@@ -705,29 +603,4 @@ void SkyLabeler::printInfo()
 //    {
 //        printf("  %20ss: %d\n", labelName[i], labelList[i].size());
 //    }
-//
-//    // Check for errors in the data structure
-//    for (int y = 0; y <= m_maxY; y++)
-//    {
-//        LabelRow *row = screenRows[y];
-//        int size      = row->size();
-//        if (size < 2)
-//            continue;
-//
-//        bool error = false;
-//        for (int i = 1; i < size; i++)
-//        {
-//            if (row->at(i - 1)->end > row->at(i)->start)
-//                error = true;
-//        }
-//        if (!error)
-//            continue;
-//
-//        printf("ERROR: %3d: ", y);
-//        for (int i = 0; i < row->size(); i++)
-//        {
-//            printf("(%d, %d) ", row->at(i)->start, row->at(i)->end);
-//        }
-//        printf("\n");
-//    }
 }
@@ -20,20 +20,19 @@
 #include "skylabel.h"
 
 #include <QFontMetricsF>
+#include <QHash>
 #include <QList>
 #include <QVector>
 #include <QPainter>
 #include <QPicture>
 #include <QFont>
 
+#include <vector>
+
 class QString;
 class QPointF;
 class SkyMap;
 class Projector;
-struct LabelRun;
-
-typedef QList<LabelRun *> LabelRow;
-typedef QVector<LabelRow *> ScreenRows;
 
 /**
  *@class SkyLabeler
@@ -47,21 +46,14 @@ typedef QVector<LabelRow *> ScreenRows;
  * and return true.
  *
  * Since we need to check for overlap for every label every time it is
- * potentially drawn on the screen, efficiency is essential.  So instead of
- * having a 2-dimensional array of boolean values we use Run Length Encoding
- * and store the virtual array in a QVector of QLists.  Each element of the
- * vector, a LabelRow, corresponds to a horizontal strip of pixels on the actual
- * screen.  How many vertical pixels are in each strip is controlled by
- * m_yDensity.  The higher the density, the fewer vertical pixels per strip and
- * hence a larger number of strips are needed to cover the screen.  As
- * m_yDensity increases so does the density of the strips.
- *
- * The information in the X-dimension is completed run length encoded. A
- * consecutive run of pixels in one strip that are covered by one or more labels
- * is stored in a LabelRun object that merely stores the start pixel and the end
- * pixel.  A LabelRow is a list of LabelRun's stored in ascending order.  This
- * saves a lot of space over an explicit array and it also makes checking for
- * overlaps faster and even makes inserting new overlaps faster on average.
+ * potentially drawn on the screen, efficiency is essential.  The virtual
+ * screen is a grid of cells, each one horizontal strip of pixels high (one
+ * line of text) and a few characters wide.  Every cell keeps the list of marked
+ * regions that touch it.  Labels never overlap, so a cell only ever holds a
+ * handful of regions and checking a label costs the same no matter how many
+ * labels are already on the screen.  drawNameLabel() first checks where the
+ * label starts, so labels in crowded areas are rejected before their text is
+ * even measured.  The text widths are cached across frames.
  *
  * Synopsis:
  *
@@ -291,8 +283,9 @@ class SkyLabeler
     /**
          * @short Works just like markText() above but for an arbitrary
          * rectangular region bounded by top, bot, left, and right.
+         * If mark is false, the region is only checked and not marked.
          */
-    bool markRegion(qreal left, qreal right, qreal top, qreal bot);
+    bool markRegion(qreal left, qreal right, qreal top, qreal bot, bool mark = true);
 
     //----- Diagnostics and Information -----//
 
@@ -332,17 +325,36 @@ class SkyLabeler
     int marks() { return m_marks; }
 
   private:
-    ScreenRows screenRows;
-    int m_maxX { 0 };
+    /** Horizontal extent of a marked region, the cells list it in every strip it covers */
+    struct LabelRegion
+    {
+        int left;
+        int right;
+    };
+
+    /** Clear the virtual screen and resize it to the given size in pixels. */
+    void resetScreen(int width, int height);
+
+    /** @return width of the text in the current font, cached across frames. */
+    qreal textWidth(const QString &text);
+
+    // Indexes into m_regions of the regions touching each cell, row by row
+    std::vector<std::vector<int>> m_cells;
+    // Cells that are not empty, so only those are cleared by reset()
+    std::vector<int> m_usedCells;
+    std::vector<LabelRegion> m_regions;
+    int m_columns { 0 };
     int m_maxY { 0 };
     int m_size { 0 };
-    /// When to merge two adjacent regions
+    /// Width of a cell of the virtual screen
     int m_minDeltaX { 30 };
     int m_marks { 0 };
     int m_hits { 0 };
     int m_misses { 0 };
-    int m_elements { 0 };
     int m_errors { 0 };
+    // Text widths per font, see QFont::key(). Bounded in fonts and in texts per font.
+    QHash<QString, QHash<QString, qreal>> m_textWidths;
+    QString m_fontKey;
     qreal m_yScale { 0 };
     double m_offset { 0 };
     QFont m_stdFont, m_skyFont;
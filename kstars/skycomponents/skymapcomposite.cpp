@@ -34,6 +34,7 @@
 #include "localmeridiancomponent.h"
 #include "ksasteroid.h"
 #include "kscomet.h"
+#include "ksprofiler.h"
 #ifndef KSTARS_LITE
 #include "kstars.h"
 #endif
@@ -47,6 +48,7 @@
 #include "supernovaecomponent.h"
 #include "syncedcatalogcomponent.h"
 #include "targetlistcomponent.h"
+#include "auxiliary/startuptaskgraph.h"
 #include "projections/projector.h"
 #include "skyobjects/deepskyobject.h"
 #include "skyobjects/ksplanet.h"
@@ -63,6 +65,8 @@
 
 #include <QApplication>
 
+#include <functional>
+
 #include <kstars_debug.h>
 
 SkyMapComposite::SkyMapComposite(SkyComposite *parent) : SkyComposite(parent), m_reindexNum(J2000)
@@ -76,113 +80,165 @@ SkyMapComposite::SkyMapComposite(SkyComposite *parent) : SkyComposite(parent), m
     // You can also set the debug level of individual
     // appendLine() and appendPoly() calls.
 
-    //Add all components
+    connect(this, SIGNAL(progressText(QString)), KStarsData::Instance(), SIGNAL(progressText(QString)));
+}
+
+QStringList SkyMapComposite::addLoaders(StartupTaskGraph *graph, const QStringList &dependencies)
+{
+    QStringList loaders;
+    auto addLoader = [&](const QString &name, const QStringList &after, const std::function<void()> &load)
+    {
+        graph->addTask(name, dependencies + after, StartupTaskGraph::MainThread, [load]() -> bool
+        {
+            load();
+            return true;
+        });
+        loaders << name;
+    };
+
+    // Compiling ngcic.dat only reads files and the mesh index, it overlaps with the stars
+    std::shared_ptr<std::unique_ptr<DeepSkyStore>> ngcicStore(new std::unique_ptr<DeepSkyStore>());
+    graph->addTask("sky-ngcic", QStringList(), StartupTaskGraph::WorkerThread, [ngcicStore]() -> bool
+    {
+        *ngcicStore = DeepSkyComponent::openStore();
+        return true;
+    });
+
+    addLoader("sky-milkyway", QStringList(), [this]()
+    {
+        addComponent(m_MilkyWay = new MilkyWay(this), 50);
+    });
+
+    addLoader("sky-stars", QStringList(), [this]()
+    {
+        addComponent(m_Stars = StarComponent::Create(this), 10);
+    });
+
+    addLoader("sky-grids", QStringList(), [this]()
+    {
+        addComponent(m_EquatorialCoordinateGrid = new EquatorialCoordinateGrid(this));
+        addComponent(m_HorizontalCoordinateGrid = new HorizontalCoordinateGrid(this));
+#ifndef KSTARS_LITE
+        addComponent(m_LocalMeridianComponent = new LocalMeridianComponent(this));
+#endif
+    });
+
+    addLoader("sky-cboundlines", QStringList(), [this]()
+    {
+        addComponent(m_CBoundLines = new ConstellationBoundaryLines(this), 80);
+    });
+
+    addLoader("sky-cultures", QStringList(), [this]()
+    {
+        m_Cultures.reset(new CultureList());
+    });
+
     //Stars must come before constellation lines
-#ifdef KSTARS_LITE
-    addComponent(m_MilkyWay = new MilkyWay(this), 50);
-    addComponent(m_Stars = StarComponent::Create(this), 10);
-    addComponent(m_EquatorialCoordinateGrid = new EquatorialCoordinateGrid(this));
-    addComponent(m_HorizontalCoordinateGrid = new HorizontalCoordinateGrid(this));
-
-    // Do add to components.
-    addComponent(m_CBoundLines = new ConstellationBoundaryLines(this), 80);
-    m_Cultures.reset(new CultureList());
-    addComponent(m_CLines = new ConstellationLines(this, m_Cultures.get()), 85);
-    addComponent(m_CNames = new ConstellationNamesComponent(this, m_Cultures.get()), 90);
-    addComponent(m_Equator = new Equator(this), 95);
-    addComponent(m_Ecliptic = new Ecliptic(this), 95);
-    addComponent(m_Horizon = new HorizonComponent(this), 100);
-    addComponent(m_DeepSky = new DeepSkyComponent(this), 5);
-    addComponent(m_ConstellationArt = new ConstellationArtComponent(this, m_Cultures.get()), 100);
-
-    addComponent(m_ArtificialHorizon = new ArtificialHorizonComponent(this), 110);
-
-    m_internetResolvedCat = "_Internet_Resolved";
-    m_manualAdditionsCat  = "_Manual_Additions";
-    addComponent(m_internetResolvedComponent = new SyncedCatalogComponent(this, m_internetResolvedCat, true, 0), 6);
-    addComponent(m_manualAdditionsComponent = new SyncedCatalogComponent(this, m_manualAdditionsCat, true, 0), 6);
-    m_CustomCatalogs.reset(new SkyComposite(this));
-    QStringList allcatalogs = Options::showCatalogNames();
+    addLoader("sky-clines", QStringList() << "sky-stars" << "sky-cultures", [this]()
+    {
+        addComponent(m_CLines = new ConstellationLines(this, m_Cultures.get()), 85);
+    });
 
-    if (!allcatalogs.contains(m_internetResolvedCat))
+    addLoader("sky-cnames", QStringList() << "sky-cultures", [this]()
     {
-        allcatalogs.append(m_internetResolvedCat);
-    }
-    if (!allcatalogs.contains(m_manualAdditionsCat))
+        addComponent(m_CNames = new ConstellationNamesComponent(this, m_Cultures.get()), 90);
+    });
+
+    addLoader("sky-guides", QStringList(), [this]()
     {
-        allcatalogs.append(m_manualAdditionsCat);
-    }
-    Options::setShowCatalogNames(allcatalogs);
+        addComponent(m_Equator = new Equator(this), 95);
+        addComponent(m_Ecliptic = new Ecliptic(this), 95);
+        addComponent(m_Horizon = new HorizonComponent(this), 100);
+    });
 
-    for (int i = 0; i < allcatalogs.size(); ++i)
+    addLoader("sky-deepsky", QStringList() << "sky-ngcic", [this, ngcicStore]()
     {
-        if (allcatalogs.at(i) == m_internetResolvedCat ||
-                allcatalogs.at(i) == m_manualAdditionsCat) // This is a special catalog
-            continue;
-        m_CustomCatalogs->addComponent(new CatalogComponent(this, allcatalogs.at(i), false, i),
-                                       6); // FIXME: Should this be 6 or 5? See SkyMapComposite::reloadDeepSky()
-    }
+        addComponent(m_DeepSky = new DeepSkyComponent(this, std::move(*ngcicStore)), 5);
+    });
 
-    addComponent(m_SolarSystem = new SolarSystemComposite(this), 2);
-
-    //addComponent( m_ObservingList = new TargetListComponent( this , 0, QPen(),
-    //                                                       &Options::obsListSymbol, &Options::obsListText ), 120 );
-    addComponent(m_StarHopRouteList = new TargetListComponent(this, 0, QPen()), 130);
-    addComponent(m_Satellites = new SatellitesComponent(this), 7);
-    addComponent(m_Supernovae = new SupernovaeComponent(this), 7);
-    SkyMapLite::Instance()->loadingFinished();
-#else
-    addComponent(m_MilkyWay = new MilkyWay(this), 50);
-    addComponent(m_Stars = StarComponent::Create(this), 10);
-    addComponent(m_EquatorialCoordinateGrid = new EquatorialCoordinateGrid(this));
-    addComponent(m_HorizontalCoordinateGrid = new HorizontalCoordinateGrid(this));
-    addComponent(m_LocalMeridianComponent = new LocalMeridianComponent(this));
-
-    // Do add to components.
-    addComponent(m_CBoundLines = new ConstellationBoundaryLines(this), 80);
-    m_Cultures.reset(new CultureList());
-    addComponent(m_CLines = new ConstellationLines(this, m_Cultures.get()), 85);
-    addComponent(m_CNames = new ConstellationNamesComponent(this, m_Cultures.get()), 90);
-    addComponent(m_Equator = new Equator(this), 95);
-    addComponent(m_Ecliptic = new Ecliptic(this), 95);
-    addComponent(m_Horizon = new HorizonComponent(this), 100);
-    addComponent(m_DeepSky = new DeepSkyComponent(this), 5);
-    addComponent(m_ConstellationArt = new ConstellationArtComponent(this, m_Cultures.get()), 100);
-
-    // Hips
-    addComponent(m_HiPS = new HIPSComponent(this));
-
-    addComponent(m_Terrain = new TerrainComponent(this));
-
-    addComponent(m_ArtificialHorizon = new ArtificialHorizonComponent(this), 110);
-
-    m_internetResolvedCat = "_Internet_Resolved";
-    m_manualAdditionsCat  = "_Manual_Additions";
-    addComponent(m_internetResolvedComponent = new SyncedCatalogComponent(this, m_internetResolvedCat, true, 0), 6);
-    addComponent(m_manualAdditionsComponent = new SyncedCatalogComponent(this, m_manualAdditionsCat, true, 0), 6);
-    m_CustomCatalogs.reset(new SkyComposite(this));
-    QStringList allcatalogs = Options::showCatalogNames();
-    for (int i = 0; i < allcatalogs.size(); ++i)
+    addLoader("sky-cart", QStringList() << "sky-cultures", [this]()
     {
-        if (allcatalogs.at(i) == m_internetResolvedCat ||
-                allcatalogs.at(i) == m_manualAdditionsCat) // This is a special catalog
-            continue;
-        m_CustomCatalogs->addComponent(new CatalogComponent(this, allcatalogs.at(i), false, i),
-                                       6); // FIXME: Should this be 6 or 5? See SkyMapComposite::reloadDeepSky()
-    }
+        addComponent(m_ConstellationArt = new ConstellationArtComponent(this, m_Cultures.get()), 100);
+    });
 
-    addComponent(m_SolarSystem = new SolarSystemComposite(this), 2);
+#ifndef KSTARS_LITE
+    addLoader("sky-hips", QStringList(), [this]()
+    {
+        addComponent(m_HiPS = new HIPSComponent(this));
+        addComponent(m_Terrain = new TerrainComponent(this));
+    });
+#endif
 
-    addComponent(m_Flags = new FlagComponent(this), 4);
+    addLoader("sky-artificialhorizon", QStringList(), [this]()
+    {
+        addComponent(m_ArtificialHorizon = new ArtificialHorizonComponent(this), 110);
+    });
 
-    addComponent(m_ObservingList =
-                     new TargetListComponent(this, nullptr, QPen(), &Options::obsListSymbol, &Options::obsListText),
-                 120);
-    addComponent(m_StarHopRouteList = new TargetListComponent(this, nullptr, QPen()), 130);
-    addComponent(m_Satellites = new SatellitesComponent(this), 7);
-    addComponent(m_Supernovae = new SupernovaeComponent(this), 7);
+    addLoader("sky-catalogs", QStringList(), [this]()
+    {
+        m_internetResolvedCat = "_Internet_Resolved";
+        m_manualAdditionsCat  = "_Manual_Additions";
+        addComponent(m_internetResolvedComponent = new SyncedCatalogComponent(this, m_internetResolvedCat, true, 0), 6);
+        addComponent(m_manualAdditionsComponent = new SyncedCatalogComponent(this, m_manualAdditionsCat, true, 0), 6);
+        m_CustomCatalogs.reset(new SkyComposite(this));
+        QStringList allcatalogs = Options::showCatalogNames();
+#ifdef KSTARS_LITE
+        if (!allcatalogs.contains(m_internetResolvedCat))
+        {
+            allcatalogs.append(m_internetResolvedCat);
+        }
+        if (!allcatalogs.contains(m_manualAdditionsCat))
+        {
+            allcatalogs.append(m_manualAdditionsCat);
+        }
+        Options::setShowCatalogNames(allcatalogs);
 #endif
-    connect(this, SIGNAL(progressText(QString)), KStarsData::Instance(), SIGNAL(progressText(QString)));
+
+        for (int i = 0; i < allcatalogs.size(); ++i)
+        {
+            if (allcatalogs.at(i) == m_internetResolvedCat ||
+                    allcatalogs.at(i) == m_manualAdditionsCat) // This is a special catalog
+                continue;
+            m_CustomCatalogs->addComponent(new CatalogComponent(this, allcatalogs.at(i), false, i),
+                                           6); // FIXME: Should this be 6 or 5? See SkyMapComposite::reloadDeepSky()
+        }
+    });
+
+    addLoader("sky-solarsystem", QStringList(), [this]()
+    {
+        addComponent(m_SolarSystem = new SolarSystemComposite(this), 2);
+    });
+
+    addLoader("sky-targetlists", QStringList(), [this]()
+    {
+#ifndef KSTARS_LITE
+        addComponent(m_Flags = new FlagComponent(this), 4);
+
+        addComponent(m_ObservingList =
+                         new TargetListComponent(this, nullptr, QPen(), &Options::obsListSymbol, &Options::obsListText),
+                     120);
+#endif
+        addComponent(m_StarHopRouteList = new TargetListComponent(this, nullptr, QPen()), 130);
+    });
+
+    addLoader("sky-satellites", QStringList(), [this]()
+    {
+        addComponent(m_Satellites = new SatellitesComponent(this), 7);
+    });
+
+    addLoader("sky-supernovae", QStringList(), [this]()
+    {
+        addComponent(m_Supernovae = new SupernovaeComponent(this), 7);
+    });
+
+#ifdef KSTARS_LITE
+    addLoader("sky-lite", QStringList(loaders), []()
+    {
+        SkyMapLite::Instance()->loadingFinished();
+    });
+#endif
+
+    return loaders;
 }
 
 void SkyMapComposite::update(KSNumbers *num)
@@ -279,6 +335,13 @@ void SkyMapComposite::draw(SkyPainter *skyp)
         return;
     }
 
+    // Time every component separately, so the profiler shows where a frame goes
+    auto drawComponent = [skyp](SkyComponent *component, const QString &name)
+    {
+        KSPROFILE_SCOPE("draw", name);
+        component->draw(skyp);
+    };
+
     m_skyMesh->inDraw(true);
     SkyPoint *focus = map->focus();
     m_skyMesh->aperture(focus, radius + 1.0, DRAW_BUF); // divide by 2 for testing
@@ -314,71 +377,77 @@ void SkyMapComposite::draw(SkyPainter *skyp)
             }
     }
 
-    m_MilkyWay->draw(skyp);
+    drawComponent(m_MilkyWay, QStringLiteral("MilkyWay"));
 
     // Draw HIPS after milky way but before everything else
-    m_HiPS->draw(skyp);
+    drawComponent(m_HiPS, QStringLiteral("HiPS"));
 
-    m_EquatorialCoordinateGrid->draw(skyp);
-    m_HorizontalCoordinateGrid->draw(skyp);
-    m_LocalMeridianComponent->draw(skyp);
+    drawComponent(m_EquatorialCoordinateGrid, QStringLiteral("EquatorialCoordinateGrid"));
+    drawComponent(m_HorizontalCoordinateGrid, QStringLiteral("HorizontalCoordinateGrid"));
+    drawComponent(m_LocalMeridianComponent, QStringLiteral("LocalMeridian"));
 
     //Draw constellation boundary lines only if we draw western constellations
     if (m_Cultures->current() == "Western")
     {
-        m_CBoundLines->draw(skyp);
-        m_ConstellationArt->draw(skyp);
+        drawComponent(m_CBoundLines, QStringLiteral("ConstellationBoundaryLines"));
+        drawComponent(m_ConstellationArt, QStringLiteral("ConstellationArt"));
     }
     else if (m_Cultures->current() == "Inuit")
     {
-        m_ConstellationArt->draw(skyp);
+        drawComponent(m_ConstellationArt, QStringLiteral("ConstellationArt"));
     }
 
-    m_CLines->draw(skyp);
+    drawComponent(m_CLines, QStringLiteral("ConstellationLines"));
 
-    m_Equator->draw(skyp);
+    drawComponent(m_Equator, QStringLiteral("Equator"));
 
-    m_Ecliptic->draw(skyp);
+    drawComponent(m_Ecliptic, QStringLiteral("Ecliptic"));
 
-    m_DeepSky->draw(skyp);
+    drawComponent(m_DeepSky, QStringLiteral("DeepSky"));
 
-    m_CustomCatalogs->draw(skyp);
-    m_internetResolvedComponent->draw(skyp);
-    m_manualAdditionsComponent->draw(skyp);
+    drawComponent(m_CustomCatalogs.get(), QStringLiteral("CustomCatalogs"));
+    drawComponent(m_internetResolvedComponent, QStringLiteral("InternetResolved"));
+    drawComponent(m_manualAdditionsComponent, QStringLiteral("ManualAdditions"));
 
-    m_Stars->draw(skyp);
+    drawComponent(m_Stars, QStringLiteral("Stars"));
 
-    m_SolarSystem->drawTrails(skyp);
-    m_SolarSystem->draw(skyp);
+    {
+        KSPROFILE_SCOPE("draw", QStringLiteral("SolarSystemTrails"));
+        m_SolarSystem->drawTrails(skyp);
+    }
+    drawComponent(m_SolarSystem, QStringLiteral("SolarSystem"));
 
-    m_Satellites->draw(skyp);
+    drawComponent(m_Satellites, QStringLiteral("Satellites"));
 
-    m_Supernovae->draw(skyp);
+    drawComponent(m_Supernovae, QStringLiteral("Supernovae"));
 
-    map->drawObjectLabels(labelObjects());
+    {
+        KSPROFILE_SCOPE("draw", QStringLiteral("Labels"));
+        map->drawObjectLabels(labelObjects());
 
-    m_skyLabeler->drawQueuedLabels();
-    m_CNames->draw(skyp);
-    m_Stars->drawLabels();
-    m_DeepSky->drawLabels();
+        m_skyLabeler->drawQueuedLabels();
+        m_CNames->draw(skyp);
+        m_Stars->drawLabels();
+        m_DeepSky->drawLabels();
+    }
 
     m_ObservingList->pen = QPen(QColor(data->colorScheme()->colorNamed("ObsListColor")), 1.);
     m_ObservingList->list2 = KStarsData::Instance()->observingList()->sessionList();
-    m_ObservingList->draw(skyp);
+    drawComponent(m_ObservingList, QStringLiteral("ObservingList"));
 
-    m_Flags->draw(skyp);
+    drawComponent(m_Flags, QStringLiteral("Flags"));
 
     m_StarHopRouteList->pen = QPen(QColor(data->colorScheme()->colorNamed("StarHopRouteColor")), 1.);
-    m_StarHopRouteList->draw(skyp);
+    drawComponent(m_StarHopRouteList, QStringLiteral("StarHopRoute"));
 
-    m_ArtificialHorizon->draw(skyp);
+    drawComponent(m_ArtificialHorizon, QStringLiteral("ArtificialHorizon"));
 
-    m_Horizon->draw(skyp);
+    drawComponent(m_Horizon, QStringLiteral("Horizon"));
 
     m_skyMesh->inDraw(false);
 
     // Draw terrain at the end.
-    m_Terrain->draw(skyp);
+    drawComponent(m_Terrain, QStringLiteral("Terrain"));
 
     // DEBUG Edit. Keywords: Trixel boundaries. Currently works only in QPainter mode
     // -jbb uncomment these to see trixel outlines:
@@ -632,6 +701,13 @@ SkyObject *SkyMapComposite::findByName(const QString &name)
     return nullptr;
 }
 
+SkyObject *SkyMapComposite::objectOf(const QPair<QString, const SkyObject *> &entry)
+{
+    if (entry.second != nullptr)
+        return const_cast<SkyObject *>(entry.second);
+    return findByName(entry.first);
+}
+
 SkyObject *SkyMapComposite::findStarByGenetiveName(const QString name)
 {
     return m_Stars->findStarByGenetiveName(name);
@@ -665,7 +741,7 @@ KSPlanetBase *SkyMapComposite::planet(int n)
 void SkyMapComposite::addCustomCatalog(const QString &filename, int index)
 {
     CatalogComponent *cc = new CatalogComponent(this, filename, false, index);
-    if (cc->objectList().size())
+    if (cc->objectCount())
     {
         m_CustomCatalogs->addComponent(cc);
     }
@@ -54,6 +54,7 @@ class SkyMap;
 class SkyObject;
 class SolarSystemComposite;
 class StarComponent;
+class StartupTaskGraph;
 class SupernovaeComponent;
 class SyncedCatalogComponent;
 class TargetListComponent;
@@ -79,11 +80,26 @@ class SkyMapComposite : public QObject, public SkyComposite
         /**
          * Constructor
          * @p parent pointer to the parent SkyComponent
+         * @note The sky components are not created here, see addLoaders().
          */
         explicit SkyMapComposite(SkyComposite *parent = nullptr);
 
         virtual ~SkyMapComposite() override = default;
 
+        /**
+         * @short Register the loaders of the sky components in a startup graph
+         *
+         * Each group of components becomes its own task, depending only on the
+         * groups it needs (e.g. constellation lines on stars and cultures), so
+         * independent groups load as soon as they are ready. The components are
+         * built on the main thread as they share the sky mesh buffers and the
+         * name lists; ngcic.dat is compiled on a worker while the stars load.
+         * @p graph the startup graph, not run yet
+         * @p dependencies tasks every loader depends on
+         * @return the names of the loaders, all of them completed means the composite is ready
+         */
+        QStringList addLoaders(StartupTaskGraph *graph, const QStringList &dependencies);
+
         void update(KSNumbers *num = nullptr) override;
 
         /**
@@ -155,6 +171,13 @@ class SkyMapComposite : public QObject, public SkyComposite
          */
         SkyObject *findByName(const QString &name) override;
 
+        /**
+         * @return the object of an entry of objectLists()
+         * @note Entries of objects which are created on demand have no object yet, it is then
+         * found by name and created.
+         */
+        SkyObject *objectOf(const QPair<QString, const SkyObject *> &entry);
+
         /**
          * @return the list of objects in the region defined by skypoints
          * @param p1 first sky point (top-left vertex of rectangular region)
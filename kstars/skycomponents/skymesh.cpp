@@ -30,6 +30,8 @@
 #include <QPolygonF>
 #include <QPointF>
 
+#include <cmath>
+
 QMap<int, SkyMesh *> SkyMesh::pinstances;
 int SkyMesh::defaultLevel = -1;
 
@@ -60,6 +62,48 @@ SkyMesh::SkyMesh(int level) : HTMesh(level, level, NUM_MESH_BUF), m_drawID(0), m
 {
     errLimit = HTMesh::size() / 4;
     m_inDraw = false;
+    // Room for the covers of a few dozen typical fields of view
+    m_coverCache.setMaxCost(16 * HTMesh::size());
+}
+
+void SkyMesh::intersect(double ra, double dec, double radius, BufNum bufNum)
+{
+    // Grid spacing: a power of two degrees close to radius / 64
+    const int scale   = static_cast<int>(std::floor(std::log2(std::max(radius, 1e-4) / 64.0)));
+    const double step = std::ldexp(1.0, scale);
+
+    ra = std::fmod(ra, 360.0);
+    if (ra < 0)
+        ra += 360.0;
+
+    CoverKey key;
+    key.ra     = static_cast<int>(std::lround(ra / step));
+    key.dec    = static_cast<int>(std::lround(dec / step));
+    key.radius = static_cast<int>(std::ceil(radius / step));
+    key.scale  = scale;
+
+    MeshBuffer *buffer = meshBuffer(bufNum);
+
+    const QVector<Trixel> *cover = m_coverCache.object(key);
+    if (cover)
+    {
+        buffer->reset();
+        for (Trixel trixel : *cover)
+            buffer->append(trixel);
+        return;
+    }
+
+    // Rounding moves the center by at most step / sqrt(2), so one more step of radius
+    // covers every circle with this key
+    HTMesh::intersect(key.ra * step, qBound(-90.0, key.dec * step, 90.0), (key.radius + 1) * step, bufNum);
+
+    // Do not keep a truncated result
+    if (buffer->error())
+        return;
+
+    QVector<Trixel> *trixels = new QVector<Trixel>(buffer->size());
+    std::copy(buffer->buffer(), buffer->buffer() + buffer->size(), trixels->begin());
+    m_coverCache.insert(key, trixels, std::max(1, trixels->size()));
 }
 
 void SkyMesh::aperture(SkyPoint *p0, double radius, MeshBufNum_t bufNum)
@@ -86,7 +130,7 @@ void SkyMesh::aperture(SkyPoint *p0, double radius, MeshBufNum_t bufNum)
 #endif
     }
 
-    HTMesh::intersect(p1.ra().Degrees(), p1.dec().Degrees(), radius, (BufNum)bufNum);
+    intersect(p1.ra().Degrees(), p1.dec().Degrees(), radius, (BufNum)bufNum);
     m_drawID++;
 //    if (m_inDraw && bufNum != DRAW_BUF)
 //        printf("Warning: overlapping buffer: %d\n", bufNum);
@@ -114,7 +158,7 @@ void SkyMesh::indexStar(StarObject *star1, StarObject *star2)
 
 void SkyMesh::index(const SkyPoint *p, double radius, MeshBufNum_t bufNum)
 {
-    HTMesh::intersect(p->ra().Degrees(), p->dec().Degrees(), radius, (BufNum)bufNum);
+    intersect(p->ra().Degrees(), p->dec().Degrees(), radius, (BufNum)bufNum);
 //    if (m_inDraw && bufNum != DRAW_BUF)
 //        printf("Warning: overlapping buffer: %d\n", bufNum);
 }
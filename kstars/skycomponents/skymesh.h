@@ -21,7 +21,9 @@
 #include "typedef.h"
 #include "htmesh/HTMesh.h"
 
+#include <QCache>
 #include <QMap>
+#include <QVector>
 
 class QPainter;
 class QPointF;
@@ -129,6 +131,25 @@ class SkyMesh : public HTMesh
          */
     Trixel index(const SkyPoint *p);
 
+    /**
+         *@short finds the trixels that cover the circle, like HTMesh::intersect(),
+         * but remembers the result.
+         *
+         * The center and radius are rounded to a grid that is 1/64 of the radius
+         * and the cover is computed for a circle enlarged to contain every circle
+         * rounding to the same grid point. Repeated and nearby queries, such as the
+         * apertures of consecutive frames of a slow pan, copy the cached trixels
+         * into the buffer instead of intersecting the mesh again. The buffer may
+         * hold a few trixels beyond the exact cover, so callers must still check
+         * the distance of what they find, as they already do.
+         *@param ra Central ra in degrees
+         *@param dec Central dec in degrees
+         *@param radius Radius of the circle in degrees
+         *@param bufNum the output buffer to hold the results
+         */
+    void intersect(double ra, double dec, double radius, BufNum bufNum = 0);
+    using HTMesh::intersect;
+
     /**
          * @short returns the sky region needed to cover the rectangle defined by two
          * SkyPoints p1 and p2
@@ -294,6 +315,25 @@ class SkyMesh : public HTMesh
     void inDraw(bool inDraw) { m_inDraw = inDraw; }
 
   private:
+    // Circle on the grid of intersect(): center and radius in units of 2^scale degrees
+    struct CoverKey
+    {
+        int ra, dec, radius, scale;
+
+        bool operator==(const CoverKey &other) const
+        {
+            return ra == other.ra && dec == other.dec && radius == other.radius && scale == other.scale;
+        }
+
+        friend uint qHash(const CoverKey &key, uint seed = 0)
+        {
+            return qHash(qMakePair(qMakePair(key.ra, key.dec), qMakePair(key.radius, key.scale)), seed);
+        }
+    };
+
+    // Sorted trixels of recent covers, the cost of an entry is its number of trixels
+    QCache<CoverKey, QVector<Trixel>> m_coverCache;
+
     DrawID m_drawID;
     int errLimit { 0 };
     int m_debug { 0 };
@@ -31,6 +31,8 @@
 SyncedCatalogComponent::SyncedCatalogComponent(SkyComposite *parent, const QString &catname, bool showerrs, int index)
     : CatalogComponent(parent, catname, showerrs, index, false)
 {
+    m_LoadByTrixel = false;
+
     // First check if the catalog exists
     CatalogDB *db = KStarsData::Instance()->catalogdb();
     Q_ASSERT(db);
@@ -111,6 +113,7 @@ DeepSkyObject *SyncedCatalogComponent::addObject(CatalogEntryData &catalogEntry)
         objectLists()[newObj->type()].append(QPair<QString, const SkyObject *>(newObj->name(), newObj));
     }
     m_ObjectList.append(newObj);
+    indexObject(newObj);
     qDebug() << "Added new SkyObject " << newObj->name() << " to synced catalog " << m_catName << " which now contains "
              << m_ObjectList.count() << " objects.";
     return newObj;
@@ -155,6 +158,7 @@ bool SyncedCatalogComponent::removeObject(SkyObject &object)
         return false;
     }
     m_ObjectList.removeAll(&object);
+    unindexObject(&object);
     qDebug() << "Remove SkyObject " << name << " from synced catalog " << m_catName;
     // Remove the catalog entry
     CatalogEntryData cedata = NameResolver::resolveName(name);
@@ -1236,8 +1236,17 @@ void SkyMap::forceUpdate(bool now)
 
     computeSkymap = true;
 
-    // Ensure that stars are recomputed
-    data->incUpdateID();
+    // Ensure that stars are recomputed if the sky moved. Their horizontal coordinates only
+    // depend on the time and the location, so while the clock is stopped a pan or a zoom
+    // reuses the coordinates of the previous frame.
+    if (data->lst()->Degrees() != m_CoordinatesLST || data->geo()->lat()->Degrees() != m_CoordinatesLatitude ||
+            Options::useRelativistic() != m_CoordinatesRelativistic || Options::alwaysRecomputeCoordinates())
+    {
+        m_CoordinatesLST          = data->lst()->Degrees();
+        m_CoordinatesLatitude     = data->geo()->lat()->Degrees();
+        m_CoordinatesRelativistic = Options::useRelativistic();
+        data->incUpdateID();
+    }
 
     if (now)
         m_SkyMapDraw->repaint();
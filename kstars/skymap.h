@@ -369,6 +369,8 @@ class SkyMap : public QGraphicsView
         /** Recalculates the positions of objects in the sky, and then repaints the sky map.
              * If the positions don't need to be recalculated, use update() instead of forceUpdate().
              * This saves a lot of CPU time.
+             * The horizontal coordinates of the objects are only recomputed if the sidereal time or
+             * the location changed, so panning and zooming while the clock is stopped only projects them again.
              * @param now if true, paintEvent() is run immediately.  Otherwise, it is added to the event queue
              */
         void forceUpdate(bool now = false);
@@ -720,6 +722,11 @@ class SkyMap : public QGraphicsView
 
         Projector *m_proj { nullptr };
 
+        // Sidereal time, latitude and options the horizontal coordinates were last computed for
+        double m_CoordinatesLST { -1 };
+        double m_CoordinatesLatitude { -1 };
+        bool m_CoordinatesRelativistic { false };
+
         SkyLine AngularRuler; //The line for measuring angles in the map
         QRect ZoomRect;       //The manual-focus circle.
 
@@ -441,6 +441,8 @@ void SkyMapDrawAbstract::exportSkyImage(SkyQPainter *painter, bool scale)
 
     painter->drawSkyBackground();
     m_KStarsData->skyComposite()->draw(painter);
+    // The overlays are drawn with plain QPainter calls
+    painter->flushPointSources();
     drawOverlays(*painter);
     painter->setVectorStars(vectorStarState); // Restore the state of the painter
 }
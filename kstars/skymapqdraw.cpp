@@ -15,6 +15,7 @@
  ***************************************************************************/
 
 #include "skymapqdraw.h"
+#include "ksprofiler.h"
 #include "skymapcomposite.h"
 #include "skyqpainter.h"
 #include "skymap.h"
@@ -66,6 +67,8 @@ void SkyMapQDraw::paintEvent(QPaintEvent *event)
         return; // exit because the pixmap is repainted and that's all what we want
     }
 
+    KSPROFILE_SCOPE("draw", QStringLiteral("Frame"));
+
     // FIXME: used to notify infobox about possible change of object coordinates
     // Not elegant at all. Should find better option
     m_SkyMap->showFocusCoords();
@@ -0,0 +1,485 @@
+/*  KStars Ephemeris Cache
+    Piecewise Chebyshev fits of the positions of the planets and the Moon.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#include "ksephemeriscache.h"
+
+#include "kspaths.h"
+#include "kstarsdatetime.h"
+#include "skyobjects/ksmoon.h"
+#include "skyobjects/ksplanet.h"
+#include "skyobjects/kssun.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+#include <kstars_debug.h>
+
+namespace
+{
+const quint32 CACHE_MAGIC   = 0x4b534543; // KSEC
+const quint32 CACHE_VERSION = 2;
+// Magic, version and degree
+const int HEADER_SIZE = 12;
+// Key, segment count, error bound and the largest number of segments
+const quint32 MAX_RECORD_SIZE = 20 + (KSEphemerisCache::BLOCK_DAYS / KSEphemerisCache::MIN_SEGMENT_DAYS) *
+                                (2 + 3 * (KSEphemerisCache::DEGREE + 1)) * sizeof(double);
+
+qint64 blockIndex(long double jd)
+{
+    return static_cast<qint64>(std::floor(static_cast<double>(jd) / KSEphemerisCache::BLOCK_DAYS));
+}
+}
+
+constexpr int KSEphemerisCache::DEGREE;
+constexpr double KSEphemerisCache::BLOCK_DAYS;
+constexpr double KSEphemerisCache::MIN_SEGMENT_DAYS;
+constexpr double KSEphemerisCache::TOLERANCE;
+constexpr int KSEphemerisCache::MAX_BLOCKS;
+
+KSEphemerisCache *KSEphemerisCache::Instance()
+{
+    static KSEphemerisCache cache;
+    return &cache;
+}
+
+KSEphemerisCache::KSEphemerisCache()
+{
+    // Private copies, the fits are computed in other threads
+    m_Planets[MERCURY].reset(new KSPlanet(i18n("Mercury")));
+    m_Planets[VENUS].reset(new KSPlanet(i18n("Venus")));
+    m_Planets[EARTH].reset(new KSPlanet(i18n("Earth")));
+    m_Planets[MARS].reset(new KSPlanet(i18n("Mars")));
+    m_Planets[JUPITER].reset(new KSPlanet(i18n("Jupiter")));
+    m_Planets[SATURN].reset(new KSPlanet(i18n("Saturn")));
+    m_Planets[URANUS].reset(new KSPlanet(i18n("Uranus")));
+    m_Planets[NEPTUNE].reset(new KSPlanet(i18n("Neptune")));
+    m_Moon.reset(new KSMoon());
+
+    // Queries use the series until the fits are read
+    m_Loading = QtConcurrent::run([this]()
+    {
+        load();
+    });
+}
+
+KSEphemerisCache::~KSEphemerisCache()
+{
+    m_Loading.waitForFinished();
+}
+
+KSEphemerisCache::Body KSEphemerisCache::bodyForName(const QString &untranslatedName)
+{
+    if (untranslatedName == "Mercury")
+        return MERCURY;
+    else if (untranslatedName == "Venus")
+        return VENUS;
+    else if (untranslatedName == "Earth")
+        return EARTH;
+    else if (untranslatedName == "Mars")
+        return MARS;
+    else if (untranslatedName == "Jupiter")
+        return JUPITER;
+    else if (untranslatedName == "Saturn")
+        return SATURN;
+    else if (untranslatedName == "Uranus")
+        return URANUS;
+    else if (untranslatedName == "Neptune")
+        return NEPTUNE;
+    else if (untranslatedName == "Moon")
+        return MOON;
+
+    return NO_BODY;
+}
+
+KSEphemerisCache::Body KSEphemerisCache::bodyForObject(const SkyObject *object)
+{
+    if (dynamic_cast<const KSMoon *>(object))
+        return MOON;
+    if (dynamic_cast<const KSSun *>(object))
+        return EARTH;
+
+    const KSPlanet *planet = dynamic_cast<const KSPlanet *>(object);
+    return planet ? bodyForName(planet->untranslatedName()) : NO_BODY;
+}
+
+QFuture<void> KSEphemerisCache::request(const QVector<Body> &bodies, long double startJD, long double stopJD)
+{
+    {
+        // The series are read from disk on first use, which must not happen in the workers
+        QWriteLocker locker(&m_Lock);
+        for (Body body : bodies)
+        {
+            if (body == MOON)
+                m_Moon->loadData();
+            else if (body > NO_BODY && body < MOON)
+                m_Planets[body]->loadData();
+        }
+    }
+
+    return QtConcurrent::run([this, bodies, startJD, stopJD]()
+    {
+        // Blocks read from the cache file are not fitted again
+        m_Loading.waitForFinished();
+
+        QVector<quint64> keys;
+        {
+            QWriteLocker locker(&m_Lock);
+            for (Body body : bodies)
+            {
+                if (body <= NO_BODY || body >= BODY_COUNT)
+                    continue;
+
+                for (qint64 block = blockIndex(startJD); block <= blockIndex(stopJD); block++)
+                {
+                    const quint64 key = blockKey(body, block);
+                    if (m_Blocks.contains(key) || m_Pending.contains(key))
+                        continue;
+
+                    if (m_Blocks.size() + m_Pending.size() >= MAX_BLOCKS)
+                    {
+                        qCWarning(KSTARS) << "Ephemeris cache is full, positions are computed from the series.";
+                        break;
+                    }
+
+                    m_Pending.insert(key);
+                    keys.append(key);
+                }
+            }
+        }
+
+        if (keys.isEmpty())
+            return;
+
+        QVector<quint64> blocks = keys;
+        QtConcurrent::blockingMap(blocks, [this](quint64 & key)
+        {
+            fitBlock(key);
+        });
+        save(keys);
+    });
+}
+
+bool KSEphemerisCache::ecliptic(Body body, long double jd, EclipticPosition &position) const
+{
+    if (body <= NO_BODY || body >= BODY_COUNT || m_BlockCount.load() == 0)
+        return false;
+
+    const double t = static_cast<double>(jd);
+    double xyz[3];
+    {
+        QReadLocker locker(&m_Lock);
+
+        auto block = m_Blocks.constFind(blockKey(body, blockIndex(jd)));
+        if (block == m_Blocks.constEnd())
+            return false;
+
+        // Last segment starting before jd
+        const QVector<Segment> &segments = block.value().segments;
+        auto segment = std::upper_bound(segments.constBegin(), segments.constEnd(), t,
+                                        [](double value, const Segment & segment)
+        {
+            return value < segment.startJD;
+        });
+        if (segment != segments.constBegin())
+            --segment;
+
+        // Clenshaw recurrence
+        const double x = 2.0 * (t - segment->startJD) / segment->length - 1.0;
+        for (int i = 0; i < 3; i++)
+        {
+            const double *c = segment->coefficients[i];
+            double b1 = 0, b2 = 0;
+            for (int j = DEGREE; j > 0; j--)
+            {
+                const double b = c[j] + 2.0 * x * b1 - b2;
+                b2 = b1;
+                b1 = b;
+            }
+            xyz[i] = c[0] + x * b1 - b2;
+        }
+    }
+
+    position.longitude.setRadians(atan2(xyz[1], xyz[0]));
+    position.longitude.setD(position.longitude.reduce().Degrees());
+    position.latitude.setRadians(atan2(xyz[2], sqrt(xyz[0] * xyz[0] + xyz[1] * xyz[1])));
+    position.radius = sqrt(xyz[0] * xyz[0] + xyz[1] * xyz[1] + xyz[2] * xyz[2]);
+    return true;
+}
+
+double KSEphemerisCache::errorBound() const
+{
+    QReadLocker locker(&m_Lock);
+    return m_ErrorBound;
+}
+
+void KSEphemerisCache::clear()
+{
+    m_Loading.waitForFinished();
+
+    QMutexLocker saveLocker(&m_SaveMutex);
+    {
+        QWriteLocker locker(&m_Lock);
+        m_Blocks.clear();
+        m_ErrorBound = 0;
+        m_BlockCount.store(0);
+    }
+
+    QFile::remove(filename());
+}
+
+void KSEphemerisCache::fitBlock(quint64 key)
+{
+    const Body body    = static_cast<Body>(key >> 32);
+    const qint64 block = static_cast<qint32>(key & 0xffffffff);
+
+    Block fit;
+    fitSegments(body, block * BLOCK_DAYS, BLOCK_DAYS, fit);
+
+    QWriteLocker locker(&m_Lock);
+    m_Pending.remove(key);
+    m_Blocks.insert(key, fit);
+    m_ErrorBound = std::max(m_ErrorBound, fit.error);
+    m_BlockCount.store(m_Blocks.size());
+}
+
+void KSEphemerisCache::fitSegments(Body body, double startJD, double length, Block &block) const
+{
+    Segment segment;
+    const double segmentError = fitSegment(body, startJD, length, segment);
+
+    if (segmentError > TOLERANCE && length / 2 >= MIN_SEGMENT_DAYS)
+    {
+        fitSegments(body, startJD, length / 2, block);
+        fitSegments(body, startJD + length / 2, length / 2, block);
+        return;
+    }
+
+    block.segments.append(segment);
+    block.error = std::max(block.error, segmentError);
+}
+
+double KSEphemerisCache::fitSegment(Body body, double startJD, double length, Segment &segment) const
+{
+    const int N = DEGREE + 1;
+
+    segment.startJD = startJD;
+    segment.length  = length;
+
+    // Interpolate the series at the Chebyshev nodes
+    double values[N][3];
+    for (int k = 0; k < N; k++)
+    {
+        const double x = cos(dms::PI * (k + 0.5) / N);
+        seriesPosition(body, startJD + length * (x + 1.0) / 2.0, values[k]);
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < N; j++)
+        {
+            double sum = 0;
+            for (int k = 0; k < N; k++)
+                sum += values[k][i] * cos(dms::PI * j * (k + 0.5) / N);
+            segment.coefficients[i][j] = 2.0 * sum / N;
+        }
+        segment.coefficients[i][0] /= 2.0;
+    }
+
+    // The interpolation is exact at the nodes, test the ends and halfway between the nodes
+    double error = 0;
+    for (int k = 0; k <= N; k++)
+    {
+        const double x = cos(dms::PI * k / N);
+        double expected[3];
+        seriesPosition(body, startJD + length * (x + 1.0) / 2.0, expected);
+
+        double distance = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            const double *c = segment.coefficients[i];
+            double b1 = 0, b2 = 0;
+            for (int j = DEGREE; j > 0; j--)
+            {
+                const double b = c[j] + 2.0 * x * b1 - b2;
+                b2 = b1;
+                b1 = b;
+            }
+            const double difference = c[0] + x * b1 - b2 - expected[i];
+            distance += difference * difference;
+        }
+        error = std::max(error, sqrt(distance));
+    }
+
+    return error;
+}
+
+void KSEphemerisCache::seriesPosition(Body body, double jd, double xyz[3]) const
+{
+    EclipticPosition position;
+    if (body == MOON)
+        m_Moon->calcEcliptic((jd - J2000) / 36525.0, position);
+    else
+        m_Planets[body]->calcEclipticSeries((jd - J2000) / 365250.0, position);
+
+    double sinLong, cosLong, sinLat, cosLat;
+    position.longitude.SinCos(sinLong, cosLong);
+    position.latitude.SinCos(sinLat, cosLat);
+
+    xyz[0] = position.radius * cosLat * cosLong;
+    xyz[1] = position.radius * cosLat * sinLong;
+    xyz[2] = position.radius * sinLat;
+}
+
+QString KSEphemerisCache::filename() const
+{
+    return KSPaths::writableLocation(QStandardPaths::GenericCacheLocation) + "ephemeris.cache";
+}
+
+void KSEphemerisCache::load()
+{
+    QMutexLocker saveLocker(&m_SaveMutex);
+
+    QFile file(filename());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0, version = 0;
+    qint32 degree = 0;
+    in >> magic >> version >> degree;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION || degree != DEGREE)
+    {
+        qCDebug(KSTARS) << "Removing ephemeris cache" << file.fileName() << "of another version.";
+        file.close();
+        QFile::remove(filename());
+        return;
+    }
+
+    // Every record is checked, a damaged one and everything after it is dropped
+    QHash<quint64, Block> cache;
+    double errorBound = 0;
+    qint64 validSize  = HEADER_SIZE;
+    bool damaged      = false;
+    // A full cache is not damaged, the records after the first MAX_BLOCKS ones are kept in the file
+    while (!in.atEnd() && cache.size() < MAX_BLOCKS)
+    {
+        // Cleared once the record is read
+        damaged = true;
+
+        quint32 size = 0;
+        quint16 checksum = 0;
+        in >> size;
+        if (in.status() != QDataStream::Ok || size == 0 || size > MAX_RECORD_SIZE)
+            break;
+
+        const QByteArray record = file.read(size);
+        in >> checksum;
+        if (in.status() != QDataStream::Ok || record.size() != static_cast<int>(size) ||
+                qChecksum(record.constData(), record.size()) != checksum)
+            break;
+
+        QDataStream recordIn(record);
+        recordIn.setVersion(QDataStream::Qt_5_0);
+        quint64 key = 0;
+        qint32 count = 0;
+        Block block;
+        recordIn >> key >> count >> block.error;
+        if (count <= 0 || count > BLOCK_DAYS / MIN_SEGMENT_DAYS || static_cast<qint64>(key >> 32) >= BODY_COUNT)
+            break;
+
+        block.segments.resize(count);
+        for (auto &segment : block.segments)
+        {
+            recordIn >> segment.startJD >> segment.length;
+            for (auto &coefficients : segment.coefficients)
+                for (double &coefficient : coefficients)
+                    recordIn >> coefficient;
+        }
+        if (recordIn.status() != QDataStream::Ok || !recordIn.atEnd())
+            break;
+
+        cache.insert(key, block);
+        errorBound = std::max(errorBound, block.error);
+        validSize  = file.pos();
+        damaged    = false;
+    }
+
+    if (damaged)
+    {
+        qCWarning(KSTARS) << "Ephemeris cache" << file.fileName() << "is damaged after" << cache.size() << "blocks.";
+        file.close();
+        // Later records are appended to the valid part
+        QFile::resize(filename(), validSize);
+    }
+
+    QWriteLocker locker(&m_Lock);
+    for (auto block = cache.constBegin(); block != cache.constEnd(); ++block)
+        m_Blocks.insert(block.key(), block.value());
+    m_ErrorBound = std::max(m_ErrorBound, errorBound);
+    m_BlockCount.store(m_Blocks.size());
+}
+
+void KSEphemerisCache::save(const QVector<quint64> &keys) const
+{
+    // Requests finishing together append to the same file
+    QMutexLocker saveLocker(&m_SaveMutex);
+
+    QDir().mkpath(KSPaths::writableLocation(QStandardPaths::GenericCacheLocation));
+
+    QFile file(filename());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        qCWarning(KSTARS) << "Cannot write ephemeris cache" << file.fileName() << file.errorString();
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    if (file.size() == 0)
+        out << CACHE_MAGIC << CACHE_VERSION << static_cast<qint32>(DEGREE);
+
+    // Only the new blocks are appended, each record with its size and checksum
+    QReadLocker locker(&m_Lock);
+    for (quint64 key : keys)
+    {
+        auto block = m_Blocks.constFind(key);
+        if (block == m_Blocks.constEnd())
+            continue;
+
+        QByteArray record;
+        QDataStream recordOut(&record, QIODevice::WriteOnly);
+        recordOut.setVersion(QDataStream::Qt_5_0);
+        recordOut << key << static_cast<qint32>(block.value().segments.size()) << block.value().error;
+        for (const auto &segment : block.value().segments)
+        {
+            recordOut << segment.startJD << segment.length;
+            for (const auto &coefficients : segment.coefficients)
+                for (double coefficient : coefficients)
+                    recordOut << coefficient;
+        }
+
+        out << static_cast<quint32>(record.size());
+        out.writeRawData(record.constData(), record.size());
+        out << qChecksum(record.constData(), record.size());
+    }
+
+    if (out.status() != QDataStream::Ok)
+        qCWarning(KSTARS) << "Cannot write ephemeris cache" << file.fileName() << file.errorString();
+}
@@ -0,0 +1,162 @@
+/*  KStars Ephemeris Cache
+    Piecewise Chebyshev fits of the positions of the planets and the Moon.
+
+    Copyright (C) 2026 agent (agent@local)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+*/
+
+#pragma once
+
+#include "ksplanetbase.h"
+
+#include <QAtomicInt>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QVector>
+
+#include <memory>
+
+class KSMoon;
+class KSPlanet;
+class SkyObject;
+
+/**
+ * @class KSEphemerisCache
+ * @short Answers position queries of the planets and the Moon from piecewise Chebyshev fits.
+ *
+ * Evaluating the VSOP87 series of a planet or the series of the Moon takes thousands of terms.
+ * Tools which need a body at many instants request the time span first. The span is fitted in the
+ * background, afterwards KSPlanet::calcEcliptic() and KSMoon::findGeocentricPosition() evaluate a
+ * polynomial instead of the series. Instants outside of fitted spans still use the series.
+ *
+ * Time is split into blocks of BLOCK_DAYS days. A block of a body is covered by segments with
+ * polynomials of degree DEGREE in rectangular ecliptic coordinates. A segment is halved until it
+ * agrees with the series to TOLERANCE AU at its ends and halfway between its Chebyshev nodes.
+ * This is below 0.1 arcseconds for the Moon and below 0.005 arcseconds for the planets as seen
+ * from Earth, far smaller than the errors of the series themselves. errorBound() returns the
+ * largest deviation found.
+ *
+ * Fitted blocks are appended to a file in the cache directory, so later sessions do not fit them
+ * again. The file is read in the background when the cache is created, and every block is
+ * checked against its checksum. Until it is read, queries use the series.
+ *
+ * All functions are thread safe.
+ */
+class KSEphemerisCache
+{
+    public:
+        typedef enum
+        {
+            NO_BODY = -1,
+            MERCURY,
+            VENUS,
+            EARTH,
+            MARS,
+            JUPITER,
+            SATURN,
+            URANUS,
+            NEPTUNE,
+            MOON,
+            BODY_COUNT
+        } Body;
+
+        static KSEphemerisCache *Instance();
+
+        ~KSEphemerisCache();
+
+        /** @return the body of the planet with the given untranslated name, or NO_BODY. */
+        static Body bodyForName(const QString &untranslatedName);
+
+        /**
+         * @return the body whose position is needed to find the position of the object, NO_BODY if
+         * the object is not cached. The Sun is found from the position of the Earth.
+         */
+        static Body bodyForObject(const SkyObject *object);
+
+        /**
+         * @brief request Fit the positions of the bodies from startJD to stopJD in the background.
+         * Spans which are fitted already, or read from the cache file, are skipped. Callers in the
+         * user interface should wait for the future with a QFutureWatcher.
+         * @return a future which finishes once all blocks of the span are fitted.
+         */
+        QFuture<void> request(const QVector<Body> &bodies, long double startJD, long double stopJD);
+
+        /**
+         * @brief ecliptic Evaluate the fit of a body.
+         * @param jd Julian day
+         * @param position ecliptic coordinates referred to the equinox of date and distance in AU.
+         * Heliocentric for the planets, geocentric for the Moon.
+         * @return false if jd is not in a fitted span of the body.
+         */
+        bool ecliptic(Body body, long double jd, EclipticPosition &position) const;
+
+        /** @return the largest deviation of a fit from the series in AU. */
+        double errorBound() const;
+
+        /** Forget all fits, in memory and on disk. */
+        void clear();
+
+        static constexpr int DEGREE { 13 };
+        static constexpr double BLOCK_DAYS { 32 };
+        static constexpr double MIN_SEGMENT_DAYS { 0.5 };
+        static constexpr double TOLERANCE { 1e-9 };
+        // About 140 years of all bodies, some 25 MB
+        static constexpr int MAX_BLOCKS { 16384 };
+
+    private:
+        KSEphemerisCache();
+
+        struct Segment
+        {
+            double startJD;
+            double length;
+            // Chebyshev coefficients of x, y and z
+            double coefficients[3][DEGREE + 1];
+        };
+
+        struct Block
+        {
+            // Segments covering the block, in order of time
+            QVector<Segment> segments;
+            // Largest deviation of the segments from the series
+            double error { 0 };
+        };
+
+        static quint64 blockKey(Body body, qint64 block)
+        {
+            return (static_cast<quint64>(body) << 32) | static_cast<quint32>(block);
+        }
+
+        void fitBlock(quint64 key);
+        void fitSegments(Body body, double startJD, double length, Block &block) const;
+        // Returns the largest deviation from the series at the test points
+        double fitSegment(Body body, double startJD, double length, Segment &segment) const;
+        void seriesPosition(Body body, double jd, double xyz[3]) const;
+
+        QString filename() const;
+        void load();
+        // Appends the blocks to the cache file
+        void save(const QVector<quint64> &keys) const;
+
+        std::unique_ptr<KSPlanet> m_Planets[MOON];
+        std::unique_ptr<KSMoon> m_Moon;
+
+        mutable QReadWriteLock m_Lock;
+        mutable QMutex m_SaveMutex;
+        QHash<quint64, Block> m_Blocks;
+        // Blocks being fitted
+        QSet<quint64> m_Pending;
+        double m_ErrorBound { 0 };
+        // Reading of the cache file
+        QFuture<void> m_Loading;
+        // Lets queries skip the lock while nothing is cached
+        QAtomicInt m_BlockCount { 0 };
+};
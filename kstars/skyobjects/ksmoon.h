@@ -83,6 +83,15 @@ class KSMoon : public KSPlanetBase
      */
     bool findGeocentricPosition(const KSNumbers *num, const KSPlanetBase *) override;
 
+    /**
+     * Evaluate the lunar series, ignoring the fits of the ephemeris cache.
+     * @param T Julian centuries since J2000
+     * @param position geocentric ecliptic longitude, latitude and distance in AU
+     * @note loadData() must have been called.
+     * @see KSEphemerisCache
+     */
+    void calcEcliptic(double T, EclipticPosition &position) const;
+
     /**
      * @brief updateMag calls findMagnitude() to calculate current magnitude of moon
      * according to current phase. This function is required to perform findMagnitude()
@@ -17,9 +17,11 @@
 
 #include "ksplanet.h"
 
+#include "ksephemeriscache.h"
 #include "ksnumbers.h"
 #include "ksutils.h"
 #include "ksfilereader.h"
+#include "kstarsdatetime.h"
 
 #include <cmath>
 #include <typeinfo>
@@ -122,6 +124,7 @@ bool KSPlanet::OrbitDataManager::loadData(KSPlanet::OrbitDataColl &odc, const QS
 KSPlanet::KSPlanet(const QString &s, const QString &imfile, const QColor &c, double pSize)
     : KSPlanetBase(s, imfile, c, pSize)
 {
+    m_EphemerisBody = KSEphemerisCache::bodyForName(untranslatedName());
 }
 
 KSPlanet::KSPlanet(int n) : KSPlanetBase()
@@ -153,6 +156,8 @@ KSPlanet::KSPlanet(int n) : KSPlanetBase()
             qDebug() << "Error: Illegal identifier in KSPlanet constructor: " << n;
             break;
     }
+
+    m_EphemerisBody = KSEphemerisCache::bodyForName(untranslatedName());
 }
 
 KSPlanet *KSPlanet::clone() const
@@ -198,6 +203,15 @@ bool KSPlanet::loadData()
 }
 
 void KSPlanet::calcEcliptic(double Tau, EclipticPosition &epret) const
+{
+    if (KSEphemerisCache::Instance()->ecliptic(static_cast<KSEphemerisCache::Body>(m_EphemerisBody),
+            J2000 + Tau * 365250.0l, epret))
+        return;
+
+    calcEclipticSeries(Tau, epret);
+}
+
+void KSPlanet::calcEclipticSeries(double Tau, EclipticPosition &epret) const
 {
     double sum[6];
     OrbitDataColl odc;
@@ -84,6 +84,14 @@ class KSPlanet : public KSPlanetBase
      */
     virtual void calcEcliptic(double jm, EclipticPosition &ret) const;
 
+    /**
+     * Evaluate the VSOP87 series like calcEcliptic(), ignoring the fits of the ephemeris cache.
+     * @param jm Julian Millenia (=jd/1000)
+     * @param ret The ecliptic coordinates are returned by reference through this argument.
+     * @see KSEphemerisCache
+     */
+    void calcEclipticSeries(double jm, EclipticPosition &ret) const;
+
   protected:
     /**
      * Calculate the geocentric RA, Dec coordinates of the Planet.
@@ -183,4 +191,8 @@ class KSPlanet : public KSPlanetBase
   protected:
     bool data_loaded { false };
     static OrbitDataManager odm;
+
+  private:
+    // KSEphemerisCache::Body of this planet
+    int m_EphemerisBody { -1 };
 };
@@ -34,6 +34,7 @@
 
 #include <QDebug>
 
+#include <algorithm>
 #include <cmath>
 
 #ifdef HAVE_LIBNOVA
@@ -247,6 +248,17 @@ void SkyPoint::precess(const KSNumbers *num)
     Dec.setUsing_asin(v[2]);
 }
 
+void SkyPoint::apparentFromJ2000(const KSNumbers *num)
+{
+    // The catalog coordinates are CachingDms, so this needs no trigonometry until atan2 and asin
+    const Eigen::Vector3d s(RA0.cos() * Dec0.cos(), RA0.sin() * Dec0.cos(), Dec0.sin());
+    const Eigen::Vector3d v = num->precessionNutation() * s + num->aberration();
+
+    RA.setUsing_atan2(v[1], v[0]);
+    RA.reduceToRange(dms::ZERO_TO_2PI);
+    Dec.setUsing_asin(v[2] / v.norm());
+}
+
 SkyPoint SkyPoint::deprecess(const KSNumbers *num, long double epoch)
 {
     SkyPoint p1(RA, Dec);
@@ -514,11 +526,15 @@ void SkyPoint::updateCoords(const KSNumbers *num, bool /*includePlanets*/, const
     }
     if (recompute)
     {
-        precess(num);
-        nutate(num);
         if (lens)
+        {
+            precess(num);
+            nutate(num);
             bendlight(); // FIXME: Shouldn't we apply this on the horizontal coordinates?
-        aberrate(num);
+            aberrate(num);
+        }
+        else
+            apparentFromJ2000(num);
         lastPrecessJD = num->getJD();
         Q_ASSERT(std::isfinite(RA.Degrees()) && std::isfinite(Dec.Degrees()));
     }
@@ -675,6 +691,208 @@ void SkyPoint::GalacticToEquatorial1950(const dms *galLong, const dms *galLat)
     Dec.setRadians(asin(singLat * sinb + cosgLat * cosb * cosgLong_a));
 }
 
+namespace
+{
+// sin and cos of x in float, after cephes sinf/cosf. No branches or library calls, so loops
+// over arrays vectorize.
+inline void polySinCos(float x, float &sine, float &cosine)
+{
+    const float quadrant = std::floor(x * static_cast<float>(2.0 / dms::PI) + 0.5f);
+    // pi/2 split in three parts keeps the reduction exact for the angles of the sky
+    const float r = ((x - quadrant * 1.5703125f) - quadrant * 4.837512969970703125e-4f) -
+                    quadrant * 7.549789948768648e-8f;
+    const float z = r * r;
+
+    const float s = r + r * z * ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f);
+    const float c = 1.0f - 0.5f * z + z * z * ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z +
+                    4.166664568298827e-2f);
+
+    const int q = static_cast<int>(quadrant) & 3;
+    sine   = (q == 0) ? s : (q == 1) ? c : (q == 2) ? -s : -c;
+    cosine = (q == 0) ? c : (q == 1) ? -s : (q == 2) ? -c : s;
+}
+
+template <typename T>
+void equatorialToHorizontal(const SkyPoint::UnitVectors<T> &equatorial, const dms &LST, const dms &lat, T *alt,
+                            T *az)
+{
+    double sinLST, cosLST, sinLat, cosLat;
+    LST.SinCos(sinLST, cosLST);
+    lat.SinCos(sinLat, cosLat);
+
+    const T sL = sinLST, cL = cosLST, sPhi = sinLat, cPhi = cosLat;
+    const T twoPi = 2.0 * dms::PI;
+    const T *x = equatorial.x.data();
+    const T *y = equatorial.y.data();
+    const T *z = equatorial.z.data();
+    const int count = equatorial.size();
+
+    for (int i = 0; i < count; ++i)
+    {
+        // cos(Dec) times cos and sin of the hour angle
+        const T h = x[i] * cL + y[i] * sL;
+        const T w = x[i] * sL - y[i] * cL;
+
+        const T sinAlt = std::min(T(1), std::max(T(-1), z[i] * sPhi + h * cPhi));
+        const T north  = z[i] * cPhi - h * sPhi;
+
+        alt[i] = std::asin(sinAlt);
+        const T azimuth = std::atan2(-w, north);
+        az[i] = azimuth < 0 ? azimuth + twoPi : azimuth;
+    }
+}
+}
+
+void SkyPoint::toUnitVectors(const double *ra, const double *dec, int count, UnitVectors<double> &vectors)
+{
+    vectors.resize(count);
+    double *x = vectors.x.data();
+    double *y = vectors.y.data();
+    double *z = vectors.z.data();
+
+    for (int i = 0; i < count; ++i)
+    {
+        const double cosDec = std::cos(dec[i]);
+        x[i] = std::cos(ra[i]) * cosDec;
+        y[i] = std::sin(ra[i]) * cosDec;
+        z[i] = std::sin(dec[i]);
+    }
+}
+
+void SkyPoint::toUnitVectors(const float *ra, const float *dec, int count, UnitVectors<float> &vectors)
+{
+    vectors.resize(count);
+    float *x = vectors.x.data();
+    float *y = vectors.y.data();
+    float *z = vectors.z.data();
+
+    for (int i = 0; i < count; ++i)
+    {
+        float sinRA, cosRA, sinDec, cosDec;
+        polySinCos(ra[i], sinRA, cosRA);
+        polySinCos(dec[i], sinDec, cosDec);
+        x[i] = cosRA * cosDec;
+        y[i] = sinRA * cosDec;
+        z[i] = sinDec;
+    }
+}
+
+void SkyPoint::fromUnitVectors(const UnitVectors<double> &vectors, double *ra, double *dec)
+{
+    const int count = vectors.size();
+    for (int i = 0; i < count; ++i)
+    {
+        const double alpha = std::atan2(vectors.y[i], vectors.x[i]);
+        ra[i]  = alpha < 0 ? alpha + 2.0 * dms::PI : alpha;
+        dec[i] = std::asin(std::min(1.0, std::max(-1.0, vectors.z[i])));
+    }
+}
+
+void SkyPoint::precess(const KSNumbers *num, const UnitVectors<double> &j2000, UnitVectors<double> &ofDate)
+{
+    const Eigen::Matrix3d &m = num->p2();
+    const int count = j2000.size();
+    ofDate.resize(count);
+
+    const double *x = j2000.x.data();
+    const double *y = j2000.y.data();
+    const double *z = j2000.z.data();
+    double *u = ofDate.x.data();
+    double *v = ofDate.y.data();
+    double *w = ofDate.z.data();
+
+    const double m00 = m(0, 0), m01 = m(0, 1), m02 = m(0, 2);
+    const double m10 = m(1, 0), m11 = m(1, 1), m12 = m(1, 2);
+    const double m20 = m(2, 0), m21 = m(2, 1), m22 = m(2, 2);
+
+    for (int i = 0; i < count; ++i)
+    {
+        u[i] = m00 * x[i] + m01 * y[i] + m02 * z[i];
+        v[i] = m10 * x[i] + m11 * y[i] + m12 * z[i];
+        w[i] = m20 * x[i] + m21 * y[i] + m22 * z[i];
+    }
+}
+
+void SkyPoint::EquatorialToHorizontal(const UnitVectors<double> &equatorial, const dms &LST, const dms &lat,
+                                      double *alt, double *az)
+{
+    equatorialToHorizontal(equatorial, LST, lat, alt, az);
+}
+
+void SkyPoint::EquatorialToHorizontal(const UnitVectors<float> &equatorial, const dms &LST, const dms &lat,
+                                      float *alt, float *az)
+{
+    equatorialToHorizontal(equatorial, LST, lat, alt, az);
+}
+
+void SkyPoint::EquatorialToHorizontal(SkyPoint *const *points, int count, const CachingDms *LST,
+                                      const CachingDms *lat)
+{
+    // The sine and cosine of RA and Dec are cached by CachingDms already
+    UnitVectors<double> vectors;
+    vectors.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        const CachingDms &ra = points[i]->ra(), &dec = points[i]->dec();
+        vectors.x[i] = ra.cos() * dec.cos();
+        vectors.y[i] = ra.sin() * dec.cos();
+        vectors.z[i] = dec.sin();
+    }
+
+    std::vector<double> alt(count), az(count);
+    equatorialToHorizontal(vectors, *LST, *lat, alt.data(), az.data());
+
+    for (int i = 0; i < count; ++i)
+    {
+        points[i]->Alt.setRadians(alt[i]);
+        points[i]->Az.setRadians(az[i]);
+    }
+}
+
+void SkyPoint::findEcliptic(const UnitVectors<double> &equatorial, const dms &obliquity, double *ecLong,
+                            double *ecLat)
+{
+    double sinOb, cosOb;
+    obliquity.SinCos(sinOb, cosOb);
+
+    const int count = equatorial.size();
+    for (int i = 0; i < count; ++i)
+    {
+        // Rotate about the x axis (the equinox) by the obliquity
+        const double y = equatorial.y[i] * cosOb + equatorial.z[i] * sinOb;
+        const double z = equatorial.z[i] * cosOb - equatorial.y[i] * sinOb;
+
+        const double lambda = std::atan2(y, equatorial.x[i]);
+        ecLong[i] = lambda < 0 ? lambda + 2.0 * dms::PI : lambda;
+        ecLat[i]  = std::asin(std::min(1.0, std::max(-1.0, z)));
+    }
+}
+
+void SkyPoint::Equatorial1950ToGalactic(const UnitVectors<double> &equatorial, double *galLong, double *galLat)
+{
+    // North galactic pole at RA 192.25, Dec 27.4 and the north celestial pole at galactic longitude 123,
+    // as in the single point version
+    double sinRAPole, cosRAPole, sinDecPole, cosDecPole;
+    dms(192.25).SinCos(sinRAPole, cosRAPole);
+    dms(27.4).SinCos(sinDecPole, cosDecPole);
+    const double poleLongitude = 123.0 * dms::DegToRad;
+
+    const int count = equatorial.size();
+    for (int i = 0; i < count; ++i)
+    {
+        const double x = equatorial.x[i], y = equatorial.y[i], z = equatorial.z[i];
+
+        // cos(Dec) times sin and cos of (RA - RA of the pole)
+        const double s = y * cosRAPole - x * sinRAPole;
+        const double c = x * cosRAPole + y * sinRAPole;
+
+        double l = poleLongitude - std::atan2(s, z * cosDecPole - c * sinDecPole);
+        l = std::fmod(l, 2.0 * dms::PI);
+        galLong[i] = l < 0 ? l + 2.0 * dms::PI : l;
+        galLat[i]  = std::asin(std::min(1.0, std::max(-1.0, z * sinDecPole + c * cosDecPole)));
+    }
+}
+
 void SkyPoint::B1950ToJ2000(void)
 {
     double cosRA, sinRA, cosDec, sinDec;
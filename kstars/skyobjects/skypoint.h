@@ -23,6 +23,7 @@
 #include "kstarsdatetime.h"
 
 #include <QList>
+#include <vector>
 #ifndef KSTARS_LITE
 #include <QtDBus/QtDBus>
 #endif
@@ -369,6 +370,76 @@ class SkyPoint
          */
         void GalacticToEquatorial1950(const dms *galLong, const dms *galLat);
 
+        ////
+        //// 3.1 Batch coordinate conversions.
+        //// =================================
+
+        /**
+         * @short Directions of many points as unit vectors, for the batch conversions below.
+         *
+         * x points to RA 0h, z to the north pole. The components are kept in separate arrays so
+         * that the loops over them compile to SIMD code. Converting a catalog to vectors once
+         * avoids the sine and cosine of RA and Dec in every later conversion.
+         */
+        template <typename T>
+        struct UnitVectors
+        {
+            std::vector<T> x, y, z;
+
+            int size() const
+            {
+                return static_cast<int>(x.size());
+            }
+            void resize(int count)
+            {
+                x.resize(count);
+                y.resize(count);
+                z.resize(count);
+            }
+        };
+
+        /**
+         * @short Convert count (RA, Dec) pairs, in radians, to unit vectors.
+         * The float overload uses a polynomial sine and cosine accurate to about 1e-7, which
+         * is plenty for display.
+         */
+        static void toUnitVectors(const double *ra, const double *dec, int count, UnitVectors<double> &vectors);
+        static void toUnitVectors(const float *ra, const float *dec, int count, UnitVectors<float> &vectors);
+
+        /** @short Convert unit vectors back to RA in [0, 2pi) and Dec, in radians. */
+        static void fromUnitVectors(const UnitVectors<double> &vectors, double *ra, double *dec);
+
+        /**
+         * @short Precess J2000 unit vectors to the mean equator and equinox of num with the
+         * precession matrix of KSNumbers, like precess() does for one point.
+         */
+        static void precess(const KSNumbers *num, const UnitVectors<double> &j2000, UnitVectors<double> &ofDate);
+
+        /**
+         * @short Batch version of EquatorialToHorizontal().
+         * @param equatorial unit vectors of the current (RA, Dec).
+         * @param alt receives equatorial.size() altitudes in radians.
+         * @param az receives the azimuths in radians, from North through East in [0, 2pi).
+         */
+        static void EquatorialToHorizontal(const UnitVectors<double> &equatorial, const dms &LST, const dms &lat,
+                                           double *alt, double *az);
+        static void EquatorialToHorizontal(const UnitVectors<float> &equatorial, const dms &LST, const dms &lat,
+                                           float *alt, float *az);
+
+        /**
+         * @short Update the Alt/Az of count points at once.
+         * Same result as calling EquatorialToHorizontal() on each point.
+         */
+        static void EquatorialToHorizontal(SkyPoint *const *points, int count, const CachingDms *LST,
+                                           const CachingDms *lat);
+
+        /** @short Batch version of findEcliptic(), longitudes in [0, 2pi) and latitudes in radians. */
+        static void findEcliptic(const UnitVectors<double> &equatorial, const dms &obliquity, double *ecLong,
+                                 double *ecLat);
+
+        /** @short Batch version of Equatorial1950ToGalactic() for B1950 unit vectors, results in radians. */
+        static void Equatorial1950ToGalactic(const UnitVectors<double> &equatorial, double *galLong, double *galLat);
+
         ////
         //// 4. Coordinate update/corrections.
         //// =================================
@@ -757,6 +828,13 @@ class SkyPoint
          */
         void precess(const KSNumbers *num);
 
+        /**
+         * Set the current coordinates to the apparent place of the catalog coordinates
+         * for the epoch of num: precess(), nutate() and aberrate() in one step, using the
+         * precession-nutation matrix and aberration vector of KSNumbers.
+         */
+        void apparentFromJ2000(const KSNumbers *num);
+
 #ifdef UNIT_TEST
         friend class TestSkyPoint; // Test class
 #endif
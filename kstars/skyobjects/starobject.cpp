@@ -280,6 +280,8 @@ void StarObject::updateCoords(const KSNumbers *num, bool, const CachingDms *, co
 
     getIndexCoords(num, newRA, newDec);
 
+    // The corrected coordinates carry their sine and cosine, which SkyPoint::updateCoords()
+    // feeds straight into the precession-nutation matrix of num
     setRA0(newRA);
     setDec0(newDec);
     SkyPoint::updateCoords(num);
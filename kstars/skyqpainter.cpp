@@ -19,7 +19,12 @@
 
 #include "skyqpainter.h"
 
+#include <QPaintEngine>
 #include <QPointer>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <cstring>
 
 #include "kstarsdata.h"
 #include "Options.h"
@@ -90,6 +95,68 @@ const int nSPclasses = 7;
 // These pixmaps are never deallocated. Not really good...
 QPixmap *imageCache[nSPclasses][nStarSizes] = { { nullptr } };
 
+// The star images of all sizes and spectral classes in one premultiplied image, one cell per
+// image. Row is the spectral class, column the size.
+const int atlasCell = nStarSizes - 1;
+QImage starAtlas;
+
+// Transparent layer the queued stars are blended into. Only the rows that were drawn are
+// cleared again, so it stays allocated between frames.
+QImage starLayer;
+
+// Below this many queued stars, splitting the layer into bands costs more than it saves
+const int minParallelStars = 2048;
+
+// Source over for premultiplied ARGB, two channels at a time as QPainter does
+inline quint32 blendPixel(quint32 source, quint32 destination)
+{
+    const quint32 alpha = 255 - (source >> 24);
+    quint32 rb = (destination & 0xff00ff) * alpha;
+    quint32 ag = ((destination >> 8) & 0xff00ff) * alpha;
+    rb = ((rb + ((rb >> 8) & 0xff00ff) + 0x800080) >> 8) & 0xff00ff;
+    ag = (ag + ((ag >> 8) & 0xff00ff) + 0x800080) & 0xff00ff00;
+    return source + (rb | ag);
+}
+
+struct StarBand
+{
+    int top;
+    int bottom;
+    std::vector<int> stars;
+};
+
+std::vector<StarBand> starBands;
+
+template <typename PointSource>
+void blendBand(const StarBand &band, const std::vector<PointSource> &stars, uchar *layerBits, int layerStride)
+{
+    const uchar *atlasBits = starAtlas.constBits();
+    const int atlasStride  = starAtlas.bytesPerLine();
+    const int layerWidth   = starLayer.width();
+
+    for (int index : band.stars)
+    {
+        const PointSource &star = stars[index];
+        const int firstRow      = qMax(star.y, band.top);
+        const int lastRow       = qMin(star.y + star.size, band.bottom);
+        const int firstColumn   = qMax(star.x, 0);
+        const int lastColumn    = qMin(star.x + star.size, layerWidth);
+        const int width         = lastColumn - firstColumn;
+
+        for (int y = firstRow; y < lastRow; y++)
+        {
+            const uchar *atlasRow = atlasBits + (star.spectralClass * atlasCell + y - star.y) * atlasStride;
+            const quint32 *source = reinterpret_cast<const quint32 *>(atlasRow) + (star.size - 1) * atlasCell +
+                                    firstColumn - star.x;
+            quint32 *destination  = reinterpret_cast<quint32 *>(layerBits + y * layerStride) + firstColumn;
+
+            // Short loop without branches, the compiler vectorizes it
+            for (int x = 0; x < width; x++)
+                destination[x] = blendPixel(source[x], destination[x]);
+        }
+    }
+}
+
 std::unique_ptr<QPixmap> visibleSatPixmap, invisibleSatPixmap;
 }
 
@@ -111,6 +178,9 @@ void SkyQPainter::releaseImageCache()
             pmap[size] = nullptr;
         }
     }
+
+    starAtlas = QImage();
+    starLayer = QImage();
 }
 
 SkyQPainter::SkyQPainter(QPaintDevice *pd) : SkyPainter(), QPainter()
@@ -154,11 +224,79 @@ void SkyQPainter::begin()
 
 void SkyQPainter::end()
 {
+    flushPointSources();
     QPainter::end();
 }
 
+void SkyQPainter::flushPointSources()
+{
+    if (m_pointSources.empty())
+        return;
+
+    if (starLayer.size() != m_size)
+    {
+        starLayer = QImage(m_size, QImage::Format_ARGB32_Premultiplied);
+        starLayer.fill(Qt::transparent);
+    }
+
+    const QRect bounds = m_pointSourceBounds & starLayer.rect();
+    if (bounds.isEmpty())
+    {
+        m_pointSources.clear();
+        m_pointSourceBounds = QRect();
+        return;
+    }
+
+    uchar *layerBits   = starLayer.bits();
+    const int stride   = starLayer.bytesPerLine();
+
+    // Each band only blends the rows it covers, so bands can be blended concurrently and the
+    // stars of a band still overlap in the order they were drawn.
+    int bandCount = 1;
+    if (m_pointSources.size() >= static_cast<size_t>(minParallelStars))
+        bandCount = qBound(1, QThread::idealThreadCount() * 4, qMax(1, bounds.height() / atlasCell));
+    const int bandHeight = (bounds.height() + bandCount - 1) / bandCount;
+
+    starBands.resize(bandCount);
+    for (int i = 0; i < bandCount; i++)
+    {
+        starBands[i].top    = bounds.top() + i * bandHeight;
+        starBands[i].bottom = qMin(starBands[i].top + bandHeight, bounds.bottom() + 1);
+        starBands[i].stars.clear();
+    }
+
+    for (size_t i = 0; i < m_pointSources.size(); i++)
+    {
+        const PointSource &star = m_pointSources[i];
+        const int first         = qMax(0, (star.y - bounds.top()) / bandHeight);
+        const int last          = qMin(bandCount - 1, (star.y + star.size - 1 - bounds.top()) / bandHeight);
+        for (int band = first; band <= last; band++)
+            starBands[band].stars.push_back(static_cast<int>(i));
+    }
+
+    const std::vector<PointSource> &stars = m_pointSources;
+    auto blend = [&stars, layerBits, stride](const StarBand & band)
+    {
+        blendBand(band, stars, layerBits, stride);
+    };
+
+    if (bandCount == 1)
+        blend(starBands[0]);
+    else
+        QtConcurrent::blockingMap(starBands, blend);
+
+    drawImage(bounds.topLeft(), starLayer, bounds);
+
+    for (int y = bounds.top(); y <= bounds.bottom(); y++)
+        std::memset(layerBits + y * stride + bounds.left() * 4, 0, bounds.width() * 4);
+
+    m_pointSources.clear();
+    m_pointSourceBounds = QRect();
+}
+
 void SkyQPainter::drawSkyBackground()
 {
+    flushPointSources();
     //FIXME use projector
     fillRect(0, 0, m_size.width(), m_size.height(), KStarsData::Instance()->colorScheme()->colorNamed("SkyColor"));
 }
@@ -262,6 +400,21 @@ void SkyQPainter::initStarImages()
             *pmap[size] = BigImage.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
         }
     }
+
+    starAtlas = QImage(atlasCell * (nStarSizes - 1), atlasCell * nSPclasses, QImage::Format_ARGB32_Premultiplied);
+    starAtlas.fill(Qt::transparent);
+    QPainter atlasPainter(&starAtlas);
+    atlasPainter.setCompositionMode(QPainter::CompositionMode_Source);
+    for (int spectralClass = 0; spectralClass < nSPclasses; spectralClass++)
+    {
+        for (int size = 1; size < nStarSizes; size++)
+        {
+            if (imageCache[spectralClass][size])
+                atlasPainter.drawPixmap((size - 1) * atlasCell, spectralClass * atlasCell, *imageCache[spectralClass][size]);
+        }
+    }
+    atlasPainter.end();
+
     starColorMode = Options::starColorMode();
 
     if (!visibleSatPixmap.get())
@@ -272,6 +425,8 @@ void SkyQPainter::initStarImages()
 
 void SkyQPainter::drawSkyLine(SkyPoint *a, SkyPoint *b)
 {
+    flushPointSources();
+
     bool aVisible, bVisible;
     QPointF aScreen = m_proj->toScreen(a, true, &aVisible);
     QPointF bScreen = m_proj->toScreen(b, true, &bVisible);
@@ -298,6 +453,8 @@ void SkyQPainter::drawSkyLine(SkyPoint *a, SkyPoint *b)
 
 void SkyQPainter::drawSkyPolyline(LineList *list, SkipHashList *skipList, LineListLabel *label)
 {
+    flushPointSources();
+
     SkyList *points = list->points();
     bool isVisible, isVisibleLast;
 
@@ -349,6 +506,8 @@ void SkyQPainter::drawSkyPolyline(LineList *list, SkipHashList *skipList, LineLi
 
 void SkyQPainter::drawSkyPolygon(LineList *list, bool forceClip)
 {
+    flushPointSources();
+
     bool isVisible  = false, isVisibleLast;
     SkyList *points = list->points();
     QPolygonF polygon;
@@ -407,6 +566,8 @@ void SkyQPainter::drawSkyPolygon(LineList *list, bool forceClip)
 
 bool SkyQPainter::drawPlanet(KSPlanetBase *planet)
 {
+    flushPointSources();
+
     if (!m_proj->checkVisibility(planet))
         return false;
 
@@ -474,6 +635,8 @@ bool SkyQPainter::drawPlanet(KSPlanetBase *planet)
 
 bool SkyQPainter::drawEarthShadow(KSEarthShadow *shadow)
 {
+    flushPointSources();
+
     if (!m_proj->checkVisibility(shadow))
         return false;
 
@@ -498,6 +661,8 @@ bool SkyQPainter::drawEarthShadow(KSEarthShadow *shadow)
 
 bool SkyQPainter::drawComet(KSComet *com)
 {
+    flushPointSources();
+
     if (!m_proj->checkVisibility(com))
         return false;
 
@@ -570,7 +735,27 @@ bool SkyQPainter::drawPointSource(SkyPoint *loc, float mag, char sp)
             m_proj->onScreen(
                 pos)) // FIXME: onScreen here should use canvas size rather than SkyMap size, especially while printing in portrait mode!
     {
-        drawPointSource(pos, starWidth(mag), sp);
+        const float size = starWidth(mag);
+        if ((m_vectorStars && starColorMode != 0) || starAtlas.isNull() || paintEngine() == nullptr ||
+                paintEngine()->type() != QPaintEngine::Raster)
+        {
+            drawPointSource(pos, size, sp);
+            return true;
+        }
+
+        // Queue the star, flushPointSources() blends all of them at once
+        PointSource star;
+        star.size          = qBound(1, static_cast<int>(size), nStarSizes - 1);
+        star.x             = qRound(pos.x() - 0.5 * star.size);
+        star.y             = qRound(pos.y() - 0.5 * star.size);
+        star.spectralClass = harvardToIndex(sp);
+
+        const QRect rect(star.x, star.y, star.size, star.size);
+        if (rect.intersects(QRect(QPoint(0, 0), m_size)))
+        {
+            m_pointSources.push_back(star);
+            m_pointSourceBounds |= rect;
+        }
         return true;
     }
     else
@@ -581,6 +766,8 @@ bool SkyQPainter::drawPointSource(SkyPoint *loc, float mag, char sp)
 
 void SkyQPainter::drawPointSource(const QPointF &pos, float size, char sp)
 {
+    flushPointSources();
+
     int isize = qMin(static_cast<int>(size), 14);
     if (!m_vectorStars || starColorMode == 0)
     {
@@ -617,6 +804,8 @@ void SkyQPainter::drawPointSource(const QPointF &pos, float size, char sp)
 
 bool SkyQPainter::drawConstellationArtImage(ConstellationsArt *obj)
 {
+    flushPointSources();
+
     double zoom = Options::zoomFactor();
 
     bool visible = false;
@@ -650,6 +839,8 @@ bool SkyQPainter::drawConstellationArtImage(ConstellationsArt *obj)
 
 bool SkyQPainter::drawHips()
 {
+    flushPointSources();
+
     int w = viewport().width();
     int h = viewport().height();
     QImage *hipsImage = new QImage(w, h, QImage::Format_ARGB32_Premultiplied);
@@ -663,6 +854,8 @@ bool SkyQPainter::drawHips()
 
 bool SkyQPainter::drawTerrain()
 {
+    flushPointSources();
+
     int w = viewport().width();
     int h = viewport().height();
     QImage *terrainImage = new QImage(w, h, QImage::Format_ARGB32_Premultiplied);
@@ -677,6 +870,8 @@ bool SkyQPainter::drawTerrain()
 
 bool SkyQPainter::drawDeepSkyObject(DeepSkyObject *obj, bool drawImage)
 {
+    flushPointSources();
+
     if (!m_proj->checkVisibility(obj))
         return false;
 
@@ -725,6 +920,8 @@ bool SkyQPainter::drawDeepSkyImage(const QPointF &pos, DeepSkyObject *obj, float
 
 void SkyQPainter::drawDeepSkySymbol(const QPointF &pos, int type, float size, float e, float positionAngle)
 {
+    flushPointSources();
+
     float x    = pos.x();
     float y    = pos.y();
     float zoom = Options::zoomFactor();
@@ -959,6 +1156,8 @@ void SkyQPainter::drawDeepSkySymbol(const QPointF &pos, int type, float size, fl
 
 void SkyQPainter::drawObservingList(const QList<SkyObject *> &obs)
 {
+    flushPointSources();
+
     foreach (SkyObject *obj, obs)
     {
         bool visible = false;
@@ -976,6 +1175,8 @@ void SkyQPainter::drawObservingList(const QList<SkyObject *> &obs)
 
 void SkyQPainter::drawFlags()
 {
+    flushPointSources();
+
     KStarsData *data = KStarsData::Instance();
     std::shared_ptr<SkyPoint> point;
     QImage image;
@@ -1009,6 +1210,8 @@ void SkyQPainter::drawFlags()
 
 void SkyQPainter::drawHorizon(bool filled, SkyPoint *labelPoint, bool *drawLabel)
 {
+    flushPointSources();
+
     QVector<Vector2f> ground = m_proj->groundPoly(labelPoint, drawLabel);
     if (ground.size())
     {
@@ -1027,6 +1230,8 @@ void SkyQPainter::drawHorizon(bool filled, SkyPoint *labelPoint, bool *drawLabel
 
 bool SkyQPainter::drawSatellite(Satellite *sat)
 {
+    flushPointSources();
+
     if (!m_proj->checkVisibility(sat))
         return false;
 
@@ -1066,6 +1271,8 @@ bool SkyQPainter::drawSatellite(Satellite *sat)
 
 bool SkyQPainter::drawSupernova(Supernova *sup)
 {
+    flushPointSources();
+
     KStarsData *data = KStarsData::Instance();
     if (!m_proj->checkVisibility(sup))
     {
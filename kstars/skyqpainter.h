@@ -23,6 +23,9 @@
 
 #include <QColor>
 #include <QMap>
+#include <QRect>
+
+#include <vector>
 
 class Projector;
 class QWidget;
@@ -36,6 +39,11 @@ class KSEarthShadow;
  * @short The QPainter-based painting backend.
  * This class implements the SkyPainter interface using a QPainter.
  * For documentation, @see SkyPainter.
+ *
+ * Stars drawn with drawPointSource(SkyPoint *, float, char) on a raster device are queued and
+ * blended from a sprite atlas in one pass, instead of one drawPixmap() call each. The queue is
+ * drawn before anything else this painter draws and by end(). Call flushPointSources() before
+ * drawing with the QPainter functions directly.
  */
 class SkyQPainter : public SkyPainter, public QPainter
 {
@@ -87,6 +95,9 @@ class SkyQPainter : public SkyPainter, public QPainter
         /** Recalculates the star pixmaps. */
         static void initStarImages();
 
+        /** Draw the queued point sources now. */
+        void flushPointSources();
+
         // Sky drawing functions
         void drawSkyBackground() override;
         void drawSkyLine(SkyPoint *a, SkyPoint *b) override;
@@ -113,12 +124,23 @@ class SkyQPainter : public SkyPainter, public QPainter
     private:
         virtual bool drawDeepSkyImage(const QPointF &pos, DeepSkyObject *obj, float positionAngle);
 
+        struct PointSource
+        {
+            // Top left corner of the sprite on the canvas
+            int x;
+            int y;
+            int size;
+            int spectralClass;
+        };
+
         QPaintDevice *m_pd { nullptr };
         const Projector *m_proj { nullptr };
         bool m_vectorStars { false };
         HIPSRenderer *m_hipsRender { nullptr };
         TerrainRenderer *m_terrainRender { nullptr };
         QSize m_size;
+        std::vector<PointSource> m_pointSources;
+        QRect m_pointSourceBounds;
         static int starColorMode;
         static QColor m_starColor;
         static QMap<char, QColor> ColorMap;
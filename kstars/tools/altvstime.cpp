@@ -16,6 +16,7 @@
  ***************************************************************************/
 
 #include "altvstime.h"
+#include "altitudecurves.h"
 
 #include "avtplotwidget.h"
 #include "dms.h"
@@ -420,9 +421,12 @@ void AltVsTime::processObject(SkyObject *o, bool forceAdd)
         // time range: 24h
 
         int offset = 3;
-        for (double h = -12.0, i = 0; h <= 12.0; h += 0.25, i++)
+        AltitudeCurves curves = plotCurves();
+        curves.compute(QVector<const SkyPoint *>() << o);
+        const double *altitudes = curves.altitudes(0);
+        for (int i = 0; i < curves.samples(); i++)
         {
-            y[i] = findAltitude(o, h);
+            y[i] = altitudes[i];
             if (y[i] > maxAlt)
                 maxAlt = y[i];
             if (y[i] < minAlt)
@@ -469,6 +473,12 @@ void AltVsTime::processObject(SkyObject *o, bool forceAdd)
     delete num;
 }
 
+AltitudeCurves AltVsTime::plotCurves()
+{
+    //getDate converts the user-entered local time to UT
+    return AltitudeCurves(geo, getDate().addSecs((24.0 * DayOffset - 12.0) * 3600.0), 0.25, 97);
+}
+
 double AltVsTime::findAltitude(SkyPoint *p, double hour)
 {
     hour += 24.0 * DayOffset;
@@ -970,7 +980,7 @@ void AltVsTime::slotUpdateDateLoc()
     KStarsData *data     = KStarsData::Instance();
     KStarsDateTime today = getDate();
     KSNumbers *num       = new KSNumbers(today.djd());
-    KSNumbers *oldNum    = nullptr;
+    KSNumbers *oldNum    = new KSNumbers(data->ut().djd());
     CachingDms LST       = geo->GSTtoLST(today.gst());
 
     //First determine time of sunset and sunrise
@@ -978,115 +988,72 @@ void AltVsTime::slotUpdateDateLoc()
     // Determine dawn/dusk time and min/max sun elevation
     setDawnDusk();
 
+    QVector<const SkyPoint *> targets;
     for (int i = 0; i < pList.count(); ++i)
     {
         SkyObject *o = pList.at(i);
-        if (o)
-        {
-            //If the object is in the solar system, recompute its position for the given date
-            if (o->isSolarSystem())
-            {
-                oldNum = new KSNumbers(data->ut().djd());
-                o->updateCoords(num, true, geo->lat(), &LST, true);
-            }
-
-            //precess coords to target epoch
-            o->updateCoordsNow(num);
-
-            //update pList entry
-            pList.replace(i, o);
-
-            // We are creating a new data set (time, altitude) for the new date:
-            QVector<double> time_dataSet, altitude_dataSet;
-            double point_altitudeValue, point_timeValue;
-            // compute the new graph values:
-            // time range: 24h
-            int offset = 3;
-            for (double h = -12.0, i = 0; h <= 12.0; h += 0.25, i++)
-            {
-                point_altitudeValue = findAltitude(o, h);
-                altitude_dataSet.push_back(point_altitudeValue);
-                if (point_altitudeValue > maxAlt)
-                    maxAlt = point_altitudeValue;
-                if (point_altitudeValue < minAlt)
-                    minAlt = point_altitudeValue;
-                point_timeValue = i * 900 + 43200;
-                time_dataSet.push_back(point_timeValue);
-            }
 
-            // Replace graph data set:
-            avtUI->View->graph(i)->setData(time_dataSet, altitude_dataSet);
+        //If the object is in the solar system, recompute its position for the given date
+        if (o->isSolarSystem())
+            o->updateCoords(num, true, geo->lat(), &LST, true);
 
-            // Go into initial state: without Zoom/Pan
-            avtUI->View->xAxis->setRange(43200, 129600);
-            avtUI->View->xAxis2->setRange(61200, 147600);
+        //precess coords to target epoch
+        o->updateCoordsNow(num);
 
-            // Center the altitude axis in 0 value:
-            if (abs(minAlt) > maxAlt)
-                maxAlt = abs(minAlt);
-            else
-                minAlt = -maxAlt;
-            avtUI->View->yAxis->setRange(minAlt - offset, maxAlt + offset);
+        targets.append(o);
+    }
 
-            // Update background coordinates:
-            background->topLeft->setCoords(avtUI->View->xAxis->range().lower, avtUI->View->yAxis->range().upper);
-            background->bottomRight->setCoords(avtUI->View->xAxis->range().upper, avtUI->View->yAxis->range().lower);
+    // compute the new graph values of all objects at once:
+    // time range: 24h
+    AltitudeCurves curves = plotCurves();
+    curves.compute(targets);
 
-            // Redraw the plot:
-            avtUI->View->replot();
+    int offset = 3;
+    for (int i = 0; i < pList.count(); ++i)
+    {
+        SkyObject *o = pList.at(i);
 
-            //restore original position
-            if (o->isSolarSystem())
-            {
-                o->updateCoords(oldNum, true, data->geo()->lat(), data->lst());
-                delete oldNum;
-                oldNum = nullptr;
-            }
-            o->EquatorialToHorizontal(data->lst(), data->geo()->lat());
-        }
-        else //assume unfound object is a custom object
+        // We are creating a new data set (time, altitude) for the new date:
+        QVector<double> time_dataSet, altitude_dataSet;
+        const double *altitudes = curves.altitudes(i);
+        for (int j = 0; j < curves.samples(); j++)
         {
-            pList.at(i)->updateCoordsNow(num); //precess to desired epoch
-
-            // We are creating a new data set (time, altitude) for the new date:
-            QVector<double> time_dataSet, altitude_dataSet;
-            double point_altitudeValue, point_timeValue;
-            // compute the new graph values:
-            // time range: 24h
-            int offset = 3;
-            for (double h = -12.0, i = 0; h <= 12.0; h += 0.25, i++)
-            {
-                point_altitudeValue = findAltitude(pList.at(i), h);
-                altitude_dataSet.push_back(point_altitudeValue);
-                if (point_altitudeValue > maxAlt)
-                    maxAlt = point_altitudeValue;
-                if (point_altitudeValue < minAlt)
-                    minAlt = point_altitudeValue;
-                point_timeValue = i * 900 + 43200;
-                time_dataSet.push_back(point_timeValue);
-            }
+            altitude_dataSet.push_back(altitudes[j]);
+            if (altitudes[j] > maxAlt)
+                maxAlt = altitudes[j];
+            if (altitudes[j] < minAlt)
+                minAlt = altitudes[j];
+            time_dataSet.push_back(j * 900 + 43200);
+        }
 
-            // Replace graph data set:
-            avtUI->View->graph(i)->setData(time_dataSet, altitude_dataSet);
+        // Replace graph data set:
+        avtUI->View->graph(i)->setData(time_dataSet, altitude_dataSet);
 
-            // Go into initial state: without Zoom/Pan
-            avtUI->View->xAxis->setRange(43200, 129600);
-            avtUI->View->xAxis2->setRange(61200, 147600);
+        //restore original position
+        if (o->isSolarSystem())
+            o->updateCoords(oldNum, true, data->geo()->lat(), data->lst());
+        o->EquatorialToHorizontal(data->lst(), data->geo()->lat());
+    }
 
-            // Center the altitude axis in 0 value:
-            if (abs(minAlt) > maxAlt)
-                maxAlt = abs(minAlt);
-            else
-                minAlt = -maxAlt;
-            avtUI->View->yAxis->setRange(minAlt - offset, maxAlt + offset);
+    if (!pList.isEmpty())
+    {
+        // Go into initial state: without Zoom/Pan
+        avtUI->View->xAxis->setRange(43200, 129600);
+        avtUI->View->xAxis2->setRange(61200, 147600);
 
-            // Update background coordinates:
-            background->topLeft->setCoords(avtUI->View->xAxis->range().lower, avtUI->View->yAxis->range().upper);
-            background->bottomRight->setCoords(avtUI->View->xAxis->range().upper, avtUI->View->yAxis->range().lower);
+        // Center the altitude axis in 0 value:
+        if (abs(minAlt) > maxAlt)
+            maxAlt = abs(minAlt);
+        else
+            minAlt = -maxAlt;
+        avtUI->View->yAxis->setRange(minAlt - offset, maxAlt + offset);
 
-            // Redraw the plot:
-            avtUI->View->replot();
-        }
+        // Update background coordinates:
+        background->topLeft->setCoords(avtUI->View->xAxis->range().lower, avtUI->View->yAxis->range().upper);
+        background->bottomRight->setCoords(avtUI->View->xAxis->range().upper, avtUI->View->yAxis->range().lower);
+
+        // Redraw the plot once for all objects:
+        avtUI->View->replot();
     }
 
     if (getDate().time().hour() > 12)
@@ -1099,6 +1066,7 @@ void AltVsTime::slotUpdateDateLoc()
     avtUI->View->update();
 
     delete num;
+    delete oldNum;
 }
 
 void AltVsTime::slotChooseCity()
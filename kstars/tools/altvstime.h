@@ -28,6 +28,7 @@ class QCPRange;
 class QMouseEvent;
 class QPixmap;
 
+class AltitudeCurves;
 class GeoLocation;
 class KStarsDateTime;
 class SkyObject;
@@ -117,6 +118,9 @@ class AltVsTime : public QDialog
      */
     double findAltitude(SkyPoint *p, double hour);
 
+    /** @return the curve generator for the 24 hours shown, at 15 minute steps */
+    AltitudeCurves plotCurves();
+
     /**
      * @short get object name. If star has no name, generate a name based on catalog number.
      * @param o sky object.
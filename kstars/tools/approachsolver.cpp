@@ -16,8 +16,61 @@
  ***************************************************************************/
 
 #include "approachsolver.h"
+
+#include <QSemaphore>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include <kstars_debug.h>
 
+namespace
+{
+// Samples searched by one task
+const int CHUNK_SAMPLES = 64;
+// Minima are refined to a minute
+const long double PRECISION = 1.0l / (24.0l * 60.0l);
+// 2 - golden ratio
+const long double GOLDEN_SECTION = 0.381966011250105151795l;
+
+// Part of the uniform sampling of a range
+struct Chunk
+{
+    long double startJD;
+    long double stopJD;
+    long double step;
+    // Number of steps of the whole range
+    int steps;
+    // Index of the first sample and number of samples of this chunk
+    int first;
+    int count;
+
+    long double sampleJD(int index) const
+    {
+        // Land exactly on the end of the range
+        return (index == steps) ? stopJD : startJD + index * step;
+    }
+};
+
+// A minimum of the distance of a pair between startJD and stopJD
+struct Candidate
+{
+    int pair;
+    long double startJD;
+    long double stopJD;
+};
+
+struct Approach
+{
+    long double jd { 0 };
+    dms distance;
+    bool close { false };
+};
+}
+
 ApproachSolver::ApproachSolver(QObject *parent) : QObject(parent)
 {
     m_geoPlace = KStarsData::Instance()->geo();
@@ -32,136 +85,215 @@ void ApproachSolver::setGeoLocation(GeoLocation *geo)
         m_geoPlace = KStarsData::Instance()->geo();
 }
 
-// FIXME: We need a better algo for finding approaches!
 QMap<long double, dms> ApproachSolver::findClosestApproach(long double startJD,
         long double stopJD, std::function<void (long double, dms)> const &callback)
 {
-    QMap<long double, dms> Separations;
-    QPair<long double, dms> extremum;
-    dms Dist;
-    dms prevDist;
-
-    double step, step0;
-    int Sign, prevSign;
-
-    //  qCDebug(KSTARS) << "Entered KSConjunct::findClosestApproach() with startJD = " << (double)startJD;
-    //  qCDebug(KSTARS) << "Initial Positional Information: \n";
-    //  qCDebug(KSTARS) << m_object1->name() << ": RA = " << m_object1->ra() -> toHMSString() << "; Dec = " << m_object1->dec() -> toDMSString() << "\n";
-    //  qCDebug(KSTARS) << m_object2->name() << ": RA = " << m_object2->ra() -> toHMSString() << "; Dec = " << m_object2->dec() -> toDMSString() << "\n";
-    prevSign = 0;
-
-    step0 = findInitialStep(startJD, stopJD);
-    step = step0;
-    //	qCDebug(KSTARS) << "Initial Separation between " << m_object1->name() << " and " << m_object2->name() << " = " << (prevDist.toDMSString());
-
-    long double jd = startJD;
-    prevDist       = updateAndFindDistance(jd);
-    jd += step;
-    while (jd <= stopJD)
+    const QMap<long double, dms> Separations =
+        findClosestApproaches(QVector<Interval>() << Interval(startJD, stopJD)).value(0);
+
+    if (callback)
     {
-        int progress = int(100.0 * (jd - startJD) / (stopJD - startJD));
-        emit solverMadeProgress(progress);
+        for (auto it = Separations.constBegin(); it != Separations.constEnd(); ++it)
+            callback(it.key(), it.value());
+    }
 
-        Dist = updateAndFindDistance(jd);
-        Sign = sgn(Dist - prevDist);
-        //	qCDebug(KSTARS) << "Dist = " << Dist.toDMSString() << "; prevDist = " << prevDist.toDMSString() << "; Difference = " << (Dist.Degrees() - prevDist.Degrees()) << "; Step = " << step;
+    return Separations;
+}
+
+QVector<QMap<long double, dms>> ApproachSolver::findClosestApproaches(const QVector<Interval> &intervals)
+{
+    QVector<QMap<long double, dms>> Separations(pairCount());
+
+    // Split the sampling of every range into chunks of at most CHUNK_SAMPLES samples. Neighbouring
+    // chunks share two samples, so every sample is the middle of a triple in exactly one chunk.
+    std::vector<Chunk> chunks;
+    for (const auto &interval : intervals)
+    {
+        const long double startJD = interval.first;
+        const long double stopJD  = interval.second;
+        if (stopJD <= startJD)
+            continue;
 
-        //How close are we to a conjunction, and how fast are we approaching one?
-        double factor = fabs((Dist.Degrees() - prevDist.Degrees()) / Dist.Degrees());
-        if (factor > 10.0) //let's go faster!
+        double step0 = findInitialStep(startJD, stopJD);
+        if (step0 <= 0)
+            step0 = double(stopJD - startJD) / 4.0;
+
+        Chunk chunk;
+        chunk.startJD = startJD;
+        chunk.stopJD  = stopJD;
+        chunk.steps   = std::max(2, int(std::ceil(double(stopJD - startJD) / step0)));
+        chunk.step    = (stopJD - startJD) / chunk.steps;
+        for (chunk.first = 0; chunk.first + 2 <= chunk.steps; chunk.first += CHUNK_SAMPLES - 2)
         {
-            step = step0 * factor / 10.0;
+            chunk.count = std::min(CHUNK_SAMPLES, chunk.steps + 1 - chunk.first);
+            chunks.push_back(chunk);
         }
-        else //slow down, we're getting close!
+    }
+
+    if (chunks.empty())
+        return Separations;
+
+    QVector<ApproachSolver *> workers;
+    std::vector<std::unique_ptr<ApproachSolver>> ownedWorkers;
+    const int threads = std::min(QThread::idealThreadCount(), int(chunks.size()));
+    for (int i = 0; threads > 1 && i < threads; i++)
+    {
+        ApproachSolver *worker = createWorker();
+        if (worker == nullptr)
+            break;
+
+        worker->m_geoPlace      = m_geoPlace;
+        worker->m_maxSeparation = m_maxSeparation;
+        // The first update loads the orbital elements into shared tables, which is not thread safe
+        worker->updatePositions(chunks.front().startJD);
+
+        ownedWorkers.emplace_back(worker);
+        workers.append(worker);
+    }
+    if (workers.isEmpty())
+        workers.append(this);
+
+    // Bracket the minima: the middle sample of a triple is not farther than its neighbours
+    std::vector<std::vector<Candidate>> chunkCandidates(chunks.size());
+    forEachTask(workers, int(chunks.size()), 0, 80, [&chunks, &chunkCandidates](ApproachSolver * worker, int index)
+    {
+        const Chunk &chunk = chunks[index];
+        const int pairs    = worker->pairCount();
+
+        std::vector<double> distances(chunk.count * pairs);
+        for (int k = 0; k < chunk.count; k++)
         {
-            step = step0;
+            worker->updatePositions(chunk.sampleJD(chunk.first + k));
+            for (int pair = 0; pair < pairs; pair++)
+                distances[k * pairs + pair] = worker->findPairDistance(pair).radians();
         }
 
-        if (Sign != prevSign && prevSign == -1) //all right, we may have just passed a conjunction
+        std::vector<Candidate> &candidates = chunkCandidates[index];
+        for (int k = 1; k + 1 < chunk.count; k++)
         {
-            if (step > step0) //mini-loop to back up and make sure we're close enough
+            for (int pair = 0; pair < pairs; pair++)
             {
-                //            qCDebug(KSTARS) << "Entering slow loop: ";
-                jd -= step;
-                step = step0;
-                Sign = prevSign;
-                while (jd <= stopJD)
+                const double distance = distances[k * pairs + pair];
+                if (distances[(k - 1) * pairs + pair] > distance && distance <= distances[(k + 1) * pairs + pair])
                 {
-                    Dist = updateAndFindDistance(jd);
-                    Sign = sgn(Dist - prevDist);
-                    //	qCDebug(KSTARS) << "Dist=" << Dist.toDMSString() << "; prevDist=" << prevDist.toDMSString() << "; Diff=" << (Dist.Degrees() - prevDist.Degrees()) << "djd=" << (int)(jd - startJD);
-                    if (Sign != prevSign)
-                        break;
-
-                    prevDist = Dist;
-                    prevSign = Sign;
-                    jd += step;
+                    Candidate candidate;
+                    candidate.pair    = pair;
+                    candidate.startJD = chunk.sampleJD(chunk.first + k - 1);
+                    candidate.stopJD  = chunk.sampleJD(chunk.first + k + 1);
+                    candidates.push_back(candidate);
                 }
             }
+        }
+    });
 
-            //	qCDebug(KSTARS) << "Sign = " << Sign << " and " << "prevSign = " << prevSign << ": Entering findPrecise()\n";
-            if (findPrecise(&extremum, jd, step, Sign))
-            {
-                if (extremum.second.radians() < getMaxSeparation())
-                {
-                    Separations.insert(extremum.first, extremum.second);
+    std::vector<Candidate> candidates;
+    for (const auto &found : chunkCandidates)
+        candidates.insert(candidates.end(), found.begin(), found.end());
 
-                    if(callback)
-                        callback(extremum.first, extremum.second);
-                }
+    // Refine only the brackets, with a golden section search
+    std::vector<Approach> approaches(candidates.size());
+    forEachTask(workers, int(candidates.size()), 80, 100, [&candidates, &approaches](ApproachSolver * worker, int index)
+    {
+        const Candidate &candidate = candidates[index];
+        auto distance = [worker, &candidate](long double jd) -> double
+        {
+            worker->updatePositions(jd);
+            return worker->findPairDistance(candidate.pair).radians();
+        };
+
+        long double a  = candidate.startJD;
+        long double b  = candidate.stopJD;
+        long double x1 = a + GOLDEN_SECTION * (b - a);
+        long double x2 = b - GOLDEN_SECTION * (b - a);
+        double f1      = distance(x1);
+        double f2      = distance(x2);
+        while (b - a > PRECISION)
+        {
+            if (f1 <= f2)
+            {
+                b  = x2;
+                x2 = x1;
+                f2 = f1;
+                x1 = a + GOLDEN_SECTION * (b - a);
+                f1 = distance(x1);
+            }
+            else
+            {
+                a  = x1;
+                x1 = x2;
+                f1 = f2;
+                x2 = b - GOLDEN_SECTION * (b - a);
+                f2 = distance(x2);
             }
         }
 
-        prevDist = Dist;
-        prevSign = Sign;
-        jd += step;
+        Approach &approach = approaches[index];
+        approach.jd = (a + b) / 2.0;
+        worker->updatePositions(approach.jd);
+        approach.distance = worker->findPairDistance(candidate.pair);
+        // The maximum separation may depend on the positions of the objects
+        approach.close = approach.distance.radians() < worker->getMaxSeparation();
+    });
+
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        if (approaches[i].close)
+            Separations[candidates[i].pair].insert(approaches[i].jd, approaches[i].distance);
     }
 
     return Separations;
 }
 
-bool ApproachSolver::findPrecise(QPair<long double, dms> *out, long double jd,
-                                 double step, int prevSign)
+void ApproachSolver::forEachTask(const QVector<ApproachSolver *> &workers, int count, int progressStart,
+                                 int progressEnd, const std::function<void (ApproachSolver *, int)> &task)
 {
-    dms prevDist;
-    int Sign;
-    dms Dist;
-
-    if (out == nullptr)
+    int lastProgress = -1;
+    auto reportProgress = [&](int done)
     {
-        qCDebug(KSTARS) << "ERROR: Argument out to KSConjunct::findPrecise(...) was nullptr!";
-        return false;
-    }
-
-    prevDist = updateAndFindDistance(jd);
+        const int progress = progressStart + (progressEnd - progressStart) * done / std::max(count, 1);
+        if (progress != lastProgress)
+        {
+            lastProgress = progress;
+            emit solverMadeProgress(progress);
+        }
+    };
 
-    step     = -step / 2.0;
-    prevSign = -prevSign;
+    reportProgress(0);
 
-    while (true)
+    if (workers.size() == 1 && workers.first() == this)
     {
-        jd += step;
-        Dist = updateAndFindDistance(jd);
-        //    qCDebug(KSTARS) << "Dist=" << Dist.toDMSString() << "; prevDist=" << prevDist.toDMSString() << "; Diff=" << (Dist.Degrees() - prevDist.Degrees()) << "step=" << step;
-
-        if (fabs(step) < 1.0 / (24.0 * 60.0))
+        for (int i = 0; i < count; i++)
         {
-            out->first  = jd - step / 2.0;
-            out->second = updateAndFindDistance(jd - step / 2.0);
-            if (out->second.radians() < updateAndFindDistance(jd - 5.0).radians())
-                return true;
-            else
-                return false;
+            task(this, i);
+            reportProgress(i + 1);
         }
-        Sign = sgn(Dist - prevDist);
-        if (Sign != prevSign)
+        return;
+    }
+
+    QAtomicInt next(0);
+    QSemaphore finished;
+    QList<QFuture<void>> futures;
+    for (ApproachSolver *worker : workers)
+    {
+        futures.append(QtConcurrent::run([&next, &finished, &task, worker, count]()
         {
-            step = -step / 2.0;
-            Sign = -Sign;
-        }
-        prevSign = Sign;
-        prevDist = Dist;
+            for (int i = next.fetchAndAddRelaxed(1); i < count; i = next.fetchAndAddRelaxed(1))
+            {
+                task(worker, i);
+                finished.release();
+            }
+        }));
     }
+
+    // Progress is emitted from the calling thread, the receivers update widgets
+    for (int i = 0; i < count; i++)
+    {
+        finished.acquire();
+        reportProgress(i + 1);
+    }
+
+    for (auto &future : futures)
+        future.waitForFinished();
 }
 
 dms ApproachSolver::findSkyPointDistance(SkyPoint * obj1, SkyPoint * obj2)
@@ -171,11 +303,3 @@ dms ApproachSolver::findSkyPointDistance(SkyPoint * obj1, SkyPoint * obj2)
     return dist;
 }
 
-int ApproachSolver::sgn(dms a)
-{
-    // Auxiliary function used by the KSConjunct::findClosestApproach(...)
-    // method and the KSConjunct::findPrecise(...) method
-
-    return ((a.radians() > 0) ? 1 : ((a.radians() < 0) ? -1 : 0));
-}
-
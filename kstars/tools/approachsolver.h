@@ -22,6 +22,8 @@
 
 #include <QObject>
 #include <QMap>
+#include <QPair>
+#include <QVector>
 #include <memory>
 
 /**
@@ -61,11 +63,26 @@ public:
                                                long double stopJD,
                                                const std::function<void (long double, dms)> &callback = {}); // FIXME: QMap is awkward!
 
+    /** A range of Julian days, first is the start and second the end. */
+    typedef QPair<long double, long double> Interval;
+
+    /**
+     * @short Compute the closest approaches of all pairs of objects in the given ranges
+     *
+     * Every range is sampled with the step of findInitialStep(). Minima of the distance are bracketed
+     * between three samples and only those brackets are refined to a minute. The samples and the
+     * refinements are spread over the threads of the global thread pool if createWorker() is implemented.
+     *
+     * @param intervals ranges of Julian days to search
+     * @return for every pair, the julian days of close approaches against separation
+     */
+    QVector<QMap<long double, dms>> findClosestApproaches(const QVector<Interval> &intervals);
+
     /**
      * @brief getGeoLocation
      * @return the currently set GeoLocation
      */
-    GeoLocation * getGeoLocation() { return m_geoPlace; }
+    GeoLocation * getGeoLocation() const { return m_geoPlace; }
 
 
     /**
@@ -106,6 +123,29 @@ protected:
      */
     virtual dms findDistance() = 0;
 
+    /**
+     * @return the number of object pairs whose distance is found by findPairDistance.
+     * All pairs are moved by a single updatePositions call.
+     */
+    virtual int pairCount() const { return 1; }
+
+    /**
+     * @short Finds the angular distance between the objects of a pair.
+     * @param pair index of the pair, less than pairCount()
+     */
+    virtual dms findPairDistance(int pair)
+    {
+        Q_UNUSED(pair);
+        return findDistance();
+    }
+
+    /**
+     * @short Create a solver for the same objects to search part of the range in another thread.
+     * The location and maximum separation are copied by the caller.
+     * @return a new solver owned by the caller, or nullptr to search in the calling thread only.
+     */
+    virtual ApproachSolver *createWorker() const { return nullptr; }
+
     /**
      * @brief updatePositions
      * @short Update the positions of the objects involved.
@@ -121,40 +161,16 @@ protected:
      */
     virtual double findInitialStep(long double startJD, long double stopJD) = 0;
 
-    /**
-     * @short Compute the precise value of the extremum once the extremum has been detected.
-     *
-     * @param out  A pointer to a QPair that stores the Julian Day and Separation corresponding to the extremum
-     * @param jd  Julian day corresponding to the endpoint of the interval where extremum was detected.
-     * @param step  The step in jd taken during computation earlier. (Defines the interval size)
-     * @param prevSign The previous sign of increment in moving from jd - step to jd
-     *
-     * @return true if the extremum is a minimum
-     */
-    bool findPrecise(QPair<long double, dms> *out, long double jd,
-                     double step, int prevSign);
-
     KSPlanet m_Earth;
 
 private:
     /**
-     * @brief updateAndFindDistance
-     * @param jd Julian Date for which to calculate
-     * @return output of ApproachSolver::findDistance
-     */
-    dms updateAndFindDistance(long double jd) {
-        updatePositions(jd);
-        return findDistance();
-    }
-
-    /**
-     * @short Return the sign of an angle
-     *
-     * @param a  The angle whose sign has to be returned
-     *
-     * @return (-1, 0, 1) if a.radians() is (-ve, zero, +ve)
+     * @brief forEachTask Run task for every index from 0 to count - 1, spread over the workers
+     * @param progressStart progress emitted before the first task
+     * @param progressEnd progress emitted after the last task
      */
-    int sgn(dms a);
+    void forEachTask(const QVector<ApproachSolver *> &workers, int count, int progressStart, int progressEnd,
+                     const std::function<void (ApproachSolver *, int)> &task);
 
     GeoLocation * m_geoPlace { nullptr };
     double m_maxSeparation;
@@ -26,6 +26,7 @@
 
 #include "geolocation.h"
 #include "ksconjunct.h"
+#include "ksephemeriscache.h"
 #include "kstars.h"
 #include "ksnotification.h"
 #include "kstarsdata.h"
@@ -42,6 +43,18 @@
 #include <QStandardItemModel>
 #include <QtConcurrent>
 
+namespace
+{
+// Objects whose conjunctions are searched in one pass, small enough to abort the search between batches
+const int CONJUNCTION_BATCH_SIZE = 64;
+}
+
+ConjunctionsTool::~ConjunctionsTool()
+{
+    // The search uses the solver and the objects
+    m_BatchWatcher.waitForFinished();
+}
+
 ConjunctionsTool::ConjunctionsTool(QWidget *parentSplit) : QFrame(parentSplit)
 {
     setupUi(this);
@@ -85,11 +98,10 @@ ConjunctionsTool::ConjunctionsTool(QWidget *parentSplit) : QFrame(parentSplit)
     // Mode Change
     connect(ModeSelector, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &ConjunctionsTool::setMode);
 
-    //connect(ComputeButton, SIGNAL(clicked()), this, SLOT(slotCompute()));
-    connect(ComputeButton, &QPushButton::clicked, [this]()
-    {
-        QtConcurrent::run(this, &ConjunctionsTool::slotCompute);
-    });
+    // The search runs in the global thread pool, see startNextBatch()
+    connect(ComputeButton, SIGNAL(clicked()), this, SLOT(slotCompute()));
+    connect(&m_EphemerisWatcher, &QFutureWatcher<void>::finished, this, &ConjunctionsTool::startNextBatch);
+    connect(&m_BatchWatcher, &QFutureWatcher<Conjunctions>::finished, this, &ConjunctionsTool::processBatch);
     connect(FilterTypeComboBox, SIGNAL(currentIndexChanged(int)), SLOT(slotFilterType(int)));
     connect(ClearButton, SIGNAL(clicked()), this, SLOT(slotClear()));
     connect(ExportButton, SIGNAL(clicked()), this, SLOT(slotExport()));
@@ -254,7 +266,10 @@ void ConjunctionsTool::slotCompute(void)
         opposition = true;
     QStringList objects; // List of sky object used as Object1
     KStarsData *data = KStarsData::Instance();
-    int progress     = 0;
+
+    // One search at a time, the solver is shared by the batches
+    if (m_EphemerisWatcher.isRunning() || m_BatchWatcher.isRunning() || !m_Batches.isEmpty())
+        return;
 
     // Check if we have a valid angle in maxSeparationBox
     dms maxSeparation(0.0);
@@ -283,7 +298,8 @@ void ConjunctionsTool::slotCompute(void)
     }
 
     // Init KSConjunct object
-    KSConjunct ksc;
+    m_Conjunct.reset(new KSConjunct());
+    KSConjunct &ksc = *m_Conjunct;
     connect(&ksc, SIGNAL(madeProgress(int)), this, SLOT(showProgress(int)));
     ksc.setGeoLocation(geoPlace);
 
@@ -353,37 +369,42 @@ void ConjunctionsTool::slotCompute(void)
         objects.removeAll("Iapetus");
     }
 
+    // The search evaluates the planets thousands of times, their positions are fitted before it starts
+    QVector<KSEphemerisCache::Body> bodies;
+    bodies << KSEphemerisCache::EARTH << KSEphemerisCache::bodyForObject(Object2.get());
+    if (FilterTypeComboBox->currentIndex() == 0)
+        bodies << KSEphemerisCache::bodyForObject(Object1.get());
+    else if (FilterTypeComboBox->currentIndex() == 1 || FilterTypeComboBox->currentIndex() == 3 ||
+             FilterTypeComboBox->currentIndex() == 4)
+    {
+        for (int body = KSEphemerisCache::MERCURY; body < KSEphemerisCache::BODY_COUNT; body++)
+            bodies << static_cast<KSEphemerisCache::Body>(body);
+    }
     ksc.setMaxSeparation(maxSeparation);
     ksc.setObject2(Object2);
     ksc.setOpposition(opposition);
 
+    m_Interval = ApproachSolver::Interval(startJD, stopJD);
+
     if (FilterTypeComboBox->currentIndex() != 0)
     {
         // Show a progress dialog while processing
-        QProgressDialog progressDlg(i18n("Compute conjunction..."), i18n("Abort"), 0, objects.count(), this);
-        progressDlg.setWindowTitle(i18n("Conjunction"));
-        progressDlg.setWindowModality(Qt::WindowModal);
-        progressDlg.setValue(0);
+        m_ProgressDialog = new QProgressDialog(i18n("Compute conjunction..."), i18n("Abort"), 0, objects.count(), this);
+        m_ProgressDialog->setWindowTitle(i18n("Conjunction"));
+        m_ProgressDialog->setWindowModality(Qt::WindowModal);
+        m_ProgressDialog->setValue(0);
 
+        // Objects sampled with the same step are searched together, a fast object would slow down the others
+        QMap<double, QStringList> objectsByStep;
         for (auto &object : objects)
+            objectsByStep[KSConjunct::initialStep(object, Object2->name(), startJD, stopJD)].append(object);
+
+        for (const auto &group : objectsByStep)
         {
-            // If the user click on the 'cancel' button
-            if (progressDlg.wasCanceled())
-                break;
-
-            // Update progress dialog
-            ++progress;
-            progressDlg.setValue(progress);
-            progressDlg.setLabelText(i18n("Compute conjunction between %1 and %2", Object2->name(), object));
-
-            // Compute conjuction
-            Object1 = std::shared_ptr<SkyObject>(data->skyComposite()->findByName(object)->clone());
-            ksc.setObject1(Object1);
-            showConjunctions(ksc.findClosestApproach(startJD, stopJD),
-                             object, Object2->name());
+            for (int i = 0; i < group.size(); i += CONJUNCTION_BATCH_SIZE)
+                m_Batches.append(group.mid(i, CONJUNCTION_BATCH_SIZE));
         }
-
-        progressDlg.setValue(objects.count());
+        m_BatchProgress = 0;
     }
     else
     {
@@ -392,16 +413,68 @@ void ConjunctionsTool::slotCompute(void)
 
         ComputeStack->setCurrentIndex(1);
 
-        ksc.setObject1(Object1);
-        showConjunctions(ksc.findClosestApproach(startJD, stopJD),
-                         Object1->name(), Object2->name());
-        ComputeStack->setCurrentIndex(0);
+        m_Batches.append(QStringList() << Object1->name());
+    }
+
+    m_EphemerisWatcher.setFuture(KSEphemerisCache::Instance()->request(bodies, startJD - 1, stopJD + 1));
+}
+
+void ConjunctionsTool::startNextBatch()
+{
+    if (m_Batches.isEmpty() || (m_ProgressDialog != nullptr && m_ProgressDialog->wasCanceled()))
+    {
+        if (m_ProgressDialog != nullptr)
+        {
+            m_ProgressDialog->setValue(m_ProgressDialog->maximum());
+            m_ProgressDialog->deleteLater();
+            m_ProgressDialog = nullptr;
+        }
+        else
+        {
+            ComputeStack->setCurrentIndex(0);
+
+            // Restore cursor
+            QApplication::restoreOverrideCursor();
+        }
 
-        // Restore cursor
-        QApplication::restoreOverrideCursor();
+        m_Batches.clear();
+        Object2.reset();
+        return;
     }
 
-    Object2.reset();
+    const QStringList &batch = m_Batches.first();
+    QVector<SkyObject_s> objects1;
+    if (m_ProgressDialog != nullptr)
+    {
+        // Update progress dialog
+        m_ProgressDialog->setValue(m_BatchProgress);
+        m_ProgressDialog->setLabelText(i18n("Compute conjunction between %1 and %2", Object2->name(), batch.first()));
+
+        for (const auto &object : batch)
+            objects1.append(std::shared_ptr<SkyObject>(KStarsData::Instance()->skyComposite()->findByName(object)->clone()));
+    }
+    else
+        objects1.append(Object1);
+
+    // Compute conjuctions of the whole batch in one pass, away from the user interface
+    KSConjunct *ksc = m_Conjunct.get();
+    ksc->setObjects1(objects1);
+    const QVector<ApproachSolver::Interval> intervals = QVector<ApproachSolver::Interval>() << m_Interval;
+    m_BatchWatcher.setFuture(QtConcurrent::run([ksc, intervals]()
+    {
+        return ksc->findClosestApproaches(intervals);
+    }));
+}
+
+void ConjunctionsTool::processBatch()
+{
+    const QStringList batch = m_Batches.takeFirst();
+    const Conjunctions conjunctions = m_BatchWatcher.result();
+    for (int i = 0; i < batch.size(); i++)
+        showConjunctions(conjunctions.value(i), batch[i], Object2->name());
+
+    m_BatchProgress += batch.size();
+    startNextBatch();
 }
 
 void ConjunctionsTool::showProgress(int n)
@@ -25,14 +25,19 @@
 #pragma once
 
 #include "dms.h"
+#include "ksconjunct.h"
 #include "ui_conjunctions.h"
 
 #include <QFrame>
+#include <QFutureWatcher>
 #include <QMap>
+#include <QPointer>
 #include <QString>
 #include "skycomponents/typedef.h"
 #include <memory>
 
+class QProgressDialog;
+
 class QSortFilterProxyModel;
 class QStandardItemModel;
 
@@ -51,7 +56,7 @@ class ConjunctionsTool : public QFrame, public Ui::ConjunctionsDlg
 
   public:
     explicit ConjunctionsTool(QWidget *p);
-    virtual ~ConjunctionsTool() override = default;
+    virtual ~ConjunctionsTool() override;
 
   public slots:
 
@@ -66,7 +71,15 @@ class ConjunctionsTool : public QFrame, public Ui::ConjunctionsDlg
     void slotExport();
     void slotFilterReg(const QString &);
 
+  private slots:
+    /** Show the conjunctions of the finished batch and start the next one. */
+    void processBatch();
+
+    /** Search the first batch in the global thread pool, or finish the search if there is none. */
+    void startNextBatch();
+
   private:
+
     void showConjunctions(const QMap<long double, dms> &conjunctionlist, const QString &object1,
                           const QString &object2);
 
@@ -96,4 +109,16 @@ class ConjunctionsTool : public QFrame, public Ui::ConjunctionsDlg
     QStandardItemModel *m_Model { nullptr };
     QSortFilterProxyModel *m_SortModel { nullptr };
     int m_index { 0 };
+
+    typedef QVector<QMap<long double, dms>> Conjunctions;
+    /// Names of the objects searched in one pass, the first batch is being searched
+    QList<QStringList> m_Batches;
+    std::unique_ptr<KSConjunct> m_Conjunct;
+    ApproachSolver::Interval m_Interval;
+    // Fits the positions of the planets before the first batch
+    QFutureWatcher<void> m_EphemerisWatcher;
+    QFutureWatcher<Conjunctions> m_BatchWatcher;
+    /// Only set when several objects are searched
+    QPointer<QProgressDialog> m_ProgressDialog;
+    int m_BatchProgress { 0 };
 };
@@ -16,6 +16,7 @@
  ***************************************************************************/
 
 #include "lunareclipsehandler.h"
+#include "ksephemeriscache.h"
 #include "skymapcomposite.h"
 #include "solarsystemcomposite.h"
 #include "dms.h"
@@ -23,6 +24,7 @@
 LunarEclipseHandler::LunarEclipseHandler(QObject * parent) : EclipseHandler(parent),
     m_sun(), m_moon(), m_shadow(&m_moon, &m_sun, &m_Earth)
 {
+    connect(this, &ApproachSolver::solverMadeProgress, this, &EclipseHandler::signalProgress);
 }
 
 EclipseHandler::EclipseVector LunarEclipseHandler::computeEclipses(long double startJD, long double endJD)
@@ -31,6 +33,10 @@ EclipseHandler::EclipseVector LunarEclipseHandler::computeEclipses(long double s
 
     const long double SEARCH_INTERVAL = 5.l; // Days
 
+    // Fit the Sun and the Moon once, the search evaluates them thousands of times
+    KSEphemerisCache::Instance()->request(QVector<KSEphemerisCache::Body>() << KSEphemerisCache::EARTH << KSEphemerisCache::MOON,
+                                          startJD - 1, endJD + SEARCH_INTERVAL + 1).waitForFinished();
+
     QVector<EclipseEvent_s> eclipses;
     QVector<long double> fullMoons = getFullMoons(startJD, endJD);
 
@@ -38,47 +44,35 @@ EclipseHandler::EclipseVector LunarEclipseHandler::computeEclipses(long double s
     if (total == 0)
         return eclipses;
 
-    float step = 1 / total;
-    float progress = 0;
+    // All windows are searched in one pass
+    QVector<Interval> windows;
+    for(auto date : fullMoons)
+        windows.append(Interval(date, date + SEARCH_INTERVAL));
 
-    connect(this, &ApproachSolver::solverMadeProgress, this, [ &, this] (int dProgress)
+    const QMap<long double, dms> approaches = findClosestApproaches(windows).value(0);
+    for (auto it = approaches.constBegin(); it != approaches.constEnd(); ++it)
     {
-        float tmpProgress = roundf(progress + step * dProgress);
-        if (tmpProgress > progress)
+        const long double JD = it.key();
+        EclipseEvent::ECLIPSE_TYPE type;
+        updatePositions(JD);
+
+        KSEarthShadow::ECLIPSE_TYPE extended_type = m_shadow.getEclipseType();
+        switch (extended_type)
         {
-            progress = tmpProgress;
-            emit signalProgress(static_cast<int>(progress));
+            case KSEarthShadow::FULL_PENUMBRA:
+            case KSEarthShadow::FULL_UMBRA:
+                type = EclipseEvent::FULL;
+                break;
+            case KSEarthShadow::NONE:
+                continue;
+            default:
+                type = EclipseEvent::PARTIAL;
+                break;
         }
-    });
 
-    for(auto date : fullMoons)
-    {
-        findClosestApproach(date, date + SEARCH_INTERVAL, [&eclipses, this] (long double JD, dms)
-        {
-            EclipseEvent::ECLIPSE_TYPE type;
-            updatePositions(JD);
-
-            KSEarthShadow::ECLIPSE_TYPE extended_type = m_shadow.getEclipseType();
-            switch (extended_type)
-            {
-                case KSEarthShadow::FULL_PENUMBRA:
-                case KSEarthShadow::FULL_UMBRA:
-                    type = EclipseEvent::FULL;
-                    break;
-                case KSEarthShadow::NONE:
-                    return;
-                default:
-                    type = EclipseEvent::PARTIAL;
-                    break;
-            }
-
-            EclipseEvent_s event = std::make_shared<LunarEclipseEvent>(JD, *getGeoLocation(), type, extended_type);
-            emit signalEventFound(event);
-            eclipses.append(event);
-        });
-
-        progress++;
-        emit signalProgress(static_cast<int>(roundf(100 * (progress / total))));
+        EclipseEvent_s event = std::make_shared<LunarEclipseEvent>(JD, *getGeoLocation(), type, extended_type);
+        emit signalEventFound(event);
+        eclipses.append(event);
     }
 
     emit signalProgress(100);
@@ -140,6 +134,13 @@ LunarEclipseHandler::~LunarEclipseHandler()
 
 }
 
+ApproachSolver *LunarEclipseHandler::createWorker() const
+{
+    LunarEclipseHandler *worker = new LunarEclipseHandler();
+    worker->m_mode = m_mode;
+    return worker;
+}
+
 void LunarEclipseHandler::updatePositions(long double jd)
 {
     KStarsDateTime t(jd);
@@ -112,6 +112,8 @@ protected:
     // NOTE: This method depends on m_mode!
     double getMaxSeparation() override;
 
+    ApproachSolver *createWorker() const override;
+
 private:
     /**
      * @brief getFullMoons
@@ -22,6 +22,7 @@
 #include "skyobjects/skyobject.h"
 #include "skyobjects/ksplanetbase.h"
 
+#include <algorithm>
 #include <cmath>
 
 KSConjunct::KSConjunct() : ApproachSolver ()
@@ -31,7 +32,12 @@ KSConjunct::KSConjunct() : ApproachSolver ()
 
 dms KSConjunct::findDistance()
 {
-    dms dist = findSkyPointDistance(m_object1.get(), m_object2.get());
+    return findPairDistance(0);
+}
+
+dms KSConjunct::findPairDistance(int pair)
+{
+    dms dist = findSkyPointDistance(m_object1[pair].get(), m_object2.get());
     if (m_opposition)
     {
         dist.setD(180 - dist.Degrees());
@@ -48,16 +54,49 @@ void KSConjunct::updatePositions(long double jd)
     m_Earth.findPosition(&num);
     CachingDms LST(getGeoLocation()->GSTtoLST(t.gst()));
 
-    KSPlanetBase *p = dynamic_cast<KSPlanetBase*>(m_object1.get());
-    if (p)
-        p->findPosition(&num, getGeoLocation()->lat(), &LST, &m_Earth);
-    else
-        m_object1->updateCoordsNow(&num);
+    for (auto &object : m_object1)
+    {
+        KSPlanetBase *p = dynamic_cast<KSPlanetBase*>(object.get());
+        if (p)
+            p->findPosition(&num, getGeoLocation()->lat(), &LST, &m_Earth);
+        else
+            object->updateCoordsNow(&num);
+    }
 
     m_object2->findPosition(&num, getGeoLocation()->lat(), &LST, &m_Earth);
 }
 
+ApproachSolver *KSConjunct::createWorker() const
+{
+    KSConjunct *worker = new KSConjunct();
+
+    // Every thread moves its own copies of the objects
+    for (const auto &object : m_object1)
+    {
+        SkyObject_s copy(object->clone());
+        TrailObject *trail = dynamic_cast<TrailObject*>(copy.get());
+        if (trail)
+            trail->clearTrail();
+        worker->m_object1.append(copy);
+    }
+    worker->m_object2.reset(static_cast<KSPlanetBase*>(m_object2->clone()));
+    worker->m_object2->clearTrail();
+    worker->m_opposition = m_opposition;
+
+    return worker;
+}
+
 double KSConjunct::findInitialStep(long double startJD, long double stopJD)
+{
+    double step0 = double(stopJD - startJD) / 4.0;
+
+    for (const auto &object : m_object1)
+        step0 = std::min(step0, initialStep(object->name(), m_object2->name(), startJD, stopJD));
+
+    return step0;
+}
+
+double KSConjunct::initialStep(const QString &name1, const QString &name2, long double startJD, long double stopJD)
 {
 
     double step0 =
@@ -68,22 +107,22 @@ double KSConjunct::findInitialStep(long double startJD, long double stopJD)
         step0 = 24.8 * 365.25;
 
     // FIXME: This can be done better, but for now, I'm doing it the dumb way -- asimha
-    if (m_object1->name() == i18n("Neptune") || m_object2->name() == i18n("Neptune") || m_object1->name() == i18n("Uranus") ||
-            m_object2->name() == i18n("Uranus"))
+    if (name1 == i18n("Neptune") || name2 == i18n("Neptune") || name1 == i18n("Uranus") ||
+            name2 == i18n("Uranus"))
         if (step0 > 3652.5)
             step0 = 3652.5;
-    if (m_object1->name() == i18n("Jupiter") || m_object2->name() == i18n("Jupiter") || m_object1->name() == i18n("Saturn") ||
-            m_object2->name() == i18n("Saturn"))
+    if (name1 == i18n("Jupiter") || name2 == i18n("Jupiter") || name1 == i18n("Saturn") ||
+            name2 == i18n("Saturn"))
         if (step0 > 365.25)
             step0 = 365;
-    if (m_object1->name() == i18n("Mars") || m_object2->name() == i18n("Mars"))
+    if (name1 == i18n("Mars") || name2 == i18n("Mars"))
         if (step0 > 10.0)
             step0 = 10.0;
-    if (m_object1->name() == i18n("Venus") || m_object1->name() == i18n("Mercury") || m_object2->name() == i18n("Mercury") ||
-            m_object2->name() == i18n("Venus"))
+    if (name1 == i18n("Venus") || name1 == i18n("Mercury") || name2 == i18n("Mercury") ||
+            name2 == i18n("Venus"))
         if (step0 > 5.0)
             step0 = 5.0;
-    if (m_object1->name() == i18n("Moon") || m_object2->name() == i18n("Moon"))
+    if (name1 == i18n("Moon") || name2 == i18n("Moon"))
         if (step0 > 0.25)
             step0 = 0.25;
 
@@ -39,22 +39,37 @@ public:
     /** Constructor. Instantiates a KSNumbers for internal computations. */
     KSConjunct();
 
-    void setObject1(SkyObject_s &obj) { m_object1 = obj; }
+    void setObject1(SkyObject_s &obj) { m_object1 = { obj }; }
     void setObject2(KSPlanetBase_s &obj) { m_object2 = obj; }
     void setOpposition(bool opposition) { m_opposition = opposition; }
 
+    /**
+     * @short Search the approaches of several objects to object 2 at once.
+     * Pair i of findClosestApproaches() is objects[i] and object 2.
+     */
+    void setObjects1(const QVector<SkyObject_s> &objects) { m_object1 = objects; }
+
+    /**
+     * @return the sampling step in days used to find the approaches of the objects with the given names.
+     * Objects which move faster need a smaller step, so searching them together with slow ones is slower.
+     */
+    static double initialStep(const QString &name1, const QString &name2, long double startJD, long double stopJD);
+
 signals:
     void madeProgress(int);
 
 protected:
     double findInitialStep(long double startJD, long double stopJD) override;
     void updatePositions(long double jd) override;
+    int pairCount() const override { return m_object1.size(); }
+    dms findPairDistance(int pair) override;
+    ApproachSolver *createWorker() const override;
 
 private:
     dms findDistance() override;
 
 
-    SkyObject_s m_object1;
+    QVector<SkyObject_s> m_object1;
     KSPlanetBase_s m_object2;
     bool m_opposition { false };
 };
@@ -21,6 +21,7 @@
 
 #include "config-kstars.h"
 
+#include "altitudecurves.h"
 #include "constellationboundarylines.h"
 #include "fov.h"
 #include "imageviewer.h"
@@ -1163,27 +1164,18 @@ void ObservingList::plot(SkyObject *o)
     ui->avt->setMoonRiseSetTimes(ksal->getMoonRise(), ksal->getMoonSet());
     ui->avt->setMoonIllum(ksal->getMoonIllum());
     ui->avt->update();
+    // 49 samples every half hour, from noon to noon
+    AltitudeCurves curves(geo, ut.addSecs((DayOffset * 24.0 - 12.0) * 3600.0), 0.5, 49);
+    curves.compute(QVector<const SkyPoint *>() << o);
     KPlotObject *po = new KPlotObject(Qt::white, KPlotObject::Lines, 2.0);
-    for (double h = -12.0; h <= 12.0; h += 0.5)
+    for (int i = 0; i < curves.samples(); i++)
     {
-        po->addPoint(h, findAltitude(o, (h + DayOffset * 24.0)));
+        po->addPoint(-12.0 + 0.5 * i, curves.altitude(0, i));
     }
     ui->avt->removeAllPlotObjects();
     ui->avt->addPlotObject(po);
 }
 
-double ObservingList::findAltitude(SkyPoint *p, double hour)
-{
-    // Jasem 2015-09-05 Using correct procedure to find altitude
-    SkyPoint sp                   = *p; // make a copy
-    QDateTime midnight            = QDateTime(dt.date(), QTime());
-    KStarsDateTime ut             = geo->LTtoUT(KStarsDateTime(midnight));
-    KStarsDateTime targetDateTime = ut.addSecs(hour * 3600.0);
-    dms LST                       = geo->GSTtoLST(targetDateTime.gst());
-    sp.EquatorialToHorizontal(&LST, geo->lat());
-    return sp.alt().Degrees();
-}
-
 void ObservingList::slotChangeTab(int index)
 {
     noSelection = true;
@@ -20,10 +20,37 @@
 #include "geolocation.h"
 #include "kstarsdata.h"
 #include "dialogs/locationdialog.h"
+#include "htmesh/MeshIterator.h"
 #include "skycomponents/constellationboundarylines.h"
 #include "skycomponents/skymapcomposite.h"
+#include "skycomponents/skymesh.h"
 #include "skyobjects/deepskyobject.h"
 
+#include <QSet>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// Observability is computed for the center of declination bands of this width
+const double BAND_DEGREES = 0.1;
+
+// Hour angle in hours within which a + c cos(HA) >= s, -1 if never
+double hourAngleLimit(double s, double a, double c)
+{
+    if (c < 1e-12)
+        return a >= s ? 12.0 : -1.0;
+
+    double cosHA = (s - a) / c;
+    if (cosHA <= -1.0)
+        return 12.0;
+    if (cosHA > 1.0)
+        return -1.0;
+    return std::acos(cosHA) * 12.0 / dms::PI;
+}
+}
+
 ObsListWizardUI::ObsListWizardUI(QWidget *p) : QFrame(p)
 {
     setupUi(this);
@@ -69,13 +96,14 @@ ObsListWizard::ObsListWizard(QWidget *ksparent) : QDialog(ksparent)
     // Enable the update count button when certain elements are changed
     connect(olw->TypeList, &QListWidget::itemSelectionChanged, this, &ObsListWizard::slotObjectCountDirty);
     connect(olw->ConstellationList, &QListWidget::itemSelectionChanged, this, &ObsListWizard::slotObjectCountDirty);
-    connect(olw->RAMin, &QLineEdit::editingFinished, this, &ObsListWizard::slotParseRegion);
-    connect(olw->RAMax, &QLineEdit::editingFinished, this, &ObsListWizard::slotParseRegion);
-    connect(olw->DecMin, &QLineEdit::editingFinished, this, &ObsListWizard::slotParseRegion);
-    connect(olw->DecMax, &QLineEdit::editingFinished, this, &ObsListWizard::slotParseRegion);
-    connect(olw->RA, &QLineEdit::editingFinished, this, &ObsListWizard::slotParseRegion);
-    connect(olw->Dec, &QLineEdit::editingFinished, this, &ObsListWizard::slotParseRegion);
-    connect(olw->Radius, &QLineEdit::editingFinished, this, &ObsListWizard::slotObjectCountDirty);
+    connect(olw->RegionList, &QListWidget::itemSelectionChanged, this, &ObsListWizard::slotObjectCountDirty);
+    // Region boxes are parsed as they are typed, the count follows them
+    foreach (QLineEdit *box, QList<QLineEdit *>() << olw->RAMin << olw->RAMax << olw->DecMin << olw->DecMax << olw->RA
+             << olw->Dec << olw->Radius)
+    {
+        connect(box, &QLineEdit::editingFinished, this, &ObsListWizard::slotParseRegion);
+        connect(box, &QLineEdit::textEdited, this, &ObsListWizard::slotParseRegion);
+    }
     connect(olw->Date, &QDateEdit::dateChanged, this, &ObsListWizard::slotObjectCountDirty);
     connect(olw->Mag, static_cast<void(QDoubleSpinBox::*)(double)>(&QDoubleSpinBox::valueChanged), this,
             &ObsListWizard::slotObjectCountDirty);
@@ -126,34 +154,78 @@ void ObsListWizard::initialize()
     olw->RAMin->setDegType(false);
     olw->RAMax->setDegType(false);
 
-    //Initialize object counts
-    ObjectCount   = 0;                                        //number of objects in observing list
-    StarCount     = data->skyComposite()->stars().size();     //total number of stars
-    PlanetCount   = 10;                                       //Sun, Moon, 8 planets
-    AsteroidCount = data->skyComposite()->asteroids().size(); //total number of asteroids
-    CometCount    = data->skyComposite()->comets().size();    //total number of comets
-    //DeepSkyObjects
-    OpenClusterCount = 0;
-    GlobClusterCount = 0;
-    GasNebCount      = 0;
-    PlanNebCount     = 0;
-    GalaxyCount      = 0;
+    ObjectCount = 0;
+
+    //Fill the attribute columns, in the order of the built list.
+    //Stars are sorted by mag. JM 2012-10-22: Skip unnamed stars
+    foreach (SkyObject *o, data->skyComposite()->stars())
+    {
+        if (o->name() != "star")
+            addCandidate(o, STARS);
+    }
+
+    //Sun, Moon, Planets
+    foreach (const QString &name, QStringList() << i18n("Sun") << i18n("Moon") << i18n("Mercury") << i18n("Venus")
+             << i18n("Mars") << i18n("Jupiter") << i18n("Saturn") << i18n("Uranus") << i18n("Neptune"))
+    {
+        SkyObject *o = data->skyComposite()->findByName(name);
+        if (o)
+            addCandidate(o, SOLAR_SYSTEM);
+    }
 
     foreach (DeepSkyObject *o, data->skyComposite()->deepSkyObjects())
     {
-        if (o->type() == SkyObject::GALAXY)
-            ++GalaxyCount; //most deepsky obj are galaxies, so check them first
-        else if (o->type() == SkyObject::STAR || o->type() == SkyObject::CATALOG_STAR)
-            ++StarCount;
-        else if (o->type() == SkyObject::OPEN_CLUSTER)
-            ++OpenClusterCount;
-        else if (o->type() == SkyObject::GLOBULAR_CLUSTER)
-            ++GlobClusterCount;
-        else if (o->type() == SkyObject::GASEOUS_NEBULA || o->type() == SkyObject::SUPERNOVA_REMNANT)
-            ++GasNebCount;
-        else if (o->type() == SkyObject::PLANETARY_NEBULA)
-            ++PlanNebCount;
+        switch (o->type())
+        {
+            case SkyObject::OPEN_CLUSTER:
+                addCandidate(o, OPEN_CLUSTERS);
+                break;
+            case SkyObject::GLOBULAR_CLUSTER:
+                addCandidate(o, GLOBULAR_CLUSTERS);
+                break;
+            case SkyObject::GASEOUS_NEBULA:
+            case SkyObject::SUPERNOVA_REMNANT:
+                addCandidate(o, GASEOUS_NEBULAE);
+                break;
+            case SkyObject::PLANETARY_NEBULA:
+                addCandidate(o, PLANETARY_NEBULAE);
+                break;
+            case SkyObject::GALAXY:
+                addCandidate(o, GALAXIES);
+                break;
+            default:
+                break;
+        }
     }
+
+    foreach (SkyObject *o, data->skyComposite()->comets())
+        addCandidate(o, COMETS);
+
+    foreach (SkyObject *o, data->skyComposite()->asteroids())
+        addCandidate(o, ASTEROIDS);
+
+    //Bitmap index of each category
+    for (int c = 0; c < CATEGORY_COUNT; ++c)
+        m_Categories[c] = QBitArray(m_Objects.size());
+    for (int i = 0; i < m_Objects.size(); ++i)
+        m_Categories[m_Category[i]].setBit(i);
+
+    m_ByDec.resize(m_Objects.size());
+    for (int i = 0; i < m_ByDec.size(); ++i)
+        m_ByDec[i] = i;
+    std::sort(m_ByDec.begin(), m_ByDec.end(), [this](int a, int b)
+    {
+        return m_Dec[a] < m_Dec[b];
+    });
+}
+
+void ObsListWizard::addCandidate(SkyObject *o, Category category)
+{
+    m_Objects.append(o);
+    m_Mag.append(o->mag());
+    m_RA.append(o->ra().Hours());
+    m_Dec.append(o->dec().Degrees());
+    m_Category.append(category);
 }
 
 bool ObsListWizard::isItemSelected(const QString &name, QListWidget *listWidget, bool *ok)
@@ -394,32 +466,17 @@ void ObsListWizard::slotParseRegion()
 
 void ObsListWizard::slotObjectCountDirty()
 {
-    olw->updateButton->setDisabled(false);
+    // Only the changed filter is recomputed, so the count is updated right away
+    slotUpdateObjectCount();
 }
 
 void ObsListWizard::slotUpdateObjectCount()
 {
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-    ObjectCount = 0;
-    if (isItemSelected(i18n("Stars"), olw->TypeList))
-        ObjectCount += StarCount;
-    if (isItemSelected(i18n("Sun, moon, planets"), olw->TypeList))
-        ObjectCount += PlanetCount;
-    if (isItemSelected(i18n("Comets"), olw->TypeList))
-        ObjectCount += CometCount;
-    if (isItemSelected(i18n("Asteroids"), olw->TypeList))
-        ObjectCount += AsteroidCount;
-    if (isItemSelected(i18n("Galaxies"), olw->TypeList))
-        ObjectCount += GalaxyCount;
-    if (isItemSelected(i18n("Open clusters"), olw->TypeList))
-        ObjectCount += OpenClusterCount;
-    if (isItemSelected(i18n("Globular clusters"), olw->TypeList))
-        ObjectCount += GlobClusterCount;
-    if (isItemSelected(i18n("Gaseous nebulae"), olw->TypeList))
-        ObjectCount += GasNebCount;
-    if (isItemSelected(i18n("Planetary nebulae"), olw->TypeList))
-        ObjectCount += PlanNebCount;
+    // Nothing to count while the wizard is being set up
+    if (m_Objects.isEmpty())
+        return;
 
+    QApplication::setOverrideCursor(Qt::WaitCursor);
     applyFilters(false); //false = only adjust counts, do not build list
     QApplication::restoreOverrideCursor();
     olw->updateButton->setDisabled(true);
@@ -427,560 +484,313 @@ void ObsListWizard::slotUpdateObjectCount()
 
 void ObsListWizard::applyFilters(bool doBuildList)
 {
-    bool filterPass  = true;
-    KStarsData *data = KStarsData::Instance();
     if (doBuildList)
         obsList().clear();
 
-    //We don't need to call applyRegionFilter() if no region filter is selected, *and*
-    //we are just counting items (i.e., doBuildList is false)
-    bool needRegion = true;
-    if (!doBuildList && isItemSelected(i18n("all over the sky"), olw->RegionList))
-        needRegion = false;
+    updateTypeFilter();
+    updateMagnitudeFilter();
+    updateRegionFilter();
+    updateObservableFilter();
 
-    double maglimit = 100.;
-    if (olw->SelectByMagnitude->isChecked())
-        maglimit = olw->Mag->value();
+    QBitArray selected = m_TypeMask & m_MagMask & m_RegionMask & m_ObservableMask;
+    ObjectCount        = selected.count(true);
 
-    //Stars
-    if (isItemSelected(i18n("Stars"), olw->TypeList))
+    if (doBuildList)
     {
-        const QList<SkyObject *> &starList = data->skyComposite()->stars();
-        int starIndex(starList.size());
-        if (maglimit < 100.)
-        {
-            //Stars are sorted by mag, so use binary search algo to find index of faintest mag
-            int low(0), high(starList.size() - 1), middle(high);
-            while (low < high)
-            {
-                middle = (low + high) / 2;
-                if (maglimit == starList.at(middle)->mag())
-                    break;
-                if (maglimit < starList.at(middle)->mag())
-                    high = middle - 1;
-                if (maglimit > starList.at(middle)->mag())
-                    low = middle + 1;
-            }
-            //now, the star at "middle" has the right mag, but we want the *last* star that has this mag.
-            for (starIndex = middle + 1; starIndex < starList.size(); ++starIndex)
-            {
-                if (starList.at(starIndex)->mag() > maglimit)
-                    break;
-            }
-        }
-
-        //DEBUG
-        qDebug() << QString("starIndex for mag %1: %2").arg(maglimit).arg(starIndex);
-
-        if (!doBuildList)
-        {
-            //reduce StarCount by appropriate amount
-            ObjectCount -= StarCount;
-            ObjectCount += starIndex;
-        }
-        for (int i = 0; i < starIndex; ++i)
+        obsList().reserve(ObjectCount);
+        for (int i = 0; i < selected.size(); ++i)
         {
-            SkyObject *o = (SkyObject *)(starList[i]);
-
-            // JM 2012-10-22: Skip unnamed stars
-            if (o->name() == "star")
-            {
-                if (!doBuildList)
-                    --ObjectCount;
-                continue;
-            }
-
-            if (needRegion)
-                filterPass = applyRegionFilter(o, doBuildList, !doBuildList);
-            //Filter objects visible from geo at Date if region filter passes
-            if (olw->SelectByDate->isChecked() && filterPass)
-                applyObservableFilter(o, doBuildList, !doBuildList);
+            if (selected.testBit(i))
+                obsList().append(m_Objects[i]);
         }
     }
 
-    //Sun, Moon, Planets
-    if (isItemSelected(i18n("Sun, moon, planets"), olw->TypeList))
-    {
-        if (maglimit < data->skyComposite()->findByName(i18n("Sun"))->mag())
-        {
-            if (!doBuildList)
-                --ObjectCount;
-            filterPass = false;
-        }
-        else
-            filterPass = true;
-
-        if (needRegion && filterPass)
-            filterPass = applyRegionFilter(data->skyComposite()->findByName(i18n("Sun")), doBuildList);
-        if (olw->SelectByDate->isChecked() && filterPass)
-            applyObservableFilter(data->skyComposite()->findByName(i18n("Sun")), doBuildList);
-
-        if (maglimit < data->skyComposite()->findByName(i18n("Moon"))->mag())
-        {
-            if (!doBuildList)
-                --ObjectCount;
-            filterPass = false;
-        }
-        else
-            filterPass = true;
-
-        if (needRegion && filterPass)
-            filterPass = applyRegionFilter(data->skyComposite()->findByName(i18n("Moon")), doBuildList);
-        if (olw->SelectByDate->isChecked() && filterPass)
-            applyObservableFilter(data->skyComposite()->findByName(i18n("Moon")), doBuildList);
-
-        if (maglimit < data->skyComposite()->findByName(i18n("Mercury"))->mag())
-        {
-            if (!doBuildList)
-                --ObjectCount;
-            filterPass = false;
-        }
-        else
-            filterPass = true;
-        if (needRegion && filterPass)
-            filterPass = applyRegionFilter(data->skyComposite()->findByName(i18n("Mercury")), doBuildList);
-        if (olw->SelectByDate->isChecked() && filterPass)
-            applyObservableFilter(data->skyComposite()->findByName(i18n("Mercury")), doBuildList);
+    olw->CountLabel->setText(i18np("Your observing list currently has 1 object",
+                                   "Your observing list currently has %1 objects", ObjectCount));
+}
 
-        if (maglimit < data->skyComposite()->findByName(i18n("Venus"))->mag())
-        {
-            if (!doBuildList)
-                --ObjectCount;
-            filterPass = false;
-        }
-        else
-            filterPass = true;
+void ObsListWizard::updateTypeFilter()
+{
+    const QString names[CATEGORY_COUNT] = { i18n("Stars"), i18n("Sun, moon, planets"), i18n("Open clusters"),
+                                            i18n("Globular clusters"), i18n("Gaseous nebulae"), i18n("Planetary nebulae"),
+                                            i18n("Galaxies"), i18n("Comets"), i18n("Asteroids")
+                                          };
 
-        if (needRegion && filterPass)
-            filterPass = applyRegionFilter(data->skyComposite()->findByName(i18n("Venus")), doBuildList);
-        if (olw->SelectByDate->isChecked() && filterPass)
-            applyObservableFilter(data->skyComposite()->findByName(i18n("Venus")), doBuildList);
+    QString key;
+    for (int c = 0; c < CATEGORY_COUNT; ++c)
+        key += isItemSelected(names[c], olw->TypeList) ? '1' : '0';
 
-        if (maglimit < data->skyComposite()->findByName(i18n("Mars"))->mag())
-        {
-            if (!doBuildList)
-                --ObjectCount;
-            filterPass = false;
-        }
-        else
-            filterPass = true;
-        if (needRegion && filterPass)
-            filterPass = applyRegionFilter(data->skyComposite()->findByName(i18n("Mars")), doBuildList);
-        if (olw->SelectByDate->isChecked() && filterPass)
-            applyObservableFilter(data->skyComposite()->findByName(i18n("Mars")), doBuildList);
+    if (key == m_TypeKey && m_TypeMask.size() == m_Objects.size())
+        return;
 
-        if (maglimit < data->skyComposite()->findByName(i18n("Jupiter"))->mag())
-        {
-            if (!doBuildList)
-                --ObjectCount;
-            filterPass = false;
-        }
-        else
-            filterPass = true;
-        if (needRegion && filterPass)
-            filterPass = applyRegionFilter(data->skyComposite()->findByName(i18n("Jupiter")), doBuildList);
-        if (olw->SelectByDate->isChecked() && filterPass)
-            applyObservableFilter(data->skyComposite()->findByName(i18n("Jupiter")), doBuildList);
+    m_TypeKey  = key;
+    m_TypeMask = QBitArray(m_Objects.size());
+    for (int c = 0; c < CATEGORY_COUNT; ++c)
+    {
+        if (key[c] == '1')
+            m_TypeMask |= m_Categories[c];
+    }
+}
 
-        if (maglimit < data->skyComposite()->findByName(i18n("Saturn"))->mag())
-        {
-            if (!doBuildList)
-                --ObjectCount;
-            filterPass = false;
-        }
-        else
-            filterPass = true;
+void ObsListWizard::updateMagnitudeFilter()
+{
+    const bool byMagnitude = olw->SelectByMagnitude->isChecked();
+    const double maglimit  = olw->Mag->value();
+    const bool noMag       = olw->IncludeNoMag->isChecked();
 
-        if (needRegion && filterPass)
-            filterPass = applyRegionFilter(data->skyComposite()->findByName(i18n("Saturn")), doBuildList);
-        if (olw->SelectByDate->isChecked() && filterPass)
-            applyObservableFilter(data->skyComposite()->findByName(i18n("Saturn")), doBuildList);
+    QString key;
+    if (byMagnitude)
+        key = QString("%1 %2").arg(maglimit).arg(noMag);
 
-        if (maglimit < data->skyComposite()->findByName(i18n("Uranus"))->mag())
-        {
-            if (!doBuildList)
-                --ObjectCount;
-            filterPass = false;
-        }
-        else
-            filterPass = true;
+    if (key == m_MagKey && m_MagMask.size() == m_Objects.size())
+        return;
 
-        if (needRegion && filterPass)
-            filterPass = applyRegionFilter(data->skyComposite()->findByName(i18n("Uranus")), doBuildList);
-        if (olw->SelectByDate->isChecked() && filterPass)
-            applyObservableFilter(data->skyComposite()->findByName(i18n("Uranus")), doBuildList);
+    m_MagKey = key;
+    if (!byMagnitude)
+    {
+        m_MagMask = QBitArray(m_Objects.size(), true);
+        return;
+    }
 
-        if (maglimit < data->skyComposite()->findByName(i18n("Neptune"))->mag())
-        {
-            if (!doBuildList)
-                --ObjectCount;
-            filterPass = false;
-        }
-        else
-            filterPass = true;
-
-        if (needRegion && filterPass)
-            filterPass = applyRegionFilter(data->skyComposite()->findByName(i18n("Neptune")), doBuildList);
-        if (olw->SelectByDate->isChecked() && filterPass)
-            applyObservableFilter(data->skyComposite()->findByName(i18n("Neptune")), doBuildList);
-
-        //        if (maglimit < data->skyComposite()->findByName(i18nc("Asteroid name (optional)", "Pluto"))->mag())
-        //        {
-        //            if (!doBuildList)
-        //                --ObjectCount;
-        //            filterPass = false;
-        //        }
-        //        else
-        //            filterPass = true;
-
-        //        if (needRegion && filterPass)
-        //            filterPass = applyRegionFilter(data->skyComposite()->findByName(i18nc("Asteroid name (optional)", "Pluto")), doBuildList);
-        //        if (olw->SelectByDate->isChecked() && filterPass)
-        //            applyObservableFilter(data->skyComposite()->findByName(i18nc("Asteroid name (optional)", "Pluto")), doBuildList);
+    m_MagMask = QBitArray(m_Objects.size());
+    for (int i = 0; i < m_Mag.size(); ++i)
+    {
+        //Objects without magnitude are listed on request
+        if (m_Mag[i] > 90. ? noMag : m_Mag[i] <= maglimit)
+            m_MagMask.setBit(i);
     }
+}
 
-    //Deep sky objects
-    bool dso =
-        (isItemSelected(i18n("Open clusters"), olw->TypeList) ||
-         isItemSelected(i18n("Globular clusters"), olw->TypeList) ||
-         isItemSelected(i18n("Gaseous nebulae"), olw->TypeList) ||
-         isItemSelected(i18n("Planetary nebulae"), olw->TypeList) || isItemSelected(i18n("Galaxies"), olw->TypeList));
+void ObsListWizard::updateRegionFilter()
+{
+    QString key;
+    QSet<QString> constellations;
 
-    if (dso)
+    if (isItemSelected(i18n("by constellation"), olw->RegionList))
     {
-        //Don't need to do anything if we are just counting objects and not
-        //filtering by region or magnitude
-        if (needRegion || olw->SelectByMagnitude->isChecked() || olw->SelectByDate->isChecked())
-        {
-            foreach (DeepSkyObject *o, data->skyComposite()->deepSkyObjects())
-            {
-                //Skip unselected object types
-                bool typeSelected = false;
-                // if ( (o->type() == SkyObject::STAR || o->type() == SkyObject::CATALOG_STAR) &&
-                //       isItemSelected( i18n( "Stars" ), olw->TypeList ) )
-                // typeSelected = true;
-                switch (o->type())
-                {
-                    case SkyObject::OPEN_CLUSTER:
-                        if (isItemSelected(i18n("Open clusters"), olw->TypeList))
-                            typeSelected = true;
-                        break;
-
-                    case SkyObject::GLOBULAR_CLUSTER:
-                        if (isItemSelected(i18n("Globular clusters"), olw->TypeList))
-                            typeSelected = true;
-                        break;
-
-                    case SkyObject::GASEOUS_NEBULA:
-                    case SkyObject::SUPERNOVA_REMNANT:
-                        if (isItemSelected(i18n("Gaseous nebulae"), olw->TypeList))
-                            typeSelected = true;
-                        break;
-
-                    case SkyObject::PLANETARY_NEBULA:
-                        if (isItemSelected(i18n("Planetary nebulae"), olw->TypeList))
-                            typeSelected = true;
-                        break;
-                    case SkyObject::GALAXY:
-                        if (isItemSelected(i18n("Galaxies"), olw->TypeList))
-                            typeSelected = true;
-                        break;
-                }
+        foreach (QListWidgetItem *item, olw->ConstellationList->selectedItems())
+            constellations.insert(item->text().toLower());
 
-                if (!typeSelected)
-                    continue;
-
-                if (olw->SelectByMagnitude->isChecked())
-                {
-                    if (o->mag() > 90.)
-                    {
-                        if (olw->IncludeNoMag->isChecked())
-                        {
-                            if (needRegion)
-                                filterPass = applyRegionFilter(o, doBuildList);
-                            if (olw->SelectByDate->isChecked() && filterPass)
-                                applyObservableFilter(o, doBuildList);
-                        }
-                        else if (!doBuildList)
-                            --ObjectCount;
-                    }
-                    else
-                    {
-                        if (o->mag() <= maglimit)
-                        {
-                            if (needRegion)
-                                filterPass = applyRegionFilter(o, doBuildList);
-                            if (olw->SelectByDate->isChecked() && filterPass)
-                                applyObservableFilter(o, doBuildList);
-                        }
-                        else if (!doBuildList)
-                            --ObjectCount;
-                    }
-                }
-                else
-                {
-                    if (needRegion)
-                        filterPass = applyRegionFilter(o, doBuildList);
-                    if (olw->SelectByDate->isChecked() && filterPass)
-                        applyObservableFilter(o, doBuildList);
-                }
-            }
-        }
+        QStringList selected = constellations.values();
+        selected.sort();
+        key = "constellation " + selected.join(',');
     }
+    else if (isItemSelected(i18n("in a rectangular region"), olw->RegionList))
+        key = QString("rectangle %1 %2 %3 %4").arg(xRect1).arg(xRect2).arg(yRect1).arg(yRect2);
+    else if (isItemSelected(i18n("in a circular region"), olw->RegionList))
+        key = QString("circle %1 %2 %3").arg(pCirc.ra().Degrees()).arg(pCirc.dec().Degrees()).arg(rCirc);
+
+    if (key == m_RegionKey && m_RegionMask.size() == m_Objects.size())
+        return;
+
+    m_RegionKey = key;
 
-    //Comets
-    if (isItemSelected(i18n("Comets"), olw->TypeList))
+    //No region filter, all objects pass
+    if (key.isEmpty())
     {
-        foreach (SkyObject *o, data->skyComposite()->comets())
-        {
-            if (olw->SelectByMagnitude->isChecked())
-            {
-                if (o->mag() > 90.)
-                {
-                    if (olw->IncludeNoMag->isChecked())
-                    {
-                        if (needRegion)
-                            filterPass = applyRegionFilter(o, doBuildList);
-                        if (olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter(o, doBuildList);
-                    }
-                    else if (!doBuildList)
-                        --ObjectCount;
-                }
-                else
-                {
-                    if (o->mag() <= maglimit)
-                    {
-                        if (needRegion)
-                            filterPass = applyRegionFilter(o, doBuildList);
-                        if (olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter(o, doBuildList);
-                    }
-                    else if (!doBuildList)
-                        --ObjectCount;
-                }
-            }
-            else
-            {
-                if (needRegion)
-                    filterPass = applyRegionFilter(o, doBuildList);
-                if (olw->SelectByDate->isChecked() && filterPass)
-                    applyObservableFilter(o, doBuildList);
-            }
-        }
+        m_RegionMask = QBitArray(m_Objects.size(), true);
+        return;
     }
 
-    //Asteroids
-    if (isItemSelected(i18n("Asteroids"), olw->TypeList))
+    m_RegionMask = QBitArray(m_Objects.size());
+
+    //select by constellation
+    if (!constellations.isEmpty())
     {
-        foreach (SkyObject *o, data->skyComposite()->asteroids())
+        indexConstellations();
+        QBitArray selected(m_ConstellationNames.size());
+        for (int c = 0; c < m_ConstellationNames.size(); ++c)
+            selected.setBit(c, constellations.contains(m_ConstellationNames[c]));
+
+        for (int i = 0; i < m_Constellation.size(); ++i)
         {
-            if (olw->SelectByMagnitude->isChecked())
-            {
-                if (o->mag() > 90.)
-                {
-                    if (olw->IncludeNoMag->isChecked())
-                    {
-                        if (needRegion)
-                            filterPass = applyRegionFilter(o, doBuildList);
-                        if (olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter(o, doBuildList);
-                    }
-                    else if (!doBuildList)
-                        --ObjectCount;
-                }
-                else
-                {
-                    if (o->mag() <= maglimit)
-                    {
-                        if (needRegion)
-                            filterPass = applyRegionFilter(o, doBuildList);
-                        if (olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter(o, doBuildList);
-                    }
-                    else if (!doBuildList)
-                        --ObjectCount;
-                }
-            }
-            else
-            {
-                if (needRegion)
-                    filterPass = applyRegionFilter(o, doBuildList);
-                if (olw->SelectByDate->isChecked() && filterPass)
-                    applyObservableFilter(o, doBuildList);
-            }
+            if (selected.testBit(m_Constellation[i]))
+                m_RegionMask.setBit(i);
         }
     }
 
-    //Update the object count label
-    if (doBuildList)
-        ObjectCount = obsList().size();
-
-    olw->CountLabel->setText(i18np("Your observing list currently has 1 object",
-                                   "Your observing list currently has %1 objects", ObjectCount));
-}
-
-bool ObsListWizard::applyRegionFilter(SkyObject *o, bool doBuildList, bool doAdjustCount)
-{
-    //select by constellation
-    if (isItemSelected(i18n("by constellation"), olw->RegionList))
+    //select by rectangular region, only the objects in the declination range are checked
+    else if (key.startsWith("rectangle"))
     {
-        QString c = KStarsData::Instance()->skyComposite()->constellationBoundary()->constellationName(o);
-
-        if (isItemSelected(c, olw->ConstellationList))
+        QVector<int>::const_iterator it =
+            std::lower_bound(m_ByDec.constBegin(), m_ByDec.constEnd(), yRect1, [this](int i, double dec)
         {
-            if (doBuildList)
-                obsList().append(o);
+            return m_Dec[i] < dec;
+        });
 
-            return true;
-        }
-        else if (doAdjustCount)
+        for (; it != m_ByDec.constEnd() && m_Dec[*it] <= yRect2; ++it)
         {
-            --ObjectCount;
-            return false;
+            double ra = m_RA[*it];
+            if (xRect1 < 0.0 ? (ra >= xRect1 + 24.0 || ra <= xRect2) : (ra >= xRect1 && ra <= xRect2))
+                m_RegionMask.setBit(*it);
         }
-        else
-            return false;
     }
 
-    //select by rectangular region
-    else if (isItemSelected(i18n("in a rectangular region"), olw->RegionList))
+    //select by circular region, only the objects of the trixels covering it are checked
+    else if (key.startsWith("circle") && rCirc > 0.0)
     {
-        double ra      = o->ra().Hours();
-        double dec     = o->dec().Degrees();
-        bool addObject = false;
-        if (dec >= yRect1 && dec <= yRect2)
+        indexTrixels();
+        SkyMesh *mesh = SkyMesh::Instance();
+        if (mesh == nullptr || rCirc >= 90.0)
         {
-            if (xRect1 < 0.0)
-            {
-                addObject = ra >= xRect1 + 24.0 || ra <= xRect2;
-            }
-            else
-            {
-                addObject = ra >= xRect1 && ra <= xRect2;
-            }
+            for (int i = 0; i < m_Objects.size(); ++i)
+                m_RegionMask.setBit(i, m_Objects[i]->angularDistanceTo(&pCirc).Degrees() < rCirc);
+            return;
         }
 
-        if (addObject)
+        mesh->intersect(pCirc.ra().Degrees(), pCirc.dec().Degrees(), rCirc, (BufNum)OBJ_NEAREST_BUF);
+        MeshIterator region(mesh, OBJ_NEAREST_BUF);
+        while (region.hasNext())
         {
-            if (doBuildList)
-                obsList().append(o);
+            QHash<Trixel, QVector<int>>::const_iterator cell = m_ByTrixel.constFind(region.next());
+            if (cell == m_ByTrixel.constEnd())
+                continue;
 
-            return true;
+            foreach (int i, cell.value())
+            {
+                if (m_Objects[i]->angularDistanceTo(&pCirc).Degrees() < rCirc)
+                    m_RegionMask.setBit(i);
+            }
         }
+    }
+}
 
-        else
-        {
-            if (doAdjustCount)
-                --ObjectCount;
+void ObsListWizard::indexConstellations()
+{
+    if (m_Constellation.size() == m_Objects.size())
+        return;
 
-            return false;
-        }
-    }
+    ConstellationBoundaryLines *boundaries = KStarsData::Instance()->skyComposite()->constellationBoundary();
+    QHash<QString, int> ids;
 
-    //select by circular region
-    //make sure circ region data are valid
-    else if (isItemSelected(i18n("in a circular region"), olw->RegionList))
+    m_Constellation.resize(m_Objects.size());
+    for (int i = 0; i < m_Objects.size(); ++i)
     {
-        if (o->angularDistanceTo(&pCirc).Degrees() < rCirc)
-        {
-            if (doBuildList)
-                obsList().append(o);
-
-            return true;
-        }
-        else if (doAdjustCount)
+        QString name = boundaries->constellationName(m_Objects[i]).toLower();
+        QHash<QString, int>::const_iterator id = ids.constFind(name);
+        if (id == ids.constEnd())
         {
-            --ObjectCount;
-            return false;
+            id = ids.insert(name, m_ConstellationNames.size());
+            m_ConstellationNames.append(name);
         }
-        else
-            return false;
+        m_Constellation[i] = id.value();
     }
+}
 
-    //No region filter, just add the object
-    else if (doBuildList)
-    {
-        obsList().append(o);
-    }
+void ObsListWizard::indexTrixels()
+{
+    SkyMesh *mesh = SkyMesh::Instance();
+    if (mesh == nullptr || !m_ByTrixel.isEmpty())
+        return;
 
-    return true;
+    // Objects are indexed at their current coordinates, like those of the region
+    for (int i = 0; i < m_Objects.size(); ++i)
+        m_ByTrixel[mesh->HTMesh::index(m_RA[i] * 15.0, m_Dec[i])].append(i);
 }
 
-bool ObsListWizard::applyObservableFilter(SkyObject *o, bool doBuildList, bool doAdjustCount)
+void ObsListWizard::observingWindow(KStarsDateTime &from, KStarsDateTime &to)
 {
-    SkyPoint p = *o;
-
     //Check altitude of object every hour from 18:00 to midnight
-    //If it's ever above 15 degrees, flag it as visible
-    KStarsDateTime Evening(olw->Date->date(), QTime(18, 0, 0), Qt::LocalTime);
-    KStarsDateTime Midnight(olw->Date->date().addDays(1), QTime(0, 0, 0), Qt::LocalTime);
-    double minAlt = 15, maxAlt = 90;
+    from = KStarsDateTime(olw->Date->date(), QTime(18, 0, 0), Qt::LocalTime);
+    to   = KStarsDateTime(olw->Date->date().addDays(1), QTime(0, 0, 0), Qt::LocalTime);
 
     // Or use user-selected values, if they're valid
     if (olw->timeFrom->time().isValid() && olw->timeTo->time().isValid())
     {
-        Evening.setTime(olw->timeFrom->time());
-        Midnight.setTime(olw->timeTo->time());
+        from.setTime(olw->timeFrom->time());
+        to.setTime(olw->timeTo->time());
 
         // If time from < timeTo (e.g. 06:00 PM to 9:00 PM)
         // then we stay on the same day.
         if (olw->timeFrom->time() < olw->timeTo->time())
         {
-            Midnight.setDate(olw->Date->date());
+            to.setDate(olw->Date->date());
         }
         // Otherwise we advance by one day
         else
         {
-            Midnight.setDate(olw->Date->date().addDays(1));
+            to.setDate(olw->Date->date().addDays(1));
         }
     }
+}
 
-    minAlt = olw->minAlt->value();
-    maxAlt = olw->maxAlt->value();
-
-    // This is the "relaxed" search mode
-    // where if the object obeys the restrictions in 50% of the time of the range
-    // then it qualifies as "visible"
-    double totalCount = 0, visibleCount = 0;
-    for (KStarsDateTime t = Evening; t < Midnight; t = t.addSecs(3600.0))
+void ObsListWizard::updateObservableFilter()
+{
+    if (!olw->SelectByDate->isChecked())
     {
-        dms LST = geo->GSTtoLST(t.gst());
-        p.EquatorialToHorizontal(&LST, geo->lat());
-        totalCount++;
-        if (p.alt().Degrees() >= minAlt && p.alt().Degrees() <= maxAlt)
-            visibleCount++;
+        m_ObservableKey.clear();
+        m_ObservableMask = QBitArray(m_Objects.size(), true);
+        return;
     }
 
-    // If the object is within the min/max alt at least coverage % of the time range
-    // then consider it visible
-    if (visibleCount / totalCount >= olw->coverage->value() / 100.0)
-        return true;
-
-    if (doAdjustCount)
-        --ObjectCount;
-    if (doBuildList)
-        obsList().takeAt(obsList().indexOf(o));
-
-    return false;
-
-    // This is the strict mode where ANY object that does not meet the min & max
-    // altitude at ANY time would be removed from the list.
-#if 0
-    for (KStarsDateTime t = Evening; t < Midnight; t = t.addSecs(3600.0))
+    KStarsDateTime from, to;
+    observingWindow(from, to);
+    const double minAlt = olw->minAlt->value();
+    const double maxAlt = olw->maxAlt->value();
+
+    // The visible hours only change with the site and the night
+    QString hoursKey = QString("%1 %2 %3 %4 %5 %6")
+                       .arg(geo->lat()->Degrees())
+                       .arg(geo->lng()->Degrees())
+                       .arg(from.toString(Qt::ISODate))
+                       .arg(to.toString(Qt::ISODate))
+                       .arg(minAlt)
+                       .arg(maxAlt);
+
+    if (hoursKey != m_VisibleHoursKey || m_VisibleHours.size() != m_Objects.size())
     {
-        dms LST = geo->GSTtoLST(t.gst());
-        p.EquatorialToHorizontal(&LST, geo->lat());
-        if (p.alt().Degrees() < minAlt || p.alt().Degrees() > maxAlt)
+        m_VisibleHoursKey = hoursKey;
+
+        QVector<double> lst;
+        for (KStarsDateTime t = from; t < to; t = t.addSecs(3600.0))
+            lst.append(geo->GSTtoLST(t.gst()).Hours());
+        m_WindowHours = lst.size();
+
+        // sin(alt) = sin(lat) sin(dec) + cos(lat) cos(dec) cos(HA), so each band is within the
+        // altitude limits between two hour angles
+        const int bands = qRound(180.0 / BAND_DEGREES) + 1;
+        QVector<double> innerHA(bands), outerHA(bands);
+        double sinLat, cosLat;
+        geo->lat()->SinCos(sinLat, cosLat);
+        for (int b = 0; b < bands; ++b)
         {
-            if (doAdjustCount)
-                --ObjectCount;
-            if (doBuildList)
-                obsList().takeAt(obsList().indexOf(o));
-            return false;
+            double sinDec, cosDec;
+            dms(b * BAND_DEGREES - 90.0).SinCos(sinDec, cosDec);
+            outerHA[b] = hourAngleLimit(std::sin(minAlt * dms::DegToRad), sinLat * sinDec, cosLat * cosDec);
+            innerHA[b] = hourAngleLimit(std::sin(maxAlt * dms::DegToRad), sinLat * sinDec, cosLat * cosDec);
+        }
+
+        m_VisibleHours.resize(m_Objects.size());
+        for (int i = 0; i < m_Objects.size(); ++i)
+        {
+            const int b = qBound(0, qRound((m_Dec[i] + 90.0) / BAND_DEGREES), bands - 1);
+            quint8 hours = 0;
+            foreach (double t, lst)
+            {
+                double ha = std::fabs(std::remainder(t - m_RA[i], 24.0));
+                if (ha <= outerHA[b] && ha >= innerHA[b])
+                    ++hours;
+            }
+            m_VisibleHours[i] = hours;
         }
     }
-    return true;
-#endif
 
+    // This is the "relaxed" search mode
+    // where if the object obeys the restrictions in coverage % of the time of the range
+    // then it qualifies as "visible"
+    const double coverage = olw->coverage->value() / 100.0;
+    QString key           = QString("%1 %2").arg(hoursKey).arg(coverage);
+    if (key == m_ObservableKey && m_ObservableMask.size() == m_Objects.size())
+        return;
+
+    m_ObservableKey  = key;
+    m_ObservableMask = QBitArray(m_Objects.size());
+    if (m_WindowHours == 0)
+        return;
+
+    for (int i = 0; i < m_VisibleHours.size(); ++i)
+    {
+        if (m_VisibleHours[i] >= coverage * m_WindowHours)
+            m_ObservableMask.setBit(i);
+    }
 }
@@ -17,15 +17,20 @@
 #pragma once
 
 #include "ui_obslistwizard.h"
+#include "skycomponents/typedef.h"
 #include "skyobjects/skypoint.h"
 
+#include <QBitArray>
 #include <QDialog>
+#include <QHash>
+#include <QVector>
 
 class QListWidget;
 class QPushButton;
 
 class SkyObject;
 class GeoLocation;
+class KStarsDateTime;
 
 class ObsListWizardUI : public QFrame, public Ui::ObsListWizard
 {
@@ -39,6 +44,10 @@ class ObsListWizardUI : public QFrame, public Ui::ObsListWizard
  * @class ObsListWizard
  * @short Wizard for constructing observing lists
  *
+ * The candidate objects are kept in attribute columns (magnitude, position, category) with one
+ * bitmap per filter. Changing a filter only recomputes its bitmap, so the object count follows
+ * the user's input as it is typed.
+ *
  * @author Jason Harris
  */
 class ObsListWizard : public QDialog
@@ -70,12 +79,37 @@ class ObsListWizard : public QDialog
     void slotApplyFilters() { applyFilters(true); }
 
   private:
+    /** Object categories of the type list */
+    enum Category
+    {
+        STARS,
+        SOLAR_SYSTEM,
+        OPEN_CLUSTERS,
+        GLOBULAR_CLUSTERS,
+        GASEOUS_NEBULAE,
+        PLANETARY_NEBULAE,
+        GALAXIES,
+        COMETS,
+        ASTEROIDS,
+        CATEGORY_COUNT
+    };
+
     void initialize();
+    void addCandidate(SkyObject *o, Category category);
     void applyFilters(bool doBuildList);
 
-    /** @return true if the object passes the filter region constraints, false otherwise.*/
-    bool applyRegionFilter(SkyObject *o, bool doBuildList, bool doAdjustCount = true);
-    bool applyObservableFilter(SkyObject *o, bool doBuildList, bool doAdjustCount = true);
+    /** @short Filters are evaluated over all candidates, each only when its settings changed */
+    void updateTypeFilter();
+    void updateMagnitudeFilter();
+    void updateRegionFilter();
+    void updateObservableFilter();
+
+    /** @short Constellation and HTM cell columns, only built once a region filter needs them */
+    void indexConstellations();
+    void indexTrixels();
+
+    /** @short Set from and to to the local times of the observing window */
+    void observingWindow(KStarsDateTime &from, KStarsDateTime &to);
 
     /**
      * Convenience function for safely getting the selected state of a QListWidget item by name.
@@ -99,15 +133,27 @@ class ObsListWizard : public QDialog
     QList<SkyObject *> ObsList;
     ObsListWizardUI *olw { nullptr };
     uint ObjectCount { 0 };
-    uint StarCount { 0 };
-    uint PlanetCount { 0 };
-    uint CometCount { 0 };
-    uint AsteroidCount { 0 };
-    uint GalaxyCount { 0 };
-    uint OpenClusterCount { 0 };
-    uint GlobClusterCount { 0 };
-    uint GasNebCount { 0 };
-    uint PlanNebCount { 0 };
+
+    // Attribute columns of the candidate objects, in the order of the built list
+    QVector<SkyObject *> m_Objects;
+    QVector<double> m_Mag;
+    QVector<double> m_RA;
+    QVector<double> m_Dec;
+    QVector<quint8> m_Category;
+    QBitArray m_Categories[CATEGORY_COUNT];
+    // Candidates sorted by declination
+    QVector<int> m_ByDec;
+    QVector<int> m_Constellation;
+    QStringList m_ConstellationNames;
+    QHash<Trixel, QVector<int>> m_ByTrixel;
+    // Visible hours of each candidate in the observing window, and their count
+    QVector<quint8> m_VisibleHours;
+    int m_WindowHours { 0 };
+
+    // One bitmap per filter, and the settings it was computed with
+    QBitArray m_TypeMask, m_MagMask, m_RegionMask, m_ObservableMask;
+    QString m_TypeKey, m_MagKey, m_RegionKey, m_ObservableKey, m_VisibleHoursKey;
+
     double xRect1 { 0 };
     double xRect2 { 0 };
     double yRect1 { 0 };
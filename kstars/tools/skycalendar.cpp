@@ -18,6 +18,7 @@
 #include "skycalendar.h"
 
 #include "geolocation.h"
+#include "ksephemeriscache.h"
 #include "ksplanetbase.h"
 #include "kstarsdata.h"
 #include "dialogs/locationdialog.h"
@@ -80,10 +81,11 @@ SkyCalendar::SkyCalendar(QWidget *parent) : QDialog(parent)
     scUI->CalendarView->setHorizon();
 
     plotButtonText = scUI->CreateButton->text();
-    connect(scUI->CreateButton, &QPushButton::clicked, [this]()
+    connect(scUI->CreateButton, &QPushButton::clicked, this, &SkyCalendar::slotFillCalendar);
+    // The planets are plotted in the background once their positions are fitted
+    connect(&m_EphemerisWatcher, &QFutureWatcher<void>::finished, [this]()
     {
-        scUI->CreateButton->setText(i18n("Please Wait") + "...");
-        QtConcurrent::run(this, &SkyCalendar::slotFillCalendar);
+        QtConcurrent::run(this, &SkyCalendar::plotPlanets);
     });
 
     connect(scUI->LocationButton, SIGNAL(clicked()), this, SLOT(slotLocation()));
@@ -96,11 +98,35 @@ int SkyCalendar::year()
 
 void SkyCalendar::slotFillCalendar()
 {
+    scUI->CreateButton->setText(i18n("Please Wait") + "...");
     scUI->CreateButton->setEnabled(false);
 
     scUI->CalendarView->resetPlot();
     scUI->CalendarView->setHorizon();
 
+    // Rise and set times of a whole year evaluate the planets thousands of times, fit their positions once
+    QVector<KSEphemerisCache::Body> bodies;
+    bodies << KSEphemerisCache::EARTH;
+    if (scUI->checkBox_Mercury->isChecked())
+        bodies << KSEphemerisCache::MERCURY;
+    if (scUI->checkBox_Venus->isChecked())
+        bodies << KSEphemerisCache::VENUS;
+    if (scUI->checkBox_Mars->isChecked())
+        bodies << KSEphemerisCache::MARS;
+    if (scUI->checkBox_Jupiter->isChecked())
+        bodies << KSEphemerisCache::JUPITER;
+    if (scUI->checkBox_Saturn->isChecked())
+        bodies << KSEphemerisCache::SATURN;
+    if (scUI->checkBox_Uranus->isChecked())
+        bodies << KSEphemerisCache::URANUS;
+    if (scUI->checkBox_Neptune->isChecked())
+        bodies << KSEphemerisCache::NEPTUNE;
+    const KStarsDateTime yearStart(QDate(year(), 1, 1), QTime(0, 0, 0));
+    m_EphemerisWatcher.setFuture(KSEphemerisCache::Instance()->request(bodies, yearStart.djd() - 2, yearStart.djd() + 368));
+}
+
+void SkyCalendar::plotPlanets()
+{
     if (scUI->checkBox_Mercury->isChecked())
         addPlanetEvents(KSPlanetBase::MERCURY);
     if (scUI->checkBox_Venus->isChecked())
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <QDialog>
+#include <QFutureWatcher>
 #include <QMutex>
 
 #include "ui_skycalendar.h"
@@ -57,6 +58,8 @@ class SkyCalendar : public QDialog
     //void slotCalculating();
 
   private:
+    /** Plot the events of the selected planets, runs in the global thread pool. */
+    void plotPlanets();
     void addPlanetEvents(int nPlanet);
     void drawEventLabel(float x1, float y1, float x2, float y2, QString LabelText);
 
@@ -65,4 +68,6 @@ class SkyCalendar : public QDialog
     QMutex calculationMutex;
     QString plotButtonText;
     bool calculating { false };
+    // Fits the positions of the selected planets before they are plotted
+    QFutureWatcher<void> m_EphemerisWatcher;
 };
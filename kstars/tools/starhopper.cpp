@@ -24,6 +24,226 @@
 
 #include <kstars_debug.h>
 
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace
+{
+/**
+ * Static 3-d tree over the unit vectors of the stars of the search region. The median of each
+ * range is stored in its middle, so no pointers are needed.
+ */
+class StarIndex
+{
+  public:
+    explicit StarIndex(const QList<StarObject *> &stars)
+    {
+        m_Points.reserve(stars.size());
+        for (const StarObject *star : stars)
+        {
+            Point point;
+            toVector(*star, point.v);
+            point.star = star;
+            m_Points.push_back(point);
+        }
+        build(0, m_Points.size(), 0);
+    }
+
+    int size() const { return m_Points.size(); }
+
+    const StarObject *star(int i) const { return m_Points[i].star; }
+
+    const double *vector(int i) const { return m_Points[i].v; }
+
+    /** @short Append the indexes of the stars within radius degrees of v to result */
+    void query(const double v[3], double radius, QVector<int> &result) const
+    {
+        const double chord = 2.0 * std::sin(std::min(radius, 180.0) * dms::DegToRad / 2.0);
+        query(0, m_Points.size(), 0, v, chord * chord, result);
+    }
+
+    static void toVector(const SkyPoint &p, double v[3])
+    {
+        double sinRA, cosRA, sinDec, cosDec;
+        p.ra().SinCos(sinRA, cosRA);
+        p.dec().SinCos(sinDec, cosDec);
+        v[0] = cosDec * cosRA;
+        v[1] = cosDec * sinRA;
+        v[2] = sinDec;
+    }
+
+  private:
+    struct Point
+    {
+        double v[3];
+        const StarObject *star;
+    };
+
+    void build(int begin, int end, int axis)
+    {
+        if (end - begin < 2)
+            return;
+
+        const int middle = (begin + end) / 2;
+        std::nth_element(m_Points.begin() + begin, m_Points.begin() + middle, m_Points.begin() + end,
+                         [axis](const Point & a, const Point & b)
+        {
+            return a.v[axis] < b.v[axis];
+        });
+        build(begin, middle, (axis + 1) % 3);
+        build(middle + 1, end, (axis + 1) % 3);
+    }
+
+    void query(int begin, int end, int axis, const double v[3], double chord2, QVector<int> &result) const
+    {
+        if (begin >= end)
+            return;
+
+        const int middle = (begin + end) / 2;
+        const Point &p   = m_Points[middle];
+        const double dx = p.v[0] - v[0], dy = p.v[1] - v[1], dz = p.v[2] - v[2];
+        if (dx * dx + dy * dy + dz * dz <= chord2)
+            result.append(middle);
+
+        const double split = v[axis] - p.v[axis];
+        const int next     = (axis + 1) % 3;
+        if (split < 0 || split * split <= chord2)
+            query(begin, middle, next, v, chord2, result);
+        if (split >= 0 || split * split <= chord2)
+            query(middle + 1, end, next, v, chord2, result);
+    }
+
+    QVector<Point> m_Points;
+};
+
+double angularDistance(const double a[3], const double b[3])
+{
+    double dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    return std::acos(std::max(-1.0, std::min(1.0, dot))) / dms::DegToRad;
+}
+
+/**
+ * The part of the cost of a hop which only depends on the star hopped to: its brightness, its
+ * colour, and how easy it is to recognize. This is a very heuristic method.
+ */
+double starCost(const StarIndex &index, int i, float fov, float maglim, QString &patternName)
+{
+    const StarObject *nextstar = index.star(i);
+    QVector<int> localNeighbors;
+
+    // Test 1: How bright is the star?
+    // The brighter, the better. FIXME: 8.0 is now an arbitrary reference to the average faint star.
+    // Should actually depend on FOV, something like log( FOV ).
+    double magcost = nextstar->mag() - 7.0 + 5 * log10(fov);
+
+    // Test 2: Is the star strikingly red / yellow coloured?
+    QString SpType  = nextstar->sptype();
+    char spclass    = SpType.isEmpty() ? 0 : SpType.at(0).toLatin1();
+    double speccost = (spclass == 'G' || spclass == 'K' || spclass == 'M') ? -0.3 : 0;
+
+    // Test 6: Is the destination an asterism? Are there bright stars clustered nearby?
+    index.query(index.vector(i), fov / 10, localNeighbors);
+    int density = 0;
+    for (int j : localNeighbors)
+    {
+        if (index.star(j)->mag() <= maglim + 1.0)
+            ++density;
+    }
+    double stardensitycost = 1 - density; // -1 "magnitude" for every neighbouring star
+
+    // Test 7: Identify star patterns
+
+#define RIGHT_ANGLE_THRESHOLD 0.05
+#define EQUAL_EDGE_THRESHOLD  0.025
+
+    double patterncost = 0;
+    QList<const StarObject *> similar;
+    float factor = 1.0;
+    while (factor <= 10.0)
+    {
+        // Use a larger aperture for pattern identification; max 1.0 mag difference
+        localNeighbors.clear();
+        similar.clear();
+        index.query(index.vector(i), fov / factor, localNeighbors);
+        for (int j : localNeighbors)
+        {
+            const StarObject *star = index.star(j);
+            if (star != nextstar && fabs(star->mag() - nextstar->mag()) <= 1.0)
+                similar.append(star);
+        } // Now, we should have a pruned list
+        factor += 1.0;
+        if (similar.size() == 2)
+            break;
+    }
+    factor -= 1.0;
+    if (similar.size() == 2)
+    {
+        patternName = i18n("triangle (of similar magnitudes)"); // any three stars form a triangle!
+        // Try to find triangles. Note that we assume that the standard Euclidian metric works on a sphere for small angles, i.e. the celestial sphere is nearly flat over our FOV.
+        const StarObject *star1 = similar[0];
+        double dRA1             = nextstar->ra().radians() - star1->ra().radians();
+        double dDec1            = nextstar->dec().radians() - star1->dec().radians();
+        double dist1sqr         = dRA1 * dRA1 + dDec1 * dDec1;
+
+        const StarObject *star2 = similar[1];
+        double dRA2             = nextstar->ra().radians() - star2->ra().radians();
+        double dDec2            = nextstar->dec().radians() - star2->dec().radians();
+        double dist2sqr         = dRA2 * dRA2 + dDec2 * dDec2;
+
+        // Check for right-angled triangles (without loss of generality, right angle is at this vertex)
+        if (fabs((dRA1 * dRA2 - dDec1 * dDec2) / sqrt(dist1sqr * dist2sqr)) < RIGHT_ANGLE_THRESHOLD)
+        {
+            // We have a right angled triangle! Give -3 magnitudes!
+            patterncost += -3;
+            patternName = i18n("right-angled triangle");
+        }
+
+        // Check for isosceles triangles (without loss of generality, this is the vertex)
+        if (fabs((dist1sqr - dist2sqr) / (dist1sqr)) < EQUAL_EDGE_THRESHOLD)
+        {
+            patterncost += -1;
+            patternName = i18n("isosceles triangle");
+            if (fabs((dRA2 * dDec1 - dRA1 * dDec2) / sqrt(dist1sqr * dist2sqr)) < RIGHT_ANGLE_THRESHOLD)
+            {
+                patterncost += -1;
+                patternName = i18n("straight line of 3 stars");
+            }
+            // Check for equilateral triangles
+            double dist3    = star1->angularDistanceTo(star2).radians();
+            double dist3sqr = dist3 * dist3;
+            if (fabs((dist3sqr - dist1sqr) / dist1sqr) < EQUAL_EDGE_THRESHOLD)
+            {
+                patterncost += -1;
+                patternName = i18n("equilateral triangle");
+            }
+        }
+    }
+    // TODO: Identify squares.
+    if (!patternName.isEmpty())
+        patternName += i18n(" within %1% of FOV of the marked star", (int)(100.0 / factor));
+
+    qCDebug(KSTARS) << "Mag cost: " << magcost << "; Spec Cost: " << speccost << "; Density cost: " << stardensitycost
+                    << "; Pattern cost: " << patterncost << "; Pattern: " << patternName;
+
+    return magcost + speccost + stardensitycost + patterncost;
+}
+
+/** A node of the search: the start point, or one of the stars of the index */
+struct Node
+{
+    double g { std::numeric_limits<double>::infinity() };
+    double h { 0 };
+    // Cost of hopping to the star, not computed yet if NaN
+    double starCost { std::numeric_limits<double>::quiet_NaN() };
+    int cameFrom { -1 };
+    bool closed { false };
+};
+}
+
 QList<StarObject *> *StarHopper::computePath(const SkyPoint &src, const SkyPoint &dest, float fov__, float maglim__,
                                              QStringList *metadata_)
 {
@@ -44,51 +264,62 @@ QList<const StarObject *> StarHopper::computePath_const(const SkyPoint &src, con
     start  = &src;
     end    = &dest;
 
-    came_from.clear();
     result_path.clear();
 
-    // Implements the A* search algorithm
-
-    QList<SkyPoint const *> cSet;
-    QList<SkyPoint const *> oSet;
-    QHash<SkyPoint const *, double> g_score;
-    QHash<SkyPoint const *, double> f_score;
-    QHash<SkyPoint const *, double> h_score;
-
+    const double distance = src.angularDistanceTo(&dest).Degrees();
     qCDebug(KSTARS) << "StarHopper is trying to compute a path from source: " << src.ra().toHMSString()
-             << src.dec().toDMSString() << " to destination: " << dest.ra().toHMSString() << dest.dec().toDMSString()
-             << "; a starhop of " << src.angularDistanceTo(&dest).Degrees() << " degrees!";
+                    << src.dec().toDMSString() << " to destination: " << dest.ra().toHMSString() << dest.dec().toDMSString()
+                    << "; a starhop of " << distance << " degrees!";
+
+    // Nodes further than 1.2 times the starting distance from the destination are not expanded,
+    // so every star the search can consider is within this radius. Patterns are looked for up to
+    // a field of view around the stars. Fetch them all at once, at the fainter limit used for the
+    // star density, with a margin for the precession of the region center.
+    SkyPoint center = dest;
+    center.catalogueCoord(KStarsData::Instance()->updateNum()->julianDay());
+    QList<StarObject *> stars;
+    StarComponent::Instance()->starsInAperture(stars, center, distance * 1.2 + 2 * fov + 1.0, maglim + 1.0);
+    std::sort(stars.begin(), stars.end());
+    stars.erase(std::unique(stars.begin(), stars.end()), stars.end());
+
+    StarIndex index(stars);
+    qCDebug(KSTARS) << "Search region has " << index.size() << " stars";
+
+    double destVector[3], srcVector[3];
+    StarIndex::toVector(dest, destVector);
+    StarIndex::toVector(src, srcVector);
+
+    // Implements the A* search algorithm, node 0 is the start and node i + 1 the star i of the index
+    QVector<Node> nodes(index.size() + 1);
+    auto vectorOf = [&](int node) -> const double *
+    {
+        return node == 0 ? srcVector : index.vector(node - 1);
+    };
+
+    // The open set is a binary heap, outdated entries are skipped when they come up
+    typedef std::pair<double, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> oSet;
 
-    oSet.append(&src);
-    g_score[&src] = 0;
-    h_score[&src] = src.angularDistanceTo(&dest).Degrees() / fov;
-    f_score[&src] = h_score[&src];
+    nodes[0].g = 0;
+    nodes[0].h = distance / fov;
+    oSet.push(Entry(nodes[0].h, 0));
 
-    while (!oSet.isEmpty())
+    QVector<int> neighbors;
+    while (!oSet.empty())
     {
-        qCDebug(KSTARS) << "Next step";
         // Find the node with the lowest f_score value
-        SkyPoint const *curr_node = nullptr;
-        double lowfscore          = 1.0e8;
-
-        foreach (const SkyPoint *sp, oSet)
-        {
-            if (f_score[sp] < lowfscore)
-            {
-                lowfscore = f_score[sp];
-                curr_node = sp;
-            }
-        }
-        if (curr_node == nullptr)
+        const Entry top = oSet.top();
+        oSet.pop();
+        const int curr_node = top.second;
+        Node &curr          = nodes[curr_node];
+        if (curr.closed || top.first > curr.g + curr.h)
             continue;
 
-        qCDebug(KSTARS) << "Lowest fscore (vertex distance-plus-cost score) is " << lowfscore
-                 << " with coords: " << curr_node->ra().toHMSString() << curr_node->dec().toDMSString()
-                 << ". Considering this node now.";
-        if (curr_node == &dest || (curr_node != &src && h_score[curr_node] < 0.5))
+        if (curr_node != 0 && curr.h < 0.5)
         {
             // We are at destination
-            reconstructPath(came_from[curr_node]);
+            for (int node = curr.cameFrom; node > 0; node = nodes[node].cameFrom)
+                result_path.prepend(index.star(node - 1));
             qCDebug(KSTARS) << "We've arrived at the destination! Yay! Result path count: " << result_path.count();
 
             // Just a test -- try to print out useful instructions to the debug console. Once we make star hopper unexperimental, we should move this to some sort of a display
@@ -119,7 +350,7 @@ QList<const StarObject *> StarHopper::computePath_const(const SkyPoint &src, con
                     else
                     {
                         starHopDirections = i18n(" Slew %1 degrees %2 to find a(n) %3", QString::number(angDist.Degrees(), 'f', 2), direction,
-                                                     patternNames.value(hopStar));
+                                                 patternNames.value(hopStar));
                         qCDebug(KSTARS) << starHopDirections;
                     }
                     metadata->append(starHopDirections);
@@ -132,232 +363,53 @@ QList<const StarObject *> StarHopper::computePath_const(const SkyPoint &src, con
             return result_path;
         }
 
-        oSet.removeOne(curr_node);
-        cSet.append(curr_node);
+        curr.closed = true;
 
         // FIXME: Make sense. If current node ---> dest distance is
         // larger than src --> dest distance by more than 20%, don't
         // even bother considering it.
-
-        if (h_score[curr_node] > h_score[&src] * 1.2)
-        {
-            qCDebug(KSTARS) << "Node under consideration has larger distance to destination (h-score) than start node! "
-                        "Ignoring it.";
+        if (curr.h > nodes[0].h * 1.2)
             continue;
-        }
 
         // Get the list of stars that are neighbours of this node
-        QList<StarObject *> neighbors;
-
-        // FIXME: Actually, this should be done in
-        // HorizontalToEquatorial, but we do it here because SkyPoint
-        // needs a lot of fixing to handle unprecessed and precessed,
-        // equatorial and horizontal coordinates nicely
-        SkyPoint *CurrentNode = const_cast<SkyPoint *>(curr_node);
-        //CurrentNode->deprecess(KStarsData::Instance()->updateNum());
-        CurrentNode->catalogueCoord(KStarsData::Instance()->updateNum()->julianDay());
-        //qCDebug(KSTARS) << "Calling starsInAperture";
-        StarComponent::Instance()->starsInAperture(neighbors, *curr_node, fov, maglim);
-        qCDebug(KSTARS) << "Choosing next node from a set of " << neighbors.count();
-        // Look for the potential next node
-        double curr_g_score = g_score[curr_node];
-
-        for (auto &nhd_node : neighbors)
+        neighbors.clear();
+        index.query(vectorOf(curr_node), fov, neighbors);
+
+        for (int star : neighbors)
         {
-            if (cSet.contains(nhd_node))
+            if (index.star(star)->mag() > maglim)
                 continue;
 
-            // Compute the tentative g_score
-            double tentative_g_score = curr_g_score + cost(curr_node, nhd_node);
-            bool tentative_better;
-            if (!oSet.contains(nhd_node))
-            {
-                oSet.append(nhd_node);
-                tentative_better = true;
-            }
-            else if (tentative_g_score < g_score[nhd_node])
-                tentative_better = true;
-            else
-                tentative_better = false;
+            const int nhd_node = star + 1;
+            Node &nhd          = nodes[nhd_node];
+            if (nhd.closed)
+                continue;
 
-            if (tentative_better)
+            // The cost of a star is computed once, whichever node it is reached from
+            if (std::isnan(nhd.starCost))
             {
-                came_from[nhd_node] = curr_node;
-                g_score[nhd_node]   = tentative_g_score;
-                h_score[nhd_node]   = nhd_node->angularDistanceTo(&dest).Degrees() / fov;
-                f_score[nhd_node]   = g_score[nhd_node] + h_score[nhd_node];
+                QString patternName;
+                nhd.starCost = starCost(index, star, fov, maglim, patternName);
+                if (!patternName.isEmpty())
+                    patternNames.insert(index.star(star), patternName);
             }
-        }
-    }
-    qCDebug(KSTARS) << "REGRET! Returning empty list!";
-    return QList<StarObject const *>(); // Return an empty QList
-}
-
-void StarHopper::reconstructPath(SkyPoint const *curr_node)
-{
-    if (curr_node != start)
-    {
-        StarObject const *s = dynamic_cast<StarObject const *>(curr_node);
-        Q_ASSERT(s);
-        result_path.prepend(s);
-        reconstructPath(came_from[s]);
-    }
-}
-
-float StarHopper::cost(const SkyPoint *curr, const SkyPoint *next)
-{
-    // This is a very heuristic method, that tries to produce a cost
-    // for each hop.
-
-    float netcost = 0;
-
-    // Convert 'next' into a StarObject
-    if (next == start)
-    {
-        // If the next hop is back to square one, junk it
-        return 1e8;
-    }
-    bool isThisTheEnd = (next == end);
-
-    float magcost, speccost;
-    magcost = speccost = 0;
-
-    if (!isThisTheEnd)
-    {
-        // We ought to be dealing with a star
-        StarObject const *nextstar = dynamic_cast<StarObject const *>(next);
-        Q_ASSERT(nextstar);
-
-        // Test 1: How bright is the star?
-        magcost =
-            nextstar->mag() - 7.0 +
-            5 * log10(
-                    fov); // The brighter, the better. FIXME: 8.0 is now an arbitrary reference to the average faint star. Should actually depend on FOV, something like log( FOV ).
-
-        // Test 2: Is the star strikingly red / yellow coloured?
-        QString SpType = nextstar->sptype();
-        char spclass   = SpType.at(0).toLatin1();
-        speccost       = (spclass == 'G' || spclass == 'K' || spclass == 'M') ? -0.3 : 0;
-        /*
-        // Test 3: Is the star in the general direction of the object?
-        // We use the cosine rule to find the angle between the hop direction, and the direction to destination
-        // a = side joining curr to end
-        // b = side joining curr to next
-        // c = side joining next to end
-        // C = angle between curr-next and curr-end
-        double sina, sinb, cosa, cosb;
-        curr->angularDistanceTo(dest).SinCos( &sina, &cosa );
-        curr->angularDistanceTo(next).SinCos( &sinb, &cosb );
-        double cosc = cos(next->angularDistanceTo(end).radians());
-        double cosC = ( cosc - cosa * cosb ) / (sina * sinb);
-        float dircost;
-        if( cosC < 0 ) // Wrong direction!
-        dircost = 1e8; // Some humongous number;
-        else
-        dircost = sqrt( 1 - cosC * cosC ) / cosC; // tan( C )
-        */
-    }
-
-    // Test 4: How far is the hop?
-    double distcost =
-        (curr->angularDistanceTo(next).Degrees() /
-         fov); // 1 "magnitude" incremental cost for 1 FOV. Is this even required, or is it just equivalent to halving our distance unit? I think it is required since the hop is not necessarily in the direction of the object -- asimha
-
-    // Test 5: How effective is the hop? [Might not be required with A*]
-    //    double distredcost = -((src->angularDistanceTo( dest ).Degrees() - next->angularDistanceTo( dest ).Degrees()) * 60 / fov)*3; // 3 "magnitudes" for 1 FOV closer
-
-    // Test 6: Is the destination an asterism? Are there bright stars clustered nearby?
-    QList<StarObject *> localNeighbors;
-    StarComponent::Instance()->starsInAperture(localNeighbors, *next, fov / 10, maglim + 1.0);
-    double stardensitycost = 1 - localNeighbors.count(); // -1 "magnitude" for every neighbouring star
 
-// Test 7: Identify star patterns
+            // Test 4: How far is the hop? 1 "magnitude" incremental cost for 1 FOV.
+            double netcost = nhd.starCost + angularDistance(vectorOf(curr_node), vectorOf(nhd_node)) / fov;
+            if (netcost < 0)
+                netcost = 0.1; // FIXME: Heuristics aren't supposed to be entirely random. This one is.
 
-#define RIGHT_ANGLE_THRESHOLD 0.05
-#define EQUAL_EDGE_THRESHOLD  0.025
-
-    double patterncost = 0;
-    QString patternName;
-    if (!isThisTheEnd)
-    {
-        // We ought to be dealing with a star
-        StarObject const *nextstar = dynamic_cast<StarObject const *>(next);
-        Q_ASSERT(nextstar);
-
-        float factor = 1.0;
-        while (factor <= 10.0)
-        {
-            localNeighbors.clear();
-            StarComponent::Instance()->starsInAperture(
-                localNeighbors, *next, fov / factor,
-                nextstar->mag() + 1.0); // Use a larger aperture for pattern identification; max 1.0 mag difference
-            foreach (StarObject *star, localNeighbors)
-            {
-                if (star == nextstar)
-                    localNeighbors.removeOne(star);
-                else if (fabs(star->mag() - nextstar->mag()) > 1.0)
-                    localNeighbors.removeOne(star);
-            } // Now, we should have a pruned list
-            factor += 1.0;
-            if (localNeighbors.size() == 2)
-                break;
-        }
-        factor -= 1.0;
-        if (localNeighbors.size() == 2)
-        {
-            patternName = i18n("triangle (of similar magnitudes)"); // any three stars form a triangle!
-            // Try to find triangles. Note that we assume that the standard Euclidian metric works on a sphere for small angles, i.e. the celestial sphere is nearly flat over our FOV.
-            StarObject *star1 = localNeighbors[0];
-            double dRA1       = nextstar->ra().radians() - star1->ra().radians();
-            double dDec1      = nextstar->dec().radians() - star1->dec().radians();
-            double dist1sqr   = dRA1 * dRA1 + dDec1 * dDec1;
-
-            StarObject *star2 = localNeighbors[1];
-            double dRA2       = nextstar->ra().radians() - star2->ra().radians();
-            double dDec2      = nextstar->dec().radians() - star2->dec().radians();
-            double dist2sqr   = dRA2 * dRA2 + dDec2 * dDec2;
-
-            // Check for right-angled triangles (without loss of generality, right angle is at this vertex)
-            if (fabs((dRA1 * dRA2 - dDec1 * dDec2) / sqrt(dist1sqr * dist2sqr)) < RIGHT_ANGLE_THRESHOLD)
-            {
-                // We have a right angled triangle! Give -3 magnitudes!
-                patterncost += -3;
-                patternName = i18n("right-angled triangle");
-            }
-
-            // Check for isosceles triangles (without loss of generality, this is the vertex)
-            if (fabs((dist1sqr - dist2sqr) / (dist1sqr)) < EQUAL_EDGE_THRESHOLD)
+            // Compute the tentative g_score
+            double tentative_g_score = nodes[curr_node].g + netcost;
+            if (tentative_g_score < nhd.g)
             {
-                patterncost += -1;
-                patternName = i18n("isosceles triangle");
-                if (fabs((dRA2 * dDec1 - dRA1 * dDec2) / sqrt(dist1sqr * dist2sqr)) < RIGHT_ANGLE_THRESHOLD)
-                {
-                    patterncost += -1;
-                    patternName = i18n("straight line of 3 stars");
-                }
-                // Check for equilateral triangles
-                double dist3    = star1->angularDistanceTo(star2).radians();
-                double dist3sqr = dist3 * dist3;
-                if (fabs((dist3sqr - dist1sqr) / dist1sqr) < EQUAL_EDGE_THRESHOLD)
-                {
-                    patterncost += -1;
-                    patternName = i18n("equilateral triangle");
-                }
+                nhd.cameFrom = curr_node;
+                nhd.g        = tentative_g_score;
+                nhd.h        = angularDistance(vectorOf(nhd_node), destVector) / fov;
+                oSet.push(Entry(nhd.g + nhd.h, nhd_node));
             }
         }
-        // TODO: Identify squares.
-        if (!patternName.isEmpty())
-        {
-            patternName += i18n(" within %1% of FOV of the marked star", (int)(100.0 / factor));
-            patternNames.insert(nextstar, patternName);
-        }
     }
-
-    netcost = magcost + speccost + distcost + stardensitycost + patterncost;
-    if (netcost < 0)
-        netcost = 0.1; // FIXME: Heuristics aren't supposed to be entirely random. This one is.
-    qCDebug(KSTARS) << "Mag cost: " << magcost << "; Spec Cost: " << speccost << "; Dist Cost: " << distcost
-             << "; Density cost: " << stardensitycost << "; Pattern cost: " << patterncost << "; Net cost: " << netcost
-             << "; Pattern: " << patternName;
-    return netcost;
+    qCDebug(KSTARS) << "REGRET! Returning empty list!";
+    return QList<StarObject const *>(); // Return an empty QList
 }
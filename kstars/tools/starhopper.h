@@ -29,6 +29,9 @@ class StarObject;
  * @class StarHopper
  * @short Helps planning star hopping
  *
+ * The stars of the search region are fetched once and kept in a 3-d tree, which answers the
+ * neighbour queries of the A* search. The open set is a binary heap.
+ *
  * @version 1.0
  * @author Akarsh Simha
  */
@@ -54,29 +57,12 @@ class StarHopper
                                                 QStringList *metadata = nullptr);
 
   private:
-    /**
-     * @short The cost function for hopping from current position to the a given star, in view of the final destination
-     * @param curr Source SkyPoint
-     * @param next Next point in the hop.
-     * @note If 'next' is neither the starting point of the hop, nor
-     * the ending point, it _has_ to be a StarObject. A dynamic cast
-     * followed by a Q_ASSERT will ensure this.
-     */
-    float cost(const SkyPoint *curr, const SkyPoint *next);
-
-    /**
-     * @short For internal use by the A* Search Algorithm. Completes
-     * the star-hop path. See https://en.wikipedia.org/wiki/A*_search_algorithm for details
-     */
-    void reconstructPath(SkyPoint const *curr_node);
-
     float fov { 0 };
     float maglim { 0 };
     QString starHopDirections;
     // Useful for internal computations
     SkyPoint const *start { nullptr };
     SkyPoint const *end { nullptr };
-    QHash<const SkyPoint *, const SkyPoint *> came_from; // Used by the A* search algorithm
     QList<StarObject const *> result_path;
     QHash<SkyPoint const *, QString> patternNames; // if patterns were identified, they are added to this hash.
 };
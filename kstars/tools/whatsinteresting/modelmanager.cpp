@@ -18,6 +18,7 @@
 #include "modelmanager.h"
 
 #include "ksfilereader.h"
+#include "ksnumbers.h"
 #include "kstars.h"
 #include "kstarsdata.h"
 #include "obsconditions.h"
@@ -26,8 +27,21 @@
 #include "skyobjlistmodel.h"
 #include "starobject.h"
 
+#include <QFutureWatcher>
+#include <QTimer>
 #include <QtConcurrent>
 
+#include <algorithm>
+
+namespace
+{
+// Number of items added to a model before control returns to the event loop
+const int MODEL_CHUNK_SIZE = 200;
+
+// Objects lower than this are not visible
+const double HORIZON_DEGREES = 6.0;
+}
+
 ModelManager::ModelManager(ObsConditions *obs)
 {
     m_ObsConditions = obs;
@@ -35,17 +49,14 @@ ModelManager::ModelManager(ObsConditions *obs)
     tempModel = new SkyObjListModel();
 
     m_ModelList  = QList<SkyObjListModel *>();
-    m_ObjectList = QList<QList<SkyObjItem *>>();
-
-    favoriteClusters = QList<SkyObjItem *>();
-    favoriteNebulas  = QList<SkyObjItem *>();
-    favoriteGalaxies = QList<SkyObjItem *>();
+    m_ObjectList = QList<ObjectList>();
 
     for (int i = 0; i < NumberOfLists; i++)
     {
         m_ModelList.append(new SkyObjListModel());
-        m_ObjectList.append(QList<SkyObjItem *>());
+        m_ObjectList.append(ObjectList());
     }
+    m_Generation.fill(0, NumberOfLists);
 
     QtConcurrent::run(this, &ModelManager::loadLists);
 }
@@ -53,8 +64,7 @@ ModelManager::ModelManager(ObsConditions *obs)
 ModelManager::~ModelManager()
 {
     qDeleteAll(m_ModelList);
-    foreach (QList<SkyObjItem *> list, m_ObjectList)
-        qDeleteAll(list);
+    qDeleteAll(m_Items);
     delete tempModel;
 }
 
@@ -71,20 +81,11 @@ void ModelManager::loadLists()
     {
         QPair<QString, const SkyObject *> pair = listStars.value(i);
         const StarObject *star                 = dynamic_cast<const StarObject *>(pair.second);
-        if (star->hasLatinName())
-            m_ObjectList[Stars].append(new SkyObjItem((SkyObject *)(star)));
-    }
-    QString prevName;
-    for (int i = 0; i < m_ObjectList[Stars].size(); i++)
-    {
-        SkyObjItem *star = m_ObjectList[Stars].at(i);
-        if (prevName == star->getName())
-        {
-            m_ObjectList[Stars].removeAt(i);
-            i--;
-        }
-        prevName = star->getName();
+        if (star != nullptr && star->hasLatinName())
+            m_ObjectList[Stars].objects.append(const_cast<StarObject *>(star));
     }
+    sortUnique(m_ObjectList[Stars].objects);
+    indexDirections(m_ObjectList[Stars]);
 
     KSFileReader fileReader;
     if (!fileReader.open("Interesting.dat"))
@@ -109,19 +110,22 @@ void ModelManager::loadLists()
                 case SkyObject::OPEN_CLUSTER:
                 case SkyObject::GLOBULAR_CLUSTER:
                 case SkyObject::GALAXY_CLUSTER:
-                    favoriteClusters.append(new SkyObjItem(o));
+                    favoriteClusters.objects.append(o);
                     break;
                 case SkyObject::PLANETARY_NEBULA:
                 case SkyObject::DARK_NEBULA:
                 case SkyObject::GASEOUS_NEBULA:
-                    favoriteNebulas.append(new SkyObjItem(o));
+                    favoriteNebulas.objects.append(o);
                     break;
                 case SkyObject::GALAXY:
-                    favoriteGalaxies.append(new SkyObjItem(o));
+                    favoriteGalaxies.objects.append(o);
                     break;
             }
         }
     }
+    indexDirections(favoriteClusters);
+    indexDirections(favoriteNebulas);
+    indexDirections(favoriteGalaxies);
 
     emit loadProgressUpdated(0.20);
 
@@ -156,8 +160,9 @@ void ModelManager::loadLists()
     {
         SkyObject *o;
         if ((o = data->skyComposite()->findByName("M " + QString::number(i))))
-            m_ObjectList[Messier].append(new SkyObjItem(o));
+            m_ObjectList[Messier].objects.append(o);
     }
+    indexDirections(m_ObjectList[Messier]);
 
     emit loadProgressUpdated(1);
 }
@@ -173,9 +178,11 @@ void ModelManager::loadNGCCatalog()
                 emit loadProgressUpdated((double)i / 7840.0);
             SkyObject *o;
             if ((o = data->skyComposite()->findByName("NGC " + QString::number(i))))
-                m_ObjectList[NGC].append(new SkyObjItem(o));
+                m_ObjectList[NGC].objects.append(o);
         }
-        updateModel(m_ObsConditions, "ngc");
+        indexDirections(m_ObjectList[NGC]);
+        // This runs on a worker thread, the model is updated on the GUI thread
+        QMetaObject::invokeMethod(this, "refreshModel", Qt::QueuedConnection, Q_ARG(QString, "ngc"));
         emit loadProgressUpdated(1);
     }
     ngcLoaded = true;
@@ -192,9 +199,10 @@ void ModelManager::loadICCatalog()
                 emit loadProgressUpdated((double)i / 3866.0);
             SkyObject *o;
             if ((o = data->skyComposite()->findByName("IC " + QString::number(i))))
-                m_ObjectList[IC].append(new SkyObjItem(o));
+                m_ObjectList[IC].objects.append(o);
         }
-        updateModel(m_ObsConditions, "ic");
+        indexDirections(m_ObjectList[IC]);
+        QMetaObject::invokeMethod(this, "refreshModel", Qt::QueuedConnection, Q_ARG(QString, "ic"));
         emit loadProgressUpdated(1);
     }
     icLoaded = true;
@@ -211,9 +219,10 @@ void ModelManager::loadSharplessCatalog()
                 emit loadProgressUpdated((double)i / 320.0);
             SkyObject *o;
             if ((o = data->skyComposite()->findByName("Sh2 " + QString::number(i))))
-                m_ObjectList[Sharpless].append(new SkyObjItem(o));
+                m_ObjectList[Sharpless].objects.append(o);
         }
-        updateModel(m_ObsConditions, "sharpless");
+        indexDirections(m_ObjectList[Sharpless]);
+        QMetaObject::invokeMethod(this, "refreshModel", Qt::QueuedConnection, Q_ARG(QString, "sharpless"));
         emit loadProgressUpdated(1);
     }
     sharplessLoaded = true;
@@ -222,76 +231,180 @@ void ModelManager::loadSharplessCatalog()
 void ModelManager::updateAllModels(ObsConditions *obs)
 {
     m_ObsConditions = obs;
-    resetAllModels();
 
     for (int i = 0; i < NumberOfLists; i++)
-        loadObjectsIntoModel(*m_ModelList[i], m_ObjectList[i]);
+        loadObjectsIntoModel(i, m_ObjectList[i]);
 }
 
 void ModelManager::updateModel(ObsConditions *obs, QString modelName)
 {
-    m_ObsConditions        = obs;
-    SkyObjListModel *model = returnModel(modelName);
-    if (model)
-    {
-        model->resetModel();
-        if (showOnlyFavorites && modelName == "galaxies")
-            loadObjectsIntoModel(*m_ModelList[getModelNumber(modelName)], favoriteGalaxies);
-        else if (showOnlyFavorites && modelName == "nebulas")
-            loadObjectsIntoModel(*m_ModelList[getModelNumber(modelName)], favoriteNebulas);
-        else if (showOnlyFavorites && modelName == "clusters")
-            loadObjectsIntoModel(*m_ModelList[getModelNumber(modelName)], favoriteClusters);
-        else
-            loadObjectsIntoModel(*m_ModelList[getModelNumber(modelName)], m_ObjectList[getModelNumber(modelName)]);
-        emit modelUpdated();
-    }
+    m_ObsConditions = obs;
+    int modelNumber = getModelNumber(modelName);
+    if (modelNumber < 0)
+        return;
+
+    if (showOnlyFavorites && modelName == "galaxies")
+        loadObjectsIntoModel(modelNumber, favoriteGalaxies);
+    else if (showOnlyFavorites && modelName == "nebulas")
+        loadObjectsIntoModel(modelNumber, favoriteNebulas);
+    else if (showOnlyFavorites && modelName == "clusters")
+        loadObjectsIntoModel(modelNumber, favoriteClusters);
+    else
+        loadObjectsIntoModel(modelNumber, m_ObjectList[modelNumber]);
 }
 
-void ModelManager::loadObjectList(QList<SkyObjItem *> &skyObjectList, int type)
+void ModelManager::refreshModel(const QString &modelName)
+{
+    updateModel(m_ObsConditions, modelName);
+}
+
+void ModelManager::loadObjectList(ObjectList &skyObjectList, int type)
 {
     if (KStars::Closing)
         return;
 
-    KStarsData *data                                   = KStarsData::Instance();
-    QVector<QPair<QString, const SkyObject *>> objects = data->skyComposite()->objectLists(type);
+    SkyMapComposite *composite                         = KStarsData::Instance()->skyComposite();
+    QVector<QPair<QString, const SkyObject *>> objects = composite->objectLists(type);
 
+    skyObjectList.objects.reserve(skyObjectList.objects.size() + objects.size());
     for (int i = 0; i < objects.size(); i++)
     {
         if (KStars::Closing)
             return;
 
-        QPair<QString, const SkyObject *> pair = objects.value(i);
-        const SkyObject *listObject            = pair.second;
-        if (listObject->name() != i18n("Sun"))
-            skyObjectList.append(new SkyObjItem(const_cast<SkyObject *>(listObject)));
+        const SkyObject *listObject = composite->objectOf(objects.value(i));
+        if (listObject != nullptr && listObject->name() != i18n("Sun"))
+            skyObjectList.objects.append(const_cast<SkyObject *>(listObject));
     }
-    QString prevName;
-    for (int i = 0; i < skyObjectList.size(); i++)
+
+    sortUnique(skyObjectList.objects);
+    indexDirections(skyObjectList);
+}
+
+void ModelManager::sortUnique(QVector<SkyObject *> &objects)
+{
+    std::stable_sort(objects.begin(), objects.end(), [](const SkyObject * a, const SkyObject * b)
     {
-        if (KStars::Closing)
-            return;
+        return a->name() < b->name();
+    });
 
-        SkyObjItem *obj = skyObjectList.at(i);
-        if (prevName == obj->getName())
-        {
-            skyObjectList.removeAt(i);
-            i--;
-        }
-        prevName = obj->getName();
+    objects.erase(std::unique(objects.begin(), objects.end(), [](const SkyObject * a, const SkyObject * b)
+    {
+        return a->name() == b->name();
+    }), objects.end());
+}
+
+void ModelManager::indexDirections(ObjectList &list)
+{
+    const int count = list.objects.size();
+    std::vector<double> ra(count), dec(count);
+    for (int i = 0; i < count; i++)
+    {
+        ra[i]  = list.objects[i]->ra0().radians();
+        dec[i] = list.objects[i]->dec0().radians();
     }
+    SkyPoint::toUnitVectors(ra.data(), dec.data(), count, list.j2000);
 }
 
-void ModelManager::loadObjectsIntoModel(SkyObjListModel &model, QList<SkyObjItem *> &skyObjectList)
+QVector<SkyObject *> ModelManager::visibleObjects(const ObjectList &list, const QVector<Visibility> &checked,
+        const KStarsDateTime &ut, const CachingDms &lst, const CachingDms &lat,
+        double magLimit)
 {
-    KStarsData *data = KStarsData::Instance();
+    // Precession is enough to tell whether an object is above the horizon limit
+    KSNumbers num(ut.djd());
+    SkyPoint::UnitVectors<double> ofDate;
+    SkyPoint::precess(&num, list.j2000, ofDate);
+
+    const int count = list.objects.size();
+    std::vector<double> alt(count), az(count);
+    SkyPoint::EquatorialToHorizontal(ofDate, lst, lat, alt.data(), az.data());
 
-    foreach (SkyObjItem *soitem, skyObjectList)
+    QVector<SkyObject *> visible;
+    for (int i = 0; i < count; i++)
     {
-        bool isVisible =
-            (showOnlyVisible) ? (m_ObsConditions->isVisible(data->geo(), data->lst(), soitem->getSkyObject())) : true;
+        bool isVisible = checked[i] != UNCHECKED ? checked[i] == VISIBLE :
+                         alt[i] > HORIZON_DEGREES * dms::DegToRad && list.objects[i]->mag() < magLimit;
         if (isVisible)
-            model.addSkyObject(soitem);
+            visible.append(list.objects[i]);
+    }
+    return visible;
+}
+
+void ModelManager::loadObjectsIntoModel(int modelNumber, const ObjectList &skyObjectList)
+{
+    const int generation = ++m_Generation[modelNumber];
+
+    if (!showOnlyVisible)
+    {
+        addChunk(modelNumber, skyObjectList.objects, 0, generation);
+        return;
     }
+
+    KStarsData *data = KStarsData::Instance();
+
+    // Satellites and bodies of the solar system move, they are checked one by one here.
+    // The others are checked together on a worker thread.
+    QVector<Visibility> checked(skyObjectList.objects.size(), UNCHECKED);
+    for (int i = 0; i < skyObjectList.objects.size(); i++)
+    {
+        SkyObject *o = skyObjectList.objects[i];
+        if (o->type() == SkyObject::SATELLITE || o->isSolarSystem())
+            checked[i] = m_ObsConditions->isVisible(data->geo(), data->lst(), o) ? VISIBLE : HIDDEN;
+    }
+
+    const KStarsDateTime ut = data->geo()->LTtoUT(KStarsDateTime(QDateTime::currentDateTime().toLocalTime()));
+    const CachingDms lst    = *data->lst();
+    const CachingDms lat    = *data->geo()->lat();
+    const double magLimit   = m_ObsConditions->getTrueMagLim();
+
+    QFutureWatcher<QVector<SkyObject *>> *watcher = new QFutureWatcher<QVector<SkyObject *>>(this);
+    connect(watcher, &QFutureWatcher<QVector<SkyObject *>>::finished, this, [this, watcher, modelNumber, generation]()
+    {
+        watcher->deleteLater();
+        addChunk(modelNumber, watcher->result(), 0, generation);
+    });
+    watcher->setFuture(QtConcurrent::run([ = ]()
+    {
+        return visibleObjects(skyObjectList, checked, ut, lst, lat, magLimit);
+    }));
+}
+
+void ModelManager::addChunk(int modelNumber, const QVector<SkyObject *> &objects, int start, int generation)
+{
+    // A newer update of the model replaces this one
+    if (KStars::Closing || generation != m_Generation[modelNumber])
+        return;
+
+    SkyObjListModel *model = m_ModelList[modelNumber];
+    const int end          = qMin(start + MODEL_CHUNK_SIZE, objects.size());
+
+    QList<SkyObjItem *> items;
+    for (int i = start; i < end; i++)
+        items.append(itemFor(objects[i]));
+
+    if (start == 0)
+        model->resetModel();
+    model->addSkyObjects(items);
+
+    // The view is refreshed once, later chunks are inserted into it
+    if (start == 0)
+        emit modelUpdated();
+
+    if (end < objects.size())
+    {
+        QTimer::singleShot(0, this, [this, modelNumber, objects, end, generation]()
+        {
+            addChunk(modelNumber, objects, end, generation);
+        });
+    }
+}
+
+SkyObjItem *ModelManager::itemFor(SkyObject *object)
+{
+    SkyObjItem *&item = m_Items[object];
+    if (item == nullptr)
+        item = new SkyObjItem(object);
+    return item;
 }
 
 void ModelManager::resetAllModels()
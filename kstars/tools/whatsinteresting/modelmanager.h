@@ -18,17 +18,27 @@
 #pragma once
 
 #include "skyobjitem.h"
+#include "skypoint.h"
 
+#include <QHash>
 #include <QList>
 #include <QObject>
+#include <QVector>
 
+class CachingDms;
+class KStarsDateTime;
 class ObsConditions;
+class SkyObject;
 class SkyObjListModel;
 
 /**
  * @class ModelManager
  * @brief Manages models for QML listviews of different types of sky-objects.
  *
+ * Lists only hold the sky-objects, a SkyObjItem is created the first time its object is shown.
+ * The visibility of the objects of a list is checked in bulk on a worker thread, and the visible
+ * ones are added to the model in chunks so that the interface stays responsive.
+ *
  * @author Samikshan Bairagya
  */
 class ModelManager : public QObject
@@ -103,20 +113,52 @@ class ModelManager : public QObject
     void loadProgressUpdated(double progress);
     void modelUpdated();
 
+  private slots:
+    void refreshModel(const QString &modelName);
+
   private:
+    /** Visibility of an object, as far as it was checked before the bulk check */
+    typedef enum
+    {
+        UNCHECKED,
+        HIDDEN,
+        VISIBLE
+    } Visibility;
+
+    /** Objects of a list, with their J2000 directions */
+    struct ObjectList
+    {
+        QVector<SkyObject *> objects;
+        SkyPoint::UnitVectors<double> j2000;
+    };
+
     void loadLists();
-    void loadObjectList(QList<SkyObjItem *> &skyObjectList, int type);
+    void loadObjectList(ObjectList &skyObjectList, int type);
     void loadNamedStarList();
-    void loadObjectsIntoModel(SkyObjListModel &model, QList<SkyObjItem *> &skyObjectList);
+
+    /** Sort the objects by name and keep one object of each name */
+    static void sortUnique(QVector<SkyObject *> &objects);
+    static void indexDirections(ObjectList &list);
+    static QVector<SkyObject *> visibleObjects(const ObjectList &list, const QVector<Visibility> &checked,
+            const KStarsDateTime &ut, const CachingDms &lst, const CachingDms &lat,
+            double magLimit);
+
+    void loadObjectsIntoModel(int modelNumber, const ObjectList &skyObjectList);
+    void addChunk(int modelNumber, const QVector<SkyObject *> &objects, int start, int generation);
+    SkyObjItem *itemFor(SkyObject *object);
 
     ObsConditions *m_ObsConditions { nullptr };
-    QList<QList<SkyObjItem *>> m_ObjectList;
+    QList<ObjectList> m_ObjectList;
     QList<SkyObjListModel *> m_ModelList;
+    // Incremented by each update of a model, so chunks of older updates are dropped
+    QVector<int> m_Generation;
+    // Items of all objects shown so far
+    QHash<SkyObject *, SkyObjItem *> m_Items;
     bool showOnlyVisible { true };
     bool showOnlyFavorites { true };
-    QList<SkyObjItem *> favoriteGalaxies;
-    QList<SkyObjItem *> favoriteNebulas;
-    QList<SkyObjItem *> favoriteClusters;
+    ObjectList favoriteGalaxies;
+    ObjectList favoriteNebulas;
+    ObjectList favoriteClusters;
     SkyObjListModel *tempModel { nullptr };
     bool ngcLoaded { false };
     bool icLoaded { false };
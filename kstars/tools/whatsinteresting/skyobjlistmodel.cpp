@@ -46,6 +46,16 @@ void SkyObjListModel::addSkyObject(SkyObjItem *soitem)
     endInsertRows();
 }
 
+void SkyObjListModel::addSkyObjects(const QList<SkyObjItem *> &items)
+{
+    if (items.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), rowCount(), rowCount() + items.size() - 1);
+    m_SoItemList.append(items);
+    endInsertRows();
+}
+
 int SkyObjListModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent)
@@ -88,5 +98,7 @@ int SkyObjListModel::getSkyObjIndex(SkyObjItem *item)
 
 void SkyObjListModel::resetModel()
 {
+    beginResetModel();
     m_SoItemList.clear();
+    endResetModel();
 }
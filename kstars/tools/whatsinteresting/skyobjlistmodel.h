@@ -41,6 +41,13 @@ class SkyObjListModel : public QAbstractListModel
      */
     void addSkyObject(SkyObjItem *sobj);
 
+    /**
+     * @brief Add sky-objects to the end of the model at once.
+     * @param items
+     * Pointers to the sky-objects to be added.
+     */
+    void addSkyObjects(const QList<SkyObjItem *> &items);
+
     /**
      * @brief Create and return a QHash<int, QByteArray> of rolenames for the SkyObjItem.
      * @return QHash<int, QByteArray> of rolenames for the SkyObjItem.
@@ -289,9 +289,9 @@ void WUTDialog::slotLoadList(const QString &c)
 
             for (const auto &object : starObjects)
             {
-                const SkyObject *o =  object.second;
+                const SkyObject *o = data->skyComposite()->objectOf(object);
 
-                if (checkVisibility(o) && o->mag() <= m_Mag)
+                if (o != nullptr && checkVisibility(o) && o->mag() <= m_Mag)
                 {
                     visibleObjects(c).insert(o);
                 }